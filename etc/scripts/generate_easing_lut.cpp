@@ -0,0 +1,86 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file etc/scripts/generate_easing_lut.cpp
+ * \brief Generates the precomputed easing lookup tables in \c src/lights/easing_lut.cpp
+ *
+ * The tables are sampled directly from the easing functions in
+ * \c src/lights/transition.cpp so the fixed-point and the floating-point
+ * transition paths never drift apart. Regenerate the tables after modifying
+ * any of the easing functions:
+ *
+ * \code
+ * c++ -I src/lights -o generate_easing_lut etc/scripts/generate_easing_lut.cpp src/lights/transition.cpp
+ * ./generate_easing_lut > src/lights/easing_lut.cpp
+ * \endcode
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "transition.h"
+
+static const char* EASING_MODE_NAMES[NUM_EASING_FUNCTIONS] = {
+    "LINEAR",
+    "IN_SINE", "OUT_SINE", "IN_OUT_SINE",
+    "IN_QUAD", "OUT_QUAD", "IN_OUT_QUAD",
+    "IN_CUBIC", "OUT_CUBIC", "IN_OUT_CUBIC",
+    "IN_QUART", "OUT_QUART", "IN_OUT_QUART",
+    "IN_QUINT", "OUT_QUINT", "IN_OUT_QUINT",
+    "IN_EXPO", "OUT_EXPO", "IN_OUT_EXPO",
+    "IN_CIRC", "OUT_CIRC", "IN_OUT_CIRC",
+    "IN_BACK", "OUT_BACK", "IN_OUT_BACK",
+    "IN_ELASTIC", "OUT_ELASTIC", "IN_OUT_ELASTIC",
+    "IN_BOUNCE", "OUT_BOUNCE", "IN_OUT_BOUNCE"
+};
+
+int main(void)
+{
+    int mode, i;
+    FILE* fp;
+    char line[256];
+
+    /* Copy the license header of this file verbatim */
+    fp = fopen(__FILE__, "r");
+    if (fp) {
+        for (i = 0; i < 18 && fgets(line, sizeof(line), fp); i++) {
+            fputs(line, stdout);
+        }
+        fclose(fp);
+    }
+
+    printf("\n/* This file was generated by etc/scripts/generate_easing_lut.cpp; do not edit. */\n\n");
+    printf("#include \"transition.h\"\n\n");
+    printf("const int16_t EASING_LUTS[NUM_EASING_FUNCTIONS][EASING_LUT_SIZE] = {\n");
+
+    for (mode = 0; mode < NUM_EASING_FUNCTIONS; mode++) {
+        printf("    /* EASING_%s */\n    {", EASING_MODE_NAMES[mode]);
+        for (i = 0; i < EASING_LUT_SIZE; i++) {
+            transition_progress_t progress = ((transition_progress_t)i) / (EASING_LUT_SIZE - 1);
+            long value = lround(EASING_FUNCTIONS[mode](progress) * TRANSITION_FIXED_ONE);
+            printf("%s%ld%s", i % 13 == 0 ? "\n        " : " ", value, i < EASING_LUT_SIZE - 1 ? "," : "");
+        }
+        printf(" }%s\n", mode < NUM_EASING_FUNCTIONS - 1 ? "," : "");
+    }
+
+    printf("};\n");
+
+    return 0;
+}
@@ -35,12 +35,19 @@ __BEGIN_DECLS
 
 /**
  * @brief Dynamic buffer of bytes that can grow or shrink as needed.
+ *
+ * When the buffer needs to grow, its capacity is at least doubled so
+ * appending to the buffer takes amortized constant time. Use
+ * \ref sb_buffer_reserve() if the final size of the buffer is known in
+ * advance, and \ref sb_buffer_shrink_to_fit() to release the excess memory
+ * when the buffer is not going to grow any more.
  */
 typedef struct {
     uint8_t* stor_begin; /**< Start of the buffer */
     uint8_t* end; /**< End of the \em used part of the buffer */
     uint8_t* stor_end; /**< End of the allocated storage area */
     sb_bool_t owned; /**< Whether the struct owns the internal buffer */
+    sb_bool_t borrowed; /**< Whether the storage area was provided by the caller and must be moved to the heap when the buffer grows */
 } sb_buffer_t;
 
 /**
@@ -52,6 +59,7 @@ typedef struct {
 sb_error_t sb_buffer_init(sb_buffer_t* buf, size_t initial_size);
 sb_error_t sb_buffer_init_from_bytes(sb_buffer_t* buf, void* bytes, size_t num_bytes);
 void sb_buffer_init_view(sb_buffer_t* buf, void* bytes, size_t num_bytes);
+void sb_buffer_init_with_storage(sb_buffer_t* buf, void* storage, size_t capacity);
 void sb_buffer_destroy(sb_buffer_t* buf);
 
 size_t sb_buffer_capacity(const sb_buffer_t* buf);
@@ -61,12 +69,15 @@ size_t sb_buffer_size(const sb_buffer_t* buf);
 sb_error_t sb_buffer_clear(sb_buffer_t* buf);
 sb_error_t sb_buffer_resize(sb_buffer_t* buf, size_t new_size);
 sb_error_t sb_buffer_prune(sb_buffer_t* buf);
+sb_error_t sb_buffer_reserve(sb_buffer_t* buf, size_t capacity);
+sb_error_t sb_buffer_shrink_to_fit(sb_buffer_t* buf);
 
 void sb_buffer_fill(sb_buffer_t* buf, uint8_t value);
 sb_error_t sb_buffer_append_byte(sb_buffer_t* buf, uint8_t byte);
 sb_error_t sb_buffer_append_bytes(sb_buffer_t* buf, const void* bytes, size_t num_bytes);
 sb_error_t sb_buffer_concat(sb_buffer_t* buf, const sb_buffer_t* other);
 sb_error_t sb_buffer_extend_with_zeros(sb_buffer_t* buf, size_t num_zeros);
+sb_error_t sb_buffer_extend_uninitialized(sb_buffer_t* buf, size_t num_bytes, uint8_t** ptr);
 
 __END_DECLS
 
@@ -78,6 +78,12 @@ typedef struct {
     } params;
 } sb_rgbw_conversion_t;
 
+/**
+ * Fixed-point representation of an interpolation ratio of 1 for
+ * \ref sb_rgb_color_linear_interpolation_fixed()
+ */
+#define SB_RGB_COLOR_FIXED_RATIO_ONE 16384
+
 /**
  * Constant for the black color.
  */
@@ -94,6 +100,8 @@ sb_bool_t sb_rgb_color_equals(sb_rgb_color_t first, sb_rgb_color_t second);
 sb_bool_t sb_rgb_color_almost_equals(sb_rgb_color_t first, sb_rgb_color_t second, uint8_t eps);
 sb_rgb_color_t sb_rgb_color_linear_interpolation(
     sb_rgb_color_t first, sb_rgb_color_t second, float ratio);
+sb_rgb_color_t sb_rgb_color_linear_interpolation_fixed(
+    sb_rgb_color_t first, sb_rgb_color_t second, int32_t ratio);
 sb_rgb_color_t sb_rgb_color_make(uint8_t red, uint8_t green, uint8_t blue);
 sb_rgbw_color_t sb_rgb_color_to_rgbw(sb_rgb_color_t color, sb_rgbw_conversion_t conv);
 sb_rgb_color_t sb_rgb_color_from_color_temperature(float temperature);
@@ -0,0 +1,170 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKYBRUSH_FLEET_H
+#define SKYBRUSH_FLEET_H
+
+#include <skybrush/basic_types.h>
+#include <skybrush/colors.h>
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+#include <skybrush/lights.h>
+#include <skybrush/trajectory.h>
+#include <skybrush/yaw_control.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file fleet.h
+ * @brief Frame-synchronous sampling of the trajectories, yaw setpoints and
+ * light programs of an entire fleet, and spatio-temporal proximity queries
+ * over the trajectories of a fleet.
+ */
+
+/**
+ * @brief Structure that owns a trajectory, a yaw and a light player for each
+ * drone in a fleet and evaluates all of them at the same timestamp.
+ */
+typedef struct sb_fleet_sampler_s {
+    /** The trajectory players, one for each drone */
+    sb_trajectory_player_t* trajectory_players;
+
+    /** The yaw players, one for each drone, or null if the yaw angles are
+     * taken from the trajectories */
+    sb_yaw_player_t* yaw_players;
+
+    /** The light players of the fleet; empty if the fleet has no light programs */
+    sb_light_fleet_player_t light_players;
+
+    /** The number of drones in the fleet */
+    size_t num_drones;
+
+    /** Number of threads to use when sampling the fleet; zero means one
+     * thread per CPU core, one means that everything is evaluated on the
+     * calling thread */
+    size_t num_threads;
+} sb_fleet_sampler_t;
+
+sb_error_t sb_fleet_sampler_init(
+    sb_fleet_sampler_t* sampler, const sb_trajectory_t* trajectories,
+    const sb_yaw_control_t* yaw_controls, const sb_light_program_t* programs,
+    size_t num_drones);
+void sb_fleet_sampler_destroy(sb_fleet_sampler_t* sampler);
+size_t sb_fleet_sampler_size(const sb_fleet_sampler_t* sampler);
+void sb_fleet_sampler_set_num_threads(sb_fleet_sampler_t* sampler, size_t num_threads);
+sb_error_t sb_fleet_sampler_sample_at(
+    sb_fleet_sampler_t* sampler, unsigned long timestamp,
+    float* x, float* y, float* z, float* yaw, sb_rgb_color_t* colors);
+
+/**
+ * @brief A single trajectory segment of a drone in a fleet index, together
+ * with the region of space-time that the segment may occupy.
+ */
+typedef struct sb_fleet_index_item_s {
+    /** Bounding box of the segment in space */
+    sb_bounding_box_t box;
+
+    /** Start time of the segment, in milliseconds */
+    uint32_t start_time_msec;
+
+    /** End time of the segment, in milliseconds */
+    uint32_t end_time_msec;
+
+    /** Index of the drone that the segment belongs to */
+    uint32_t drone;
+
+    /** Index of the segment in the trajectory of the drone; equal to the
+     * number of segments for the stationary period after the end of the
+     * trajectory */
+    uint32_t segment;
+} sb_fleet_index_item_t;
+
+/**
+ * @brief A node in the bounding volume hierarchy of a fleet index.
+ *
+ * The left child of an internal node always immediately follows the node
+ * itself in the node array.
+ */
+typedef struct sb_fleet_index_node_s {
+    /** Bounding box of all the segments below the node in space */
+    sb_bounding_box_t box;
+
+    /** Earliest start time of all the segments below the node */
+    uint32_t start_time_msec;
+
+    /** Latest end time of all the segments below the node */
+    uint32_t end_time_msec;
+
+    /** Index of the first item for leaf nodes, index of the right child for
+     * internal nodes */
+    uint32_t first;
+
+    /** Number of items in a leaf node; zero for internal nodes */
+    uint32_t count;
+} sb_fleet_index_node_t;
+
+/**
+ * @brief Spatio-temporal index over the trajectories of a fleet that answers
+ * queries like "which drones are within a given distance of a point at a
+ * given time" without evaluating the trajectory of every drone.
+ */
+typedef struct sb_fleet_index_s {
+    /** Trajectory players, one for each drone, used to calculate the exact
+     * positions of the candidate drones */
+    sb_trajectory_player_t* players;
+
+    /** The trajectory segments of all the drones, in the order of the leaves
+     * of the bounding volume hierarchy */
+    sb_fleet_index_item_t* items;
+
+    /** Number of items in the index */
+    size_t num_items;
+
+    /** Nodes of the bounding volume hierarchy; the first one is the root */
+    sb_fleet_index_node_t* nodes;
+
+    /** Number of nodes in the bounding volume hierarchy */
+    size_t num_nodes;
+
+    /** Identifier of the last query for each drone, used to evaluate each
+     * drone at most once per query */
+    uint32_t* last_query;
+
+    /** Identifier of the last query */
+    uint32_t query_id;
+
+    /** The number of drones in the fleet */
+    size_t num_drones;
+} sb_fleet_index_t;
+
+sb_error_t sb_fleet_index_init(
+    sb_fleet_index_t* index, const sb_trajectory_t* trajectories,
+    size_t num_drones, size_t num_threads);
+void sb_fleet_index_destroy(sb_fleet_index_t* index);
+size_t sb_fleet_index_size(const sb_fleet_index_t* index);
+sb_error_t sb_fleet_index_find_near_point(
+    sb_fleet_index_t* index, unsigned long timestamp, sb_vector3_with_yaw_t point,
+    float radius, size_t* drones, size_t max_drones, size_t* num_found);
+sb_error_t sb_fleet_index_find_near_drone(
+    sb_fleet_index_t* index, unsigned long timestamp, size_t drone,
+    float radius, size_t* drones, size_t max_drones, size_t* num_found);
+
+__END_DECLS
+
+#endif
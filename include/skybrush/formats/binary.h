@@ -70,6 +70,33 @@ typedef enum {
     SB_BINARY_FEATURE_CRC32 = 1
 } sb_binary_header_feature_t;
 
+/**
+ * Flags that modify the behaviour of a binary file parser.
+ */
+typedef enum {
+    /** Verify the CRC32 checksum of the file (if it has one) when the parser
+     * is initialized. This is the default. */
+    SB_BINARY_PARSER_VERIFY_CRC_EAGER = 0,
+
+    /** Verify the CRC32 checksum of the file (if it has one) when the body of
+     * a block is accessed for the first time */
+    SB_BINARY_PARSER_VERIFY_CRC_LAZY = 1,
+
+    /** Do not verify the CRC32 checksum of the file */
+    SB_BINARY_PARSER_VERIFY_CRC_SKIP = 2,
+
+    /** Mask that selects the CRC verification mode from the flags */
+    SB_BINARY_PARSER_VERIFY_CRC_MASK = 3,
+
+    /** Look up the result of the CRC32 verification in a process-wide cache
+     * and store successful verifications there. Files are identified by their
+     * device, inode, modification time and size; in-memory buffers are
+     * identified by their address and size. Use this flag only if the
+     * contents of the file or buffer are not modified in a way that would
+     * keep these properties intact. */
+    SB_BINARY_PARSER_USE_CRC_CACHE = 4
+} sb_binary_file_parser_flags_t;
+
 /**
  * Struct representing a single block in the Skybrush binary file format.
  */
@@ -93,6 +120,10 @@ typedef struct
 
     uint8_t version; /**< The schema version number of the file being parsed */
     uint8_t features; /**< The feature bits that describe the additional info present in the header (checksums etc) */
+    uint8_t flags; /**< Flags that modify the behaviour of the parser; see \ref sb_binary_file_parser_flags_t */
+
+    uint32_t expected_crc32; /**< The CRC32 checksum stored in the header of the file */
+    sb_bool_t crc32_pending; /**< Whether the CRC32 checksum of the file still needs to be verified */
 
     long int start_of_first_block; /**< Start position of the first block in the file */
     sb_binary_block_t current_block; /**< The current block in the file */
@@ -116,6 +147,31 @@ sb_error_t sb_binary_file_parser_init_from_buffer(
  */
 sb_error_t sb_binary_file_parser_init_from_file(sb_binary_file_parser_t* parser, int fd);
 
+/**
+ * Creates a new parser object backed by an in-memory buffer, with the given
+ * flags.
+ *
+ * \param  parser  the parser to initialize
+ * \param  buf     the buffer that the parser will parse
+ * \param  nbytes  the number of bytes in the buffer
+ * \param  flags   flags that modify the behaviour of the parser; see
+ *         \ref sb_binary_file_parser_flags_t
+ */
+sb_error_t sb_binary_file_parser_init_from_buffer_with_flags(
+    sb_binary_file_parser_t* parser, uint8_t* buf, size_t nbytes, uint8_t flags);
+
+/**
+ * Creates a new parser object backed by a file descriptor, with the given
+ * flags.
+ *
+ * \param  parser  the parser to initialize
+ * \param  fd      the file descriptor that the parser will read
+ * \param  flags   flags that modify the behaviour of the parser; see
+ *         \ref sb_binary_file_parser_flags_t
+ */
+sb_error_t sb_binary_file_parser_init_from_file_with_flags(
+    sb_binary_file_parser_t* parser, int fd, uint8_t flags);
+
 /**
  * Destroys a parser object, releasing all the resources that it holds.
  */
@@ -150,9 +206,30 @@ sb_bool_t sb_binary_file_is_current_block_valid(const sb_binary_file_parser_t* p
  * Reads the next block from the Skybrush binary file into the buffer pointed
  * to by the given pointer. The buffer must be large enough to hold the
  * entire block.
+ *
+ * Returns \c SB_ECORRUPTED if the parser verifies the checksum of the file
+ * lazily and the checksum does not match.
  */
 sb_error_t sb_binary_file_read_current_block(sb_binary_file_parser_t* parser, uint8_t* buf);
 
+/**
+ * Returns a pointer to the body of the current block in the in-memory buffer
+ * that the parser is parsing, without copying it.
+ *
+ * The returned pointer points into the buffer that was passed to
+ * \ref sb_binary_file_parser_init_from_buffer() so it is valid for as long
+ * as that buffer is valid.
+ *
+ * \param parser  the parser
+ * \param result  the pointer to the body of the current block is returned here
+ * \return \c SB_EREAD if there is no current block, \c SB_EUNSUPPORTED if
+ *         the parser reads from a file and not from an in-memory buffer,
+ *         \c SB_ECORRUPTED if the parser verifies the checksum of the file
+ *         lazily and the checksum does not match, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_binary_file_get_current_block_view(
+    sb_binary_file_parser_t* parser, uint8_t** result);
+
 /**
  * Rewinds to the first block of the Skybrush binary file.
  */
@@ -165,6 +242,12 @@ sb_error_t sb_binary_file_rewind(sb_binary_file_parser_t* parser);
  */
 sb_error_t sb_binary_file_seek_to_next_block(sb_binary_file_parser_t* parser);
 
+/**
+ * Removes all the entries from the process-wide cache of verified CRC32
+ * checksums; see \ref SB_BINARY_PARSER_USE_CRC_CACHE.
+ */
+void sb_binary_file_crc_cache_clear(void);
+
 __END_DECLS
 
 #endif
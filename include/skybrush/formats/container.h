@@ -0,0 +1,230 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKYBRUSH_FORMATS_CONTAINER_H
+#define SKYBRUSH_FORMATS_CONTAINER_H
+
+#include <stdlib.h>
+
+#include <skybrush/basic_types.h>
+#include <skybrush/buffer.h>
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+#include <skybrush/formats/binary.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file container.h
+ * Functions related to the Skybrush container format that stores the show
+ * files of many drones in a single file.
+ *
+ * A container starts with a 16-byte header that consists of the magic bytes
+ * \c skyc, a version number, three reserved bytes, the number of entries and
+ * an AP-CRC32 checksum of the directory table, all integers being
+ * little-endian. The header is followed by the directory table that has one
+ * 16-byte entry for each drone, sorted by drone ID; each entry contains the
+ * ID of the drone, the offset and the length of the show file of the drone
+ * within the container, and an AP-CRC32 checksum of the show file. Show files
+ * are stored after the directory table, each one starting at an offset that
+ * is a multiple of \ref SB_CONTAINER_ALIGNMENT such that the container can
+ * be memory-mapped and the show files can be accessed in-place.
+ *
+ * Each show file in the container is a complete Skybrush binary show file so
+ * it can be parsed with the functions in \ref binary.h .
+ */
+
+/**
+ * Alignment of the show files within the container, in bytes.
+ */
+#define SB_CONTAINER_ALIGNMENT 8
+
+/**
+ * Version number of the container format written by the container builder.
+ */
+#define SB_CONTAINER_VERSION 1
+
+/**
+ * Struct representing an entry in the directory table of a container.
+ */
+typedef struct
+{
+    uint32_t id; /**< ID of the drone that the entry belongs to */
+    uint32_t offset; /**< Offset of the show file of the drone from the start of the container */
+    uint32_t length; /**< Length of the show file of the drone, in bytes */
+    uint32_t crc32; /**< AP-CRC32 checksum of the show file of the drone */
+} sb_container_entry_t;
+
+/**
+ * Struct representing a container that holds the show files of many drones.
+ *
+ * The container does not own the memory area that it was initialized from;
+ * the show files of the drones are accessed in-place.
+ */
+typedef struct
+{
+    uint8_t* buf; /**< The memory area holding the container */
+    size_t nbytes; /**< Number of bytes in the memory area holding the container */
+    uint32_t num_entries; /**< Number of entries in the directory table */
+} sb_container_t;
+
+/**
+ * Initializes a container from an in-memory buffer, typically a memory-mapped
+ * file.
+ *
+ * The header and the directory table of the container are validated;
+ * the show files are not verified until they are accessed. The buffer must
+ * remain valid while the container is in use.
+ *
+ * \param  container  the container to initialize
+ * \param  buf        the buffer holding the container
+ * \param  nbytes     the number of bytes in the buffer
+ * \return \c SB_EPARSE if the buffer does not contain a valid container,
+ *         \c SB_ECORRUPTED if the checksum of the directory table does not
+ *         match, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_init_from_buffer(
+    sb_container_t* container, uint8_t* buf, size_t nbytes);
+
+/**
+ * Destroys a container. The buffer that the container was initialized from
+ * is not freed.
+ */
+void sb_container_destroy(sb_container_t* container);
+
+/**
+ * Returns the number of drones in the container.
+ */
+uint32_t sb_container_get_num_entries(const sb_container_t* container);
+
+/**
+ * Returns the entry with the given index from the directory table of the
+ * container. Entries are sorted by drone ID.
+ *
+ * \return \c SB_EINVAL if the index is out of bounds, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_get_entry(
+    const sb_container_t* container, uint32_t index, sb_container_entry_t* entry);
+
+/**
+ * Finds the entry of the drone with the given ID in the directory table of
+ * the container, using binary search.
+ *
+ * \param  container  the container
+ * \param  id         the ID of the drone
+ * \param  entry      the entry is returned here if it is not null
+ * \return \c SB_ENOENT if there is no drone with the given ID in the
+ *         container, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_find_entry(
+    const sb_container_t* container, uint32_t id, sb_container_entry_t* entry);
+
+/**
+ * Returns a pointer to the show file of the drone with the given ID within
+ * the container, without copying it.
+ *
+ * \param  container  the container
+ * \param  id         the ID of the drone
+ * \param  verify     whether to verify the checksum of the show file
+ * \param  result     the pointer to the show file is returned here if it is
+ *         not null
+ * \param  nbytes     the length of the show file is returned here if it is
+ *         not null
+ * \return \c SB_ENOENT if there is no drone with the given ID in the
+ *         container, \c SB_ECORRUPTED if the checksum of the show file does
+ *         not match, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_get_show_view(
+    const sb_container_t* container, uint32_t id, sb_bool_t verify,
+    uint8_t** result, size_t* nbytes);
+
+/**
+ * Initializes a binary file parser that parses the show file of the drone
+ * with the given ID within the container, in-place.
+ *
+ * The objects in the show file can then be initialized with the
+ * \c *_init_from_parser() functions as views into the container. The checksum
+ * of the show file in the directory table is verified unless the flags
+ * request \ref SB_BINARY_PARSER_VERIFY_CRC_SKIP . The parser itself never
+ * verifies the checksum again as the directory table already covers it.
+ *
+ * \param  container  the container
+ * \param  id         the ID of the drone
+ * \param  parser     the parser to initialize
+ * \param  flags      flags of the parser; see \ref sb_binary_file_parser_flags_t
+ * \return \c SB_ENOENT if there is no drone with the given ID in the
+ *         container, \c SB_ECORRUPTED if the checksum of the show file does
+ *         not match, or any error returned by
+ *         \ref sb_binary_file_parser_init_from_buffer_with_flags()
+ */
+sb_error_t sb_container_init_parser(
+    const sb_container_t* container, uint32_t id,
+    sb_binary_file_parser_t* parser, uint8_t flags);
+
+/**
+ * Struct representing a builder that assembles a container from the show
+ * files of individual drones.
+ */
+typedef struct
+{
+    sb_buffer_t directory; /**< Directory entries added so far, in the order they were added */
+    sb_buffer_t payload; /**< Show files added so far, padded to the alignment of the container */
+} sb_container_builder_t;
+
+/**
+ * Initializes an empty container builder.
+ */
+sb_error_t sb_container_builder_init(sb_container_builder_t* builder);
+
+/**
+ * Destroys a container builder, releasing all the resources that it holds.
+ */
+void sb_container_builder_destroy(sb_container_builder_t* builder);
+
+/**
+ * Adds the show file of a drone to the container being built. The show file
+ * is copied into the builder.
+ *
+ * \param  builder  the builder
+ * \param  id       the ID of the drone
+ * \param  show     the show file of the drone in Skybrush binary format
+ * \param  nbytes   the length of the show file
+ * \return \c SB_EOVERFLOW if the container would not fit in 4 GB,
+ *         \c SB_ENOMEM if memory allocation failed, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_builder_add(
+    sb_container_builder_t* builder, uint32_t id, const uint8_t* show, size_t nbytes);
+
+/**
+ * Assembles the container from the show files added to the builder so far.
+ *
+ * \param  builder  the builder
+ * \param  result   an uninitialized buffer that will be initialized with the
+ *         contents of the container. The caller is responsible for destroying
+ *         the buffer.
+ * \return \c SB_EINVAL if the same drone ID was added more than once,
+ *         \c SB_EOVERFLOW if the container would not fit in 4 GB,
+ *         \c SB_ENOMEM if memory allocation failed, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_container_builder_get_result(
+    const sb_container_builder_t* builder, sb_buffer_t* result);
+
+__END_DECLS
+
+#endif
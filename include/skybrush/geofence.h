@@ -0,0 +1,67 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKYBRUSH_GEOFENCE_H
+#define SKYBRUSH_GEOFENCE_H
+
+#include <skybrush/basic_types.h>
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+#include <skybrush/trajectory.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file geofence.h
+ * @brief Checking trajectories against polygonal geofences with altitude limits.
+ */
+
+/**
+ * @brief Structure representing a geofence.
+ *
+ * The geofence is a vertical prism: a simple polygon in the XY plane,
+ * extruded between a minimum and a maximum altitude.
+ */
+typedef struct sb_geofence_s {
+    /** The vertices of the polygon, in the XY plane */
+    sb_vector2_t* vertices;
+
+    /** The number of vertices of the polygon */
+    size_t num_vertices;
+
+    /** The bounding box of the geofence. The Z interval of the bounding box
+     * is the allowed altitude range. */
+    sb_bounding_box_t bounding_box;
+} sb_geofence_t;
+
+sb_error_t sb_geofence_init(
+    sb_geofence_t* fence, const sb_vector2_t* vertices, size_t num_vertices,
+    float min_altitude, float max_altitude);
+void sb_geofence_destroy(sb_geofence_t* fence);
+sb_bool_t sb_geofence_contains(const sb_geofence_t* fence, sb_vector3_with_yaw_t point);
+sb_error_t sb_geofence_check_trajectory(
+    const sb_geofence_t* fence, const sb_trajectory_t* trajectory,
+    float* violation_time_sec);
+sb_error_t sb_geofence_check_trajectories_parallel(
+    const sb_geofence_t* fence, const sb_trajectory_t* trajectories,
+    size_t num_trajectories, float* violation_times_sec, size_t num_threads);
+
+__END_DECLS
+
+#endif
@@ -26,6 +26,8 @@
 #include <skybrush/colors.h>
 #include <skybrush/decls.h>
 #include <skybrush/error.h>
+#include <skybrush/formats/binary.h>
+#include <skybrush/perf_counters.h>
 
 __BEGIN_DECLS
 
@@ -63,6 +65,18 @@ sb_error_t sb_light_program_init_from_binary_file(sb_light_program_t* program, i
 sb_error_t sb_light_program_init_from_binary_file_in_memory(
     sb_light_program_t* program, uint8_t* buf, size_t length);
 
+/**
+ * Initializes a light program object from the first light program block found
+ * by an already open binary file parser. The program refers to the buffer of
+ * the parser if the parser reads from memory.
+ *
+ * \return \c SB_SUCCESS if the object was initialized successfully,
+ *         \c SB_ENOENT if the file did not contain a light program block,
+ *         \c SB_EREAD for read errors
+ */
+sb_error_t sb_light_program_init_from_parser(
+    sb_light_program_t* program, sb_binary_file_parser_t* parser);
+
 /**
  * Initializes a light program object from the contents of a memory buffer.
  *
@@ -87,6 +101,161 @@ void sb_light_program_destroy(sb_light_program_t* program);
  */
 void sb_light_program_clear(sb_light_program_t* program);
 
+/**
+ * Flags that describe the properties of a light program that were found
+ * during a static analysis with \ref sb_light_program_analyze().
+ */
+typedef enum {
+    /** The program arms triggers that may change the flow of the program at runtime */
+    SB_LIGHT_PROGRAM_HAS_TRIGGERS = 1,
+
+    /** The program has colors that depend on the values of input channels */
+    SB_LIGHT_PROGRAM_USES_CHANNELS = 2,
+
+    /** The program never reaches its end */
+    SB_LIGHT_PROGRAM_INFINITE = 4,
+
+    /** The program nests loops deeper than what the light player supports */
+    SB_LIGHT_PROGRAM_LOOPS_TOO_DEEP = 8,
+
+    /** The program contains an invalid command code or jump address */
+    SB_LIGHT_PROGRAM_INVALID = 16,
+
+    /** The analysis gave up before reaching the end of the program */
+    SB_LIGHT_PROGRAM_TOO_COMPLEX = 32
+} sb_light_program_analysis_flags_t;
+
+/**
+ * Structure holding the results of the static analysis of a light program.
+ */
+typedef struct sb_light_program_analysis_s {
+    /**
+     * Total duration of the program, in milliseconds. \c UINT32_MAX if the
+     * program never ends or if it is longer than what fits in this field.
+     */
+    uint32_t duration_msec;
+
+    /** The color of the light at the end of the program */
+    sb_rgb_color_t final_color;
+
+    /** The state of the pyro channels at the end of the program */
+    uint8_t final_pyro_channels;
+
+    /** The maximum nesting depth of loops in the program */
+    uint8_t max_loop_depth;
+
+    /** Combination of flags from \ref sb_light_program_analysis_flags_t */
+    uint8_t flags;
+} sb_light_program_analysis_t;
+
+/**
+ * Analyzes a light program without playing it.
+ *
+ * The analysis walks the bytecode of the program once, multiplying the
+ * durations of loop bodies with their iteration counts instead of executing
+ * them over and over again, and reports the total duration of the program
+ * and the state of the lights and the pyro channels at the end.
+ *
+ * The results assume that no triggers fire while the program is running.
+ * Colors that depend on input channels are assumed to be black, just like
+ * in a \c sb_light_player_t , which has no input channels. Check the
+ * \c flags field of the result to see whether these assumptions matter for
+ * the program. When the program never ends, the final color and pyro
+ * channels describe the state at the point where the analysis detected the
+ * infinite repetition.
+ *
+ * \param  program  the light program to analyze
+ * \param  result   the results of the analysis are returned here
+ * \return \c SB_SUCCESS if the analysis was completed, \c SB_ENOMEM if there
+ *         was not enough memory to decode the program
+ */
+sb_error_t sb_light_program_analyze(
+    const sb_light_program_t* program, sb_light_program_analysis_t* result);
+
+/**
+ * A single change of the pyro channels in a light program.
+ */
+typedef struct sb_light_pyro_event_s {
+    /** The timestamp of the change, in milliseconds */
+    uint32_t time_msec;
+
+    /** The state of the pyro channels before the change */
+    uint8_t channels_before;
+
+    /** The state of the pyro channels after the change */
+    uint8_t channels_after;
+} sb_light_pyro_event_t;
+
+/**
+ * List of all the changes of the pyro channels in a light program, sorted
+ * by time, with loops unrolled.
+ */
+typedef struct sb_light_pyro_events_s {
+    /** The events in the list, sorted by time; no two events share a timestamp */
+    sb_light_pyro_event_t* events;
+
+    /** The number of events in the list */
+    size_t num_events;
+
+    /** The number of events that the list can hold without reallocation */
+    size_t capacity;
+
+    /**
+     * Combination of flags from \ref sb_light_program_analysis_flags_t ,
+     * describing the light program that the events were extracted from
+     */
+    uint8_t flags;
+} sb_light_pyro_events_t;
+
+/**
+ * Extracts all the changes of the pyro channels from a light program in a
+ * single pass, without running the light player.
+ *
+ * The same assumptions apply as in \ref sb_light_program_analyze() ; in
+ * particular, triggers are assumed not to fire. When the program never ends,
+ * the list contains the events up to the point where the infinite repetition
+ * was detected; check the \c flags field of the list for
+ * \c SB_LIGHT_PROGRAM_INFINITE . Multiple changes at the same timestamp are
+ * merged into one event, and changes that cancel each other at the same
+ * timestamp are omitted.
+ *
+ * \param  events   the event list to initialize
+ * \param  program  the light program to extract the events from
+ * \return \c SB_SUCCESS if the events were extracted, \c SB_ENOMEM if there
+ *         was not enough memory
+ */
+sb_error_t sb_light_pyro_events_init_from_program(
+    sb_light_pyro_events_t* events, const sb_light_program_t* program);
+
+/**
+ * Destroys a pyro event list and releases all memory that it owns.
+ *
+ * \param  events  the event list to destroy
+ */
+void sb_light_pyro_events_destroy(sb_light_pyro_events_t* events);
+
+/**
+ * Returns the state of the pyro channels at the given timestamp using a
+ * binary search in the event list. Events are considered to be in effect
+ * from their own timestamp.
+ *
+ * \param  events     the event list
+ * \param  timestamp  the timestamp to query, in milliseconds
+ */
+uint8_t sb_light_pyro_events_get_channels_at(
+    const sb_light_pyro_events_t* events, unsigned long timestamp);
+
+/**
+ * Returns the first event that happens strictly after the given timestamp.
+ *
+ * \param  events     the event list
+ * \param  timestamp  the timestamp to query, in milliseconds
+ * \return the next event or \c NULL if there are no more events after the
+ *         given timestamp
+ */
+const sb_light_pyro_event_t* sb_light_pyro_events_get_next(
+    const sb_light_pyro_events_t* events, unsigned long timestamp);
+
 /**
  * Structure that represents a \c libskybrush light program player that the
  * calling code can "ask" what color the light program dictates at any given
@@ -119,6 +288,21 @@ typedef struct sb_light_player_s {
     unsigned long next_timestamp;
 } sb_light_player_t;
 
+/**
+ * Size of a light player snapshot, in bytes.
+ */
+#define SB_LIGHT_PLAYER_SNAPSHOT_SIZE 192
+
+/**
+ * Opaque plain-old-data snapshot of the state of a light player that can be
+ * used to restore the player later without seeking from the start of the
+ * light program. Snapshots may be copied freely and stored on disk; they are
+ * valid only for the same light program and the same build of the library.
+ */
+typedef struct sb_light_player_snapshot_s {
+    uint8_t data[SB_LIGHT_PLAYER_SNAPSHOT_SIZE]; /**< Raw contents of the snapshot */
+} sb_light_player_snapshot_t;
+
 /**
  * Initializes a \c sb_light_player_t structure.
  *
@@ -166,6 +350,139 @@ sb_bool_t sb_light_player_seek(
     sb_light_player_t* player, unsigned long timestamp,
     unsigned long* next_timestamp);
 
+/**
+ * Saves the state of the light player into a snapshot.
+ *
+ * \param  player    the player object
+ * \param  snapshot  the snapshot to write the state into
+ * \return \c SB_SUCCESS if the state was saved, \c SB_EUNSUPPORTED if the
+ *         player is waiting for a trigger and its state cannot be saved
+ */
+sb_error_t sb_light_player_save_snapshot(
+    const sb_light_player_t* player, sb_light_player_snapshot_t* snapshot);
+
+/**
+ * Restores the state of the light player from a snapshot in constant time,
+ * without executing the light program from its start.
+ *
+ * \param  player    the player object; it must already be initialized with
+ *         the same light program that the snapshot was taken from
+ * \param  snapshot  the snapshot to restore
+ * \return \c SB_SUCCESS if the snapshot was restored, \c SB_EINVAL if the
+ *         snapshot is invalid or does not belong to the light program of the
+ *         player. The state of the player is left intact in case of an error.
+ */
+sb_error_t sb_light_player_restore_snapshot(
+    sb_light_player_t* player, const sb_light_player_snapshot_t* snapshot);
+
+/**
+ * Returns the performance counters of the light player.
+ *
+ * \param  player  the player object
+ * \param  result  the counters are returned here; all of them are set to zero
+ *         if the library was compiled without performance counters
+ * \return \c SB_EUNSUPPORTED if the library was compiled without performance
+ *         counters, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_light_player_get_perf_counters(
+    const sb_light_player_t* player, sb_perf_counters_t* result);
+
+/**
+ * Resets the performance counters of the light player to zero.
+ *
+ * \param  player  the player object
+ */
+void sb_light_player_reset_perf_counters(sb_light_player_t* player);
+
+/**
+ * Structure that represents a group of light players that evaluate the light
+ * programs of an entire fleet at the same timestamp in a single call.
+ *
+ * The players and their bytecode stores are stored in a single contiguous
+ * memory block so evaluating the whole fleet does not need to chase
+ * pointers to individually allocated players.
+ */
+typedef struct sb_light_fleet_player_s {
+    /**
+     * Pointer to a contiguous array of C++ objects that hold the bytecode
+     * stores and players of the individual light programs. The pointer is
+     * untyped because we don't want to expose a C++ class in the API.
+     */
+    void* players;
+
+    /**
+     * Number of players in the fleet.
+     */
+    size_t num_players;
+
+    /**
+     * Number of threads to use when evaluating the players; zero means one
+     * thread per CPU core, one means that everything is evaluated on the
+     * calling thread.
+     */
+    size_t num_threads;
+} sb_light_fleet_player_t;
+
+/**
+ * Initializes a \c sb_light_fleet_player_t structure.
+ *
+ * The light programs are decoded into an internal, fixed-width instruction
+ * format when the fleet player is initialized so the programs themselves are
+ * not needed afterwards. The fleet player evaluates the players on the
+ * calling thread by default; see \ref sb_light_fleet_player_set_num_threads()
+ * for splitting the work across multiple threads.
+ *
+ * \param  fleet         the fleet player object
+ * \param  programs      array of light programs, one for each player
+ * \param  num_programs  the number of light programs in the array
+ * \return \c SB_ENOMEM if there is not enough memory to decode the programs
+ */
+sb_error_t sb_light_fleet_player_init(
+    sb_light_fleet_player_t* fleet, const sb_light_program_t* programs,
+    size_t num_programs);
+
+/**
+ * Destroys a \c sb_light_fleet_player_t structure.
+ *
+ * \param  fleet  the fleet player object
+ */
+void sb_light_fleet_player_destroy(sb_light_fleet_player_t* fleet);
+
+/**
+ * Returns the number of players in the fleet.
+ *
+ * \param  fleet  the fleet player object
+ */
+size_t sb_light_fleet_player_size(const sb_light_fleet_player_t* fleet);
+
+/**
+ * Sets the number of threads to use when evaluating the players.
+ *
+ * \param  fleet        the fleet player object
+ * \param  num_threads  the number of threads to use; zero means one thread
+ *         per CPU core. Has no effect if the library was compiled without
+ *         thread support.
+ */
+void sb_light_fleet_player_set_num_threads(
+    sb_light_fleet_player_t* fleet, size_t num_threads);
+
+/**
+ * Evaluates all the players of the fleet at the given timestamp.
+ *
+ * \param  fleet          the fleet player object
+ * \param  timestamp      the timestamp to seek to, in milliseconds
+ * \param  colors         array where the colors of the players are written;
+ *         must have room for as many items as there are players in the
+ *         fleet. May be null if the caller is not interested in the colors.
+ * \param  pyro_channels  array where the states of the pyro channels of the
+ *         players are written; must have room for as many items as there are
+ *         players in the fleet. May be null if the caller is not interested
+ *         in the pyro channels.
+ */
+sb_error_t sb_light_fleet_player_evaluate_at(
+    sb_light_fleet_player_t* fleet, unsigned long timestamp,
+    sb_rgb_color_t* colors, uint8_t* pyro_channels);
+
 __END_DECLS
 
 #endif
@@ -0,0 +1,81 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKYBRUSH_PERF_COUNTERS_H
+#define SKYBRUSH_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#include <skybrush/decls.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file perf_counters.h
+ * @brief Performance counters maintained by the players of the library.
+ *
+ * The counters are maintained only if the library was compiled with
+ * \c SB_ENABLE_PERF_COUNTERS defined (see the
+ * \c LIBSKYBRUSH_ENABLE_PERF_COUNTERS CMake option). Otherwise the players
+ * do not contain the counters at all and the functions that query them
+ * return \c SB_EUNSUPPORTED .
+ */
+
+/**
+ * Structure holding the performance counters of a player.
+ */
+typedef struct sb_perf_counters_s {
+    /** Number of time instants that the player was asked to seek to */
+    uint32_t seeks;
+
+    /**
+     * Number of times the player had to start again from the beginning
+     * because it was asked to seek to an earlier time instant
+     */
+    uint32_t rewinds;
+
+    /**
+     * Number of trajectory segments, yaw setpoints or light program commands
+     * decoded by the player
+     */
+    uint32_t items_decoded;
+
+    /**
+     * Number of bytecode bytes consumed by a light player. For players of
+     * pre-decoded light programs, this is the number of pre-decoded
+     * instructions. Zero for other players.
+     */
+    uint32_t bytes_executed;
+
+    /**
+     * Number of times a trajectory player calculated the first derivative of
+     * the current segment. Zero for other players.
+     */
+    uint32_t dpoly_computations;
+
+    /**
+     * Number of times a trajectory player calculated the second derivative of
+     * the current segment. Zero for other players.
+     */
+    uint32_t ddpoly_computations;
+} sb_perf_counters_t;
+
+__END_DECLS
+
+#endif
@@ -131,6 +131,17 @@ uint8_t sb_poly_get_degree(const sb_poly_t* poly);
  */
 sb_error_t sb_poly_get_extrema(const sb_poly_t* poly, sb_interval_t* result);
 
+/**
+ * Computes an interval that contains all the values of a polynomial on the
+ * [0; 1] interval.
+ *
+ * The result is exact if the degree of the polynomial is at most 3. For
+ * higher-degree polynomials, the result is the range of the coefficients
+ * of the polynomial in the Bernstein basis, which always contains the
+ * true range of the polynomial but may be slightly wider.
+ */
+void sb_poly_get_extrema_bounds(const sb_poly_t* poly, sb_interval_t* result);
+
 /**
  * Adds a constant to the polynomial in-place.
  */
@@ -202,6 +213,12 @@ void sb_poly_4d_make_zero(sb_poly_4d_t* poly);
  */
 sb_vector3_with_yaw_t sb_poly_4d_eval(const sb_poly_4d_t* poly, float t);
 
+/**
+ * Evaluates a 4D polynomial in double precision and returns an x-y-z-yaw
+ * vector.
+ */
+sb_vector3_with_yaw_t sb_poly_4d_eval_double(const sb_poly_4d_t* poly, double t);
+
 /**
  * Calculates the derivative of a 4D polynomial in-place.
  */
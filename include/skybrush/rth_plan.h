@@ -100,6 +100,8 @@ typedef struct sb_rth_plan_s {
 sb_error_t sb_rth_plan_init_from_binary_file(sb_rth_plan_t* plan, int fd);
 sb_error_t sb_rth_plan_init_from_binary_file_in_memory(
     sb_rth_plan_t* plan, uint8_t* buf, size_t nbytes);
+sb_error_t sb_rth_plan_init_from_parser(
+    sb_rth_plan_t* plan, sb_binary_file_parser_t* parser);
 sb_error_t sb_rth_plan_init_from_buffer(sb_rth_plan_t* plan,
     uint8_t* buf, size_t nbytes);
 sb_error_t sb_rth_plan_init_empty(sb_rth_plan_t* plan);
@@ -29,7 +29,10 @@
 #include <skybrush/buffer.h>
 #include <skybrush/colors.h>
 #include <skybrush/error.h>
+#include <skybrush/fleet.h>
+#include <skybrush/geofence.h>
 #include <skybrush/lights.h>
+#include <skybrush/perf_counters.h>
 #include <skybrush/poly.h>
 #include <skybrush/rth_plan.h>
 #include <skybrush/trajectory.h>
@@ -37,5 +40,6 @@
 #include <skybrush/yaw_control.h>
 
 #include <skybrush/formats/binary.h>
+#include <skybrush/formats/container.h>
 
 #endif
@@ -33,6 +33,8 @@
 #include <skybrush/basic_types.h>
 #include <skybrush/buffer.h>
 #include <skybrush/error.h>
+#include <skybrush/formats/binary.h>
+#include <skybrush/perf_counters.h>
 #include <skybrush/poly.h>
 
 #include <skybrush/decls.h>
@@ -96,6 +98,9 @@ typedef struct
     /** The duration of the trajectory segment, in seconds. */
     float duration_sec;
 
+    /** The first point of the trajectory segment */
+    sb_vector3_with_yaw_t start;
+
     /** The last point of the trajectory segment */
     sb_vector3_with_yaw_t end;
 
@@ -143,13 +148,40 @@ typedef struct sb_trajectory_s {
     float scale; /**< Scaling factor for the coordinates */
     sb_bool_t use_yaw; /**< Whether the yaw coordinates are relevant */
     size_t header_length; /**< Number of bytes in the header of the buffer */
+    sb_bool_t frozen; /**< Whether the trajectory is frozen and may not be modified */
 } sb_trajectory_t;
 
+/**
+ * Structure representing the peak value of a kinematic quantity along a
+ * trajectory and the time when the peak is attained.
+ */
+typedef struct {
+    float value; /**< The peak value */
+    float time_sec; /**< The time when the peak value is attained, in seconds */
+} sb_trajectory_peak_t;
+
+/**
+ * Structure holding the peak horizontal and vertical velocities and
+ * accelerations of a trajectory or of a single trajectory segment.
+ *
+ * Horizontal peaks refer to the length of the projection of the velocity or
+ * acceleration vector onto the XY plane. Vertical peaks refer to the absolute
+ * value of the Z component.
+ */
+typedef struct {
+    sb_trajectory_peak_t horizontal_velocity; /**< Peak horizontal speed */
+    sb_trajectory_peak_t vertical_velocity; /**< Peak vertical speed */
+    sb_trajectory_peak_t horizontal_acceleration; /**< Peak horizontal acceleration */
+    sb_trajectory_peak_t vertical_acceleration; /**< Peak vertical acceleration */
+} sb_trajectory_kinematic_peaks_t;
+
 struct sb_trajectory_builder_s;
 
 sb_error_t sb_trajectory_init_from_binary_file(sb_trajectory_t* trajectory, int fd);
 sb_error_t sb_trajectory_init_from_binary_file_in_memory(
     sb_trajectory_t* trajectory, uint8_t* buf, size_t nbytes);
+sb_error_t sb_trajectory_init_from_parser(
+    sb_trajectory_t* trajectory, sb_binary_file_parser_t* parser);
 sb_error_t sb_trajectory_init_from_buffer(sb_trajectory_t* trajectory,
     uint8_t* buf, size_t nbytes);
 sb_error_t sb_trajectory_init_from_bytes(sb_trajectory_t* trajectory,
@@ -157,13 +189,22 @@ sb_error_t sb_trajectory_init_from_bytes(sb_trajectory_t* trajectory,
 sb_error_t sb_trajectory_init_from_builder(
     sb_trajectory_t* trajectory, struct sb_trajectory_builder_s* builder);
 sb_error_t sb_trajectory_init_empty(sb_trajectory_t* trajectory);
+sb_error_t sb_trajectory_init_simplified(
+    sb_trajectory_t* result, const sb_trajectory_t* trajectory,
+    float tolerance, float yaw_tolerance);
 void sb_trajectory_destroy(sb_trajectory_t* trajectory);
 
 sb_bool_t sb_trajectory_is_empty(const sb_trajectory_t* trajectory);
+sb_bool_t sb_trajectory_is_frozen(const sb_trajectory_t* trajectory);
 sb_error_t sb_trajectory_get_axis_aligned_bounding_box(
     const sb_trajectory_t* trajectory, sb_bounding_box_t* result);
 sb_error_t sb_trajectory_get_end_position(
     const sb_trajectory_t* trajectory, sb_vector3_with_yaw_t* result);
+sb_error_t sb_trajectory_get_kinematic_peaks(
+    const sb_trajectory_t* trajectory, sb_trajectory_kinematic_peaks_t* result);
+sb_error_t sb_trajectory_get_kinematic_peaks_parallel(
+    const sb_trajectory_t* trajectories, size_t num_trajectories,
+    sb_trajectory_kinematic_peaks_t* results, size_t num_threads);
 sb_error_t sb_trajectory_get_start_position(
     const sb_trajectory_t* trajectory, sb_vector3_with_yaw_t* result);
 uint32_t sb_trajectory_get_total_duration_msec(const sb_trajectory_t* trajectory);
@@ -175,9 +216,21 @@ float sb_trajectory_propose_landing_time_sec(
     float verticality_threshold);
 
 sb_error_t sb_trajectory_clear(sb_trajectory_t* trajectory);
+void sb_trajectory_freeze(sb_trajectory_t* trajectory);
 
 /* ************************************************************************* */
 
+/**
+ * Entry of the segment table of a trajectory player that records where a
+ * segment starts in the trajectory buffer, and when and where the segment
+ * starts in time and space.
+ */
+typedef struct sb_trajectory_segment_table_entry_s {
+    uint32_t offset; /**< Start offset of the segment in the buffer */
+    uint32_t start_time_msec; /**< Start time of the segment */
+    sb_vector3_with_yaw_t start; /**< Start point of the segment */
+} sb_trajectory_segment_table_entry_t;
+
 /**
  * Structure representing a trajectory player that allows us to query the
  * position and velocity along a trajectory.
@@ -192,11 +245,36 @@ typedef struct sb_trajectory_player_s {
         size_t length; /**< Length of the current segment in the buffer */
         sb_trajectory_segment_t data; /**< The current segment of the trajectory */
     } current_segment;
+
+    /** Table of all the segments in the trajectory, used for stepping
+     * backwards. Built lazily when it is needed for the first time. */
+    sb_trajectory_segment_table_entry_t* segment_table;
+    size_t num_segments; /**< Number of entries in the segment table */
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    sb_perf_counters_t perf_counters; /**< Performance counters of the player */
+#endif
 } sb_trajectory_player_t;
 
+/**
+ * Plain-old-data snapshot of the state of a trajectory player that can be
+ * used to restore the player later without seeking from the start of the
+ * trajectory. Snapshots may be copied freely and stored on disk; they are
+ * valid only for the same trajectory on a platform with the same endianness.
+ */
+typedef struct sb_trajectory_player_snapshot_s {
+    uint32_t trajectory_size; /**< Size of the trajectory buffer, for validation */
+    uint32_t offset; /**< Start offset of the current segment */
+    uint32_t length; /**< Length of the current segment in bytes, for validation */
+    uint32_t start_time_msec; /**< Start time of the current segment */
+    sb_vector3_with_yaw_t start; /**< Start point of the current segment */
+} sb_trajectory_player_snapshot_t;
+
 sb_error_t sb_trajectory_player_init(sb_trajectory_player_t* player, const sb_trajectory_t* trajectory);
 void sb_trajectory_player_destroy(sb_trajectory_player_t* player);
 sb_error_t sb_trajectory_player_build_next_segment(sb_trajectory_player_t* player);
+sb_error_t sb_trajectory_player_build_previous_segment(sb_trajectory_player_t* player);
+sb_error_t sb_trajectory_player_build_last_segment(sb_trajectory_player_t* player);
 void sb_trajectory_player_dump_current_segment(const sb_trajectory_player_t* player);
 const sb_trajectory_segment_t* sb_trajectory_player_get_current_segment(
     const sb_trajectory_player_t* player);
@@ -206,10 +284,25 @@ sb_error_t sb_trajectory_player_get_velocity_at(
     sb_trajectory_player_t* player, float t, sb_vector3_with_yaw_t* result);
 sb_error_t sb_trajectory_player_get_acceleration_at(
     sb_trajectory_player_t* player, float t, sb_vector3_with_yaw_t* result);
+sb_error_t sb_trajectory_player_get_position_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result);
+sb_error_t sb_trajectory_player_get_velocity_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result);
+sb_error_t sb_trajectory_player_get_acceleration_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result);
+sb_error_t sb_trajectory_player_get_current_segment_peaks(
+    sb_trajectory_player_t* player, sb_trajectory_kinematic_peaks_t* result);
 sb_error_t sb_trajectory_player_get_total_duration_msec(
     sb_trajectory_player_t* player, uint32_t* duration);
 sb_bool_t sb_trajectory_player_has_more_segments(const sb_trajectory_player_t* player);
 sb_error_t sb_trajectory_player_rewind(sb_trajectory_player_t* player);
+void sb_trajectory_player_save_snapshot(
+    const sb_trajectory_player_t* player, sb_trajectory_player_snapshot_t* snapshot);
+sb_error_t sb_trajectory_player_restore_snapshot(
+    sb_trajectory_player_t* player, const sb_trajectory_player_snapshot_t* snapshot);
+sb_error_t sb_trajectory_player_get_perf_counters(
+    const sb_trajectory_player_t* player, sb_perf_counters_t* result);
+void sb_trajectory_player_reset_perf_counters(sb_trajectory_player_t* player);
 
 /* ************************************************************************* */
 
@@ -231,8 +324,35 @@ sb_error_t sb_trajectory_builder_set_start_position(
 sb_error_t sb_trajectory_builder_append_line(
     sb_trajectory_builder_t* builder, sb_vector3_with_yaw_t target,
     uint32_t duration_msec);
+sb_error_t sb_trajectory_builder_append_lines(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* targets,
+    const uint32_t* durations_msec, size_t num_segments);
 sb_error_t sb_trajectory_builder_hold_position_for(
     sb_trajectory_builder_t* builder, uint32_t duration_msec);
+sb_error_t sb_trajectory_builder_append_cubic_bezier(
+    sb_trajectory_builder_t* builder, sb_vector3_with_yaw_t control1,
+    sb_vector3_with_yaw_t control2, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec);
+sb_error_t sb_trajectory_builder_append_poly7d(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* points,
+    uint32_t duration_msec);
+
+/**
+ * Structure representing a series of sampled positions of a drone, e.g., from
+ * a flight log or a simulation, to be converted into trajectory segments.
+ */
+typedef struct {
+    const uint32_t* times_msec; /**< Timestamps of the samples, strictly increasing, in milliseconds */
+    const sb_vector3_with_yaw_t* positions; /**< Positions of the drone at the timestamps */
+    size_t num_samples; /**< Number of samples */
+} sb_trajectory_samples_t;
+
+sb_error_t sb_trajectory_builder_fit_samples(
+    sb_trajectory_builder_t* builder, const sb_trajectory_samples_t* samples,
+    float tolerance, float yaw_tolerance);
+sb_error_t sb_trajectory_builder_fit_samples_parallel(
+    sb_trajectory_builder_t* builders, const sb_trajectory_samples_t* samples,
+    size_t num_builders, float tolerance, float yaw_tolerance, size_t num_threads);
 
 /* ************************************************************************* */
 
@@ -24,6 +24,8 @@
 
 #include <skybrush/decls.h>
 #include <skybrush/error.h>
+#include <skybrush/formats/binary.h>
+#include <skybrush/perf_counters.h>
 
 __BEGIN_DECLS
 
@@ -89,6 +91,7 @@ typedef struct sb_yaw_control_s {
 
 sb_error_t sb_yaw_control_init_from_binary_file(sb_yaw_control_t* ctrl, int fd);
 sb_error_t sb_yaw_control_init_from_binary_file_in_memory(sb_yaw_control_t* ctrl, uint8_t* buf, size_t nbytes);
+sb_error_t sb_yaw_control_init_from_parser(sb_yaw_control_t* ctrl, sb_binary_file_parser_t* parser);
 sb_error_t sb_yaw_control_init_from_buffer(sb_yaw_control_t* ctrl, uint8_t* buf, size_t nbytes);
 sb_error_t sb_yaw_control_init_empty(sb_yaw_control_t* ctrl);
 void sb_yaw_control_destroy(sb_yaw_control_t* ctrl);
@@ -110,8 +113,25 @@ typedef struct sb_yaw_player_s {
         size_t length; /**< Length of the current setpoint in the buffer */
         sb_yaw_setpoint_t data; /**< The current setpoint of the yaw control object */
     } current_setpoint;
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    sb_perf_counters_t perf_counters; /**< Performance counters of the player */
+#endif
 } sb_yaw_player_t;
 
+/**
+ * Plain-old-data snapshot of the state of a yaw player that can be used to
+ * restore the player later without seeking from the start of the yaw control
+ * object. Snapshots may be copied freely and stored on disk; they are valid
+ * only for the same yaw control object on a platform with the same endianness.
+ */
+typedef struct sb_yaw_player_snapshot_s {
+    uint32_t ctrl_size; /**< Size of the yaw control buffer, for validation */
+    uint32_t offset; /**< Start offset of the current setpoint */
+    uint32_t start_time_msec; /**< Start time of the current setpoint */
+    int32_t start_yaw_ddeg; /**< Start yaw of the current setpoint */
+} sb_yaw_player_snapshot_t;
+
 sb_error_t sb_yaw_player_init(sb_yaw_player_t* player, const sb_yaw_control_t* ctrl);
 void sb_yaw_player_destroy(sb_yaw_player_t* player);
 sb_error_t sb_yaw_player_build_next_setpoint(sb_yaw_player_t* player);
@@ -121,6 +141,13 @@ sb_error_t sb_yaw_player_get_yaw_at(sb_yaw_player_t* player, float t, float* res
 sb_error_t sb_yaw_player_get_yaw_rate_at(sb_yaw_player_t* player, float t, float* result);
 sb_error_t sb_yaw_player_get_total_duration_msec(sb_yaw_player_t* player, uint32_t* duration);
 sb_bool_t sb_yaw_player_has_more_setpoints(const sb_yaw_player_t* player);
+void sb_yaw_player_save_snapshot(
+    const sb_yaw_player_t* player, sb_yaw_player_snapshot_t* snapshot);
+sb_error_t sb_yaw_player_restore_snapshot(
+    sb_yaw_player_t* player, const sb_yaw_player_snapshot_t* snapshot);
+sb_error_t sb_yaw_player_get_perf_counters(
+    const sb_yaw_player_t* player, sb_perf_counters_t* result);
+void sb_yaw_player_reset_perf_counters(sb_yaw_player_t* player);
 
 __END_DECLS
 
@@ -18,7 +18,7 @@
  */
 
 #include <assert.h>
-#include <string.h> /* memset */
+#include <string.h> /* memcpy, memset */
 
 #include <skybrush/buffer.h>
 #include <skybrush/memory.h>
@@ -46,6 +46,7 @@ sb_error_t sb_buffer_init(sb_buffer_t* buf, size_t initial_size)
     buf->end = buf->stor_begin + initial_size;
 
     buf->owned = 1;
+    buf->borrowed = 0;
 
     return SB_SUCCESS;
 }
@@ -71,6 +72,7 @@ sb_error_t sb_buffer_init_from_bytes(sb_buffer_t* buf, void* bytes, size_t num_b
     buf->stor_end = buf->stor_begin + num_bytes;
     buf->end = buf->stor_begin + num_bytes;
     buf->owned = 1;
+    buf->borrowed = 0;
 
     return SB_SUCCESS;
 }
@@ -80,7 +82,7 @@ sb_error_t sb_buffer_init_from_bytes(sb_buffer_t* buf, void* bytes, size_t num_b
  */
 void sb_buffer_destroy(sb_buffer_t* buf)
 {
-    if (buf->owned && buf->stor_begin != 0) {
+    if (buf->owned && !buf->borrowed && buf->stor_begin != 0) {
         sb_free(buf->stor_begin);
         buf->stor_begin = 0;
     }
@@ -105,6 +107,31 @@ void sb_buffer_init_view(sb_buffer_t* buf, void* bytes, size_t num_bytes)
     buf->stor_begin = bytes;
     buf->stor_end = buf->end = buf->stor_begin + num_bytes;
     buf->owned = 0;
+    buf->borrowed = 0;
+}
+
+/**
+ * @brief Initializes an empty buffer that uses a storage area provided by the
+ * caller until it needs to grow beyond its capacity.
+ *
+ * This is useful for small buffers whose storage can be allocated on the
+ * stack or embedded in another structure, avoiding heap allocations
+ * altogether in the common case. When the buffer needs to grow beyond the
+ * capacity of the provided storage area, its contents are moved to the heap
+ * and the storage area is not used any more. The storage area is never freed
+ * by the buffer and it must outlive the buffer.
+ *
+ * @param buf the buffer to initialize
+ * @param storage the storage area to use
+ * @param capacity the size of the storage area, in bytes; must be positive
+ */
+void sb_buffer_init_with_storage(sb_buffer_t* buf, void* storage, size_t capacity)
+{
+    assert(storage != 0 && capacity > 0);
+    buf->stor_begin = buf->end = storage;
+    buf->stor_end = buf->stor_begin + capacity;
+    buf->owned = 1;
+    buf->borrowed = 1;
 }
 
 /**
@@ -162,6 +189,11 @@ sb_error_t sb_buffer_clear(sb_buffer_t* buf)
 /**
  * @brief Sets the size of the buffer, allocating more memory if needed.
  *
+ * New bytes at the end of the buffer are initialized to zero. The capacity of
+ * the buffer grows geometrically, just like when appending to the buffer, so
+ * repeated calls to this function with increasing sizes take amortized
+ * constant time.
+ *
  * Note that this function does not deallocate any memory if the size of the
  * buffer decreases in case the buffer needs to grow again later.
  *
@@ -177,7 +209,7 @@ sb_error_t sb_buffer_resize(sb_buffer_t* buf, size_t new_size)
     }
 
     if (current_size < new_size) {
-        SB_CHECK(sb_i_buffer_realloc(buf, new_size));
+        SB_CHECK(sb_i_buffer_ensure_free_space(buf, new_size - current_size));
         memset(buf->end, 0, new_size - current_size);
     }
 
@@ -185,6 +217,42 @@ sb_error_t sb_buffer_resize(sb_buffer_t* buf, size_t new_size)
     return SB_SUCCESS;
 }
 
+/**
+ * @brief Resizes the buffer such that its capacity becomes equal to its
+ * current size.
+ *
+ * This function is equivalent to \ref sb_buffer_shrink_to_fit() and it is
+ * kept for sake of backward compatibility.
+ *
+ * @param buf  the buffer
+ * @return error code
+ */
+sb_error_t sb_buffer_prune(sb_buffer_t* buf)
+{
+    return sb_buffer_shrink_to_fit(buf);
+}
+
+/**
+ * @brief Ensures that the capacity of the buffer is at least the given value.
+ *
+ * The size of the buffer is left unchanged. Subsequent operations that grow
+ * the buffer up to the given capacity will not allocate memory.
+ *
+ * @param buf  the buffer
+ * @param capacity  the minimum capacity of the buffer
+ * @return \c SB_FAILURE if the buffer is a view and it would need to grow,
+ *         \c SB_ENOMEM if the memory allocation failed, \c SB_SUCCESS
+ *         otherwise
+ */
+sb_error_t sb_buffer_reserve(sb_buffer_t* buf, size_t capacity)
+{
+    if (capacity <= sb_buffer_capacity(buf)) {
+        return SB_SUCCESS;
+    }
+
+    return sb_i_buffer_realloc(buf, capacity);
+}
+
 /**
  * @brief Resizes the buffer such that its capacity becomes equal to its
  * current size.
@@ -192,13 +260,18 @@ sb_error_t sb_buffer_resize(sb_buffer_t* buf, size_t new_size)
  * The goal of this function is to make the amount of memory allocated to the
  * buffer as small as possible. If there is excess memory allocated to the
  * buffer (i.e. its capacity is larger than its size), the excess memory will
- * be freed.
+ * be freed. Buffers that still use a storage area provided by the caller
+ * are left intact.
  *
  * @param buf  the buffer
  * @return error code
  */
-sb_error_t sb_buffer_prune(sb_buffer_t* buf)
+sb_error_t sb_buffer_shrink_to_fit(sb_buffer_t* buf)
 {
+    if (buf->borrowed) {
+        return SB_SUCCESS;
+    }
+
     return sb_i_buffer_realloc(buf, sb_buffer_size(buf));
 }
 
@@ -267,9 +340,32 @@ sb_error_t sb_buffer_concat(sb_buffer_t* buf, const sb_buffer_t* other)
  */
 sb_error_t sb_buffer_extend_with_zeros(sb_buffer_t* buf, size_t num_zeros)
 {
-    SB_CHECK(sb_i_buffer_ensure_free_space(buf, sb_buffer_size(buf) + num_zeros));
-    memset(buf->end, 0, num_zeros);
-    buf->end += num_zeros;
+    uint8_t* ptr;
+
+    SB_CHECK(sb_buffer_extend_uninitialized(buf, num_zeros, &ptr));
+    memset(ptr, 0, num_zeros);
+    return SB_SUCCESS;
+}
+
+/**
+ * @brief Extends the buffer with the given number of bytes at the end without
+ * initializing them, growing the buffer as needed.
+ *
+ * This function is useful when the caller is going to overwrite the new bytes
+ * anyway, to avoid filling them with zeros first.
+ *
+ * @param buf  the buffer to extend
+ * @param num_bytes  the number of bytes to append to the end of the buffer
+ * @param ptr  pointer to a variable where the start of the newly appended
+ *        bytes is returned. The pointer is valid until the next operation
+ *        that changes the capacity of the buffer.
+ * @return error code
+ */
+sb_error_t sb_buffer_extend_uninitialized(sb_buffer_t* buf, size_t num_bytes, uint8_t** ptr)
+{
+    SB_CHECK(sb_i_buffer_ensure_free_space(buf, num_bytes));
+    *ptr = buf->end;
+    buf->end += num_bytes;
     return SB_SUCCESS;
 }
 
@@ -278,9 +374,10 @@ sb_error_t sb_buffer_extend_with_zeros(sb_buffer_t* buf, size_t num_zeros)
 /**
  * @brief Ensures that there is free space at the end of the buffer.
  *
- * This function may resize the internal storage if needed, and the new storage
- * area may be larger than what would strictly be needed to accommodate the new
- * size.
+ * This function may resize the internal storage if needed. The capacity of
+ * the storage area is doubled until it can accommodate the new size, so the
+ * new storage area may be larger than what would strictly be needed. This
+ * ensures that a sequence of appends takes amortized constant time per byte.
  *
  * @param buf  the buffer
  * @param min_space  minimum number of bytes that must be free at the end of the
@@ -294,7 +391,6 @@ static sb_error_t sb_i_buffer_ensure_free_space(sb_buffer_t* buf, size_t min_spa
         return SB_SUCCESS;
     }
 
-    desired_capacity = sb_buffer_capacity(buf);
     old_size = sb_buffer_size(buf);
     new_size = old_size + min_space;
     if (new_size < old_size) {
@@ -302,6 +398,12 @@ static sb_error_t sb_i_buffer_ensure_free_space(sb_buffer_t* buf, size_t min_spa
         return SB_ENOMEM;
     }
 
+    desired_capacity = sb_buffer_capacity(buf);
+    if (desired_capacity < 1) {
+        /* doubling would never get us anywhere from an empty storage area */
+        desired_capacity = new_size;
+    }
+
     while (new_size > desired_capacity) {
         if (desired_capacity >= SIZE_MAX - 1) {
             return SB_ENOMEM;
@@ -315,10 +417,11 @@ static sb_error_t sb_i_buffer_ensure_free_space(sb_buffer_t* buf, size_t min_spa
     return sb_i_buffer_realloc(buf, desired_capacity);
 }
 
-sb_error_t sb_i_buffer_realloc(sb_buffer_t* buf, size_t new_capacity)
+static sb_error_t sb_i_buffer_realloc(sb_buffer_t* buf, size_t new_capacity)
 {
     size_t capacity = sb_buffer_capacity(buf);
     size_t size;
+    uint8_t* storage;
 
     if (new_capacity < 1) {
         new_capacity = 1;
@@ -331,12 +434,23 @@ sb_error_t sb_i_buffer_realloc(sb_buffer_t* buf, size_t new_capacity)
 
         size = sb_buffer_size(buf);
 
-        buf->stor_begin = sb_realloc(buf->stor_begin, uint8_t, new_capacity);
-        if (buf->stor_begin == 0) {
-            buf->stor_end = buf->end = 0;
-            return SB_ENOMEM; /* LCOV_EXCL_LINE */
+        if (buf->borrowed) {
+            /* Move the contents from the storage area of the caller to the heap */
+            storage = sb_calloc(uint8_t, new_capacity);
+            if (storage == 0) {
+                return SB_ENOMEM; /* LCOV_EXCL_LINE */
+            }
+
+            memcpy(storage, buf->stor_begin, size < new_capacity ? size : new_capacity);
+            buf->borrowed = 0;
+        } else {
+            storage = sb_realloc(buf->stor_begin, uint8_t, new_capacity);
+            if (storage == 0) {
+                return SB_ENOMEM; /* LCOV_EXCL_LINE */
+            }
         }
 
+        buf->stor_begin = storage;
         buf->stor_end = buf->stor_begin + new_capacity;
         buf->end = buf->stor_begin + size;
 
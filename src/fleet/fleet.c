@@ -0,0 +1,263 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fleet.c
+ * @brief Frame-synchronous sampling of the trajectories, yaw setpoints and
+ * light programs of an entire fleet.
+ */
+
+#include <string.h>
+
+#include <skybrush/fleet.h>
+#include <skybrush/memory.h>
+
+#include "../parallel.h"
+
+typedef struct {
+    sb_fleet_sampler_t* sampler;
+    float t;
+    float* x;
+    float* y;
+    float* z;
+    float* yaw;
+} sb_i_fleet_sampler_job_t;
+
+static sb_error_t sb_i_fleet_sampler_sample_range(void* context, size_t start, size_t end);
+
+/**
+ * Initializes a fleet sampler.
+ *
+ * The sampler creates its own players for each drone but does not copy the
+ * trajectories and the yaw control objects; they must outlive the sampler.
+ * Light programs are decoded when the sampler is initialized so they are not
+ * needed afterwards. The sampler evaluates the fleet on the calling thread by
+ * default; see \ref sb_fleet_sampler_set_num_threads() for splitting the work
+ * across multiple threads.
+ *
+ * @param sampler       the sampler to initialize
+ * @param trajectories  array of trajectories, one for each drone
+ * @param yaw_controls  array of yaw control objects, one for each drone; null
+ *        if the yaw angles should be taken from the trajectories
+ * @param programs      array of light programs, one for each drone; null if
+ *        the fleet has no light programs, in which case all drones are black
+ * @param num_drones    the number of drones in the fleet
+ *
+ * @return \c SB_SUCCESS if the sampler was initialized, \c SB_EINVAL if the
+ *         trajectories are missing, \c SB_ENOMEM if there was not enough
+ *         memory
+ */
+sb_error_t sb_fleet_sampler_init(
+    sb_fleet_sampler_t* sampler, const sb_trajectory_t* trajectories,
+    const sb_yaw_control_t* yaw_controls, const sb_light_program_t* programs,
+    size_t num_drones)
+{
+    sb_error_t retval;
+    size_t i;
+
+    if (trajectories == 0 && num_drones > 0) {
+        return SB_EINVAL;
+    }
+
+    memset(sampler, 0, sizeof(sb_fleet_sampler_t));
+
+    retval = sb_light_fleet_player_init(&sampler->light_players, programs, programs ? num_drones : 0);
+    if (retval != SB_SUCCESS) {
+        return retval; /* LCOV_EXCL_LINE */
+    }
+
+    sampler->num_drones = num_drones;
+    sampler->num_threads = 1;
+
+    if (num_drones == 0) {
+        return SB_SUCCESS;
+    }
+
+    sampler->trajectory_players = sb_calloc(sb_trajectory_player_t, num_drones);
+    if (sampler->trajectory_players == 0) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    for (i = 0; i < num_drones; i++) {
+        retval = sb_trajectory_player_init(&sampler->trajectory_players[i], &trajectories[i]);
+        if (retval != SB_SUCCESS) {
+            goto cleanup; /* LCOV_EXCL_LINE */
+        }
+    }
+
+    if (yaw_controls) {
+        sampler->yaw_players = sb_calloc(sb_yaw_player_t, num_drones);
+        if (sampler->yaw_players == 0) {
+            goto cleanup; /* LCOV_EXCL_LINE */
+        }
+
+        for (i = 0; i < num_drones; i++) {
+            retval = sb_yaw_player_init(&sampler->yaw_players[i], &yaw_controls[i]);
+            if (retval != SB_SUCCESS) {
+                goto cleanup; /* LCOV_EXCL_LINE */
+            }
+        }
+    }
+
+    return SB_SUCCESS;
+
+    /* LCOV_EXCL_START */
+cleanup:
+    sb_fleet_sampler_destroy(sampler);
+    return retval == SB_SUCCESS ? SB_ENOMEM : retval;
+    /* LCOV_EXCL_STOP */
+}
+
+/**
+ * Destroys a fleet sampler and releases all memory that it owns.
+ */
+void sb_fleet_sampler_destroy(sb_fleet_sampler_t* sampler)
+{
+    size_t i;
+
+    if (sampler->trajectory_players) {
+        for (i = 0; i < sampler->num_drones; i++) {
+            sb_trajectory_player_destroy(&sampler->trajectory_players[i]);
+        }
+        sb_free(sampler->trajectory_players);
+    }
+
+    if (sampler->yaw_players) {
+        for (i = 0; i < sampler->num_drones; i++) {
+            sb_yaw_player_destroy(&sampler->yaw_players[i]);
+        }
+        sb_free(sampler->yaw_players);
+    }
+
+    sb_light_fleet_player_destroy(&sampler->light_players);
+
+    memset(sampler, 0, sizeof(sb_fleet_sampler_t));
+}
+
+/**
+ * Returns the number of drones in the fleet.
+ */
+size_t sb_fleet_sampler_size(const sb_fleet_sampler_t* sampler)
+{
+    return sampler->num_drones;
+}
+
+/**
+ * Sets the number of threads to use when sampling the fleet.
+ *
+ * @param sampler      the sampler
+ * @param num_threads  the number of threads to use; zero means one thread per
+ *        CPU core. Has no effect if the library was compiled without thread
+ *        support.
+ */
+void sb_fleet_sampler_set_num_threads(sb_fleet_sampler_t* sampler, size_t num_threads)
+{
+    sampler->num_threads = num_threads;
+    sb_light_fleet_player_set_num_threads(&sampler->light_players, num_threads);
+}
+
+/**
+ * Samples the positions, yaw angles and colors of all the drones in the fleet
+ * at the given timestamp, writing the results into structure-of-arrays
+ * buffers provided by the caller.
+ *
+ * Each buffer must have room for as many items as there are drones in the
+ * fleet, and any of them may be null if the caller is not interested in the
+ * corresponding quantity. The players keep their state between calls, so
+ * sampling frames in increasing order of time only decodes the trajectory
+ * segments and light program instructions that were not needed for the
+ * previous frame; seeking backwards is supported but slower.
+ *
+ * @param sampler    the sampler
+ * @param timestamp  the timestamp to sample the fleet at, in milliseconds
+ * @param x          the X coordinates of the drones are written here
+ * @param y          the Y coordinates of the drones are written here
+ * @param z          the Z coordinates of the drones are written here
+ * @param yaw        the yaw angles of the drones are written here
+ * @param colors     the colors of the drones are written here
+ */
+sb_error_t sb_fleet_sampler_sample_at(
+    sb_fleet_sampler_t* sampler, unsigned long timestamp,
+    float* x, float* y, float* z, float* yaw, sb_rgb_color_t* colors)
+{
+    sb_i_fleet_sampler_job_t job;
+    size_t i;
+
+    job.sampler = sampler;
+    job.t = timestamp / 1000.0f;
+    job.x = x;
+    job.y = y;
+    job.z = z;
+    job.yaw = yaw;
+
+    if (x || y || z || yaw) {
+        SB_CHECK(sb_i_parallel_for(
+            sampler->num_drones, sampler->num_threads,
+            sb_i_fleet_sampler_sample_range, &job));
+    }
+
+    if (colors) {
+        if (sb_light_fleet_player_size(&sampler->light_players) > 0) {
+            SB_CHECK(sb_light_fleet_player_evaluate_at(&sampler->light_players, timestamp, colors, 0));
+        } else {
+            for (i = 0; i < sampler->num_drones; i++) {
+                colors[i] = SB_COLOR_BLACK;
+            }
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
+/* ************************************************************************** */
+
+static sb_error_t sb_i_fleet_sampler_sample_range(void* context, size_t start, size_t end)
+{
+    sb_i_fleet_sampler_job_t* job = (sb_i_fleet_sampler_job_t*)context;
+    sb_fleet_sampler_t* sampler = job->sampler;
+    sb_bool_t need_position = job->x || job->y || job->z || (job->yaw && !sampler->yaw_players);
+    sb_vector3_with_yaw_t pos;
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        if (need_position) {
+            SB_CHECK(sb_trajectory_player_get_position_at(&sampler->trajectory_players[i], job->t, &pos));
+
+            if (job->x) {
+                job->x[i] = pos.x;
+            }
+            if (job->y) {
+                job->y[i] = pos.y;
+            }
+            if (job->z) {
+                job->z[i] = pos.z;
+            }
+        }
+
+        if (job->yaw) {
+            if (sampler->yaw_players) {
+                SB_CHECK(sb_yaw_player_get_yaw_at(&sampler->yaw_players[i], job->t, &job->yaw[i]));
+            } else {
+                job->yaw[i] = pos.yaw;
+            }
+        }
+    }
+
+    return SB_SUCCESS;
+}
@@ -0,0 +1,742 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file index.c
+ * @brief Spatio-temporal index over the trajectories of a fleet.
+ *
+ * The index is a bounding volume hierarchy over the trajectory segments of all
+ * the drones, where each segment is represented by the bounding box of the
+ * region that it may occupy in space and by the time interval that it spans.
+ * Queries descend only into the nodes that overlap with the query time and
+ * the query sphere, and then evaluate the exact positions of the candidate
+ * drones only.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <skybrush/fleet.h>
+#include <skybrush/memory.h>
+
+#include "../parallel.h"
+
+/**
+ * Maximum number of items in a leaf node of the bounding volume hierarchy.
+ */
+#define SB_I_FLEET_INDEX_LEAF_SIZE 4
+
+/**
+ * Size of the traversal stack used by queries. The hierarchy is built with
+ * median splits so its depth is logarithmic in the number of items, and the
+ * stack needs at most one entry per level plus one.
+ */
+#define SB_I_FLEET_INDEX_STACK_SIZE 64
+
+/**
+ * Number of keys that the items may be sorted by when building the
+ * hierarchy: the center of the bounding box along the X, Y and Z axes, and
+ * the start time of the segment.
+ */
+#define SB_I_FLEET_INDEX_NUM_KEYS 4
+
+/**
+ * Subtree of the hierarchy whose construction was deferred so it can be built
+ * in parallel with other subtrees.
+ */
+typedef struct {
+    size_t node; /**< Index of the root node of the subtree */
+    size_t first; /**< Index of the first item in the subtree */
+    size_t count; /**< Number of items in the subtree */
+} sb_i_fleet_index_subtree_t;
+
+typedef struct {
+    sb_fleet_index_t* index;
+
+    /** First item of each drone; has one more entry than the number of drones */
+    size_t* offsets;
+
+    /** Reciprocals of the ranges of the keys of all the items; used to make
+     * the extents of the keys comparable when choosing a split axis */
+    double scale[SB_I_FLEET_INDEX_NUM_KEYS];
+
+    /** Subtrees whose construction was deferred */
+    sb_i_fleet_index_subtree_t* subtrees;
+
+    /** Number of subtrees whose construction was deferred */
+    size_t num_subtrees;
+} sb_i_fleet_index_build_job_t;
+
+static sb_error_t sb_i_fleet_index_build_segment_tables(void* context, size_t start, size_t end);
+static sb_error_t sb_i_fleet_index_collect_items(void* context, size_t start, size_t end);
+static sb_error_t sb_i_fleet_index_build_subtrees(void* context, size_t start, size_t end);
+static void sb_i_fleet_index_build_node(
+    sb_i_fleet_index_build_job_t* job, size_t node_index, size_t first, size_t count,
+    size_t depth, size_t max_depth);
+static void sb_i_fleet_index_refit_top_nodes(
+    sb_fleet_index_t* index, size_t node_index, size_t depth, size_t max_depth);
+static size_t sb_i_fleet_index_count_nodes(size_t num_items);
+static void sb_i_fleet_index_get_key_ranges(
+    const sb_fleet_index_item_t* items, size_t count, double* lo, double* hi);
+static sb_error_t sb_i_fleet_index_query(
+    sb_fleet_index_t* index, unsigned long timestamp, sb_vector3_with_yaw_t point,
+    float radius, size_t exclude, size_t* drones, size_t max_drones, size_t* num_found);
+static sb_error_t sb_i_fleet_index_get_position(
+    sb_fleet_index_t* index, size_t drone, size_t segment, uint32_t t,
+    sb_vector3_with_yaw_t* result);
+
+/**
+ * Initializes a spatio-temporal index over the trajectories of a fleet.
+ *
+ * The index does not copy the trajectories; they must outlive the index.
+ * Decoding the trajectory segments and building the lower levels of the
+ * bounding volume hierarchy is split across multiple threads.
+ *
+ * @param index         the index to initialize
+ * @param trajectories  array of trajectories, one for each drone
+ * @param num_drones    the number of drones in the fleet
+ * @param num_threads   the number of threads to use while building the index;
+ *        zero means one thread per CPU core. Has no effect if the library was
+ *        compiled without thread support.
+ *
+ * @return \c SB_SUCCESS if the index was built, \c SB_EINVAL if the
+ *         trajectories are missing, \c SB_EOVERFLOW if the fleet is too large
+ *         to be indexed, \c SB_ENOMEM if there was not enough memory
+ */
+sb_error_t sb_fleet_index_init(
+    sb_fleet_index_t* index, const sb_trajectory_t* trajectories,
+    size_t num_drones, size_t num_threads)
+{
+    sb_i_fleet_index_build_job_t job;
+    double lo[SB_I_FLEET_INDEX_NUM_KEYS], hi[SB_I_FLEET_INDEX_NUM_KEYS];
+    size_t i, max_depth;
+    sb_error_t retval = SB_SUCCESS;
+
+    if (trajectories == 0 && num_drones > 0) {
+        return SB_EINVAL;
+    }
+
+    memset(index, 0, sizeof(sb_fleet_index_t));
+    memset(&job, 0, sizeof(job));
+    job.index = index;
+
+    index->num_drones = num_drones;
+
+    if (num_drones == 0) {
+        return SB_SUCCESS;
+    }
+
+    index->players = sb_calloc(sb_trajectory_player_t, num_drones);
+    index->last_query = sb_calloc(uint32_t, num_drones);
+    job.offsets = sb_calloc(size_t, num_drones + 1);
+    if (index->players == 0 || index->last_query == 0 || job.offsets == 0) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    for (i = 0; i < num_drones; i++) {
+        retval = sb_trajectory_player_init(&index->players[i], &trajectories[i]);
+        if (retval != SB_SUCCESS) {
+            goto cleanup; /* LCOV_EXCL_LINE */
+        }
+    }
+
+    /* Count the segments of each drone first so we know where the items of
+     * each drone will be placed */
+    retval = sb_i_parallel_for(num_drones, num_threads, sb_i_fleet_index_build_segment_tables, &job);
+    if (retval != SB_SUCCESS) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    for (i = 0; i < num_drones; i++) {
+        job.offsets[i + 1] += job.offsets[i];
+    }
+
+    index->num_items = job.offsets[num_drones];
+    if (index->num_items > UINT32_MAX) {
+        retval = SB_EOVERFLOW;
+        goto cleanup;
+    }
+
+    index->items = sb_calloc(sb_fleet_index_item_t, index->num_items);
+    if (index->items == 0) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    retval = sb_i_parallel_for(num_drones, num_threads, sb_i_fleet_index_collect_items, &job);
+    if (retval != SB_SUCCESS) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    sb_i_fleet_index_get_key_ranges(index->items, index->num_items, lo, hi);
+    for (i = 0; i < SB_I_FLEET_INDEX_NUM_KEYS; i++) {
+        job.scale[i] = hi[i] > lo[i] ? 1.0 / (hi[i] - lo[i]) : 0.0;
+    }
+
+    index->num_nodes = sb_i_fleet_index_count_nodes(index->num_items);
+    index->nodes = sb_calloc(sb_fleet_index_node_t, index->num_nodes);
+    if (index->nodes == 0) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    /* Build the upper levels of the hierarchy on the calling thread and defer
+     * the subtrees below them so they can be built in parallel. We aim for a
+     * few subtrees per thread to balance the load. */
+    num_threads = sb_i_parallel_get_num_threads(num_threads, index->num_items);
+    if (num_threads > 1) {
+        max_depth = 1;
+        while (((size_t)1 << max_depth) < 4 * num_threads) {
+            max_depth++;
+        }
+
+        job.subtrees = sb_calloc(sb_i_fleet_index_subtree_t, (size_t)1 << max_depth);
+        if (job.subtrees == 0) {
+            goto cleanup; /* LCOV_EXCL_LINE */
+        }
+    } else {
+        max_depth = SIZE_MAX;
+    }
+
+    sb_i_fleet_index_build_node(&job, 0, 0, index->num_items, 0, max_depth);
+
+    if (job.num_subtrees > 0) {
+        retval = sb_i_parallel_for(job.num_subtrees, num_threads, sb_i_fleet_index_build_subtrees, &job);
+        if (retval != SB_SUCCESS) {
+            goto cleanup; /* LCOV_EXCL_LINE */
+        }
+
+        sb_i_fleet_index_refit_top_nodes(index, 0, 0, max_depth);
+    }
+
+    sb_free(job.offsets);
+    sb_free_unless_null(job.subtrees);
+
+    return SB_SUCCESS;
+
+cleanup:
+    sb_free_unless_null(job.offsets);
+    sb_free_unless_null(job.subtrees);
+    sb_fleet_index_destroy(index);
+    return retval == SB_SUCCESS ? SB_ENOMEM : retval;
+}
+
+/**
+ * Destroys a fleet index and releases all memory that it owns.
+ */
+void sb_fleet_index_destroy(sb_fleet_index_t* index)
+{
+    size_t i;
+
+    if (index->players) {
+        for (i = 0; i < index->num_drones; i++) {
+            sb_trajectory_player_destroy(&index->players[i]);
+        }
+        sb_free(index->players);
+    }
+
+    sb_free_unless_null(index->items);
+    sb_free_unless_null(index->nodes);
+    sb_free_unless_null(index->last_query);
+
+    memset(index, 0, sizeof(sb_fleet_index_t));
+}
+
+/**
+ * Returns the number of drones in the fleet.
+ */
+size_t sb_fleet_index_size(const sb_fleet_index_t* index)
+{
+    return index->num_drones;
+}
+
+/**
+ * Finds the drones that are within a given distance from a point at the given
+ * timestamp.
+ *
+ * Queries reuse the trajectory players of the index, therefore the index must
+ * not be queried from multiple threads at the same time.
+ *
+ * @param index      the index
+ * @param timestamp  the timestamp of the query, in milliseconds
+ * @param point      the point to measure distances from; its yaw is ignored
+ * @param radius     the maximum distance, in the same units as the
+ *        coordinates of the trajectories
+ * @param drones     the indices of the drones within the given distance are
+ *        written here, in no particular order
+ * @param max_drones the maximum number of drone indices to write into
+ *        \p drones
+ * @param num_found  the number of drones within the given distance is
+ *        returned here. It may be larger than \p max_drones ; only the first
+ *        \p max_drones indices are written in this case.
+ *
+ * @return \c SB_SUCCESS if the query was executed, \c SB_EINVAL if the radius
+ *         is negative or not a number, or if the result array is missing
+ */
+sb_error_t sb_fleet_index_find_near_point(
+    sb_fleet_index_t* index, unsigned long timestamp, sb_vector3_with_yaw_t point,
+    float radius, size_t* drones, size_t max_drones, size_t* num_found)
+{
+    return sb_i_fleet_index_query(
+        index, timestamp, point, radius, SIZE_MAX, drones, max_drones, num_found);
+}
+
+/**
+ * Finds the drones that are within a given distance from another drone at the
+ * given timestamp.
+ *
+ * This function works the same way as \ref sb_fleet_index_find_near_point()
+ * but uses the position of a drone as the center of the query. The drone
+ * itself is not included in the result.
+ *
+ * @param index      the index
+ * @param timestamp  the timestamp of the query, in milliseconds
+ * @param drone      the index of the drone to measure distances from
+ * @param radius     the maximum distance, in the same units as the
+ *        coordinates of the trajectories
+ * @param drones     the indices of the drones within the given distance are
+ *        written here, in no particular order
+ * @param max_drones the maximum number of drone indices to write into
+ *        \p drones
+ * @param num_found  the number of drones within the given distance is
+ *        returned here
+ *
+ * @return \c SB_SUCCESS if the query was executed, \c SB_EINVAL if the drone
+ *         index is out of range, the radius is negative or not a number, or if
+ *         the result array is missing
+ */
+sb_error_t sb_fleet_index_find_near_drone(
+    sb_fleet_index_t* index, unsigned long timestamp, size_t drone,
+    float radius, size_t* drones, size_t max_drones, size_t* num_found)
+{
+    const sb_trajectory_player_t* player;
+    sb_vector3_with_yaw_t point;
+    uint32_t t = timestamp < UINT32_MAX ? (uint32_t)timestamp : UINT32_MAX;
+    size_t lo, hi, mid;
+
+    if (drone >= index->num_drones) {
+        return SB_EINVAL;
+    }
+
+    /* Find the segment of the drone that contains the timestamp by a binary
+     * search in the segment table of its player */
+    player = &index->players[drone];
+    lo = 0;
+    hi = player->num_segments;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (player->segment_table[mid].start_time_msec <= t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    SB_CHECK(sb_i_fleet_index_get_position(index, drone, lo > 0 ? lo - 1 : 0, t, &point));
+
+    return sb_i_fleet_index_query(
+        index, timestamp, point, radius, drone, drones, max_drones, num_found);
+}
+
+/* ************************************************************************** */
+
+static sb_error_t sb_i_fleet_index_build_segment_tables(void* context, size_t start, size_t end)
+{
+    sb_i_fleet_index_build_job_t* job = (sb_i_fleet_index_build_job_t*)context;
+    sb_trajectory_player_t* player;
+    sb_error_t retval;
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        player = &job->index->players[i];
+
+        /* Jumping to the last segment builds the segment table of the player */
+        retval = sb_trajectory_player_build_last_segment(player);
+        if (retval != SB_SUCCESS && retval != SB_ENOENT) {
+            return retval; /* LCOV_EXCL_LINE */
+        }
+
+        /* One item per segment plus one for the time after the end of the
+         * trajectory */
+        job->offsets[i + 1] = player->num_segments + 1;
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_fleet_index_collect_items(void* context, size_t start, size_t end)
+{
+    sb_i_fleet_index_build_job_t* job = (sb_i_fleet_index_build_job_t*)context;
+    sb_trajectory_player_t* player;
+    const sb_trajectory_segment_t* segment;
+    sb_fleet_index_item_t* item;
+    size_t i, j;
+
+    for (i = start; i < end; i++) {
+        player = &job->index->players[i];
+        item = &job->index->items[job->offsets[i]];
+        segment = sb_trajectory_player_get_current_segment(player);
+
+        SB_CHECK(sb_trajectory_player_rewind(player));
+
+        for (j = 0; j < player->num_segments; j++, item++) {
+            sb_poly_get_extrema_bounds(&segment->poly.x, &item->box.x);
+            sb_poly_get_extrema_bounds(&segment->poly.y, &item->box.y);
+            sb_poly_get_extrema_bounds(&segment->poly.z, &item->box.z);
+            item->start_time_msec = segment->start_time_msec;
+            item->end_time_msec = segment->end_time_msec;
+            item->drone = i;
+            item->segment = j;
+
+            SB_CHECK(sb_trajectory_player_build_next_segment(player));
+        }
+
+        /* The drone stays at the end of its trajectory forever */
+        item->box.x.min = item->box.x.max = segment->start.x;
+        item->box.y.min = item->box.y.max = segment->start.y;
+        item->box.z.min = item->box.z.max = segment->start.z;
+        item->start_time_msec = segment->start_time_msec;
+        item->end_time_msec = UINT32_MAX;
+        item->drone = i;
+        item->segment = player->num_segments;
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_fleet_index_build_subtrees(void* context, size_t start, size_t end)
+{
+    sb_i_fleet_index_build_job_t* job = (sb_i_fleet_index_build_job_t*)context;
+    const sb_i_fleet_index_subtree_t* subtree;
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        subtree = &job->subtrees[i];
+        sb_i_fleet_index_build_node(job, subtree->node, subtree->first, subtree->count, 0, SIZE_MAX);
+    }
+
+    return SB_SUCCESS;
+}
+
+static double sb_i_fleet_index_get_key(const sb_fleet_index_item_t* item, uint8_t key)
+{
+    switch (key) {
+    case 0:
+        return (double)item->box.x.min + (double)item->box.x.max;
+    case 1:
+        return (double)item->box.y.min + (double)item->box.y.max;
+    case 2:
+        return (double)item->box.z.min + (double)item->box.z.max;
+    default:
+        return item->start_time_msec;
+    }
+}
+
+#define SB_I_DEFINE_KEY_COMPARATOR(KEY)                                             \
+    static int sb_i_fleet_index_compare_by_key_##KEY(const void* a, const void* b)  \
+    {                                                                               \
+        double ka = sb_i_fleet_index_get_key((const sb_fleet_index_item_t*)a, KEY); \
+        double kb = sb_i_fleet_index_get_key((const sb_fleet_index_item_t*)b, KEY); \
+        return ka < kb ? -1 : (ka > kb ? 1 : 0);                                    \
+    }
+
+SB_I_DEFINE_KEY_COMPARATOR(0)
+SB_I_DEFINE_KEY_COMPARATOR(1)
+SB_I_DEFINE_KEY_COMPARATOR(2)
+SB_I_DEFINE_KEY_COMPARATOR(3)
+
+#undef SB_I_DEFINE_KEY_COMPARATOR
+
+static int (*const sb_i_fleet_index_comparators[SB_I_FLEET_INDEX_NUM_KEYS])(const void*, const void*) = {
+    sb_i_fleet_index_compare_by_key_0,
+    sb_i_fleet_index_compare_by_key_1,
+    sb_i_fleet_index_compare_by_key_2,
+    sb_i_fleet_index_compare_by_key_3
+};
+
+static void sb_i_fleet_index_get_key_ranges(
+    const sb_fleet_index_item_t* items, size_t count, double* lo, double* hi)
+{
+    double value;
+    size_t i;
+    uint8_t key;
+
+    for (key = 0; key < SB_I_FLEET_INDEX_NUM_KEYS; key++) {
+        lo[key] = INFINITY;
+        hi[key] = -INFINITY;
+    }
+
+    for (i = 0; i < count; i++) {
+        for (key = 0; key < SB_I_FLEET_INDEX_NUM_KEYS; key++) {
+            value = sb_i_fleet_index_get_key(&items[i], key);
+            if (value < lo[key]) {
+                lo[key] = value;
+            }
+            if (value > hi[key]) {
+                hi[key] = value;
+            }
+        }
+    }
+}
+
+static void sb_i_fleet_index_node_reset(sb_fleet_index_node_t* node)
+{
+    node->box.x.min = node->box.y.min = node->box.z.min = INFINITY;
+    node->box.x.max = node->box.y.max = node->box.z.max = -INFINITY;
+    node->start_time_msec = UINT32_MAX;
+    node->end_time_msec = 0;
+}
+
+static void sb_i_fleet_index_node_extend(
+    sb_fleet_index_node_t* node, const sb_bounding_box_t* box,
+    uint32_t start_time_msec, uint32_t end_time_msec)
+{
+    node->box.x.min = fminf(node->box.x.min, box->x.min);
+    node->box.x.max = fmaxf(node->box.x.max, box->x.max);
+    node->box.y.min = fminf(node->box.y.min, box->y.min);
+    node->box.y.max = fmaxf(node->box.y.max, box->y.max);
+    node->box.z.min = fminf(node->box.z.min, box->z.min);
+    node->box.z.max = fmaxf(node->box.z.max, box->z.max);
+
+    if (start_time_msec < node->start_time_msec) {
+        node->start_time_msec = start_time_msec;
+    }
+    if (end_time_msec > node->end_time_msec) {
+        node->end_time_msec = end_time_msec;
+    }
+}
+
+static void sb_i_fleet_index_refit_node(sb_fleet_index_t* index, size_t node_index)
+{
+    sb_fleet_index_node_t* node = &index->nodes[node_index];
+    const sb_fleet_index_node_t* left = &index->nodes[node_index + 1];
+    const sb_fleet_index_node_t* right = &index->nodes[node->first];
+
+    sb_i_fleet_index_node_reset(node);
+    sb_i_fleet_index_node_extend(node, &left->box, left->start_time_msec, left->end_time_msec);
+    sb_i_fleet_index_node_extend(node, &right->box, right->start_time_msec, right->end_time_msec);
+}
+
+static void sb_i_fleet_index_refit_top_nodes(
+    sb_fleet_index_t* index, size_t node_index, size_t depth, size_t max_depth)
+{
+    const sb_fleet_index_node_t* node = &index->nodes[node_index];
+
+    if (node->count > 0 || depth >= max_depth) {
+        /* Leaf node or root of a subtree that was built in parallel */
+        return;
+    }
+
+    sb_i_fleet_index_refit_top_nodes(index, node_index + 1, depth + 1, max_depth);
+    sb_i_fleet_index_refit_top_nodes(index, node->first, depth + 1, max_depth);
+    sb_i_fleet_index_refit_node(index, node_index);
+}
+
+static size_t sb_i_fleet_index_count_nodes(size_t num_items)
+{
+    if (num_items <= SB_I_FLEET_INDEX_LEAF_SIZE) {
+        return num_items > 0 ? 1 : 0;
+    }
+
+    return 1 + sb_i_fleet_index_count_nodes(num_items / 2) + sb_i_fleet_index_count_nodes(num_items - num_items / 2);
+}
+
+static void sb_i_fleet_index_build_node(
+    sb_i_fleet_index_build_job_t* job, size_t node_index, size_t first, size_t count,
+    size_t depth, size_t max_depth)
+{
+    sb_fleet_index_t* index = job->index;
+    sb_fleet_index_node_t* node = &index->nodes[node_index];
+    const sb_fleet_index_item_t* item;
+    sb_i_fleet_index_subtree_t* subtree;
+    double lo[SB_I_FLEET_INDEX_NUM_KEYS], hi[SB_I_FLEET_INDEX_NUM_KEYS];
+    double extent, best_extent;
+    size_t i, half;
+    uint8_t key, best_key;
+
+    if (count <= SB_I_FLEET_INDEX_LEAF_SIZE) {
+        sb_i_fleet_index_node_reset(node);
+        for (i = 0, item = &index->items[first]; i < count; i++, item++) {
+            sb_i_fleet_index_node_extend(node, &item->box, item->start_time_msec, item->end_time_msec);
+        }
+        node->first = first;
+        node->count = count;
+        return;
+    }
+
+    if (depth >= max_depth) {
+        subtree = &job->subtrees[job->num_subtrees++];
+        subtree->node = node_index;
+        subtree->first = first;
+        subtree->count = count;
+        return;
+    }
+
+    /* Split the items at the median along the key whose range is the largest
+     * compared to the range of the same key in the entire index */
+    sb_i_fleet_index_get_key_ranges(&index->items[first], count, lo, hi);
+    best_key = SB_I_FLEET_INDEX_NUM_KEYS - 1;
+    best_extent = -1;
+    for (key = 0; key < SB_I_FLEET_INDEX_NUM_KEYS; key++) {
+        extent = (hi[key] - lo[key]) * job->scale[key];
+        if (extent > best_extent) {
+            best_extent = extent;
+            best_key = key;
+        }
+    }
+
+    qsort(&index->items[first], count, sizeof(sb_fleet_index_item_t), sb_i_fleet_index_comparators[best_key]);
+
+    half = count / 2;
+    node->first = node_index + 1 + sb_i_fleet_index_count_nodes(half);
+    node->count = 0;
+
+    sb_i_fleet_index_build_node(job, node_index + 1, first, half, depth + 1, max_depth);
+    sb_i_fleet_index_build_node(job, node->first, first + half, count - half, depth + 1, max_depth);
+
+    if (max_depth == SIZE_MAX) {
+        /* Both children are complete so we can calculate the bounds now;
+         * otherwise they are calculated after the deferred subtrees are built */
+        sb_i_fleet_index_refit_node(index, node_index);
+    }
+}
+
+static float sb_i_fleet_index_distance_sq_to_box(
+    const sb_bounding_box_t* box, const sb_vector3_with_yaw_t* point)
+{
+    float dx = fmaxf(fmaxf(box->x.min - point->x, point->x - box->x.max), 0);
+    float dy = fmaxf(fmaxf(box->y.min - point->y, point->y - box->y.max), 0);
+    float dz = fmaxf(fmaxf(box->z.min - point->z, point->z - box->z.max), 0);
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static sb_error_t sb_i_fleet_index_query(
+    sb_fleet_index_t* index, unsigned long timestamp, sb_vector3_with_yaw_t point,
+    float radius, size_t exclude, size_t* drones, size_t max_drones, size_t* num_found)
+{
+    size_t stack[SB_I_FLEET_INDEX_STACK_SIZE];
+    size_t stack_size, i;
+    const sb_fleet_index_node_t* node;
+    const sb_fleet_index_item_t* item;
+    sb_vector3_with_yaw_t pos;
+    uint32_t t = timestamp < UINT32_MAX ? (uint32_t)timestamp : UINT32_MAX;
+    float radius_sq, dx, dy, dz;
+
+    if (num_found == 0 || (drones == 0 && max_drones > 0) || !(radius >= 0)) {
+        return SB_EINVAL;
+    }
+
+    *num_found = 0;
+
+    if (index->num_nodes == 0) {
+        return SB_SUCCESS;
+    }
+
+    /* Start a new query; clear the markers when the identifier wraps around */
+    index->query_id++;
+    if (index->query_id == 0) {
+        memset(index->last_query, 0, index->num_drones * sizeof(uint32_t));
+        index->query_id = 1;
+    }
+
+    radius_sq = radius * radius;
+    stack[0] = 0;
+    stack_size = 1;
+
+    while (stack_size > 0) {
+        node = &index->nodes[stack[--stack_size]];
+
+        if (
+            t < node->start_time_msec || t > node->end_time_msec ||
+            sb_i_fleet_index_distance_sq_to_box(&node->box, &point) > radius_sq
+        ) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            if (stack_size + 2 > SB_I_FLEET_INDEX_STACK_SIZE) {
+                return SB_EOVERFLOW; /* LCOV_EXCL_LINE */
+            }
+            stack[stack_size++] = node->first;
+            stack[stack_size++] = (node - index->nodes) + 1;
+            continue;
+        }
+
+        for (i = 0, item = &index->items[node->first]; i < node->count; i++, item++) {
+            if (
+                t < item->start_time_msec || t > item->end_time_msec ||
+                item->drone == exclude || index->last_query[item->drone] == index->query_id ||
+                sb_i_fleet_index_distance_sq_to_box(&item->box, &point) > radius_sq
+            ) {
+                continue;
+            }
+
+            /* Evaluate each drone only once even if the query time is at the
+             * boundary of two of its segments */
+            index->last_query[item->drone] = index->query_id;
+
+            SB_CHECK(sb_i_fleet_index_get_position(index, item->drone, item->segment, t, &pos));
+
+            dx = pos.x - point.x;
+            dy = pos.y - point.y;
+            dz = pos.z - point.z;
+            if (dx * dx + dy * dy + dz * dz <= radius_sq) {
+                if (*num_found < max_drones) {
+                    drones[*num_found] = item->drone;
+                }
+                (*num_found)++;
+            }
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_fleet_index_get_position(
+    sb_fleet_index_t* index, size_t drone, size_t segment, uint32_t t,
+    sb_vector3_with_yaw_t* result)
+{
+    sb_trajectory_player_t* player = &index->players[drone];
+    const sb_trajectory_segment_table_entry_t* entry;
+    sb_trajectory_player_snapshot_t snapshot;
+    size_t size;
+
+    /* Jump straight to the segment instead of seeking from the current one.
+     * The item after the end of the trajectory is reached by seeking forward
+     * from the last segment. */
+    if (player->num_segments > 0) {
+        if (segment >= player->num_segments) {
+            segment = player->num_segments - 1;
+        }
+        entry = &player->segment_table[segment];
+        if (player->current_segment.start != entry->offset) {
+            size = sb_buffer_size(&player->trajectory->buffer);
+            memset(&snapshot, 0, sizeof(snapshot));
+            snapshot.trajectory_size = size;
+            snapshot.offset = entry->offset;
+            snapshot.length = (segment + 1 < player->num_segments ? entry[1].offset : size) - entry->offset;
+            snapshot.start_time_msec = entry->start_time_msec;
+            snapshot.start = entry->start;
+            SB_CHECK(sb_trajectory_player_restore_snapshot(player, &snapshot));
+        }
+    }
+
+    return sb_trajectory_player_get_position_at_msec(player, t, result);
+}
@@ -21,8 +21,61 @@
 #include <skybrush/formats/binary.h>
 #include <skybrush/utils.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef SB_ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+/* Nanosecond parts of the timestamps of a file; \c st_mtime and \c st_ctime
+ * only have a resolution of one second */
+#ifdef __APPLE__
+#define SB_I_STAT_MTIME_NSEC(st) ((st).st_mtimespec.tv_nsec)
+#define SB_I_STAT_CTIME_NSEC(st) ((st).st_ctimespec.tv_nsec)
+#else
+#define SB_I_STAT_MTIME_NSEC(st) ((st).st_mtim.tv_nsec)
+#define SB_I_STAT_CTIME_NSEC(st) ((st).st_ctim.tv_nsec)
+#endif
+
+/**
+ * Number of entries in the process-wide cache of verified CRC32 checksums.
+ */
+#define CRC_CACHE_SIZE 16
+
+/**
+ * Key identifying a file or an in-memory buffer in the cache of verified
+ * CRC32 checksums.
+ */
+typedef struct {
+    dev_t dev; /**< Device of the file; zero for in-memory buffers */
+    ino_t ino; /**< Inode of the file; zero for in-memory buffers */
+    time_t mtime; /**< Modification time of the file; zero for in-memory buffers */
+    long mtime_nsec; /**< Nanosecond part of the modification time of the file */
+    time_t ctime; /**< Status change time of the file; zero for in-memory buffers */
+    long ctime_nsec; /**< Nanosecond part of the status change time of the file */
+    const uint8_t* buf; /**< Address of the in-memory buffer; null for files */
+    size_t size; /**< Size of the file or buffer */
+    uint32_t crc32; /**< The CRC32 checksum stored in the header */
+} sb_i_crc_cache_key_t;
+
+typedef struct {
+    sb_i_crc_cache_key_t entries[CRC_CACHE_SIZE];
+    size_t num_entries; /**< Number of valid entries */
+    size_t next; /**< Index of the entry to overwrite when the cache is full */
+} sb_i_crc_cache_t;
+
+static sb_i_crc_cache_t sb_i_crc_cache;
+
+#ifdef SB_ENABLE_THREADS
+static pthread_mutex_t sb_i_crc_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define CRC_CACHE_LOCK() pthread_mutex_lock(&sb_i_crc_cache_mutex)
+#define CRC_CACHE_UNLOCK() pthread_mutex_unlock(&sb_i_crc_cache_mutex)
+#else
+#define CRC_CACHE_LOCK()
+#define CRC_CACHE_UNLOCK()
+#endif
+
 /**
  * Common part of the different \c "sb_binary_file_parser_init_*" methods.
  */
@@ -34,12 +87,23 @@ static sb_error_t sb_i_binary_file_parser_init_common(sb_binary_file_parser_t* p
 static sb_error_t sb_i_binary_file_read_next_block_header(sb_binary_file_parser_t* parser);
 
 static sb_error_t sb_i_binary_file_get_crc32(sb_binary_file_parser_t* parser, uint32_t* result);
+static sb_error_t sb_i_binary_file_verify_crc32(sb_binary_file_parser_t* parser);
+static sb_error_t sb_i_crc_cache_get_key(const sb_binary_file_parser_t* parser, sb_i_crc_cache_key_t* key);
+static sb_bool_t sb_i_crc_cache_contains(const sb_i_crc_cache_key_t* key);
+static void sb_i_crc_cache_add(const sb_i_crc_cache_key_t* key);
 static off_t sb_i_binary_file_get_current_offset(sb_binary_file_parser_t* parser);
 static ssize_t sb_i_binary_file_read(sb_binary_file_parser_t* parser, void* buf, size_t nbytes);
 static sb_error_t sb_i_binary_file_seek(sb_binary_file_parser_t* parser, off_t offset);
 
 sb_error_t sb_binary_file_parser_init_from_buffer(
     sb_binary_file_parser_t* parser, uint8_t* buf, size_t nbytes)
+{
+    return sb_binary_file_parser_init_from_buffer_with_flags(
+        parser, buf, nbytes, SB_BINARY_PARSER_VERIFY_CRC_EAGER);
+}
+
+sb_error_t sb_binary_file_parser_init_from_buffer_with_flags(
+    sb_binary_file_parser_t* parser, uint8_t* buf, size_t nbytes, uint8_t flags)
 {
     if (buf == 0) {
         return SB_EINVAL;
@@ -50,11 +114,19 @@ sb_error_t sb_binary_file_parser_init_from_buffer(
     parser->buf_end = buf + nbytes;
 
     parser->fd = -1;
+    parser->flags = flags;
 
     return sb_i_binary_file_parser_init_common(parser);
 }
 
 sb_error_t sb_binary_file_parser_init_from_file(sb_binary_file_parser_t* parser, int fd)
+{
+    return sb_binary_file_parser_init_from_file_with_flags(
+        parser, fd, SB_BINARY_PARSER_VERIFY_CRC_EAGER);
+}
+
+sb_error_t sb_binary_file_parser_init_from_file_with_flags(
+    sb_binary_file_parser_t* parser, int fd, uint8_t flags)
 {
     if (fd < 0) {
         return SB_EINVAL;
@@ -65,6 +137,7 @@ sb_error_t sb_binary_file_parser_init_from_file(sb_binary_file_parser_t* parser,
     parser->buf_end = 0;
 
     parser->fd = fd;
+    parser->flags = flags;
 
     return sb_i_binary_file_parser_init_common(parser);
 }
@@ -102,6 +175,10 @@ sb_error_t sb_binary_file_read_current_block(sb_binary_file_parser_t* parser, ui
         return SB_EREAD;
     }
 
+    if (parser->crc32_pending) {
+        SB_CHECK(sb_i_binary_file_verify_crc32(parser));
+    }
+
     SB_CHECK(sb_i_binary_file_seek(parser, parser->current_block.start_of_body));
 
     bytes_read = sb_i_binary_file_read(parser, buf, parser->current_block.length);
@@ -113,6 +190,32 @@ sb_error_t sb_binary_file_read_current_block(sb_binary_file_parser_t* parser, ui
     return SB_SUCCESS;
 }
 
+sb_error_t sb_binary_file_get_current_block_view(
+    sb_binary_file_parser_t* parser, uint8_t** result)
+{
+    if (!sb_binary_file_is_current_block_valid(parser)) {
+        return SB_EREAD;
+    }
+
+    if (parser->buf == 0) {
+        return SB_EUNSUPPORTED;
+    }
+
+    if (parser->crc32_pending) {
+        SB_CHECK(sb_i_binary_file_verify_crc32(parser));
+    }
+
+    if (parser->buf + parser->current_block.start_of_body + parser->current_block.length > parser->buf_end) {
+        /* truncated block */
+        return SB_EREAD;
+    }
+
+    /* The buffer was given to us as non-const in sb_binary_file_parser_init_from_buffer() */
+    *result = (uint8_t*)parser->buf + parser->current_block.start_of_body;
+
+    return SB_SUCCESS;
+}
+
 sb_error_t sb_binary_file_rewind(sb_binary_file_parser_t* parser)
 {
     SB_CHECK(sb_i_binary_file_seek(parser, parser->start_of_first_block));
@@ -161,7 +264,8 @@ static sb_error_t sb_i_binary_file_parser_init_common(sb_binary_file_parser_t* p
 {
     char buf[4];
     long int offset;
-    uint32_t expected_crc32 = 0, observed_crc32;
+    uint32_t expected_crc32 = 0;
+    sb_i_crc_cache_key_t key;
 
     /* read and check the header */
     if (sb_i_binary_file_read(parser, buf, 4) != 4) {
@@ -218,14 +322,22 @@ static sb_error_t sb_i_binary_file_parser_init_common(sb_binary_file_parser_t* p
     }
     parser->start_of_first_block = offset;
 
-    /* Validate the CRC32 checksum if we have one */
-    if (parser->features & SB_BINARY_FEATURE_CRC32) {
-        SB_CHECK(sb_i_binary_file_get_crc32(parser, &observed_crc32));
-        if (expected_crc32 != observed_crc32) {
-            return SB_ECORRUPTED;
+    /* Validate the CRC32 checksum if we have one, unless it is verified
+     * already according to the cache or we were asked to skip or postpone
+     * the verification */
+    parser->expected_crc32 = expected_crc32;
+    parser->crc32_pending = (parser->features & SB_BINARY_FEATURE_CRC32) && (parser->flags & SB_BINARY_PARSER_VERIFY_CRC_MASK) != SB_BINARY_PARSER_VERIFY_CRC_SKIP;
+
+    if (parser->crc32_pending && (parser->flags & SB_BINARY_PARSER_USE_CRC_CACHE)) {
+        if (sb_i_crc_cache_get_key(parser, &key) == SB_SUCCESS && sb_i_crc_cache_contains(&key)) {
+            parser->crc32_pending = 0;
         }
     }
 
+    if (parser->crc32_pending && (parser->flags & SB_BINARY_PARSER_VERIFY_CRC_MASK) == SB_BINARY_PARSER_VERIFY_CRC_EAGER) {
+        SB_CHECK(sb_i_binary_file_verify_crc32(parser));
+    }
+
     /* Rewind the file or buffer and read the header of the first block */
     SB_CHECK(sb_binary_file_rewind(parser));
 
@@ -315,6 +427,31 @@ static sb_error_t sb_i_binary_file_get_crc32(sb_binary_file_parser_t* parser, ui
     return SB_SUCCESS;
 }
 
+/**
+ * Verifies the CRC32 checksum of the file and records the result in the
+ * cache if the parser is allowed to use the cache.
+ */
+static sb_error_t sb_i_binary_file_verify_crc32(sb_binary_file_parser_t* parser)
+{
+    uint32_t observed_crc32;
+    sb_i_crc_cache_key_t key;
+
+    SB_CHECK(sb_i_binary_file_get_crc32(parser, &observed_crc32));
+    if (parser->expected_crc32 != observed_crc32) {
+        return SB_ECORRUPTED;
+    }
+
+    parser->crc32_pending = 0;
+
+    if (parser->flags & SB_BINARY_PARSER_USE_CRC_CACHE) {
+        if (sb_i_crc_cache_get_key(parser, &key) == SB_SUCCESS) {
+            sb_i_crc_cache_add(&key);
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
 static off_t sb_i_binary_file_get_current_offset(sb_binary_file_parser_t* parser)
 {
     if (parser->buf) {
@@ -374,3 +511,92 @@ static sb_error_t sb_i_binary_file_seek(sb_binary_file_parser_t* parser, off_t o
         return lseek(parser->fd, offset, SEEK_SET) == offset ? SB_SUCCESS : SB_EREAD;
     }
 }
+
+/* ************************************************************************** */
+
+/* Cache of verified CRC32 checksums */
+
+void sb_binary_file_crc_cache_clear(void)
+{
+    CRC_CACHE_LOCK();
+    sb_i_crc_cache.num_entries = 0;
+    sb_i_crc_cache.next = 0;
+    CRC_CACHE_UNLOCK();
+}
+
+static sb_error_t sb_i_crc_cache_get_key(const sb_binary_file_parser_t* parser, sb_i_crc_cache_key_t* key)
+{
+    struct stat st;
+
+    memset(key, 0, sizeof(sb_i_crc_cache_key_t));
+
+    if (parser->buf) {
+        key->buf = parser->buf;
+        key->size = parser->buf_end - parser->buf;
+    } else {
+        if (fstat(parser->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            return SB_EREAD;
+        }
+
+        key->dev = st.st_dev;
+        key->ino = st.st_ino;
+        key->mtime = st.st_mtime;
+        key->mtime_nsec = SB_I_STAT_MTIME_NSEC(st);
+        key->ctime = st.st_ctime;
+        key->ctime_nsec = SB_I_STAT_CTIME_NSEC(st);
+        key->size = st.st_size;
+    }
+
+    key->crc32 = parser->expected_crc32;
+
+    return SB_SUCCESS;
+}
+
+static sb_bool_t sb_i_crc_cache_key_equals(const sb_i_crc_cache_key_t* a, const sb_i_crc_cache_key_t* b)
+{
+    return a->dev == b->dev && a->ino == b->ino && a->mtime == b->mtime && a->mtime_nsec == b->mtime_nsec && a->ctime == b->ctime && a->ctime_nsec == b->ctime_nsec && a->buf == b->buf && a->size == b->size && a->crc32 == b->crc32;
+}
+
+static sb_bool_t sb_i_crc_cache_contains(const sb_i_crc_cache_key_t* key)
+{
+    sb_bool_t result = 0;
+    size_t i;
+
+    CRC_CACHE_LOCK();
+    for (i = 0; i < sb_i_crc_cache.num_entries; i++) {
+        if (sb_i_crc_cache_key_equals(&sb_i_crc_cache.entries[i], key)) {
+            result = 1;
+            break;
+        }
+    }
+    CRC_CACHE_UNLOCK();
+
+    return result;
+}
+
+static void sb_i_crc_cache_add(const sb_i_crc_cache_key_t* key)
+{
+    size_t i;
+
+    CRC_CACHE_LOCK();
+
+    for (i = 0; i < sb_i_crc_cache.num_entries; i++) {
+        if (sb_i_crc_cache_key_equals(&sb_i_crc_cache.entries[i], key)) {
+            break;
+        }
+    }
+
+    if (i == sb_i_crc_cache.num_entries) {
+        /* Not in the cache yet; overwrite the oldest entry if full */
+        if (sb_i_crc_cache.num_entries < CRC_CACHE_SIZE) {
+            i = sb_i_crc_cache.num_entries++;
+        } else {
+            i = sb_i_crc_cache.next;
+            sb_i_crc_cache.next = (sb_i_crc_cache.next + 1) % CRC_CACHE_SIZE;
+        }
+
+        sb_i_crc_cache.entries[i] = *key;
+    }
+
+    CRC_CACHE_UNLOCK();
+}
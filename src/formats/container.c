@@ -0,0 +1,326 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <skybrush/formats/container.h>
+#include <skybrush/memory.h>
+#include <skybrush/utils.h>
+
+#include "../parsing.h"
+
+/**
+ * Length of the header of the container, in bytes.
+ */
+#define HEADER_LENGTH 16
+
+/**
+ * Length of a single entry in the directory table of the container, in bytes.
+ */
+#define ENTRY_LENGTH 16
+
+static void sb_i_container_entry_parse(const uint8_t* buf, sb_container_entry_t* entry);
+static void sb_i_container_entry_write(uint8_t* buf, const sb_container_entry_t* entry);
+static int sb_i_container_entry_compare(const void* a, const void* b);
+
+sb_error_t sb_container_init_from_buffer(
+    sb_container_t* container, uint8_t* buf, size_t nbytes)
+{
+    size_t offset;
+    uint32_t i, num_entries, expected_crc32, last_id = 0;
+    sb_container_entry_t entry;
+
+    if (buf == 0 || nbytes < HEADER_LENGTH) {
+        return SB_EPARSE;
+    }
+
+    if (memcmp(buf, "skyc", 4) || buf[4] != SB_CONTAINER_VERSION) {
+        return SB_EPARSE;
+    }
+
+    offset = 8;
+    num_entries = sb_parse_uint32(buf, &offset);
+    expected_crc32 = sb_parse_uint32(buf, &offset);
+
+    if (num_entries > (nbytes - HEADER_LENGTH) / ENTRY_LENGTH) {
+        return SB_EPARSE;
+    }
+
+    if (sb_ap_crc32_update(0, buf + HEADER_LENGTH, num_entries * ENTRY_LENGTH) != expected_crc32) {
+        return SB_ECORRUPTED;
+    }
+
+    /* Validate the directory table so we do not need to do it later */
+    for (i = 0; i < num_entries; i++) {
+        sb_i_container_entry_parse(buf + HEADER_LENGTH + i * ENTRY_LENGTH, &entry);
+
+        if (i > 0 && entry.id <= last_id) {
+            return SB_EPARSE;
+        }
+
+        if (entry.offset > nbytes || entry.length > nbytes - entry.offset) {
+            return SB_EPARSE;
+        }
+
+        last_id = entry.id;
+    }
+
+    container->buf = buf;
+    container->nbytes = nbytes;
+    container->num_entries = num_entries;
+
+    return SB_SUCCESS;
+}
+
+void sb_container_destroy(sb_container_t* container)
+{
+    container->buf = 0;
+    container->nbytes = 0;
+    container->num_entries = 0;
+}
+
+uint32_t sb_container_get_num_entries(const sb_container_t* container)
+{
+    return container->num_entries;
+}
+
+sb_error_t sb_container_get_entry(
+    const sb_container_t* container, uint32_t index, sb_container_entry_t* entry)
+{
+    if (index >= container->num_entries) {
+        return SB_EINVAL;
+    }
+
+    sb_i_container_entry_parse(container->buf + HEADER_LENGTH + index * ENTRY_LENGTH, entry);
+
+    return SB_SUCCESS;
+}
+
+sb_error_t sb_container_find_entry(
+    const sb_container_t* container, uint32_t id, sb_container_entry_t* entry)
+{
+    uint32_t lo = 0, hi = container->num_entries, mid;
+    sb_container_entry_t candidate;
+
+    /* Binary search in the directory table, which is sorted by ID */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        sb_i_container_entry_parse(container->buf + HEADER_LENGTH + mid * ENTRY_LENGTH, &candidate);
+
+        if (candidate.id == id) {
+            if (entry) {
+                *entry = candidate;
+            }
+            return SB_SUCCESS;
+        } else if (candidate.id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return SB_ENOENT;
+}
+
+sb_error_t sb_container_get_show_view(
+    const sb_container_t* container, uint32_t id, sb_bool_t verify,
+    uint8_t** result, size_t* nbytes)
+{
+    sb_container_entry_t entry;
+    uint8_t* show;
+
+    SB_CHECK(sb_container_find_entry(container, id, &entry));
+
+    show = container->buf + entry.offset;
+    if (verify && sb_ap_crc32_update(0, show, entry.length) != entry.crc32) {
+        return SB_ECORRUPTED;
+    }
+
+    if (result) {
+        *result = show;
+    }
+
+    if (nbytes) {
+        *nbytes = entry.length;
+    }
+
+    return SB_SUCCESS;
+}
+
+sb_error_t sb_container_init_parser(
+    const sb_container_t* container, uint32_t id,
+    sb_binary_file_parser_t* parser, uint8_t flags)
+{
+    uint8_t* show;
+    size_t nbytes;
+    sb_bool_t verify = (flags & SB_BINARY_PARSER_VERIFY_CRC_MASK) != SB_BINARY_PARSER_VERIFY_CRC_SKIP;
+
+    SB_CHECK(sb_container_get_show_view(container, id, verify, &show, &nbytes));
+
+    /* The checksum in the directory covers the entire show file so there is
+     * no need to let the parser verify it again */
+    flags = (flags & ~SB_BINARY_PARSER_VERIFY_CRC_MASK) | SB_BINARY_PARSER_VERIFY_CRC_SKIP;
+
+    return sb_binary_file_parser_init_from_buffer_with_flags(parser, show, nbytes, flags);
+}
+
+/* ************************************************************************** */
+
+sb_error_t sb_container_builder_init(sb_container_builder_t* builder)
+{
+    SB_CHECK(sb_buffer_init(&builder->directory, 0));
+
+    if (sb_buffer_init(&builder->payload, 0)) {
+        sb_buffer_destroy(&builder->directory); /* LCOV_EXCL_LINE */
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    return SB_SUCCESS;
+}
+
+void sb_container_builder_destroy(sb_container_builder_t* builder)
+{
+    sb_buffer_destroy(&builder->payload);
+    sb_buffer_destroy(&builder->directory);
+}
+
+sb_error_t sb_container_builder_add(
+    sb_container_builder_t* builder, uint32_t id, const uint8_t* show, size_t nbytes)
+{
+    sb_container_entry_t entry;
+    uint8_t* ptr;
+    size_t padding;
+
+    if (show == 0 && nbytes > 0) {
+        return SB_EINVAL;
+    }
+
+    if (nbytes > UINT32_MAX || sb_buffer_size(&builder->payload) > UINT32_MAX - nbytes) {
+        return SB_EOVERFLOW;
+    }
+
+    /* Offsets are relative to the start of the payload here; they are
+     * adjusted when the container is assembled */
+    entry.id = id;
+    entry.offset = sb_buffer_size(&builder->payload);
+    entry.length = nbytes;
+    entry.crc32 = sb_ap_crc32_update(0, show, nbytes);
+
+    padding = (SB_CONTAINER_ALIGNMENT - nbytes % SB_CONTAINER_ALIGNMENT) % SB_CONTAINER_ALIGNMENT;
+
+    SB_CHECK(sb_buffer_extend_uninitialized(&builder->directory, ENTRY_LENGTH, &ptr));
+    sb_i_container_entry_write(ptr, &entry);
+
+    SB_CHECK(sb_buffer_append_bytes(&builder->payload, show, nbytes));
+    SB_CHECK(sb_buffer_extend_with_zeros(&builder->payload, padding));
+
+    return SB_SUCCESS;
+}
+
+sb_error_t sb_container_builder_get_result(
+    const sb_container_builder_t* builder, sb_buffer_t* result)
+{
+    sb_container_entry_t* entries;
+    size_t i, num_entries, directory_length, payload_length, offset;
+    uint8_t* buf;
+    sb_error_t retval = SB_SUCCESS;
+
+    num_entries = sb_buffer_size(&builder->directory) / ENTRY_LENGTH;
+    directory_length = num_entries * ENTRY_LENGTH;
+    payload_length = sb_buffer_size(&builder->payload);
+
+    if (HEADER_LENGTH + directory_length > UINT32_MAX - payload_length) {
+        return SB_EOVERFLOW;
+    }
+
+    entries = sb_calloc(sb_container_entry_t, num_entries > 0 ? num_entries : 1);
+    if (entries == 0) {
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    for (i = 0; i < num_entries; i++) {
+        sb_i_container_entry_parse(SB_BUFFER(builder->directory) + i * ENTRY_LENGTH, &entries[i]);
+        entries[i].offset += HEADER_LENGTH + directory_length;
+    }
+
+    qsort(entries, num_entries, sizeof(sb_container_entry_t), sb_i_container_entry_compare);
+
+    for (i = 1; i < num_entries; i++) {
+        if (entries[i - 1].id == entries[i].id) {
+            retval = SB_EINVAL;
+            goto cleanup;
+        }
+    }
+
+    retval = sb_buffer_init(result, HEADER_LENGTH + directory_length + payload_length);
+    if (retval != SB_SUCCESS) {
+        goto cleanup; /* LCOV_EXCL_LINE */
+    }
+
+    buf = SB_BUFFER((*result));
+    memcpy(buf, "skyc", 4);
+    buf[4] = SB_CONTAINER_VERSION;
+    buf[5] = buf[6] = buf[7] = 0;
+
+    for (i = 0; i < num_entries; i++) {
+        sb_i_container_entry_write(buf + HEADER_LENGTH + i * ENTRY_LENGTH, &entries[i]);
+    }
+
+    offset = 8;
+    sb_write_uint32(buf, &offset, num_entries);
+    sb_write_uint32(buf, &offset, sb_ap_crc32_update(0, buf + HEADER_LENGTH, directory_length));
+
+    if (payload_length > 0) {
+        memcpy(buf + HEADER_LENGTH + directory_length, SB_BUFFER(builder->payload), payload_length);
+    }
+
+cleanup:
+    sb_free(entries);
+    return retval;
+}
+
+/* ************************************************************************** */
+
+static void sb_i_container_entry_parse(const uint8_t* buf, sb_container_entry_t* entry)
+{
+    size_t offset = 0;
+
+    entry->id = sb_parse_uint32(buf, &offset);
+    entry->offset = sb_parse_uint32(buf, &offset);
+    entry->length = sb_parse_uint32(buf, &offset);
+    entry->crc32 = sb_parse_uint32(buf, &offset);
+}
+
+static void sb_i_container_entry_write(uint8_t* buf, const sb_container_entry_t* entry)
+{
+    size_t offset = 0;
+
+    sb_write_uint32(buf, &offset, entry->id);
+    sb_write_uint32(buf, &offset, entry->offset);
+    sb_write_uint32(buf, &offset, entry->length);
+    sb_write_uint32(buf, &offset, entry->crc32);
+}
+
+static int sb_i_container_entry_compare(const void* a, const void* b)
+{
+    uint32_t first = ((const sb_container_entry_t*)a)->id;
+    uint32_t second = ((const sb_container_entry_t*)b)->id;
+
+    return first < second ? -1 : (first > second ? 1 : 0);
+}
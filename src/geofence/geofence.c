@@ -0,0 +1,421 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file geofence.c
+ * @brief Checking trajectories against polygonal geofences with altitude limits.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <skybrush/geofence.h>
+#include <skybrush/memory.h>
+#include <skybrush/poly.h>
+
+#include "../parallel.h"
+
+/**
+ * @def MAX_CANDIDATES
+ * @brief Maximum number of candidate crossing points in a single trajectory
+ * segment.
+ *
+ * Each polygon edge and each altitude limit may contribute at most as many
+ * crossings as the degree of the segment, plus we also need the start of the
+ * segment.
+ */
+#define MAX_CANDIDATES(fence) (((fence)->num_vertices + 2) * SB_MAX_POLY_COEFFS + 1)
+
+typedef struct {
+    const sb_geofence_t* fence;
+    const sb_trajectory_t* trajectories;
+    float* violation_times_sec;
+} sb_i_geofence_job_t;
+
+/**
+ * @brief Returns whether the given point of the XY plane is inside the
+ * polygon of the geofence.
+ */
+static sb_bool_t sb_i_geofence_contains_xy(const sb_geofence_t* fence, float x, float y);
+
+/**
+ * @brief Returns whether the polygon edge between the given points may
+ * intersect the given axis-aligned box.
+ */
+static sb_bool_t sb_i_edge_intersects_box(
+    sb_vector2_t a, sb_vector2_t b, const sb_interval_t* x, const sb_interval_t* y);
+
+/**
+ * @brief Checks a single trajectory segment against the geofence and updates
+ * the violation time if the segment leaves the geofence.
+ */
+static sb_error_t sb_i_geofence_check_segment(
+    const sb_geofence_t* fence, const sb_trajectory_segment_t* segment,
+    float* candidates, float* violation_time_sec);
+
+static int sb_i_compare_floats(const void* a, const void* b);
+
+/**
+ * @brief Initializes a geofence.
+ *
+ * @param fence  the geofence to initialize
+ * @param vertices  the vertices of the polygon of the geofence in the XY
+ *        plane, in the same units as the trajectories to check. The polygon
+ *        must be simple (i.e. it must not intersect itself) but it does not
+ *        need to be convex. The vertices are copied.
+ * @param num_vertices  the number of vertices; must be at least 3
+ * @param min_altitude  the minimum allowed altitude; use \c -INFINITY if
+ *        there is no lower limit
+ * @param max_altitude  the maximum allowed altitude; use \c INFINITY if
+ *        there is no upper limit
+ * @return \c SB_EINVAL if the polygon has less than three vertices or the
+ *         altitude range is empty, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_geofence_init(
+    sb_geofence_t* fence, const sb_vector2_t* vertices, size_t num_vertices,
+    float min_altitude, float max_altitude)
+{
+    size_t i;
+
+    if (num_vertices < 3 || !(min_altitude <= max_altitude)) {
+        return SB_EINVAL;
+    }
+
+    fence->vertices = sb_calloc(sb_vector2_t, num_vertices);
+    if (fence->vertices == 0) {
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    memcpy(fence->vertices, vertices, num_vertices * sizeof(sb_vector2_t));
+    fence->num_vertices = num_vertices;
+
+    fence->bounding_box.x.min = fence->bounding_box.y.min = INFINITY;
+    fence->bounding_box.x.max = fence->bounding_box.y.max = -INFINITY;
+    for (i = 0; i < num_vertices; i++) {
+        fence->bounding_box.x.min = fminf(fence->bounding_box.x.min, vertices[i].x);
+        fence->bounding_box.x.max = fmaxf(fence->bounding_box.x.max, vertices[i].x);
+        fence->bounding_box.y.min = fminf(fence->bounding_box.y.min, vertices[i].y);
+        fence->bounding_box.y.max = fmaxf(fence->bounding_box.y.max, vertices[i].y);
+    }
+    fence->bounding_box.z.min = min_altitude;
+    fence->bounding_box.z.max = max_altitude;
+
+    return SB_SUCCESS;
+}
+
+/**
+ * @brief Destroys a geofence.
+ */
+void sb_geofence_destroy(sb_geofence_t* fence)
+{
+    sb_free(fence->vertices);
+    fence->num_vertices = 0;
+}
+
+/**
+ * @brief Returns whether the geofence contains the given point.
+ *
+ * Points on the boundary of the geofence may be classified either way.
+ */
+sb_bool_t sb_geofence_contains(const sb_geofence_t* fence, sb_vector3_with_yaw_t point)
+{
+    return (
+        point.z >= fence->bounding_box.z.min && point.z <= fence->bounding_box.z.max && sb_i_geofence_contains_xy(fence, point.x, point.y));
+}
+
+/**
+ * @brief Checks whether a trajectory stays within the geofence.
+ *
+ * The check is exact up to the precision of the polynomial root finding; no
+ * sampling is involved. Each segment is first bounded by an axis-aligned box
+ * derived from the extrema of its polynomials. Segments whose box does not
+ * touch any edge of the geofence are accepted or rejected as a whole. For the
+ * remaining segments, the points where the segment crosses the lines of the
+ * nearby edges or the altitude limits are found by solving polynomial
+ * equations, and the segment is tested between consecutive crossings.
+ *
+ * @param fence  the geofence
+ * @param trajectory  the trajectory to check
+ * @param violation_time_sec  the time when the trajectory first leaves the
+ *        geofence is returned here, in seconds; infinity if the trajectory
+ *        stays within the geofence. May be \c NULL.
+ * @return error code
+ */
+sb_error_t sb_geofence_check_trajectory(
+    const sb_geofence_t* fence, const sb_trajectory_t* trajectory,
+    float* violation_time_sec)
+{
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t start;
+    float* candidates;
+    float result = INFINITY;
+    sb_error_t retval;
+
+    SB_CHECK(sb_trajectory_get_start_position(trajectory, &start));
+
+    if (!sb_geofence_contains(fence, start)) {
+        result = 0;
+    } else {
+        candidates = sb_calloc(float, MAX_CANDIDATES(fence));
+        if (candidates == 0) {
+            return SB_ENOMEM; /* LCOV_EXCL_LINE */
+        }
+
+        retval = sb_trajectory_player_init(&player, trajectory);
+        if (retval) {
+            sb_free(candidates); /* LCOV_EXCL_LINE */
+            return retval; /* LCOV_EXCL_LINE */
+        }
+
+        while (retval == SB_SUCCESS && isinf(result) && sb_trajectory_player_has_more_segments(&player)) {
+            retval = sb_i_geofence_check_segment(
+                fence, sb_trajectory_player_get_current_segment(&player), candidates, &result);
+            if (retval == SB_SUCCESS) {
+                retval = sb_trajectory_player_build_next_segment(&player);
+            }
+        }
+
+        sb_trajectory_player_destroy(&player);
+        sb_free(candidates);
+
+        SB_CHECK(retval);
+    }
+
+    if (violation_time_sec) {
+        *violation_time_sec = result;
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_geofence_check_range(void* context, size_t start, size_t end)
+{
+    sb_i_geofence_job_t* job = (sb_i_geofence_job_t*)context;
+
+    for (; start < end; start++) {
+        SB_CHECK(sb_geofence_check_trajectory(
+            job->fence, &job->trajectories[start], &job->violation_times_sec[start]));
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * @brief Checks multiple trajectories against the same geofence at once.
+ *
+ * This function calls \ref sb_geofence_check_trajectory() for each trajectory,
+ * distributing the trajectories among multiple threads.
+ *
+ * @param fence  the geofence
+ * @param trajectories  the trajectories to check
+ * @param num_trajectories  the number of trajectories
+ * @param violation_times_sec  the time when each trajectory first leaves the
+ *        geofence is returned here; infinity for trajectories that stay
+ *        within the geofence. Must have room for \p num_trajectories items.
+ * @param num_threads  the number of threads to use; zero means one thread
+ *        per CPU core. Has no effect if the library was compiled without
+ *        thread support.
+ * @return the first error code returned for one of the trajectories, or
+ *         \c SB_SUCCESS if all of them were checked successfully
+ */
+sb_error_t sb_geofence_check_trajectories_parallel(
+    const sb_geofence_t* fence, const sb_trajectory_t* trajectories,
+    size_t num_trajectories, float* violation_times_sec, size_t num_threads)
+{
+    sb_i_geofence_job_t job;
+
+    job.fence = fence;
+    job.trajectories = trajectories;
+    job.violation_times_sec = violation_times_sec;
+
+    return sb_i_parallel_for(num_trajectories, num_threads, sb_i_geofence_check_range, &job);
+}
+
+/* ************************************************************************** */
+
+static sb_bool_t sb_i_geofence_contains_xy(const sb_geofence_t* fence, float x, float y)
+{
+    const sb_vector2_t* v = fence->vertices;
+    size_t i, j;
+    sb_bool_t inside = 0;
+
+    if (
+        x < fence->bounding_box.x.min || x > fence->bounding_box.x.max || y < fence->bounding_box.y.min || y > fence->bounding_box.y.max) {
+        return 0;
+    }
+
+    /* Even-odd rule */
+    for (i = 0, j = fence->num_vertices - 1; i < fence->num_vertices; j = i++) {
+        if ((v[i].y > y) != (v[j].y > y) && x < (v[j].x - v[i].x) * (y - v[i].y) / (v[j].y - v[i].y) + v[i].x) {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+static sb_bool_t sb_i_edge_intersects_box(
+    sb_vector2_t a, sb_vector2_t b, const sb_interval_t* x, const sb_interval_t* y)
+{
+    float nx, ny, c, d;
+    sb_bool_t has_positive = 0, has_negative = 0;
+    float corners_x[2] = { x->min, x->max };
+    float corners_y[2] = { y->min, y->max };
+    int i;
+
+    /* The bounding box of the edge must overlap with the box */
+    if (fmaxf(a.x, b.x) < x->min || fminf(a.x, b.x) > x->max || fmaxf(a.y, b.y) < y->min || fminf(a.y, b.y) > y->max) {
+        return 0;
+    }
+
+    /* The line of the edge must not have all corners of the box on the same
+     * side. Corners on the line count as being on both sides. */
+    nx = a.y - b.y;
+    ny = b.x - a.x;
+    c = nx * a.x + ny * a.y;
+    for (i = 0; i < 4; i++) {
+        d = nx * corners_x[i & 1] + ny * corners_y[i >> 1] - c;
+        has_positive |= d >= 0;
+        has_negative |= d <= 0;
+    }
+
+    return has_positive && has_negative;
+}
+
+/**
+ * Adds the roots of the given polynomial in the open interval (0; 1) to the
+ * list of candidates.
+ */
+static sb_error_t sb_i_add_crossings(const sb_poly_t* poly, float rhs, float* candidates, size_t* num_candidates)
+{
+    float roots[SB_MAX_POLY_COEFFS];
+    uint8_t i, num_roots;
+
+    SB_CHECK(sb_poly_solve(poly, rhs, roots, &num_roots));
+
+    for (i = 0; i < num_roots; i++) {
+        if (roots[i] > 0 && roots[i] < 1) {
+            candidates[(*num_candidates)++] = roots[i];
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_bool_t sb_i_geofence_contains_segment_point(
+    const sb_geofence_t* fence, const sb_poly_4d_t* poly, float u)
+{
+    return sb_geofence_contains(fence, sb_poly_4d_eval(poly, u));
+}
+
+static sb_error_t sb_i_geofence_check_segment(
+    const sb_geofence_t* fence, const sb_trajectory_segment_t* segment,
+    float* candidates, float* violation_time_sec)
+{
+    const sb_poly_4d_t* poly = &segment->poly;
+    const sb_bounding_box_t* box = &fence->bounding_box;
+    sb_interval_t x, y, z;
+    sb_vector2_t a, b;
+    sb_poly_t crossing;
+    sb_bool_t straddles_edge = 0, straddles_altitude;
+    size_t i, num_candidates = 0;
+    uint8_t j;
+    float u, next_u;
+
+    sb_poly_get_extrema_bounds(&poly->x, &x);
+    sb_poly_get_extrema_bounds(&poly->y, &y);
+    sb_poly_get_extrema_bounds(&poly->z, &z);
+
+    /* Reject the entire segment if its box is completely outside the box of
+     * the geofence */
+    if (
+        x.max < box->x.min || x.min > box->x.max || y.max < box->y.min || y.min > box->y.max || z.max < box->z.min || z.min > box->z.max) {
+        *violation_time_sec = segment->start_time_sec;
+        return SB_SUCCESS;
+    }
+
+    candidates[num_candidates++] = 0;
+
+    straddles_altitude = z.min < box->z.min || z.max > box->z.max;
+    if (straddles_altitude) {
+        if (z.min < box->z.min) {
+            SB_CHECK(sb_i_add_crossings(&poly->z, box->z.min, candidates, &num_candidates));
+        }
+        if (z.max > box->z.max) {
+            SB_CHECK(sb_i_add_crossings(&poly->z, box->z.max, candidates, &num_candidates));
+        }
+    }
+
+    for (i = 0; i < fence->num_vertices; i++) {
+        a = fence->vertices[i];
+        b = fence->vertices[i + 1 < fence->num_vertices ? i + 1 : 0];
+
+        if (!sb_i_edge_intersects_box(a, b, &x, &y)) {
+            continue;
+        }
+
+        /* The segment crosses the line of the edge where the dot product of
+         * the position and the normal of the edge is constant */
+        straddles_edge = 1;
+        crossing.num_coeffs = poly->x.num_coeffs > poly->y.num_coeffs ? poly->x.num_coeffs : poly->y.num_coeffs;
+        for (j = 0; j < crossing.num_coeffs; j++) {
+            crossing.coeffs[j] = (a.y - b.y) * (j < poly->x.num_coeffs ? poly->x.coeffs[j] : 0) + (b.x - a.x) * (j < poly->y.num_coeffs ? poly->y.coeffs[j] : 0);
+        }
+
+        SB_CHECK(sb_i_add_crossings(&crossing, (a.y - b.y) * a.x + (b.x - a.x) * a.y, candidates, &num_candidates));
+    }
+
+    if (!straddles_edge && !straddles_altitude) {
+        /* No edge touches the box of the segment and the altitude is within
+         * limits so the entire segment is either inside or outside */
+        if (!sb_i_geofence_contains_segment_point(fence, poly, 0)) {
+            *violation_time_sec = segment->start_time_sec;
+        }
+        return SB_SUCCESS;
+    }
+
+    /* The containment status of the segment may change only at the
+     * candidates so we need to test the start of the segment and one point
+     * between each pair of consecutive candidates */
+    qsort(candidates, num_candidates, sizeof(float), sb_i_compare_floats);
+
+    if (!sb_i_geofence_contains_segment_point(fence, poly, 0)) {
+        *violation_time_sec = segment->start_time_sec;
+        return SB_SUCCESS;
+    }
+
+    for (i = 0; i < num_candidates; i++) {
+        u = candidates[i];
+        next_u = i + 1 < num_candidates ? candidates[i + 1] : 1;
+        if (!sb_i_geofence_contains_segment_point(fence, poly, (u + next_u) / 2)) {
+            *violation_time_sec = segment->start_time_sec + u * segment->duration_sec;
+            return SB_SUCCESS;
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
+static int sb_i_compare_floats(const void* a, const void* b)
+{
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
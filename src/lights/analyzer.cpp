@@ -0,0 +1,442 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <skybrush/lights.h>
+#include <skybrush/memory.h>
+
+#include "decoded_program.h"
+#include "light_player_config.h"
+
+/**
+ * Maximum number of instructions that the analysis executes before it gives
+ * up. Loops without clock manipulation inside them are not unrolled so this
+ * limit is hit only for pathological programs.
+ */
+#define MAX_ANALYSIS_STEPS (1UL << 24)
+
+/**
+ * Upper bound of the timestamps tracked during the analysis; durations are
+ * saturated at this value.
+ */
+#define MAX_ANALYSIS_TIME ((uint64_t)UINT32_MAX)
+
+/**
+ * \brief A loop that is currently being executed during the analysis.
+ */
+typedef struct {
+    /** Index of the first instruction of the loop body */
+    size_t start;
+
+    /** Number of iterations left plus one; zero for infinite loops */
+    uint8_t iterationsLeftPlusOne;
+
+    /** Timestamp when the current iteration of the loop body started */
+    uint64_t bodyStartTime;
+
+    /**
+     * Whether the loop body is free of commands that manipulate the clock.
+     * Iterations of such loops take the same amount of time and leave the
+     * lights in the same state so they do not need to be unrolled.
+     */
+    bool pure;
+} sb_i_loop_frame_t;
+
+static uint8_t sb_i_find_max_loop_depth(const DecodedInstruction* insns, size_t num_insns);
+
+/**
+ * Saturating addition of timestamps.
+ */
+static uint64_t sb_i_add_time(uint64_t now, uint64_t duration)
+{
+    now += duration;
+    return now > MAX_ANALYSIS_TIME ? MAX_ANALYSIS_TIME : now;
+}
+
+/**
+ * Appends a change of the pyro channels to the given event list. Changes that
+ * happen at the same timestamp are merged into a single event.
+ */
+static sb_error_t sb_i_light_pyro_events_add(
+    sb_light_pyro_events_t* events, uint64_t time, uint8_t before, uint8_t after)
+{
+    sb_light_pyro_event_t* event;
+    size_t new_capacity;
+
+    if (events->num_events > 0) {
+        event = &events->events[events->num_events - 1];
+        if (event->time_msec == time) {
+            event->channels_after = after;
+            if (event->channels_before == after) {
+                events->num_events--;
+            }
+            return SB_SUCCESS;
+        }
+    }
+
+    if (events->num_events == events->capacity) {
+        new_capacity = events->capacity > 0 ? events->capacity * 2 : 16;
+        event = sb_realloc(events->events, sb_light_pyro_event_t, new_capacity);
+        if (event == 0) {
+            return SB_ENOMEM; /* LCOV_EXCL_LINE */
+        }
+        events->events = event;
+        events->capacity = new_capacity;
+    }
+
+    event = &events->events[events->num_events++];
+    event->time_msec = (uint32_t)time;
+    event->channels_before = before;
+    event->channels_after = after;
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Walks a light program from its start without executing it in real time,
+ * tracking the elapsed time, the final state of the lights and, optionally,
+ * every change of the pyro channels.
+ *
+ * Loops that contain no clock manipulation are not unrolled, unless they
+ * change the pyro channels and the caller asked for the pyro events.
+ *
+ * \param program  the light program to walk
+ * \param result   the results of the analysis are returned here
+ * \param events   when not null, the changes of the pyro channels are
+ *        appended here
+ */
+static sb_error_t sb_i_light_program_walk(
+    const sb_light_program_t* program, sb_light_program_analysis_t* result,
+    sb_light_pyro_events_t* events)
+{
+    DecodedProgram decoded;
+    const DecodedInstruction* insns;
+    const DecodedInstruction* insn;
+    sb_i_loop_frame_t frames[CONFIG_MAX_LOOP_DEPTH];
+    sb_i_loop_frame_t* frame;
+    uint8_t* visited_jump_targets;
+    size_t i, pc, num_insns, depth, target;
+    uint64_t now, origin;
+    unsigned long steps;
+    uint8_t pyro_channels;
+    bool done;
+    sb_error_t retval = SB_SUCCESS;
+
+    memset(result, 0, sizeof(sb_light_program_analysis_t));
+    result->final_color = SB_COLOR_BLACK;
+
+    if (!decoded.decode(program->buffer, program->buffer_length)) {
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    insns = decoded.instructions();
+    num_insns = decoded.size();
+    if (num_insns == 0) {
+        return SB_SUCCESS;
+    }
+
+    /* Jumps clear the loop stack so the flow of the program after a jump
+     * depends only on the jump target. Landing on the same target twice
+     * means that the program repeats itself forever. */
+    visited_jump_targets = sb_calloc(uint8_t, num_insns);
+    if (visited_jump_targets == 0) {
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    result->max_loop_depth = sb_i_find_max_loop_depth(insns, num_insns);
+    if (result->max_loop_depth > CONFIG_MAX_LOOP_DEPTH) {
+        result->flags |= SB_LIGHT_PROGRAM_LOOPS_TOO_DEEP;
+    }
+
+    pc = depth = 0;
+    now = origin = 0;
+    steps = 0;
+    done = false;
+
+    while (!done && pc < num_insns) {
+        if (++steps > MAX_ANALYSIS_STEPS) {
+            result->flags |= SB_LIGHT_PROGRAM_TOO_COMPLEX;
+            break;
+        }
+
+        insn = &insns[pc++];
+
+        switch (insn->command) {
+        case CMD_END:
+            done = true;
+            break;
+
+        case CMD_NOP:
+            break;
+
+        case CMD_SLEEP:
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_WAIT_UNTIL:
+            if (origin + insn->value > now) {
+                now = sb_i_add_time(origin, insn->value);
+            }
+            for (i = 0; i < depth; i++) {
+                frames[i].pure = false;
+            }
+            break;
+
+        case CMD_SET_COLOR:
+        case CMD_FADE_TO_COLOR:
+            result->final_color.red = insn->args[0];
+            result->final_color.green = insn->args[1];
+            result->final_color.blue = insn->args[2];
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_SET_GRAY:
+        case CMD_FADE_TO_GRAY:
+            result->final_color.red = result->final_color.green = result->final_color.blue = insn->args[0];
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_SET_BLACK:
+        case CMD_FADE_TO_BLACK:
+            result->final_color = SB_COLOR_BLACK;
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_SET_WHITE:
+        case CMD_FADE_TO_WHITE:
+            result->final_color = SB_COLOR_WHITE;
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_SET_COLOR_FROM_CHANNELS:
+        case CMD_FADE_TO_COLOR_FROM_CHANNELS:
+            result->flags |= SB_LIGHT_PROGRAM_USES_CHANNELS;
+            result->final_color = SB_COLOR_BLACK;
+            now = sb_i_add_time(now, insn->value);
+            break;
+
+        case CMD_LOOP_BEGIN:
+            /* The executor silently ignores loops that do not fit on its
+             * loop stack; we do the same */
+            if (depth < CONFIG_MAX_LOOP_DEPTH) {
+                frame = &frames[depth++];
+                frame->start = pc;
+                frame->iterationsLeftPlusOne = insn->args[0];
+                frame->bodyStartTime = now;
+                frame->pure = true;
+            }
+            break;
+
+        case CMD_LOOP_END:
+            if (depth == 0) {
+                break;
+            }
+
+            frame = &frames[depth - 1];
+            if (frame->iterationsLeftPlusOne == 0) {
+                /* Infinite loop */
+                result->flags |= SB_LIGHT_PROGRAM_INFINITE;
+                now = MAX_ANALYSIS_TIME;
+                done = true;
+            } else if (frame->iterationsLeftPlusOne > 1 && !frame->pure) {
+                /* Unroll the next iteration */
+                frame->iterationsLeftPlusOne--;
+                pc = frame->start;
+            } else {
+                /* Last iteration, or all the remaining iterations are the
+                 * same as the one that we have just finished. The state of
+                 * the lights and the pyro channels after the remaining
+                 * iterations is the same as the current state because
+                 * every command sets them to absolute values. */
+                if (frame->iterationsLeftPlusOne > 1) {
+                    now = sb_i_add_time(now, (now - frame->bodyStartTime) * (frame->iterationsLeftPlusOne - 1));
+                }
+                depth--;
+                if (depth > 0 && !frame->pure) {
+                    frames[depth - 1].pure = false;
+                }
+            }
+            break;
+
+        case CMD_RESET_CLOCK:
+            origin = now;
+            for (i = 0; i < depth; i++) {
+                frames[i].pure = false;
+            }
+            break;
+
+        case CMD_JUMP:
+            target = insn->value;
+            if (target == DECODED_INSTRUCTION_INVALID_ADDRESS) {
+                result->flags |= SB_LIGHT_PROGRAM_INVALID;
+                done = true;
+            } else if (target < num_insns && visited_jump_targets[target]) {
+                result->flags |= SB_LIGHT_PROGRAM_INFINITE;
+                now = MAX_ANALYSIS_TIME;
+                done = true;
+            } else {
+                if (target < num_insns) {
+                    visited_jump_targets[target] = 1;
+                }
+                pc = target;
+                depth = 0;
+            }
+            break;
+
+        case CMD_TRIGGERED_JUMP:
+            result->flags |= SB_LIGHT_PROGRAM_HAS_TRIGGERS;
+            if ((insn->args[0] & 0x30) && insn->value == DECODED_INSTRUCTION_INVALID_ADDRESS) {
+                result->flags |= SB_LIGHT_PROGRAM_INVALID;
+                done = true;
+            }
+            break;
+
+        case CMD_SET_PYRO:
+        case CMD_SET_PYRO_ALL:
+            pyro_channels = result->final_pyro_channels;
+            if (insn->command == CMD_SET_PYRO_ALL) {
+                result->final_pyro_channels = insn->args[0] & 127;
+            } else if (insn->args[0] & 128) {
+                result->final_pyro_channels |= (insn->args[0] & 127);
+            } else {
+                result->final_pyro_channels &= ~(insn->args[0] | 128);
+            }
+
+            if (events && pyro_channels != result->final_pyro_channels) {
+                /* Every iteration of the enclosing loops produces its own
+                 * events so they must be unrolled */
+                for (i = 0; i < depth; i++) {
+                    frames[i].pure = false;
+                }
+
+                retval = sb_i_light_pyro_events_add(events, now, pyro_channels, result->final_pyro_channels);
+                if (retval != SB_SUCCESS) {
+                    done = true; /* LCOV_EXCL_LINE */
+                }
+            }
+            break;
+
+        default:
+            result->flags |= SB_LIGHT_PROGRAM_INVALID;
+            done = true;
+        }
+    }
+
+    sb_free(visited_jump_targets);
+
+    result->duration_msec = (uint32_t)now;
+
+    return retval;
+}
+
+sb_error_t sb_light_program_analyze(
+    const sb_light_program_t* program, sb_light_program_analysis_t* result)
+{
+    return sb_i_light_program_walk(program, result, 0);
+}
+
+sb_error_t sb_light_pyro_events_init_from_program(
+    sb_light_pyro_events_t* events, const sb_light_program_t* program)
+{
+    sb_light_program_analysis_t analysis;
+    sb_error_t retval;
+
+    memset(events, 0, sizeof(sb_light_pyro_events_t));
+
+    retval = sb_i_light_program_walk(program, &analysis, events);
+    if (retval != SB_SUCCESS) {
+        sb_light_pyro_events_destroy(events); /* LCOV_EXCL_LINE */
+        return retval; /* LCOV_EXCL_LINE */
+    }
+
+    events->flags = analysis.flags;
+
+    return SB_SUCCESS;
+}
+
+void sb_light_pyro_events_destroy(sb_light_pyro_events_t* events)
+{
+    sb_free_unless_null(events->events);
+    memset(events, 0, sizeof(sb_light_pyro_events_t));
+}
+
+/**
+ * Returns the index of the first event that happens strictly after the given
+ * timestamp, or the number of events if there is no such event.
+ */
+static size_t sb_i_light_pyro_events_upper_bound(
+    const sb_light_pyro_events_t* events, unsigned long timestamp)
+{
+    size_t lo = 0, hi = events->num_events, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (events->events[mid].time_msec <= timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+uint8_t sb_light_pyro_events_get_channels_at(
+    const sb_light_pyro_events_t* events, unsigned long timestamp)
+{
+    size_t index = sb_i_light_pyro_events_upper_bound(events, timestamp);
+    return index > 0 ? events->events[index - 1].channels_after : 0;
+}
+
+const sb_light_pyro_event_t* sb_light_pyro_events_get_next(
+    const sb_light_pyro_events_t* events, unsigned long timestamp)
+{
+    size_t index = sb_i_light_pyro_events_upper_bound(events, timestamp);
+    return index < events->num_events ? &events->events[index] : 0;
+}
+
+/* ************************************************************************** */
+
+/**
+ * Finds the maximum nesting depth of the loops in a decoded light program,
+ * based on the layout of the loop instructions in the program.
+ */
+static uint8_t sb_i_find_max_loop_depth(const DecodedInstruction* insns, size_t num_insns)
+{
+    uint8_t depth = 0, max_depth = 0;
+    size_t i;
+
+    for (i = 0; i < num_insns; i++) {
+        if (insns[i].command == CMD_LOOP_BEGIN) {
+            if (depth < UINT8_MAX) {
+                depth++;
+            }
+            if (depth > max_depth) {
+                max_depth = depth;
+            }
+        } else if (insns[i].command == CMD_LOOP_END) {
+            if (depth > 0) {
+                depth--;
+            }
+        }
+    }
+
+    return max_depth;
+}
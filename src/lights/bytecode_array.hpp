@@ -17,12 +17,19 @@
  * this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifndef SKYBRUSH_LIGHTS_BYTECODE_ARRAY_HPP
+#define SKYBRUSH_LIGHTS_BYTECODE_ARRAY_HPP
+
 #include "bytecode_store.h"
 
 /**
  * \brief Bytecode store implementation that works from a regular C array.
+ *
+ * The class is \c final so calls made through an \c ArrayBytecodeStore
+ * pointer (e.g., from a \c BasicCommandExecutor<ArrayBytecodeStore>) are
+ * resolved at compile time and can be inlined.
  */
-class ArrayBytecodeStore : public BytecodeStore {
+class ArrayBytecodeStore final : public BytecodeStore {
 
 private:
     /**
@@ -115,3 +122,5 @@ private:
         return result;
     }
 };
+
+#endif
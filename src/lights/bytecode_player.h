@@ -26,9 +26,20 @@
 #ifndef SKYBRUSH_LIGHTS_PLAYER_H
 #define SKYBRUSH_LIGHTS_PLAYER_H
 
+#include "../perf_counters.h"
 #include "executor.h"
 #include <skybrush/colors.h>
 
+/**
+ * \brief Plain-old-data representation of the state of a bytecode player.
+ */
+typedef struct
+{
+    CommandExecutorState executor; /**< State of the executor of the player */
+    unsigned long currentTimestamp; /**< Timestamp of the playhead */
+    unsigned long nextTimestamp; /**< Timestamp of the next bytecode command */
+} BytecodePlayerState;
+
 /**
  * LED bytecode player that can be used to jump into any arbitrary time
  * instant and retrieve the color of the LED strip at that time instant.
@@ -37,8 +48,12 @@
  * occasional jumps back in time to an earlier point. Traversing the
  * timeline backwards in a continuous manner is inefficient at the moment;
  * this can be changed later if we need it.
+ *
+ * \tparam  Store  the type of the bytecode store that the player reads from;
+ *          see \ref BasicCommandExecutor for more details.
  */
-class BytecodePlayer {
+template <typename Store>
+class BasicBytecodePlayer {
 
 private:
     /**
@@ -49,7 +64,7 @@ private:
      * when the player needs to determine the color of the LED strip at an
      * earlier time instant.
      */
-    CommandExecutor m_executor;
+    BasicCommandExecutor<Store> m_executor;
 
     /**
      * The current timestamp where the playhead stands. This is also the
@@ -66,7 +81,7 @@ public:
     /**
      * \brief Constructor.
      */
-    explicit BytecodePlayer()
+    explicit BasicBytecodePlayer()
         : m_executor()
         , m_currentTimestamp(0)
         , m_nextTimestamp(0)
@@ -78,7 +93,7 @@ public:
     /**
      * \brief Returns the bytecode store that the player will use.
      */
-    BytecodeStore* bytecodeStore() const
+    Store* bytecodeStore() const
     {
         return m_executor.bytecodeStore();
     }
@@ -110,6 +125,20 @@ public:
         return m_executor.currentPyroChannels();
     }
 
+    /**
+     * \brief Restores a state saved earlier with \c saveState() in constant
+     *        time, without seeking from the origin of the time axis.
+     *
+     * The player must already be attached to a bytecode store that contains
+     * the same bytecode that the state was saved from.
+     */
+    void restoreState(const BytecodePlayerState& state)
+    {
+        m_executor.restoreState(state.executor);
+        m_currentTimestamp = state.currentTimestamp;
+        m_nextTimestamp = state.nextTimestamp;
+    }
+
     /**
      * Rewinds the playhead to the origin of the time axis (T=0).
      */
@@ -129,7 +158,10 @@ public:
      */
     bool seek(unsigned long target, unsigned long* nextTimestamp = 0)
     {
+        SB_PERF_COUNT(m_executor.perfCounters(), seeks);
+
         if (target < m_currentTimestamp) {
+            SB_PERF_COUNT(m_executor.perfCounters(), rewinds);
             m_executor.rewind();
             m_currentTimestamp = 0;
             m_nextTimestamp = 0;
@@ -161,14 +193,50 @@ public:
         return m_executor.ended();
     }
 
+    /**
+     * \brief Saves the current state of the player.
+     *
+     * \return \c true if the state was saved, \c false if the executor of the
+     *         player is in a state that cannot be saved
+     */
+    bool saveState(BytecodePlayerState& state) const
+    {
+        if (!m_executor.saveState(state.executor)) {
+            return false;
+        }
+
+        state.currentTimestamp = m_currentTimestamp;
+        state.nextTimestamp = m_nextTimestamp;
+
+        return true;
+    }
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    /**
+     * \brief Returns the performance counters of the player.
+     */
+    sb_perf_counters_t& perfCounters()
+    {
+        return m_executor.perfCounters();
+    }
+#endif
+
     /**
      * \brief Sets the bytecode store that the player will use.
      */
-    void setBytecodeStore(BytecodeStore* pBytecodeStore)
+    void setBytecodeStore(Store* pBytecodeStore)
     {
         m_executor.setBytecodeStore(pBytecodeStore);
     }
 
+    /**
+     * \brief Sets the error handler that the executor will report errors to.
+     */
+    void setErrorHandler(ErrorHandler* handler)
+    {
+        m_executor.setErrorHandler(handler);
+    }
+
     /**
      * \brief Sets the signal source that the executor will use.
      */
@@ -186,4 +254,23 @@ public:
     }
 };
 
+/**
+ * Bytecode player that accepts any bytecode store through virtual calls.
+ */
+typedef BasicBytecodePlayer<BytecodeStore> BytecodePlayer;
+
+class ArrayBytecodeStore;
+
+/**
+ * Bytecode player that reads directly from an \c ArrayBytecodeStore without
+ * virtual calls.
+ */
+typedef BasicBytecodePlayer<ArrayBytecodeStore> ArrayBytecodePlayer;
+
+/**
+ * Bytecode player that plays a pre-decoded light program from a
+ * \c DecodedBytecodeStore .
+ */
+typedef BasicBytecodePlayer<DecodedBytecodeStore> DecodedBytecodePlayer;
+
 #endif
@@ -106,6 +106,38 @@ sb_rgb_color_t sb_rgb_color_linear_interpolation(
     return result;
 }
 
+static uint8_t sb_i_interpolate_component_fixed(uint8_t first, uint8_t second, int32_t ratio)
+{
+    int32_t value = first * SB_RGB_COLOR_FIXED_RATIO_ONE + (second - first) * ratio;
+    return value <= 0 ? 0 : clamp(value / SB_RGB_COLOR_FIXED_RATIO_ONE, 0, 255);
+}
+
+/**
+ * \brief Linearly interpolates between two colors using fixed-point arithmetic only
+ *
+ * The result is the same as the one of \ref sb_rgb_color_linear_interpolation()
+ * for ratios that can be represented exactly in fixed-point form.
+ *
+ * \param  first   the first color
+ * \param  second  the second color
+ * \param  ratio   the interpolation ratio in units of 1 / \c SB_RGB_COLOR_FIXED_RATIO_ONE;
+ *                 zero means the first color, \c SB_RGB_COLOR_FIXED_RATIO_ONE
+ *                 means the second color. Values less than zero or greater
+ *                 than \c SB_RGB_COLOR_FIXED_RATIO_ONE are allowed.
+ * \return the interpolated color
+ */
+sb_rgb_color_t sb_rgb_color_linear_interpolation_fixed(
+    sb_rgb_color_t first, sb_rgb_color_t second, int32_t ratio)
+{
+    sb_rgb_color_t result;
+
+    result.red = sb_i_interpolate_component_fixed(first.red, second.red, ratio);
+    result.green = sb_i_interpolate_component_fixed(first.green, second.green, ratio);
+    result.blue = sb_i_interpolate_component_fixed(first.blue, second.blue, ratio);
+
+    return result;
+}
+
 /**
  * @brief Creates an RGB color struct from its components
  *
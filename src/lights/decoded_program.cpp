@@ -0,0 +1,110 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <skybrush/memory.h>
+
+#include "bytecode_array.hpp"
+#include "decoded_program.h"
+
+/**
+ * Finds the index of the instruction that starts at the given byte offset.
+ *
+ * Returns the number of instructions if the offset points to the end of the
+ * bytecode or beyond, and \c DECODED_INSTRUCTION_INVALID_ADDRESS if the
+ * offset points into the middle of an instruction.
+ */
+static uint32_t findInstructionAtOffset(
+    const uint16_t* offsets, size_t num_instructions, uint16_t size, uint32_t offset)
+{
+    size_t lo = 0, hi = num_instructions, mid;
+
+    if (offset >= size) {
+        return num_instructions;
+    }
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (offsets[mid] < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return (lo < num_instructions && offsets[lo] == offset) ? lo : DECODED_INSTRUCTION_INVALID_ADDRESS;
+}
+
+void DecodedProgram::clear()
+{
+    sb_free(m_instructions);
+    m_size = 0;
+}
+
+bool DecodedProgram::decode(const uint8_t* data, uint16_t size)
+{
+    ArrayBytecodeStore store(data, size);
+    DecodedInstruction insn;
+    DecodedInstruction* instructions;
+    uint16_t* offsets;
+    size_t i, count = 0;
+
+    clear();
+
+    /* First pass: count the instructions */
+    while (store.tell() < size) {
+        decodeNextInstruction(store, insn);
+        count++;
+    }
+
+    if (count == 0) {
+        return true;
+    }
+
+    instructions = sb_calloc(DecodedInstruction, count);
+    offsets = sb_calloc(uint16_t, count);
+    if (instructions == 0 || offsets == 0) {
+        /* LCOV_EXCL_START */
+        sb_free(instructions);
+        sb_free(offsets);
+        return false;
+        /* LCOV_EXCL_STOP */
+    }
+
+    /* Second pass: decode the instructions and record where they start */
+    store.rewind();
+    for (i = 0; i < count; i++) {
+        offsets[i] = store.tell();
+        decodeNextInstruction(store, instructions[i]);
+    }
+
+    /* Third pass: turn byte offsets in jump targets into instruction indices */
+    for (i = 0; i < count; i++) {
+        DecodedInstruction& current = instructions[i];
+        if (current.command == CMD_JUMP || (current.command == CMD_TRIGGERED_JUMP && (current.args[0] & 0x30))) {
+            current.value = findInstructionAtOffset(offsets, count, size, current.value);
+        }
+    }
+
+    sb_free(offsets);
+
+    m_instructions = instructions;
+    m_size = count;
+
+    return true;
+}
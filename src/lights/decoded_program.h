@@ -0,0 +1,385 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file src/lights/decoded_program.h
+ * \brief Fixed-width, pre-decoded representation of light program bytecode.
+ *
+ * The bytecode of a light program consists of variable-length instructions
+ * (e.g., durations are encoded as varints). Decoding them is cheap but not
+ * free, and the bytecode player re-decodes the same instructions every time
+ * it rewinds and fast-forwards. This file provides a fixed-width instruction
+ * format, a function that decodes the next instruction from any bytecode
+ * store, a one-time pre-decoding pass that turns a whole program into an
+ * array of decoded instructions, and a store that the command executor can
+ * run from directly.
+ */
+
+#ifndef SKYBRUSH_LIGHTS_DECODED_PROGRAM_H
+#define SKYBRUSH_LIGHTS_DECODED_PROGRAM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bytecode_store.h"
+#include "commands.h"
+
+/**
+ * \def DECODED_INSTRUCTION_INVALID_ADDRESS
+ * Special jump target that marks a jump into the middle of an instruction
+ * in a pre-decoded program.
+ */
+#define DECODED_INSTRUCTION_INVALID_ADDRESS 0xFFFFFFFF
+
+/**
+ * \brief A single decoded light program instruction with a fixed width.
+ */
+typedef struct
+{
+    /**
+     * The command code of the instruction; one of the values of \c command_t
+     * or an invalid command code that was found in the bytecode.
+     */
+    uint8_t command;
+
+    /**
+     * Fixed-size byte arguments of the instruction: the color components or
+     * channel indices for color commands, the gray level for gray commands,
+     * the number of iterations for \c CMD_LOOP_BEGIN , the trigger parameters
+     * for \c CMD_TRIGGERED_JUMP and the channel mask for the pyro commands.
+     */
+    uint8_t args[3];
+
+    /**
+     * The variable-length argument of the instruction: the duration in
+     * milliseconds for commands with a duration, the deadline in milliseconds
+     * for \c CMD_WAIT_UNTIL and the jump target for \c CMD_JUMP and
+     * \c CMD_TRIGGERED_JUMP . Jump targets are byte offsets when the
+     * instruction was decoded from a bytecode store and instruction indices
+     * when it comes from a pre-decoded program.
+     */
+    uint32_t value;
+} DecodedInstruction;
+
+/**
+ * \brief Reads a varint from the given bytecode store.
+ */
+template <typename Store>
+inline uint32_t decodeVarint(Store& store)
+{
+    uint32_t result = 0;
+    uint8_t readByte;
+    uint8_t shift = 0;
+
+    do {
+        readByte = store.next();
+        if (shift < 32) {
+            result |= ((uint32_t)(readByte & 0x7F)) << shift;
+            shift += 7;
+        }
+    } while (readByte & 0x80);
+
+    return result;
+}
+
+/**
+ * \brief Decodes the next instruction from the given bytecode store and
+ *        advances the internal pointer of the store past the instruction.
+ *
+ * \param  store  the bytecode store to read from
+ * \param  insn   the decoded instruction is written here
+ */
+template <typename Store>
+void decodeNextInstruction(Store& store, DecodedInstruction& insn)
+{
+    insn.command = store.next();
+    insn.args[0] = insn.args[1] = insn.args[2] = 0;
+    insn.value = 0;
+
+    switch (insn.command) {
+    case CMD_SLEEP:
+    case CMD_SET_BLACK:
+    case CMD_SET_WHITE:
+    case CMD_FADE_TO_BLACK:
+    case CMD_FADE_TO_WHITE:
+        insn.value = decodeVarint(store) * 20;
+        break;
+
+    case CMD_WAIT_UNTIL:
+        insn.value = decodeVarint(store) * 20;
+        break;
+
+    case CMD_SET_COLOR:
+    case CMD_FADE_TO_COLOR:
+    case CMD_SET_COLOR_FROM_CHANNELS:
+    case CMD_FADE_TO_COLOR_FROM_CHANNELS:
+        insn.args[0] = store.next();
+        insn.args[1] = store.next();
+        insn.args[2] = store.next();
+        insn.value = decodeVarint(store) * 20;
+        break;
+
+    case CMD_SET_GRAY:
+    case CMD_FADE_TO_GRAY:
+        insn.args[0] = store.next();
+        insn.value = decodeVarint(store) * 20;
+        break;
+
+    case CMD_LOOP_BEGIN:
+    case CMD_SET_PYRO:
+    case CMD_SET_PYRO_ALL:
+        insn.args[0] = store.next();
+        break;
+
+    case CMD_JUMP:
+        insn.value = decodeVarint(store);
+        break;
+
+    case CMD_TRIGGERED_JUMP:
+        insn.args[0] = store.next();
+        /* Address follows only if the R or the F bit is set */
+        if (insn.args[0] & 0x30) {
+            insn.value = decodeVarint(store);
+        }
+        break;
+
+    default:
+        /* Commands without arguments and invalid command codes */
+        break;
+    }
+}
+
+/**
+ * \brief Light program that was pre-decoded into an array of fixed-width
+ *        instructions.
+ *
+ * Jump targets of the instructions are resolved into instruction indices.
+ * The body of a loop starts at the instruction right after the corresponding
+ * \c CMD_LOOP_BEGIN instruction so loops need no further resolution.
+ */
+class DecodedProgram {
+private:
+    /**
+     * The array of decoded instructions, owned by this object.
+     */
+    DecodedInstruction* m_instructions;
+
+    /**
+     * The number of decoded instructions.
+     */
+    size_t m_size;
+
+public:
+    /**
+     * Constructor. Creates an empty program.
+     */
+    explicit DecodedProgram()
+        : m_instructions(0)
+        , m_size(0)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    ~DecodedProgram()
+    {
+        clear();
+    }
+
+    /**
+     * \brief Clears the program and releases the memory it owns.
+     */
+    void clear();
+
+    /**
+     * \brief Decodes the given bytecode, replacing the current contents of
+     *        the program.
+     *
+     * \param  data  the bytecode to decode
+     * \param  size  the length of the bytecode, in bytes
+     * \return \c true if the bytecode was decoded, \c false if there was not
+     *         enough memory
+     */
+    bool decode(const uint8_t* data, uint16_t size);
+
+    /**
+     * \brief Returns a pointer to the decoded instructions.
+     */
+    const DecodedInstruction* instructions() const
+    {
+        return m_instructions;
+    }
+
+    /**
+     * \brief Returns the number of decoded instructions.
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    /**
+     * Copy constructor. Intentionally deleted because the object owns memory.
+     */
+    DecodedProgram(DecodedProgram const&) = delete;
+
+    /**
+     * Assignment operator. Intentionally deleted because the object owns memory.
+     */
+    void operator=(DecodedProgram const&) = delete;
+};
+
+/**
+ * \brief Bytecode store that serves instructions from a pre-decoded program.
+ *
+ * The store provides the same interface as \c BytecodeStore except that it
+ * returns whole decoded instructions instead of individual bytes, and
+ * locations are instruction indices instead of byte offsets. It is not a
+ * subclass of \c BytecodeStore ; it can only be used with a
+ * \c BasicCommandExecutor<DecodedBytecodeStore> .
+ */
+class DecodedBytecodeStore {
+private:
+    /**
+     * The decoded instructions; not owned by the store.
+     */
+    const DecodedInstruction* m_instructions;
+
+    /**
+     * The number of decoded instructions.
+     */
+    size_t m_size;
+
+    /**
+     * The index of the next instruction to be returned from the store.
+     */
+    size_t m_nextIndex;
+
+    /**
+     * Internal counter that is increased whenever \c suspend() is called and
+     * decreased whenever \c resume() is called. The store should only
+     * return \c NOP instructions when it is suspended.
+     */
+    signed short int m_suspendCounter;
+
+public:
+    /**
+     * \brief Constructs a new store that serves the instructions of the given
+     *        pre-decoded program.
+     */
+    explicit DecodedBytecodeStore(const DecodedProgram& program)
+        : m_instructions(program.instructions())
+        , m_size(program.size())
+        , m_nextIndex(0)
+        , m_suspendCounter(0)
+    {
+    }
+
+    /**
+     * \brief Returns whether the store contains no instructions at all.
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * \brief Returns the next instruction from the store and advances the
+     *        internal pointer.
+     *
+     * Returns \c CMD_END past the end of the program and \c CMD_NOP when the
+     * store is suspended.
+     */
+    void nextInstruction(DecodedInstruction& insn)
+    {
+        if (suspended()) {
+            insn.command = CMD_NOP;
+        } else if (m_nextIndex < m_size) {
+            insn = m_instructions[m_nextIndex];
+            m_nextIndex++;
+        } else {
+            insn.command = CMD_END;
+        }
+    }
+
+    /**
+     * \brief Resumes the store after a previous call to \c suspend().
+     */
+    void resume()
+    {
+        m_suspendCounter--;
+    }
+
+    /**
+     * \brief Rewinds the store to the first instruction.
+     */
+    void rewind()
+    {
+        m_nextIndex = 0;
+    }
+
+    /**
+     * \brief Moves the internal pointer to the instruction with the given index.
+     */
+    void seek(bytecode_location_t location)
+    {
+        assert(location >= 0);
+        m_nextIndex = location;
+    }
+
+    /**
+     * \brief Temporarily suspends the store so it will simply return
+     *        \c NOP until it is resumed.
+     */
+    void suspend()
+    {
+        m_suspendCounter++;
+    }
+
+    /**
+     * \brief Returns whether the store is currently suspended.
+     */
+    bool suspended() const
+    {
+        return m_suspendCounter > 0;
+    }
+
+    /**
+     * \brief Returns the index of the next instruction.
+     */
+    bytecode_location_t tell() const
+    {
+        return m_nextIndex;
+    }
+};
+
+/**
+ * \brief Fetches the next instruction from a pre-decoded program.
+ *
+ * Overload of the generic \c decodeNextInstruction() that skips the decoding
+ * step altogether.
+ */
+inline void decodeNextInstruction(DecodedBytecodeStore& store, DecodedInstruction& insn)
+{
+    store.nextInstruction(insn);
+}
+
+#endif
@@ -0,0 +1,397 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* This file was generated by etc/scripts/generate_easing_lut.cpp; do not edit. */
+
+#include "transition.h"
+
+const int16_t EASING_LUTS[NUM_EASING_FUNCTIONS][EASING_LUT_SIZE] = {
+    /* EASING_LINEAR */
+    {
+        0, 128, 256, 384, 512, 640, 768, 896, 1024, 1152, 1280, 1408, 1536,
+        1664, 1792, 1920, 2048, 2176, 2304, 2432, 2560, 2688, 2816, 2944, 3072, 3200,
+        3328, 3456, 3584, 3712, 3840, 3968, 4096, 4224, 4352, 4480, 4608, 4736, 4864,
+        4992, 5120, 5248, 5376, 5504, 5632, 5760, 5888, 6016, 6144, 6272, 6400, 6528,
+        6656, 6784, 6912, 7040, 7168, 7296, 7424, 7552, 7680, 7808, 7936, 8064, 8192,
+        8320, 8448, 8576, 8704, 8832, 8960, 9088, 9216, 9344, 9472, 9600, 9728, 9856,
+        9984, 10112, 10240, 10368, 10496, 10624, 10752, 10880, 11008, 11136, 11264, 11392, 11520,
+        11648, 11776, 11904, 12032, 12160, 12288, 12416, 12544, 12672, 12800, 12928, 13056, 13184,
+        13312, 13440, 13568, 13696, 13824, 13952, 14080, 14208, 14336, 14464, 14592, 14720, 14848,
+        14976, 15104, 15232, 15360, 15488, 15616, 15744, 15872, 16000, 16128, 16256, 16384 },
+    /* EASING_IN_SINE */
+    {
+        0, 1, 5, 11, 20, 31, 44, 60, 79, 100, 123, 149, 177,
+        208, 241, 277, 315, 355, 398, 443, 491, 541, 593, 648, 705, 765,
+        827, 891, 958, 1027, 1098, 1171, 1247, 1325, 1406, 1488, 1573, 1660, 1749,
+        1841, 1935, 2030, 2128, 2229, 2331, 2435, 2542, 2651, 2761, 2874, 2989, 3105,
+        3224, 3345, 3468, 3592, 3719, 3847, 3978, 4110, 4244, 4380, 4518, 4657, 4799,
+        4942, 5087, 5233, 5381, 5531, 5682, 5835, 5990, 6146, 6304, 6463, 6624, 6786,
+        6950, 7115, 7282, 7449, 7619, 7789, 7961, 8134, 8308, 8484, 8661, 8839, 9018,
+        9198, 9379, 9561, 9745, 9929, 10114, 10300, 10487, 10676, 10864, 11054, 11245, 11436,
+        11628, 11821, 12014, 12208, 12403, 12598, 12794, 12991, 13188, 13385, 13583, 13781, 13980,
+        14179, 14378, 14578, 14778, 14978, 15179, 15379, 15580, 15781, 15982, 16183, 16384 },
+    /* EASING_OUT_SINE */
+    {
+        0, 201, 402, 603, 804, 1005, 1205, 1406, 1606, 1806, 2006, 2205, 2404,
+        2603, 2801, 2999, 3196, 3393, 3590, 3786, 3981, 4176, 4370, 4563, 4756, 4948,
+        5139, 5330, 5520, 5708, 5897, 6084, 6270, 6455, 6639, 6823, 7005, 7186, 7366,
+        7545, 7723, 7900, 8076, 8250, 8423, 8595, 8765, 8935, 9102, 9269, 9434, 9598,
+        9760, 9921, 10080, 10238, 10394, 10549, 10702, 10853, 11003, 11151, 11297, 11442, 11585,
+        11727, 11866, 12004, 12140, 12274, 12406, 12537, 12665, 12792, 12916, 13039, 13160, 13279,
+        13395, 13510, 13623, 13733, 13842, 13949, 14053, 14155, 14256, 14354, 14449, 14543, 14635,
+        14724, 14811, 14896, 14978, 15059, 15137, 15213, 15286, 15357, 15426, 15493, 15557, 15619,
+        15679, 15736, 15791, 15843, 15893, 15941, 15986, 16029, 16069, 16107, 16143, 16176, 16207,
+        16235, 16261, 16284, 16305, 16324, 16340, 16353, 16364, 16373, 16379, 16383, 16384 },
+    /* EASING_IN_OUT_SINE */
+    {
+        0, 2, 10, 22, 39, 62, 89, 121, 157, 199, 246, 297, 353,
+        413, 479, 549, 624, 703, 787, 875, 967, 1064, 1165, 1271, 1381, 1494,
+        1612, 1734, 1859, 1989, 2122, 2259, 2399, 2543, 2691, 2841, 2995, 3152, 3312,
+        3475, 3641, 3809, 3980, 4154, 4330, 4509, 4689, 4872, 5057, 5244, 5432, 5622,
+        5814, 6007, 6202, 6397, 6594, 6791, 6990, 7189, 7389, 7589, 7790, 7991, 8192,
+        8393, 8594, 8795, 8995, 9195, 9394, 9593, 9790, 9987, 10182, 10377, 10570, 10762,
+        10952, 11140, 11327, 11512, 11695, 11875, 12054, 12230, 12404, 12575, 12743, 12909, 13072,
+        13232, 13389, 13543, 13693, 13841, 13985, 14125, 14262, 14395, 14525, 14650, 14772, 14890,
+        15003, 15113, 15219, 15320, 15417, 15509, 15597, 15681, 15760, 15835, 15905, 15971, 16031,
+        16087, 16138, 16185, 16227, 16263, 16295, 16322, 16345, 16362, 16374, 16382, 16384 },
+    /* EASING_IN_QUAD */
+    {
+        0, 1, 4, 9, 16, 25, 36, 49, 64, 81, 100, 121, 144,
+        169, 196, 225, 256, 289, 324, 361, 400, 441, 484, 529, 576, 625,
+        676, 729, 784, 841, 900, 961, 1024, 1089, 1156, 1225, 1296, 1369, 1444,
+        1521, 1600, 1681, 1764, 1849, 1936, 2025, 2116, 2209, 2304, 2401, 2500, 2601,
+        2704, 2809, 2916, 3025, 3136, 3249, 3364, 3481, 3600, 3721, 3844, 3969, 4096,
+        4225, 4356, 4489, 4624, 4761, 4900, 5041, 5184, 5329, 5476, 5625, 5776, 5929,
+        6084, 6241, 6400, 6561, 6724, 6889, 7056, 7225, 7396, 7569, 7744, 7921, 8100,
+        8281, 8464, 8649, 8836, 9025, 9216, 9409, 9604, 9801, 10000, 10201, 10404, 10609,
+        10816, 11025, 11236, 11449, 11664, 11881, 12100, 12321, 12544, 12769, 12996, 13225, 13456,
+        13689, 13924, 14161, 14400, 14641, 14884, 15129, 15376, 15625, 15876, 16129, 16384 },
+    /* EASING_OUT_QUAD */
+    {
+        0, 255, 508, 759, 1008, 1255, 1500, 1743, 1984, 2223, 2460, 2695, 2928,
+        3159, 3388, 3615, 3840, 4063, 4284, 4503, 4720, 4935, 5148, 5359, 5568, 5775,
+        5980, 6183, 6384, 6583, 6780, 6975, 7168, 7359, 7548, 7735, 7920, 8103, 8284,
+        8463, 8640, 8815, 8988, 9159, 9328, 9495, 9660, 9823, 9984, 10143, 10300, 10455,
+        10608, 10759, 10908, 11055, 11200, 11343, 11484, 11623, 11760, 11895, 12028, 12159, 12288,
+        12415, 12540, 12663, 12784, 12903, 13020, 13135, 13248, 13359, 13468, 13575, 13680, 13783,
+        13884, 13983, 14080, 14175, 14268, 14359, 14448, 14535, 14620, 14703, 14784, 14863, 14940,
+        15015, 15088, 15159, 15228, 15295, 15360, 15423, 15484, 15543, 15600, 15655, 15708, 15759,
+        15808, 15855, 15900, 15943, 15984, 16023, 16060, 16095, 16128, 16159, 16188, 16215, 16240,
+        16263, 16284, 16303, 16320, 16335, 16348, 16359, 16368, 16375, 16380, 16383, 16384 },
+    /* EASING_IN_OUT_QUAD */
+    {
+        0, 2, 8, 18, 32, 50, 72, 98, 128, 162, 200, 242, 288,
+        338, 392, 450, 512, 578, 648, 722, 800, 882, 968, 1058, 1152, 1250,
+        1352, 1458, 1568, 1682, 1800, 1922, 2048, 2178, 2312, 2450, 2592, 2738, 2888,
+        3042, 3200, 3362, 3528, 3698, 3872, 4050, 4232, 4418, 4608, 4802, 5000, 5202,
+        5408, 5618, 5832, 6050, 6272, 6498, 6728, 6962, 7200, 7442, 7688, 7938, 8192,
+        8446, 8696, 8942, 9184, 9422, 9656, 9886, 10112, 10334, 10552, 10766, 10976, 11182,
+        11384, 11582, 11776, 11966, 12152, 12334, 12512, 12686, 12856, 13022, 13184, 13342, 13496,
+        13646, 13792, 13934, 14072, 14206, 14336, 14462, 14584, 14702, 14816, 14926, 15032, 15134,
+        15232, 15326, 15416, 15502, 15584, 15662, 15736, 15806, 15872, 15934, 15992, 16046, 16096,
+        16142, 16184, 16222, 16256, 16286, 16312, 16334, 16352, 16366, 16376, 16382, 16384 },
+    /* EASING_IN_CUBIC */
+    {
+        0, 0, 0, 0, 1, 1, 2, 3, 4, 6, 8, 10, 14,
+        17, 21, 26, 32, 38, 46, 54, 63, 72, 83, 95, 108, 122,
+        137, 154, 172, 191, 211, 233, 256, 281, 307, 335, 365, 396, 429,
+        463, 500, 538, 579, 621, 666, 712, 760, 811, 864, 919, 977, 1036,
+        1099, 1163, 1230, 1300, 1372, 1447, 1524, 1605, 1688, 1773, 1862, 1953, 2048,
+        2146, 2246, 2350, 2457, 2566, 2680, 2796, 2916, 3039, 3166, 3296, 3430, 3567,
+        3707, 3852, 4000, 4152, 4308, 4467, 4631, 4798, 4969, 5145, 5324, 5508, 5695,
+        5887, 6084, 6284, 6489, 6698, 6912, 7130, 7353, 7580, 7813, 8049, 8291, 8537,
+        8788, 9044, 9305, 9571, 9842, 10117, 10398, 10685, 10976, 11273, 11575, 11882, 12195,
+        12513, 12836, 13165, 13500, 13840, 14186, 14538, 14896, 15259, 15628, 16003, 16384 },
+    /* EASING_OUT_CUBIC */
+    {
+        0, 381, 756, 1125, 1489, 1846, 2198, 2544, 2884, 3219, 3548, 3871, 4190,
+        4502, 4809, 5111, 5408, 5699, 5986, 6267, 6543, 6813, 7079, 7340, 7596, 7847,
+        8093, 8335, 8572, 8804, 9031, 9254, 9472, 9686, 9895, 10100, 10301, 10497, 10689,
+        10876, 11060, 11239, 11415, 11586, 11754, 11917, 12076, 12232, 12384, 12532, 12677, 12817,
+        12955, 13088, 13218, 13345, 13468, 13588, 13704, 13818, 13928, 14034, 14138, 14238, 14336,
+        14431, 14522, 14611, 14697, 14779, 14860, 14937, 15012, 15084, 15154, 15221, 15286, 15348,
+        15407, 15465, 15520, 15573, 15624, 15672, 15719, 15763, 15805, 15846, 15884, 15921, 15955,
+        15988, 16020, 16049, 16077, 16103, 16128, 16151, 16173, 16193, 16213, 16230, 16247, 16262,
+        16276, 16289, 16301, 16312, 16322, 16330, 16338, 16346, 16352, 16358, 16363, 16367, 16371,
+        16374, 16376, 16378, 16380, 16381, 16382, 16383, 16384, 16384, 16384, 16384, 16384 },
+    /* EASING_IN_OUT_CUBIC */
+    {
+        0, 0, 0, 1, 2, 4, 7, 11, 16, 23, 31, 42, 54,
+        69, 86, 105, 128, 154, 182, 214, 250, 289, 333, 380, 432, 488,
+        549, 615, 686, 762, 844, 931, 1024, 1123, 1228, 1340, 1458, 1583, 1715,
+        1854, 2000, 2154, 2315, 2485, 2662, 2848, 3042, 3244, 3456, 3677, 3906, 4145,
+        4394, 4652, 4921, 5199, 5488, 5787, 6097, 6418, 6750, 7093, 7448, 7814, 8192,
+        8570, 8936, 9291, 9634, 9966, 10287, 10597, 10896, 11185, 11463, 11732, 11990, 12239,
+        12478, 12707, 12928, 13140, 13342, 13536, 13722, 13899, 14069, 14230, 14384, 14530, 14669,
+        14801, 14926, 15044, 15156, 15261, 15360, 15453, 15540, 15622, 15698, 15769, 15835, 15896,
+        15952, 16004, 16051, 16095, 16134, 16170, 16202, 16230, 16256, 16279, 16298, 16315, 16330,
+        16342, 16353, 16361, 16368, 16373, 16377, 16380, 16382, 16383, 16384, 16384, 16384 },
+    /* EASING_IN_QUART */
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
+        2, 2, 3, 4, 5, 6, 8, 10, 12, 14, 17, 20, 24,
+        28, 32, 38, 43, 49, 56, 64, 72, 82, 92, 103, 114, 127,
+        141, 156, 172, 190, 209, 229, 250, 273, 298, 324, 352, 381, 413,
+        446, 482, 519, 559, 600, 644, 691, 740, 791, 845, 902, 961, 1024,
+        1090, 1158, 1230, 1305, 1383, 1465, 1551, 1640, 1733, 1830, 1931, 2036, 2146,
+        2259, 2377, 2500, 2627, 2760, 2897, 3039, 3186, 3339, 3497, 3660, 3829, 4005,
+        4185, 4373, 4566, 4765, 4971, 5184, 5403, 5630, 5863, 6104, 6351, 6607, 6870,
+        7140, 7419, 7706, 8000, 8304, 8616, 8936, 9266, 9604, 9952, 10309, 10675, 11051,
+        11437, 11833, 12240, 12656, 13083, 13521, 13970, 14430, 14901, 15384, 15878, 16384 },
+    /* EASING_OUT_QUART */
+    {
+        0, 506, 1000, 1483, 1954, 2414, 2863, 3301, 3728, 4144, 4551, 4947, 5333,
+        5709, 6075, 6432, 6780, 7118, 7448, 7768, 8080, 8384, 8678, 8965, 9244, 9514,
+        9777, 10033, 10280, 10521, 10754, 10981, 11200, 11413, 11619, 11818, 12011, 12199, 12379,
+        12555, 12724, 12887, 13045, 13198, 13345, 13487, 13624, 13757, 13884, 14007, 14125, 14238,
+        14348, 14453, 14554, 14651, 14744, 14833, 14919, 15001, 15079, 15154, 15226, 15294, 15360,
+        15423, 15482, 15539, 15593, 15644, 15693, 15740, 15784, 15825, 15865, 15902, 15938, 15971,
+        16003, 16032, 16060, 16086, 16111, 16134, 16155, 16175, 16194, 16212, 16228, 16243, 16257,
+        16270, 16281, 16292, 16302, 16312, 16320, 16328, 16335, 16341, 16346, 16352, 16356, 16360,
+        16364, 16367, 16370, 16372, 16374, 16376, 16378, 16379, 16380, 16381, 16382, 16382, 16383,
+        16383, 16383, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384 },
+    /* EASING_IN_OUT_QUART */
+    {
+        0, 0, 0, 0, 0, 0, 1, 1, 2, 3, 5, 7, 10,
+        14, 19, 25, 32, 41, 51, 64, 78, 95, 114, 137, 162, 191,
+        223, 259, 300, 345, 396, 451, 512, 579, 653, 733, 820, 915, 1018,
+        1130, 1250, 1380, 1519, 1669, 1830, 2002, 2186, 2383, 2592, 2815, 3052, 3303,
+        3570, 3853, 4152, 4468, 4802, 5154, 5526, 5917, 6328, 6761, 7215, 7692, 8192,
+        8692, 9169, 9623, 10056, 10467, 10858, 11230, 11582, 11916, 12232, 12531, 12814, 13081,
+        13332, 13569, 13792, 14001, 14198, 14382, 14554, 14715, 14865, 15004, 15134, 15254, 15366,
+        15469, 15564, 15651, 15731, 15805, 15872, 15933, 15988, 16039, 16084, 16125, 16161, 16193,
+        16222, 16247, 16270, 16289, 16306, 16320, 16333, 16343, 16352, 16359, 16365, 16370, 16374,
+        16377, 16379, 16381, 16382, 16383, 16383, 16384, 16384, 16384, 16384, 16384, 16384 },
+    /* EASING_IN_QUINT */
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 3, 4, 5,
+        6, 7, 8, 10, 12, 14, 16, 19, 22, 25, 29, 33, 38,
+        43, 49, 55, 62, 70, 79, 88, 98, 109, 122, 135, 149, 165,
+        181, 199, 219, 240, 263, 287, 313, 341, 371, 403, 437, 473, 512,
+        553, 597, 644, 693, 746, 801, 860, 923, 989, 1058, 1132, 1209, 1291,
+        1377, 1467, 1563, 1663, 1768, 1878, 1994, 2116, 2243, 2377, 2516, 2663, 2816,
+        2976, 3143, 3317, 3500, 3690, 3888, 4095, 4310, 4535, 4768, 5012, 5265, 5528,
+        5801, 6086, 6381, 6688, 7006, 7337, 7680, 8035, 8404, 8785, 9181, 9591, 10015,
+        10454, 10909, 11379, 11865, 12368, 12888, 13424, 13979, 14552, 15143, 15754, 16384 },
+    /* EASING_OUT_QUINT */
+    {
+        0, 630, 1241, 1832, 2405, 2960, 3496, 4016, 4519, 5005, 5475, 5930, 6369,
+        6793, 7203, 7599, 7981, 8349, 8704, 9047, 9378, 9696, 10003, 10298, 10583, 10856,
+        11119, 11372, 11616, 11849, 12074, 12289, 12496, 12694, 12884, 13067, 13241, 13408, 13568,
+        13721, 13868, 14007, 14141, 14268, 14390, 14506, 14616, 14721, 14822, 14917, 15007, 15093,
+        15175, 15252, 15326, 15395, 15461, 15524, 15583, 15638, 15691, 15740, 15787, 15831, 15872,
+        15911, 15947, 15981, 16013, 16043, 16071, 16097, 16121, 16144, 16165, 16185, 16203, 16219,
+        16235, 16249, 16263, 16275, 16286, 16296, 16305, 16314, 16322, 16329, 16335, 16341, 16346,
+        16351, 16355, 16359, 16362, 16365, 16368, 16370, 16372, 16374, 16376, 16377, 16378, 16379,
+        16380, 16381, 16382, 16382, 16382, 16383, 16383, 16383, 16384, 16384, 16384, 16384, 16384,
+        16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384 },
+    /* EASING_IN_OUT_QUINT */
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2,
+        3, 4, 6, 8, 11, 14, 19, 24, 31, 39, 49, 61, 75,
+        91, 109, 131, 156, 185, 218, 256, 299, 347, 401, 461, 529, 605,
+        688, 781, 884, 997, 1122, 1258, 1408, 1571, 1750, 1944, 2155, 2384, 2632,
+        2901, 3191, 3503, 3840, 4202, 4591, 5008, 5454, 5933, 6444, 6990, 7572, 8192,
+        8812, 9394, 9940, 10451, 10930, 11376, 11793, 12182, 12544, 12881, 13193, 13483, 13752,
+        14000, 14229, 14440, 14634, 14813, 14976, 15126, 15262, 15387, 15500, 15603, 15696, 15779,
+        15855, 15923, 15983, 16037, 16085, 16128, 16166, 16199, 16228, 16253, 16275, 16293, 16309,
+        16323, 16335, 16345, 16353, 16360, 16365, 16370, 16373, 16376, 16378, 16380, 16381, 16382,
+        16383, 16383, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384 },
+    /* EASING_IN_EXPO */
+    {
+        0, 17, 18, 19, 20, 21, 22, 23, 25, 26, 27, 29, 31,
+        32, 34, 36, 38, 40, 42, 45, 47, 50, 53, 56, 59, 62,
+        65, 69, 73, 77, 81, 86, 91, 96, 101, 106, 112, 119, 125,
+        132, 140, 147, 156, 164, 173, 183, 193, 204, 215, 227, 240, 253,
+        267, 282, 298, 314, 332, 350, 370, 391, 412, 435, 459, 485, 512,
+        540, 571, 602, 636, 671, 709, 748, 790, 834, 880, 929, 981, 1035,
+        1093, 1154, 1218, 1286, 1357, 1433, 1512, 1596, 1685, 1779, 1878, 1983, 2093,
+        2209, 2332, 2462, 2599, 2744, 2896, 3057, 3228, 3407, 3597, 3797, 4008, 4231,
+        4467, 4715, 4978, 5255, 5547, 5856, 6182, 6526, 6889, 7272, 7677, 8104, 8555,
+        9031, 9533, 10064, 10624, 11215, 11839, 12498, 13193, 13927, 14702, 15520, 16384 },
+    /* EASING_OUT_EXPO */
+    {
+        0, 864, 1682, 2457, 3191, 3886, 4545, 5169, 5760, 6320, 6851, 7353, 7829,
+        8280, 8707, 9112, 9495, 9858, 10202, 10528, 10837, 11129, 11406, 11669, 11917, 12153,
+        12376, 12587, 12787, 12977, 13156, 13327, 13488, 13640, 13785, 13922, 14052, 14175, 14291,
+        14401, 14506, 14605, 14699, 14788, 14872, 14951, 15027, 15098, 15166, 15230, 15291, 15349,
+        15403, 15455, 15504, 15550, 15594, 15636, 15675, 15713, 15748, 15782, 15813, 15844, 15872,
+        15899, 15925, 15949, 15972, 15993, 16014, 16034, 16052, 16070, 16086, 16102, 16117, 16131,
+        16144, 16157, 16169, 16180, 16191, 16201, 16211, 16220, 16228, 16237, 16244, 16252, 16259,
+        16265, 16272, 16278, 16283, 16288, 16293, 16298, 16303, 16307, 16311, 16315, 16319, 16322,
+        16325, 16328, 16331, 16334, 16337, 16339, 16342, 16344, 16346, 16348, 16350, 16352, 16353,
+        16355, 16357, 16358, 16359, 16361, 16362, 16363, 16364, 16365, 16366, 16367, 16384 },
+    /* EASING_IN_OUT_EXPO */
+    {
+        0, 9, 10, 11, 12, 14, 15, 17, 19, 21, 24, 26, 29,
+        33, 36, 41, 45, 50, 56, 63, 70, 78, 87, 97, 108, 120,
+        134, 149, 166, 185, 206, 230, 256, 285, 318, 354, 395, 440, 490,
+        546, 609, 679, 756, 843, 939, 1046, 1166, 1300, 1448, 1614, 1798, 2004,
+        2233, 2489, 2774, 3091, 3444, 3838, 4277, 4767, 5312, 5919, 6597, 7351, 8192,
+        9033, 9787, 10465, 11072, 11617, 12107, 12546, 12940, 13293, 13610, 13895, 14151, 14380,
+        14586, 14770, 14936, 15084, 15218, 15338, 15445, 15541, 15628, 15705, 15775, 15838, 15894,
+        15944, 15989, 16030, 16066, 16099, 16128, 16154, 16178, 16199, 16218, 16235, 16250, 16264,
+        16276, 16287, 16297, 16306, 16314, 16321, 16328, 16334, 16339, 16343, 16348, 16351, 16355,
+        16358, 16360, 16363, 16365, 16367, 16369, 16370, 16372, 16373, 16374, 16375, 16384 },
+    /* EASING_IN_CIRC */
+    {
+        0, 1, 2, 5, 8, 13, 18, 25, 32, 41, 50, 61, 72,
+        85, 98, 113, 129, 145, 163, 182, 201, 222, 244, 267, 291, 316,
+        342, 369, 397, 426, 456, 488, 520, 554, 589, 624, 661, 699, 739,
+        779, 821, 863, 907, 952, 998, 1046, 1095, 1144, 1196, 1248, 1302, 1357,
+        1413, 1470, 1529, 1590, 1651, 1714, 1779, 1844, 1912, 1980, 2050, 2122, 2195,
+        2270, 2346, 2424, 2503, 2584, 2667, 2752, 2838, 2926, 3016, 3107, 3201, 3296,
+        3393, 3493, 3594, 3698, 3803, 3911, 4022, 4134, 4249, 4366, 4486, 4609, 4734,
+        4862, 4993, 5127, 5263, 5404, 5547, 5694, 5844, 5999, 6157, 6319, 6486, 6657,
+        6833, 7014, 7200, 7392, 7590, 7795, 8006, 8225, 8452, 8688, 8934, 9190, 9458,
+        9739, 10035, 10349, 10683, 11040, 11427, 11849, 12320, 12858, 13499, 14340, 16384 },
+    /* EASING_OUT_CIRC */
+    {
+        0, 2044, 2885, 3526, 4064, 4535, 4957, 5344, 5701, 6035, 6349, 6645, 6926,
+        7194, 7450, 7696, 7932, 8159, 8378, 8589, 8794, 8992, 9184, 9370, 9551, 9727,
+        9898, 10065, 10227, 10385, 10540, 10690, 10837, 10980, 11121, 11257, 11391, 11522, 11650,
+        11775, 11898, 12018, 12135, 12250, 12362, 12473, 12581, 12686, 12790, 12891, 12991, 13088,
+        13183, 13277, 13368, 13458, 13546, 13632, 13717, 13800, 13881, 13960, 14038, 14114, 14189,
+        14262, 14334, 14404, 14472, 14540, 14605, 14670, 14733, 14794, 14855, 14914, 14971, 15027,
+        15082, 15136, 15188, 15240, 15289, 15338, 15386, 15432, 15477, 15521, 15563, 15605, 15645,
+        15685, 15723, 15760, 15795, 15830, 15864, 15896, 15928, 15958, 15987, 16015, 16042, 16068,
+        16093, 16117, 16140, 16162, 16183, 16202, 16221, 16239, 16255, 16271, 16286, 16299, 16312,
+        16323, 16334, 16343, 16352, 16359, 16366, 16371, 16376, 16379, 16382, 16384, 16384 },
+    /* EASING_IN_OUT_CIRC */
+    {
+        0, 1, 4, 9, 16, 25, 36, 49, 64, 81, 101, 122, 145,
+        171, 198, 228, 260, 294, 331, 369, 410, 454, 499, 547, 598, 651,
+        706, 765, 826, 889, 956, 1025, 1098, 1173, 1252, 1334, 1419, 1508, 1600,
+        1697, 1797, 1902, 2011, 2124, 2243, 2367, 2496, 2632, 2774, 2922, 3078, 3243,
+        3416, 3600, 3795, 4003, 4226, 4467, 4729, 5018, 5341, 5713, 6160, 6750, 8192,
+        9634, 10224, 10671, 11043, 11366, 11655, 11917, 12158, 12381, 12589, 12784, 12968, 13141,
+        13306, 13462, 13610, 13752, 13888, 14017, 14141, 14260, 14373, 14482, 14587, 14687, 14784,
+        14876, 14965, 15050, 15132, 15211, 15286, 15359, 15428, 15495, 15558, 15619, 15678, 15733,
+        15786, 15837, 15885, 15930, 15974, 16015, 16053, 16090, 16124, 16156, 16186, 16213, 16239,
+        16262, 16283, 16303, 16320, 16335, 16348, 16359, 16368, 16375, 16380, 16383, 16384 },
+    /* EASING_IN_BACK */
+    {
+        0, -3, -12, -28, -50, -77, -111, -151, -196, -247, -303, -365, -432,
+        -505, -582, -665, -752, -843, -940, -1040, -1144, -1253, -1365, -1480, -1599, -1721,
+        -1845, -1972, -2102, -2234, -2368, -2503, -2640, -2778, -2918, -3057, -3198, -3338, -3478,
+        -3618, -3757, -3895, -4032, -4168, -4301, -4433, -4562, -4689, -4812, -4933, -5049, -5162,
+        -5271, -5375, -5475, -5569, -5658, -5742, -5819, -5891, -5956, -6014, -6065, -6108, -6144,
+        -6172, -6192, -6203, -6206, -6199, -6183, -6158, -6123, -6078, -6022, -5956, -5880, -5792,
+        -5693, -5583, -5461, -5327, -5181, -5023, -4852, -4669, -4473, -4264, -4042, -3806, -3558,
+        -3295, -3019, -2730, -2426, -2109, -1777, -1431, -1071, -697, -308, 96, 513, 945,
+        1392, 1854, 2329, 2820, 3325, 3844, 4378, 4927, 5490, 6067, 6659, 7264, 7884,
+        8518, 9166, 9828, 10503, 11192, 11895, 12611, 13340, 14082, 14837, 15604, 16384 },
+    /* EASING_OUT_BACK */
+    {
+        0, 780, 1547, 2302, 3044, 3773, 4489, 5192, 5881, 6556, 7218, 7866, 8500,
+        9120, 9725, 10317, 10894, 11457, 12006, 12540, 13059, 13564, 14055, 14530, 14992, 15439,
+        15871, 16288, 16692, 17081, 17455, 17815, 18161, 18493, 18810, 19114, 19403, 19679, 19942,
+        20190, 20426, 20648, 20857, 21053, 21236, 21407, 21565, 21711, 21845, 21967, 22077, 22176,
+        22264, 22340, 22406, 22462, 22507, 22542, 22567, 22583, 22590, 22587, 22576, 22556, 22528,
+        22492, 22449, 22398, 22340, 22275, 22203, 22126, 22042, 21953, 21859, 21759, 21655, 21546,
+        21433, 21317, 21196, 21073, 20946, 20817, 20685, 20552, 20416, 20279, 20141, 20002, 19862,
+        19722, 19582, 19441, 19302, 19162, 19024, 18887, 18752, 18618, 18486, 18356, 18229, 18105,
+        17983, 17864, 17749, 17637, 17528, 17424, 17324, 17227, 17136, 17049, 16966, 16889, 16816,
+        16749, 16687, 16631, 16580, 16535, 16495, 16461, 16434, 16412, 16396, 16387, 16384 },
+    /* EASING_IN_OUT_BACK */
+    {
+        0, -6, -25, -56, -98, -152, -216, -291, -376, -470, -572, -682, -799,
+        -923, -1051, -1184, -1320, -1459, -1599, -1739, -1879, -2016, -2151, -2281, -2406, -2525,
+        -2635, -2737, -2829, -2910, -2978, -3032, -3072, -3096, -3103, -3092, -3061, -3011, -2940,
+        -2846, -2730, -2590, -2426, -2236, -2021, -1779, -1510, -1213, -888, -535, -154, 257,
+        696, 1165, 1662, 2189, 2745, 3329, 3942, 4583, 5252, 5947, 6670, 7418, 8192,
+        8966, 9714, 10437, 11132, 11801, 12442, 13055, 13639, 14195, 14722, 15219, 15688, 16127,
+        16538, 16919, 17272, 17597, 17894, 18163, 18405, 18620, 18810, 18974, 19114, 19230, 19324,
+        19395, 19445, 19476, 19487, 19480, 19456, 19416, 19362, 19294, 19213, 19121, 19019, 18909,
+        18790, 18665, 18535, 18400, 18263, 18123, 17983, 17843, 17704, 17568, 17435, 17307, 17183,
+        17066, 16956, 16854, 16760, 16675, 16600, 16536, 16482, 16440, 16409, 16390, 16384 },
+    /* EASING_IN_ELASTIC */
+    {
+        0, 3, 6, 9, 12, 15, 18, 21, 24, 26, 27, 29, 29,
+        28, 27, 25, 21, 17, 11, 5, -2, -10, -19, -28, -37, -46,
+        -55, -63, -71, -77, -81, -83, -84, -81, -76, -69, -58, -44, -27,
+        -8, 14, 38, 63, 90, 116, 143, 168, 191, 211, 227, 238, 243,
+        242, 233, 216, 190, 156, 114, 63, 5, -60, -131, -207, -284, -362,
+        -438, -510, -574, -629, -671, -698, -707, -696, -663, -607, -526, -419, -288,
+        -134, 42, 238, 448, 669, 895, 1121, 1338, 1541, 1720, 1869, 1979, 2042,
+        2051, 2000, 1884, 1698, 1439, 1108, 706, 237, -292, -874, -1496, -2144, -2803,
+        -3453, -4074, -4644, -5141, -5540, -5820, -5958, -5933, -5728, -5328, -4723, -3907, -2882,
+        -1653, -234, 1354, 3084, 4919, 6817, 8728, 10597, 12362, 13960, 15323, 16384 },
+    /* EASING_OUT_ELASTIC */
+    {
+        0, 1061, 2424, 4022, 5787, 7656, 9567, 11465, 13300, 15030, 16618, 18037, 19266,
+        20292, 21107, 21712, 22112, 22317, 22342, 22204, 21924, 21525, 21028, 20458, 19837, 19187,
+        18528, 17880, 17258, 16676, 16147, 15678, 15276, 14945, 14686, 14500, 14384, 14333, 14342,
+        14405, 14515, 14664, 14843, 15046, 15263, 15489, 15715, 15936, 16146, 16342, 16518, 16672,
+        16803, 16910, 16991, 17047, 17080, 17091, 17082, 17055, 17013, 16958, 16894, 16822, 16746,
+        16668, 16591, 16515, 16444, 16379, 16321, 16270, 16228, 16194, 16168, 16151, 16142, 16141,
+        16146, 16157, 16173, 16193, 16216, 16241, 16268, 16294, 16321, 16346, 16370, 16392, 16411,
+        16428, 16442, 16453, 16460, 16465, 16468, 16467, 16465, 16461, 16455, 16447, 16439, 16430,
+        16421, 16412, 16403, 16394, 16386, 16379, 16373, 16367, 16363, 16359, 16357, 16356, 16355,
+        16355, 16357, 16358, 16360, 16363, 16366, 16369, 16372, 16375, 16378, 16381, 16384 },
+    /* EASING_IN_OUT_ELASTIC */
+    {
+        0, 3, 6, 9, 12, 14, 14, 13, 11, 6, -1, -9, -19,
+        -28, -35, -40, -42, -38, -29, -14, 7, 32, 58, 84, 106, 119,
+        121, 108, 78, 32, -30, -103, -181, -255, -314, -349, -348, -303, -210,
+        -67, 119, 334, 560, 770, 934, 1021, 1000, 849, 554, 119, -437, -1072,
+        -1726, -2322, -2770, -2979, -2864, -2361, -1441, -117, 1542, 3408, 5298, 6980, 8192,
+        9404, 11086, 12976, 14842, 16501, 17825, 18745, 19248, 19363, 19154, 18706, 18110, 17456,
+        16821, 16265, 15830, 15535, 15384, 15363, 15450, 15614, 15824, 16050, 16265, 16451, 16594,
+        16687, 16732, 16733, 16698, 16639, 16565, 16487, 16414, 16352, 16306, 16276, 16263, 16265,
+        16278, 16300, 16326, 16352, 16377, 16398, 16413, 16422, 16426, 16425, 16419, 16412, 16403,
+        16393, 16385, 16378, 16373, 16371, 16370, 16370, 16372, 16375, 16378, 16381, 16384 },
+    /* EASING_IN_BOUNCE */
+    {
+        0, 127, 233, 318, 380, 421, 441, 438, 415, 369, 302, 214, 104,
+        53, 303, 529, 730, 908, 1061, 1190, 1295, 1376, 1433, 1466, 1474, 1459,
+        1419, 1355, 1267, 1155, 1019, 858, 674, 465, 233, 38, 450, 844, 1219,
+        1576, 1915, 2236, 2539, 2824, 3090, 3338, 3569, 3781, 3974, 4150, 4308, 4447,
+        4568, 4672, 4756, 4823, 4872, 4903, 4915, 4909, 4885, 4843, 4783, 4705, 4608,
+        4493, 4361, 4210, 4040, 3853, 3648, 3424, 3182, 2923, 2644, 2348, 2034, 1702,
+        1351, 982, 595, 190, 382, 1070, 1743, 2401, 3044, 3671, 4284, 4881, 5464,
+        6031, 6583, 7120, 7642, 8148, 8640, 9116, 9578, 10024, 10455, 10871, 11272, 11657,
+        12028, 12383, 12724, 13049, 13359, 13654, 13934, 14198, 14448, 14682, 14902, 15106, 15295,
+        15469, 15628, 15771, 15900, 16013, 16112, 16195, 16263, 16316, 16354, 16376, 16384 },
+    /* EASING_OUT_BOUNCE */
+    {
+        0, 8, 30, 68, 121, 189, 272, 371, 484, 613, 756, 915, 1089,
+        1278, 1482, 1702, 1936, 2186, 2450, 2730, 3025, 3335, 3660, 4001, 4356, 4727,
+        5112, 5513, 5929, 6360, 6806, 7268, 7744, 8236, 8742, 9264, 9801, 10353, 10920,
+        11503, 12100, 12713, 13340, 13983, 14641, 15314, 16002, 16194, 15789, 15402, 15033, 14682,
+        14350, 14036, 13740, 13461, 13202, 12960, 12736, 12531, 12344, 12174, 12024, 11891, 11776,
+        11679, 11601, 11541, 11499, 11475, 11469, 11481, 11512, 11561, 11628, 11712, 11816, 11937,
+        12076, 12234, 12410, 12603, 12816, 13046, 13294, 13560, 13845, 14148, 14469, 14808, 15165,
+        15540, 15934, 16346, 16151, 15919, 15710, 15526, 15365, 15229, 15117, 15029, 14965, 14925,
+        14910, 14918, 14951, 15008, 15089, 15194, 15323, 15476, 15654, 15855, 16081, 16331, 16280,
+        16170, 16082, 16015, 15969, 15946, 15943, 15963, 16004, 16066, 16151, 16257, 16384 },
+    /* EASING_IN_OUT_BOUNCE */
+    {
+        0, 117, 190, 220, 207, 151, 52, 151, 365, 531, 648, 717, 737,
+        710, 634, 509, 337, 116, 225, 609, 958, 1269, 1545, 1784, 1987, 2154,
+        2284, 2378, 2436, 2457, 2443, 2391, 2304, 2180, 2020, 1824, 1591, 1322, 1017,
+        675, 298, 191, 872, 1522, 2142, 2732, 3292, 3821, 4320, 4789, 5228, 5636,
+        6014, 6362, 6680, 6967, 7224, 7451, 7648, 7814, 7950, 8056, 8132, 8177, 8192,
+        8207, 8253, 8328, 8434, 8570, 8737, 8933, 9160, 9417, 9705, 10022, 10370, 10748,
+        11157, 11595, 12064, 12563, 13093, 13652, 14242, 14862, 15513, 16193, 16086, 15709, 15367,
+        15062, 14793, 14560, 14364, 14204, 14080, 13993, 13941, 13927, 13948, 14006, 14100, 14230,
+        14397, 14600, 14839, 15115, 15426, 15775, 16159, 16268, 16047, 15875, 15750, 15674, 15647,
+        15667, 15736, 15854, 16019, 16233, 16332, 16233, 16177, 16164, 16194, 16267, 16384 }
+};
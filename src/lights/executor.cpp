@@ -20,25 +20,26 @@
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
+#include <string.h>
 
+#include "bytecode_array.hpp"
 #include "bytecode_store.h"
 #include "commands.h"
 #include "error_handler.h"
 #include "executor.h"
 #include "light_player_config.h"
 
+#include "../perf_counters.h"
+
 static bool isAddressValid(unsigned long address)
 {
     return address < INT_MAX;
 }
 
-void CommandExecutorTransitionHandler::operator()(float value) const
-{
-    m_pExecutor->setCurrentColor(sb_rgb_color_linear_interpolation(startColor, endColor, value));
-}
-
-CommandExecutor::CommandExecutor()
+template <typename Store>
+BasicCommandExecutor<Store>::BasicCommandExecutor()
     : m_pBytecodeStore(0)
+    , m_pErrorHandler(0)
     , m_currentColor()
     , m_currentPyroChannels(0)
     , m_ended(true)
@@ -46,16 +47,22 @@ CommandExecutor::CommandExecutor()
     , m_resetClockFlag(false)
     , m_transitionHandler(this)
 {
+#ifdef SB_ENABLE_PERF_COUNTERS
+    memset(&m_perfCounters, 0, sizeof(m_perfCounters));
+#endif
+
     rewind();
 };
 
-signed long CommandExecutor::absoluteToInternalTime(unsigned long ms)
+template <typename Store>
+signed long BasicCommandExecutor<Store>::absoluteToInternalTime(unsigned long ms)
 {
     signed long msSigned = ms;
     return round((msSigned - m_lastClockResetTime) / m_clockSkewCompensationFactor);
 }
 
-void CommandExecutor::checkAndFireTriggers(unsigned long now)
+template <typename Store>
+void BasicCommandExecutor<Store>::checkAndFireTriggers(unsigned long now)
 {
     int i, n = CONFIG_MAX_TRIGGER_COUNT;
     for (i = 0; i < n; i++) {
@@ -66,19 +73,22 @@ void CommandExecutor::checkAndFireTriggers(unsigned long now)
     }
 }
 
-void CommandExecutor::delayExecutionUntil(unsigned long ms)
+template <typename Store>
+void BasicCommandExecutor<Store>::delayExecutionUntil(unsigned long ms)
 {
     delayExecutionUntilAbsoluteTime(internalToAbsoluteTime(ms));
 }
 
-void CommandExecutor::delayExecutionUntilAbsoluteTime(unsigned long ms)
+template <typename Store>
+void BasicCommandExecutor<Store>::delayExecutionUntilAbsoluteTime(unsigned long ms)
 {
     /* Make sure that we don't freak out if the user tries to go backward in
      * time */
     m_nextWakeupTime = m_nextWakeupTime < ms ? ms : m_nextWakeupTime;
 }
 
-void CommandExecutor::executeActionOfTrigger(const Trigger* trigger)
+template <typename Store>
+void BasicCommandExecutor<Store>::executeActionOfTrigger(const Trigger* trigger)
 {
     assert(trigger != 0);
 
@@ -94,13 +104,14 @@ void CommandExecutor::executeActionOfTrigger(const Trigger* trigger)
         break;
 
     default:
-        SET_ERROR(Errors::INVALID_TRIGGER_ACTION_TYPE);
+        errorHandler()->setError(Errors::INVALID_TRIGGER_ACTION_TYPE);
     }
 }
 
-void CommandExecutor::executeNextCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::executeNextCommand()
 {
-    uint8_t commandCode;
+    DecodedInstruction insn;
 
     if (m_ended) {
         /* Don't wake up for a while now as the execution of the bytecode
@@ -109,9 +120,16 @@ void CommandExecutor::executeNextCommand()
         return;
     }
 
-    commandCode = nextByte();
+    assert(m_pBytecodeStore != 0);
+
+    /* The counter is unsigned so subtracting the start location and adding
+     * the end location adds the length of the instruction */
+    SB_PERF_ADD(m_perfCounters, bytes_executed, -(uint32_t)m_pBytecodeStore->tell());
+    decodeNextInstruction(*m_pBytecodeStore, insn);
+    SB_PERF_ADD(m_perfCounters, bytes_executed, (uint32_t)m_pBytecodeStore->tell());
+    SB_PERF_COUNT(m_perfCounters, items_decoded);
 
-    switch (commandCode) {
+    switch (insn.command) {
     case CMD_END: /* End of program */
         stop();
         break;
@@ -120,47 +138,47 @@ void CommandExecutor::executeNextCommand()
         break;
 
     case CMD_SLEEP: /* Sleeps for a given duration */
-        handleSleepCommand();
+        handleSleepCommand(insn);
         break;
 
     case CMD_WAIT_UNTIL: /* Waits until the internal clock of the executor reaches a given value */
-        handleWaitUntilCommand();
+        handleWaitUntilCommand(insn);
         break;
 
     case CMD_SET_COLOR: /* Set the color of the LED strip and wait */
-        handleSetColorCommand();
+        handleSetColorCommand(insn);
         break;
 
     case CMD_SET_GRAY: /* Set the color of the LED strip to a shade of gray and wait */
-        handleSetGrayCommand();
+        handleSetGrayCommand(insn);
         break;
 
     case CMD_SET_BLACK: /* Set the color of the LED strip to black and wait */
-        handleSetBlackCommand();
+        handleSetBlackCommand(insn);
         break;
 
     case CMD_SET_WHITE: /* Set the color of the LED strip to white and wait */
-        handleSetWhiteCommand();
+        handleSetWhiteCommand(insn);
         break;
 
     case CMD_FADE_TO_COLOR: /* Fades the color of the LED strip */
-        handleFadeToColorCommand();
+        handleFadeToColorCommand(insn);
         break;
 
     case CMD_FADE_TO_GRAY: /* Fades the color of the LED strip to a shade of gray */
-        handleFadeToGrayCommand();
+        handleFadeToGrayCommand(insn);
         break;
 
     case CMD_FADE_TO_BLACK: /* Fades the color of the LED strip to black */
-        handleFadeToBlackCommand();
+        handleFadeToBlackCommand(insn);
         break;
 
     case CMD_FADE_TO_WHITE: /* Fades the color of the LED strip to white */
-        handleFadeToWhiteCommand();
+        handleFadeToWhiteCommand(insn);
         break;
 
     case CMD_LOOP_BEGIN: /* Marks the beginning of a loop */
-        handleLoopBeginCommand();
+        handleLoopBeginCommand(insn);
         break;
 
     case CMD_LOOP_END: /* Marks the end of a loop */
@@ -172,37 +190,38 @@ void CommandExecutor::executeNextCommand()
         break;
 
     case CMD_SET_COLOR_FROM_CHANNELS: /* Set color from the current values of some channels */
-        handleSetColorFromChannelsCommand();
+        handleSetColorFromChannelsCommand(insn);
         break;
 
     case CMD_FADE_TO_COLOR_FROM_CHANNELS: /* Fade to color from the current values of some channels */
-        handleFadeToColorFromChannelsCommand();
+        handleFadeToColorFromChannelsCommand(insn);
         break;
 
     case CMD_JUMP: /* Unconditional jump to address */
-        handleJumpCommand();
+        handleJumpCommand(insn);
         break;
 
     case CMD_TRIGGERED_JUMP: /* Donditional jump to address */
-        handleTriggeredJumpCommand();
+        handleTriggeredJumpCommand(insn);
         break;
 
     case CMD_SET_PYRO: /* Update some pyro channels */
-        handleSetPyroCommand();
+        handleSetPyroCommand(insn);
         break;
 
     case CMD_SET_PYRO_ALL: /* Update all pyro channels */
-        handleSetPyroAllCommand();
+        handleSetPyroAllCommand(insn);
         break;
 
     default:
         /* Unknown command code, stop execution and set an error condition */
-        SET_ERROR(Errors::INVALID_COMMAND_CODE);
+        errorHandler()->setError(Errors::INVALID_COMMAND_CODE);
         stop();
     }
 }
 
-void CommandExecutor::fadeColorOfLEDStrip(sb_rgb_color_t color)
+template <typename Store>
+void BasicCommandExecutor<Store>::fadeColorOfLEDStrip(sb_rgb_color_t color, unsigned long duration)
 {
     // The next line used to call millis() but we don't allow that as we want
     // to make the executor independent of millis(). We simply assume that
@@ -210,7 +229,7 @@ void CommandExecutor::fadeColorOfLEDStrip(sb_rgb_color_t color)
     // to the current timestamp to the time when we reach this point is not
     // significant.
     unsigned long now = m_currentCommandStartTime;
-    handleDelayByte(); // this is according to the internal clock
+    handleDelay(duration); // this is according to the internal clock
     unsigned long actualDuration = m_nextWakeupTime - now; // this is according to the clock of the host device
     EasingMode easingMode = EASING_LINEAR;
 
@@ -220,7 +239,8 @@ void CommandExecutor::fadeColorOfLEDStrip(sb_rgb_color_t color)
     m_transition.step(m_transitionHandler, now);
 }
 
-Trigger* CommandExecutor::findTriggerForChannelIndex(uint8_t channelIndex)
+template <typename Store>
+Trigger* BasicCommandExecutor<Store>::findTriggerForChannelIndex(uint8_t channelIndex)
 {
     uint8_t index;
 
@@ -239,55 +259,21 @@ Trigger* CommandExecutor::findTriggerForChannelIndex(uint8_t channelIndex)
     return 0;
 }
 
-unsigned long CommandExecutor::handleDelayByte()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleDelay(unsigned long duration)
 {
-    unsigned long duration = nextDuration();
-
     m_cumulativeDurationSinceStart += duration; // this is according to the internal clock
     delayExecutionUntil(m_cumulativeDurationSinceStart);
-
-    return duration;
-}
-
-EasingMode CommandExecutor::handleEasingModeByte()
-{
-    uint8_t easingModeByte = nextByte();
-    return static_cast<EasingMode>(easingModeByte);
 }
 
-unsigned long CommandExecutor::internalToAbsoluteTime(long ms)
+template <typename Store>
+unsigned long BasicCommandExecutor<Store>::internalToAbsoluteTime(long ms)
 {
     return round(m_lastClockResetTime + ms * m_clockSkewCompensationFactor);
 }
 
-uint8_t CommandExecutor::nextByte()
-{
-    assert(m_pBytecodeStore != 0);
-    return m_pBytecodeStore->next();
-}
-
-unsigned long CommandExecutor::nextDuration()
-{
-    unsigned long durationInHalfFrames = nextVarint();
-    return durationInHalfFrames * 20;
-}
-
-unsigned long CommandExecutor::nextVarint()
-{
-    unsigned long result = 0;
-    uint8_t readByte;
-    uint8_t shift = 0;
-
-    do {
-        readByte = nextByte();
-        result |= ((unsigned long)(readByte & 0x7F)) << shift;
-        shift += 7;
-    } while (readByte & 0x80);
-
-    return result;
-}
-
-void CommandExecutor::rewind()
+template <typename Store>
+void BasicCommandExecutor<Store>::rewind()
 {
     if (m_pBytecodeStore) {
         m_pBytecodeStore->rewind();
@@ -304,11 +290,92 @@ void CommandExecutor::rewind()
     m_currentColor.green = 0;
     m_currentColor.blue = 0;
 
-    CLEAR_ERROR();
+    errorHandler()->clearError();
     resetClock();
 }
 
-void CommandExecutor::setClockOriginToCurrentTimestamp(unsigned long timestamp)
+template <typename Store>
+void BasicCommandExecutor<Store>::restoreState(const CommandExecutorState& state)
+{
+    int i;
+
+    if (m_pBytecodeStore) {
+        m_pBytecodeStore->seek(state.location);
+    }
+
+    m_currentColor = state.currentColor;
+    m_currentPyroChannels = state.currentPyroChannels;
+    m_ended = state.ended;
+    m_resetClockFlag = state.resetClockFlag;
+    m_loopStack.restore(state.loops, state.numLoops);
+
+    m_cumulativeDurationSinceStart = state.cumulativeDurationSinceStart;
+    m_currentCommandStartTime = state.currentCommandStartTime;
+    m_lastClockResetTime = state.lastClockResetTime;
+    m_nextWakeupTime = state.nextWakeupTime;
+    m_clockSkewCompensationFactor = state.clockSkewCompensationFactor;
+
+    m_transition.setEasingMode(
+        state.transitionEasingMode < NUM_EASING_FUNCTIONS
+            ? static_cast<EasingMode>(state.transitionEasingMode)
+            : EASING_LINEAR);
+    m_transition.start(state.transitionDuration, state.transitionStartTime);
+    if (!state.transitionActive) {
+        m_transition.cancel();
+    }
+    m_transitionHandler.startColor = state.transitionStartColor;
+    m_transitionHandler.endColor = state.transitionEndColor;
+
+    for (i = 0; i < CONFIG_MAX_TRIGGER_COUNT; i++) {
+        m_triggers[i].disable();
+    }
+
+    errorHandler()->clearError();
+}
+
+template <typename Store>
+bool BasicCommandExecutor<Store>::saveState(CommandExecutorState& state) const
+{
+    int i;
+
+    if (m_pBytecodeStore && m_pBytecodeStore->suspended()) {
+        return false;
+    }
+
+    for (i = 0; i < CONFIG_MAX_TRIGGER_COUNT; i++) {
+        if (m_triggers[i].active()) {
+            return false;
+        }
+    }
+
+    memset(&state, 0, sizeof(CommandExecutorState));
+
+    state.location = m_pBytecodeStore ? m_pBytecodeStore->tell() : BYTECODE_LOCATION_NOWHERE;
+    state.currentColor = m_currentColor;
+    state.currentPyroChannels = m_currentPyroChannels;
+    state.ended = m_ended;
+    state.resetClockFlag = m_resetClockFlag;
+    state.numLoops = m_loopStack.size();
+    memcpy(state.loops, m_loopStack.items(), state.numLoops * sizeof(LoopStackItem));
+
+    state.cumulativeDurationSinceStart = m_cumulativeDurationSinceStart;
+    state.currentCommandStartTime = m_currentCommandStartTime;
+    state.lastClockResetTime = m_lastClockResetTime;
+    state.nextWakeupTime = m_nextWakeupTime;
+    state.clockSkewCompensationFactor = m_clockSkewCompensationFactor;
+
+    state.transitionActive = m_transition.active();
+    state.transitionEasingMode = m_transition.easingMode();
+    state.transitionStartTime = m_transition.startTime();
+    state.transitionDuration = m_transition.duration();
+    state.transitionStartColor = m_transitionHandler.startColor;
+    state.transitionEndColor = m_transitionHandler.endColor;
+
+    return true;
+}
+
+template <typename Store>
+void BasicCommandExecutor<Store>::setClockOriginToCurrentTimestamp(unsigned long timestamp)
 {
     signed long newCumulativeDuration;
 
@@ -317,18 +384,21 @@ void CommandExecutor::setClockOriginToCurrentTimestamp(unsigned long timestamp)
     m_cumulativeDurationSinceStart = (newCumulativeDuration < 0) ? 0 : newCumulativeDuration;
 }
 
-void CommandExecutor::setCurrentColor(sb_rgb_color_t color)
+template <typename Store>
+void BasicCommandExecutor<Store>::setCurrentColor(sb_rgb_color_t color)
 {
     m_currentColor = color;
 }
 
-void CommandExecutor::setCurrentColorAndResetTransition(sb_rgb_color_t color)
+template <typename Store>
+void BasicCommandExecutor<Store>::setCurrentColorAndResetTransition(sb_rgb_color_t color)
 {
     setCurrentColor(color);
     m_transitionHandler.startColor = color;
 }
 
-unsigned long CommandExecutor::step(unsigned long now)
+template <typename Store>
+unsigned long BasicCommandExecutor<Store>::step(unsigned long now)
 {
     if (m_resetClockFlag) {
         setClockOriginToCurrentTimestamp(now);
@@ -365,7 +435,8 @@ unsigned long CommandExecutor::step(unsigned long now)
     return m_nextWakeupTime;
 }
 
-void CommandExecutor::stop()
+template <typename Store>
+void BasicCommandExecutor<Store>::stop()
 {
     m_ended = true;
 }
@@ -374,96 +445,99 @@ void CommandExecutor::stop()
 /* Command handlers */
 /********************/
 
-void CommandExecutor::handleFadeToBlackCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleFadeToBlackCommand(const DecodedInstruction& insn)
 {
-    fadeColorOfLEDStrip(SB_COLOR_BLACK);
+    fadeColorOfLEDStrip(SB_COLOR_BLACK, insn.value);
 }
 
-void CommandExecutor::handleFadeToColorCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleFadeToColorCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
 
-    color.red = nextByte();
-    color.green = nextByte();
-    color.blue = nextByte();
+    color.red = insn.args[0];
+    color.green = insn.args[1];
+    color.blue = insn.args[2];
 
-    fadeColorOfLEDStrip(color);
+    fadeColorOfLEDStrip(color, insn.value);
 }
 
-void CommandExecutor::handleFadeToColorFromChannelsCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleFadeToColorFromChannelsCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
-    uint8_t channelIndices[3];
-
-    channelIndices[0] = nextByte();
-    channelIndices[1] = nextByte();
-    channelIndices[2] = nextByte();
+    const uint8_t* channelIndices = insn.args;
 
     if (m_pSignalSource == 0) {
-        SET_ERROR(Errors::OPERATION_NOT_SUPPORTED);
+        errorHandler()->setError(Errors::OPERATION_NOT_SUPPORTED);
         color.red = color.green = color.blue = 0;
     } else {
         uint8_t numChannels = m_pSignalSource->numChannels();
 
         if (channelIndices[0] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.red = 0;
         } else {
             color.red = m_pSignalSource->filteredChannelValue(channelIndices[0]);
         }
 
         if (channelIndices[1] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.green = 0;
         } else {
             color.green = m_pSignalSource->filteredChannelValue(channelIndices[1]);
         }
 
         if (channelIndices[2] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.blue = 0;
         } else {
             color.blue = m_pSignalSource->filteredChannelValue(channelIndices[2]);
         }
     }
 
-    fadeColorOfLEDStrip(color);
+    fadeColorOfLEDStrip(color, insn.value);
 }
 
-void CommandExecutor::handleFadeToGrayCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleFadeToGrayCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
 
-    color.red = color.green = color.blue = nextByte();
+    color.red = color.green = color.blue = insn.args[0];
 
-    fadeColorOfLEDStrip(color);
+    fadeColorOfLEDStrip(color, insn.value);
 }
 
-void CommandExecutor::handleFadeToWhiteCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleFadeToWhiteCommand(const DecodedInstruction& insn)
 {
-    fadeColorOfLEDStrip(SB_COLOR_WHITE);
+    fadeColorOfLEDStrip(SB_COLOR_WHITE, insn.value);
 }
 
-void CommandExecutor::handleJumpCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleJumpCommand(const DecodedInstruction& insn)
 {
-    unsigned long address = nextVarint();
+    unsigned long address = insn.value;
 
     if (isAddressValid(address)) {
         m_pBytecodeStore->seek(address);
         m_loopStack.clear();
     } else {
-        SET_ERROR(Errors::INVALID_ADDRESS);
+        errorHandler()->setError(Errors::INVALID_ADDRESS);
         stop();
     }
 }
 
-void CommandExecutor::handleLoopBeginCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleLoopBeginCommand(const DecodedInstruction& insn)
 {
-    uint8_t iterations = nextByte();
+    uint8_t iterations = insn.args[0];
     bytecode_location_t location = m_pBytecodeStore->tell();
 
     if (location == BYTECODE_LOCATION_NOWHERE) {
-        SET_ERROR(Errors::OPERATION_NOT_SUPPORTED);
+        errorHandler()->setError(Errors::OPERATION_NOT_SUPPORTED);
         stop();
         return;
     }
@@ -471,7 +545,8 @@ void CommandExecutor::handleLoopBeginCommand()
     m_loopStack.begin(location, iterations);
 }
 
-void CommandExecutor::handleLoopEndCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleLoopEndCommand()
 {
     bytecode_location_t jumpTo = m_loopStack.end();
 
@@ -480,14 +555,16 @@ void CommandExecutor::handleLoopEndCommand()
     }
 }
 
-void CommandExecutor::handleResetClockCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleResetClockCommand()
 {
     setClockOriginToCurrentTimestamp(m_currentCommandStartTime);
 }
 
-void CommandExecutor::handleSetPyroCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetPyroCommand(const DecodedInstruction& insn)
 {
-    uint8_t channelMask = nextByte();
+    uint8_t channelMask = insn.args[0];
 
     if (channelMask & 128) {
         m_currentPyroChannels |= (channelMask & 127);
@@ -496,95 +573,99 @@ void CommandExecutor::handleSetPyroCommand()
     }
 }
 
-void CommandExecutor::handleSetPyroAllCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetPyroAllCommand(const DecodedInstruction& insn)
 {
-    uint8_t channelValues = nextByte();
+    uint8_t channelValues = insn.args[0];
     m_currentPyroChannels = channelValues & 127;
 }
 
-void CommandExecutor::handleSetBlackCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetBlackCommand(const DecodedInstruction& insn)
 {
-    handleDelayByte();
+    handleDelay(insn.value);
     setCurrentColorAndResetTransition(SB_COLOR_BLACK);
 }
 
-void CommandExecutor::handleSetColorCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetColorCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
 
-    color.red = nextByte();
-    color.green = nextByte();
-    color.blue = nextByte();
+    color.red = insn.args[0];
+    color.green = insn.args[1];
+    color.blue = insn.args[2];
 
-    handleDelayByte();
+    handleDelay(insn.value);
     setCurrentColorAndResetTransition(color);
 }
 
-void CommandExecutor::handleSetColorFromChannelsCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetColorFromChannelsCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
-    uint8_t channelIndices[3];
-
-    channelIndices[0] = nextByte();
-    channelIndices[1] = nextByte();
-    channelIndices[2] = nextByte();
+    const uint8_t* channelIndices = insn.args;
 
     if (m_pSignalSource == 0) {
-        SET_ERROR(Errors::OPERATION_NOT_SUPPORTED);
+        errorHandler()->setError(Errors::OPERATION_NOT_SUPPORTED);
         color.red = color.green = color.blue = 0;
     } else {
         uint8_t numChannels = m_pSignalSource->numChannels();
 
         if (channelIndices[0] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.red = 0;
         } else {
             color.red = m_pSignalSource->filteredChannelValue(channelIndices[0]);
         }
 
         if (channelIndices[1] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.green = 0;
         } else {
             color.green = m_pSignalSource->filteredChannelValue(channelIndices[1]);
         }
 
         if (channelIndices[2] >= numChannels) {
-            SET_ERROR(Errors::INVALID_CHANNEL_INDEX);
+            errorHandler()->setError(Errors::INVALID_CHANNEL_INDEX);
             color.blue = 0;
         } else {
             color.blue = m_pSignalSource->filteredChannelValue(channelIndices[2]);
         }
     }
 
-    handleDelayByte();
+    handleDelay(insn.value);
     setCurrentColorAndResetTransition(color);
 }
 
-void CommandExecutor::handleSetGrayCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetGrayCommand(const DecodedInstruction& insn)
 {
     sb_rgb_color_t color;
 
-    color.red = color.green = color.blue = nextByte();
+    color.red = color.green = color.blue = insn.args[0];
 
-    handleDelayByte();
+    handleDelay(insn.value);
     setCurrentColorAndResetTransition(color);
 }
 
-void CommandExecutor::handleSetWhiteCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSetWhiteCommand(const DecodedInstruction& insn)
 {
-    handleDelayByte();
+    handleDelay(insn.value);
     setCurrentColorAndResetTransition(SB_COLOR_WHITE);
 }
 
-void CommandExecutor::handleSleepCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleSleepCommand(const DecodedInstruction& insn)
 {
-    handleDelayByte();
+    handleDelay(insn.value);
 }
 
-void CommandExecutor::handleTriggeredJumpCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleTriggeredJumpCommand(const DecodedInstruction& insn)
 {
-    uint8_t triggerParams = nextByte();
+    uint8_t triggerParams = insn.args[0];
     unsigned long address = 0;
     uint8_t channelIndex;
     uint8_t willNeedAddress;
@@ -608,7 +689,7 @@ void CommandExecutor::handleTriggeredJumpCommand()
     }
     willNeedAddress = (edge != 0);
     if (willNeedAddress) {
-        address = nextVarint();
+        address = insn.value;
     }
 
     // Also extract the channel index
@@ -616,14 +697,14 @@ void CommandExecutor::handleTriggeredJumpCommand()
 
     // Validate the address and send an error signal if it is invalid
     if (willNeedAddress && !isAddressValid(address)) {
-        SET_ERROR(Errors::INVALID_ADDRESS);
+        errorHandler()->setError(Errors::INVALID_ADDRESS);
         stop();
     }
 
     // Find the trigger corresponding to the channel
     pTrigger = findTriggerForChannelIndex(channelIndex);
     if (pTrigger == 0) {
-        SET_ERROR(Errors::NO_MORE_AVAILABLE_TRIGGERS);
+        errorHandler()->setError(Errors::NO_MORE_AVAILABLE_TRIGGERS);
         stop();
     } else {
         pTrigger->watchChannel(m_pSignalSource, channelIndex, edge);
@@ -635,10 +716,14 @@ void CommandExecutor::handleTriggeredJumpCommand()
     }
 }
 
-void CommandExecutor::handleWaitUntilCommand()
+template <typename Store>
+void BasicCommandExecutor<Store>::handleWaitUntilCommand(const DecodedInstruction& insn)
 {
-    unsigned long deadlineInHalfFrames = nextVarint();
-
-    delayExecutionUntil(deadlineInHalfFrames * 20);
+    delayExecutionUntil(insn.value);
     m_cumulativeDurationSinceStart = absoluteToInternalTime(m_nextWakeupTime);
 }
+
+/* Explicit instantiations for the bytecode stores used in the library */
+template class BasicCommandExecutor<BytecodeStore>;
+template class BasicCommandExecutor<ArrayBytecodeStore>;
+template class BasicCommandExecutor<DecodedBytecodeStore>;
@@ -26,7 +26,10 @@
 #define SKYBRUSH_LIGHTS_EXECUTOR_H
 
 #include <skybrush/colors.h>
+#include <skybrush/perf_counters.h>
 
+#include "decoded_program.h"
+#include "error_handler.h"
 #include "errors.h"
 #include "light_player_config.h"
 #include "loop_stack.h"
@@ -35,7 +38,6 @@
 #include "trigger.h"
 
 class BytecodeStore;
-class CommandExecutor;
 class SignalSource;
 
 /**
@@ -45,13 +47,16 @@ class SignalSource;
  * single floating-point number between 0 and 1 and invokes the
  * \c setColor() method of an associated command executor with
  * a linearly interpolated color between a given start and end color.
+ *
+ * \tparam  Executor  the type of the command executor
  */
+template <typename Executor>
 class CommandExecutorTransitionHandler {
 private:
     /**
      * The executor that the transition handler is associated to.
      */
-    CommandExecutor* m_pExecutor;
+    Executor* m_pExecutor;
 
 public:
     /**
@@ -68,7 +73,7 @@ public:
     /**
      * Constructor.
      */
-    explicit CommandExecutorTransitionHandler(CommandExecutor* pExecutor = 0)
+    explicit CommandExecutorTransitionHandler(Executor* pExecutor = 0)
         : m_pExecutor(pExecutor)
         , startColor()
         , endColor()
@@ -78,7 +83,7 @@ public:
     /**
      * Returns the command executor that the handler talks to.
      */
-    CommandExecutor* executor() const
+    Executor* executor() const
     {
         return m_pExecutor;
     }
@@ -86,7 +91,7 @@ public:
     /**
      * Sets the command executor that the handler talks to.
      */
-    void setExecutor(CommandExecutor* value)
+    void setExecutor(Executor* value)
     {
         m_pExecutor = value;
     }
@@ -96,26 +101,87 @@ public:
      *
      * @param value  the interpolation factor between the start and end color
      */
-    void operator()(float value) const;
+    void operator()(float value) const
+    {
+        m_pExecutor->setCurrentColor(sb_rgb_color_linear_interpolation(startColor, endColor, value));
+    }
+
+    /**
+     * @brief Invokes the \c setColor() method of the executor with an interpolated
+     * color, using fixed-point arithmetic.
+     *
+     * @param value  the interpolation factor between the start and end color,
+     *        in units of 1 / \c TRANSITION_FIXED_ONE
+     */
+    void operator()(transition_fixed_progress_t value) const
+    {
+        static_assert(TRANSITION_FIXED_ONE == SB_RGB_COLOR_FIXED_RATIO_ONE,
+            "fixed-point transition progress must match the fixed-point color interpolation ratio");
+        m_pExecutor->setCurrentColor(sb_rgb_color_linear_interpolation_fixed(startColor, endColor, value));
+    }
 };
 
+/**
+ * \brief Plain-old-data representation of the state of a command executor.
+ *
+ * Used to save the state of an executor and restore it later, possibly in
+ * another process, without executing the bytecode again from its start. The
+ * state refers to locations in the bytecode store so it can only be restored
+ * into an executor that executes the same bytecode.
+ */
+typedef struct
+{
+    bytecode_location_t location; /**< Location of the next instruction in the store */
+    sb_rgb_color_t currentColor; /**< Current color of the executor */
+    uint8_t currentPyroChannels; /**< Current values of the pyro channels */
+    bool ended; /**< Whether the executor has reached the end of the bytecode */
+    bool resetClockFlag; /**< Whether a clock reset is pending */
+    uint8_t numLoops; /**< Number of active loops */
+    LoopStackItem loops[CONFIG_MAX_LOOP_DEPTH]; /**< Active loops, outermost first */
+    unsigned long cumulativeDurationSinceStart; /**< Total expected duration of executed commands */
+    unsigned long currentCommandStartTime; /**< Start time of the current command */
+    unsigned long lastClockResetTime; /**< Time of the last clock reset */
+    unsigned long nextWakeupTime; /**< Time when the next command is due */
+    float clockSkewCompensationFactor; /**< Clock skew compensation factor */
+    bool transitionActive; /**< Whether a color transition is in progress */
+    uint8_t transitionEasingMode; /**< Easing mode of the color transition */
+    unsigned long transitionStartTime; /**< Start time of the color transition */
+    unsigned long transitionDuration; /**< Duration of the color transition */
+    sb_rgb_color_t transitionStartColor; /**< Start color of the color transition */
+    sb_rgb_color_t transitionEndColor; /**< End color of the color transition */
+} CommandExecutorState;
+
 /**
  * Executes commands that control the attached LED strip.
+ *
+ * \tparam  Store  the type of the bytecode store that the executor reads
+ *          from. Use \c BytecodeStore to accept any store through virtual
+ *          calls, or a concrete \c final store class to let the compiler
+ *          inline the store accessors into the decoding loop. The member
+ *          functions are explicitly instantiated in \c executor.cpp for the
+ *          store types used by the library.
  */
-class CommandExecutor {
-    friend class CommandExecutorTransitionHandler;
+template <typename Store>
+class BasicCommandExecutor {
+    friend class CommandExecutorTransitionHandler<BasicCommandExecutor>;
 
 private:
     /**
      * Object managing access to the bytecode being executed.
      */
-    BytecodeStore* m_pBytecodeStore;
+    Store* m_pBytecodeStore;
 
     /**
      * Object managing access to the values of the signal channels (typically from a remote controller).
      */
     SignalSource* m_pSignalSource;
 
+    /**
+     * Error handler that the executor reports errors to; null if the executor
+     * uses the global error handler returned by \c getErrorHandler().
+     */
+    ErrorHandler* m_pErrorHandler;
+
     /**
      * The current color calculated by the command executor. This is the color
      * that should be forwarded to the LED strip.
@@ -188,25 +254,32 @@ private:
      * Auxiliary structure for handling color transitions on the LED strip.
      * Maintains the time-related state variables of the current transition.
      */
-    Transition<CommandExecutorTransitionHandler> m_transition;
+    Transition<CommandExecutorTransitionHandler<BasicCommandExecutor> > m_transition;
 
     /**
      * Auxiliary structure for handling color transitions on the LED strip.
      * Maintains the color-related state variables of the current transition
      * and propagates the calculated color back to the command executor.
      */
-    CommandExecutorTransitionHandler m_transitionHandler;
+    CommandExecutorTransitionHandler<BasicCommandExecutor> m_transitionHandler;
 
     /**
      * Auxiliary structure for holding information about the triggers in the code.
      */
     Trigger m_triggers[CONFIG_MAX_TRIGGER_COUNT];
 
+#ifdef SB_ENABLE_PERF_COUNTERS
+    /**
+     * Performance counters of the executor and the player that owns it.
+     */
+    sb_perf_counters_t m_perfCounters;
+#endif
+
 public:
     /**
      * \brief Constructor.
      */
-    explicit CommandExecutor();
+    explicit BasicCommandExecutor();
 
     /**
      * \brief Converts a time instant given in milliseconds on the internal clock of the
@@ -217,14 +290,54 @@ public:
      */
     signed long absoluteToInternalTime(unsigned long ms);
 
+#ifdef SB_ENABLE_PERF_COUNTERS
+    /**
+     * \brief Returns the performance counters of the executor.
+     */
+    sb_perf_counters_t& perfCounters()
+    {
+        return m_perfCounters;
+    }
+
+    /**
+     * \brief Returns the performance counters of the executor.
+     */
+    const sb_perf_counters_t& perfCounters() const
+    {
+        return m_perfCounters;
+    }
+#endif
+
     /**
      * \brief Returns the bytecode store that the executor will use.
      */
-    BytecodeStore* bytecodeStore() const
+    Store* bytecodeStore() const
     {
         return m_pBytecodeStore;
     }
 
+    /**
+     * \brief Returns the error handler that the executor reports errors to.
+     */
+    ErrorHandler* errorHandler() const
+    {
+        return m_pErrorHandler ? m_pErrorHandler : getErrorHandler();
+    }
+
+    /**
+     * \brief Sets the error handler that the executor reports errors to.
+     *
+     * Executors that run concurrently on different threads must each have
+     * their own error handler because the global one is not thread-safe.
+     *
+     * \param  handler  the error handler to use; null to use the global error
+     *          handler returned by \c getErrorHandler()
+     */
+    void setErrorHandler(ErrorHandler* handler)
+    {
+        m_pErrorHandler = handler;
+    }
+
     /**
      * \brief Returns the value of the internal clock of the executor, assuming
      *        that the clock of the host device is at the given timestamp.
@@ -313,10 +426,30 @@ public:
         m_resetClockFlag = true;
     }
 
+    /**
+     * \brief Restores a state saved earlier with \c saveState().
+     *
+     * The executor must already be attached to a bytecode store that contains
+     * the same bytecode that the state was saved from. Restoring takes
+     * constant time; no bytecode is executed.
+     */
+    void restoreState(const CommandExecutorState& state);
+
+    /**
+     * \brief Saves the current state of the executor.
+     *
+     * Triggers are not part of the saved state because they refer to the
+     * signal source of the executor.
+     *
+     * \return \c true if the state was saved, \c false if it cannot be saved
+     *         because a trigger is active or the bytecode store is suspended
+     */
+    bool saveState(CommandExecutorState& state) const;
+
     /**
      * \brief Sets the bytecode store that the executor will use.
      */
-    void setBytecodeStore(BytecodeStore* pBytecodeStore)
+    void setBytecodeStore(Store* pBytecodeStore)
     {
         m_pBytecodeStore = pBytecodeStore;
         rewind();
@@ -425,8 +558,9 @@ private:
      * Common code segment for the different \c "handleFadeTo..." commands.
      *
      * \param  color       the target color
+     * \param  duration    the duration of the fade, in milliseconds
      */
-    void fadeColorOfLEDStrip(sb_rgb_color_t color);
+    void fadeColorOfLEDStrip(sb_rgb_color_t color, unsigned long duration);
 
     /**
      * \brief Finds a trigger that will handle the given channel.
@@ -444,54 +578,48 @@ private:
     Trigger* findTriggerForChannelIndex(uint8_t channelIndex);
 
     /**
-     * \brief Interprets the next byte from the bytecode as a duration and
-     *        sets the next wakeup time of the executor appropriately.
-     *
-     * \return  the parsed duration
-     */
-    unsigned long handleDelayByte();
-
-    /**
-     * \brief Interprets the next byte from the bytecode as an easing mode.
+     * \brief Advances the internal clock of the executor by the given
+     *        duration and sets the next wakeup time of the executor
+     *        appropriately.
      *
-     * \return  the parsed easing mode
+     * \param  duration  the duration of the delay, in milliseconds
      */
-    EasingMode handleEasingModeByte();
+    void handleDelay(unsigned long duration);
 
     /**
      * \brief Handles the execution of \c CMD_FADE_TO_BLACK commands.
      */
-    void handleFadeToBlackCommand();
+    void handleFadeToBlackCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_FADE_TO_COLOR commands.
      */
-    void handleFadeToColorCommand();
+    void handleFadeToColorCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_FADE_TO_COLOR_FROM_CHANNELS commands.
      */
-    void handleFadeToColorFromChannelsCommand();
+    void handleFadeToColorFromChannelsCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_FADE_TO_GRAY commands.
      */
-    void handleFadeToGrayCommand();
+    void handleFadeToGrayCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_FADE_TO_WHITE commands.
      */
-    void handleFadeToWhiteCommand();
+    void handleFadeToWhiteCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_JUMP commands.
      */
-    void handleJumpCommand();
+    void handleJumpCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_LOOP_BEGIN commands.
      */
-    void handleLoopBeginCommand();
+    void handleLoopBeginCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_LOOP_END commands.
@@ -506,70 +634,52 @@ private:
     /**
      * \brief Handles the execution of \c CMD_PYRO_SET commands.
      */
-    void handleSetPyroCommand();
+    void handleSetPyroCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_PYRO_SET_ALL commands.
      */
-    void handleSetPyroAllCommand();
+    void handleSetPyroAllCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SET_BLACK commands.
      */
-    void handleSetBlackCommand();
+    void handleSetBlackCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SET_COLOR commands.
      */
-    void handleSetColorCommand();
+    void handleSetColorCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SET_COLOR_FROM_CHANNELS commands.
      */
-    void handleSetColorFromChannelsCommand();
+    void handleSetColorFromChannelsCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SET_GRAY commands.
      */
-    void handleSetGrayCommand();
+    void handleSetGrayCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SET_WHITE commands.
      */
-    void handleSetWhiteCommand();
+    void handleSetWhiteCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_SLEEP commands.
      */
-    void handleSleepCommand();
+    void handleSleepCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_TRIGGERED_JUMP commands.
      */
-    void handleTriggeredJumpCommand();
+    void handleTriggeredJumpCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Handles the execution of \c CMD_WAIT_UNTIL commands.
      */
-    void handleWaitUntilCommand();
-
-    /**
-     * \brief Reads the next byte from the bytecode and advances the
-     *        execution pointer.
-     */
-    uint8_t nextByte();
-
-    /**
-     * \brief Reads the next byte from the bytecode, interprets it as a
-     *        duration and advances the execution pointer.
-     */
-    unsigned long nextDuration();
-
-    /**
-     * \brief Reads the next varint from the bytecode and advances the
-     *        execution pointer.
-     */
-    unsigned long nextVarint();
+    void handleWaitUntilCommand(const DecodedInstruction& insn);
 
     /**
      * \brief Sets the color of the LED strip to the given color.
@@ -598,4 +708,9 @@ private:
     void setClockOriginToCurrentTimestamp(unsigned long timestamp);
 };
 
+/**
+ * Command executor that accepts any bytecode store through virtual calls.
+ */
+typedef BasicCommandExecutor<BytecodeStore> CommandExecutor;
+
 #endif
@@ -0,0 +1,264 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <string.h>
+
+#include <skybrush/lights.h>
+#include <skybrush/memory.h>
+
+#include "../parallel.h"
+#include "bytecode_player.h"
+#include "decoded_program.h"
+#include "error_handler.h"
+
+/**
+ * \brief Error handler that records the last error of a single member of a
+ * light fleet player.
+ *
+ * The members of a fleet may be evaluated on worker threads, where reporting
+ * errors to the global error handler would be a data race. Errors are
+ * recorded here instead and forwarded to the global error handler on the
+ * calling thread after the evaluation.
+ */
+class FleetPlayerErrorRecorder : public ErrorHandler {
+public:
+    /**
+     * \brief Returns the code of the last error that happened in the player.
+     */
+    Errors::Code lastError() const
+    {
+        return m_error;
+    }
+
+protected:
+    void handleError(Errors::Code) override {};
+};
+
+/**
+ * \brief A single member of a light fleet player.
+ *
+ * Holds the pre-decoded light program, the store that serves its
+ * instructions and the player that reads from the store next to each other
+ * so a whole fleet can be laid out in a single contiguous array. Light
+ * programs are decoded once when the fleet is set up so seeking back and
+ * forth in time does not need to decode the bytecode over and over again.
+ */
+class FleetPlayerSlot {
+public:
+    /**
+     * The pre-decoded light program of the player.
+     */
+    DecodedProgram program;
+
+    /**
+     * The store that serves the instructions of the decoded light program.
+     */
+    DecodedBytecodeStore store;
+
+    /**
+     * The player that plays the light program.
+     */
+    DecodedBytecodePlayer player;
+
+    /**
+     * Records the errors of the player so they can be reported on the
+     * calling thread.
+     */
+    FleetPlayerErrorRecorder errors;
+
+    /**
+     * Constructor. Creates a slot with an empty light program.
+     */
+    explicit FleetPlayerSlot()
+        : program()
+        , store(program)
+        , player()
+        , errors()
+    {
+        player.setErrorHandler(&errors);
+        player.setBytecodeStore(&store);
+    }
+
+    /**
+     * \brief Decodes the given light program and prepares the player to play it.
+     *
+     * \param  source  the light program that the player will play
+     * \return \c true if the program was loaded, \c false if there was not
+     *         enough memory to decode it
+     */
+    bool load(const sb_light_program_t* source)
+    {
+        if (!program.decode(source->buffer, source->buffer_length)) {
+            return false; /* LCOV_EXCL_LINE */
+        }
+
+        store = DecodedBytecodeStore(program);
+        player.setBytecodeStore(&store);
+
+        return true;
+    }
+
+private:
+    /**
+     * Copy constructor. Intentionally deleted because the player holds a
+     * pointer to the store next to it.
+     */
+    FleetPlayerSlot(FleetPlayerSlot const&) = delete;
+
+    /**
+     * Assignment operator. Intentionally deleted because the player holds a
+     * pointer to the store next to it.
+     */
+    void operator=(FleetPlayerSlot const&) = delete;
+};
+
+/**
+ * \brief Arguments of a single evaluation of the fleet, shared between threads.
+ */
+typedef struct {
+    FleetPlayerSlot* slots;
+    unsigned long timestamp;
+    sb_rgb_color_t* colors;
+    uint8_t* pyro_channels;
+} sb_i_light_fleet_player_evaluation_t;
+
+static sb_error_t sb_i_light_fleet_player_evaluate_range(void* context, size_t start, size_t end);
+
+#define SLOTS (static_cast<FleetPlayerSlot*>(fleet->players))
+
+sb_error_t sb_light_fleet_player_init(
+    sb_light_fleet_player_t* fleet, const sb_light_program_t* programs,
+    size_t num_programs)
+{
+    FleetPlayerSlot* slots;
+    size_t i;
+
+    if (programs == 0 && num_programs > 0) {
+        return SB_EINVAL;
+    }
+
+    memset(fleet, 0, sizeof(sb_light_fleet_player_t));
+
+    if (num_programs > 0) {
+        slots = sb_calloc(FleetPlayerSlot, num_programs);
+        if (slots == 0) {
+            return SB_ENOMEM; /* LCOV_EXCL_LINE */
+        }
+
+        for (i = 0; i < num_programs; i++) {
+            new (&slots[i]) FleetPlayerSlot();
+        }
+
+        fleet->players = slots;
+        fleet->num_players = num_programs;
+
+        for (i = 0; i < num_programs; i++) {
+            if (!slots[i].load(&programs[i])) {
+                /* LCOV_EXCL_START */
+                sb_light_fleet_player_destroy(fleet);
+                return SB_ENOMEM;
+                /* LCOV_EXCL_STOP */
+            }
+        }
+    }
+
+    fleet->num_threads = 1;
+
+    return SB_SUCCESS;
+}
+
+void sb_light_fleet_player_destroy(sb_light_fleet_player_t* fleet)
+{
+    size_t i;
+
+    if (fleet->players) {
+        for (i = 0; i < fleet->num_players; i++) {
+            SLOTS[i].~FleetPlayerSlot();
+        }
+
+        sb_free(fleet->players);
+    }
+
+    memset(fleet, 0, sizeof(sb_light_fleet_player_t));
+}
+
+size_t sb_light_fleet_player_size(const sb_light_fleet_player_t* fleet)
+{
+    return fleet->num_players;
+}
+
+void sb_light_fleet_player_set_num_threads(
+    sb_light_fleet_player_t* fleet, size_t num_threads)
+{
+    fleet->num_threads = num_threads;
+}
+
+sb_error_t sb_light_fleet_player_evaluate_at(
+    sb_light_fleet_player_t* fleet, unsigned long timestamp,
+    sb_rgb_color_t* colors, uint8_t* pyro_channels)
+{
+    sb_i_light_fleet_player_evaluation_t evaluation;
+    size_t i;
+
+    evaluation.slots = SLOTS;
+    evaluation.timestamp = timestamp;
+    evaluation.colors = colors;
+    evaluation.pyro_channels = pyro_channels;
+
+    SB_CHECK(sb_i_parallel_for(
+        fleet->num_players, fleet->num_threads,
+        sb_i_light_fleet_player_evaluate_range, &evaluation));
+
+    /* Forward the first error of the players to the global error handler,
+     * now that we are back on the calling thread */
+    for (i = 0; i < fleet->num_players; i++) {
+        if (SLOTS[i].errors.lastError() != Errors::SUCCESS) {
+            SET_ERROR(SLOTS[i].errors.lastError());
+            break;
+        }
+    }
+
+    return SB_SUCCESS;
+}
+
+#undef SLOTS
+
+/* ************************************************************************** */
+
+static sb_error_t sb_i_light_fleet_player_evaluate_range(void* context, size_t start, size_t end)
+{
+    sb_i_light_fleet_player_evaluation_t* evaluation = static_cast<sb_i_light_fleet_player_evaluation_t*>(context);
+    FleetPlayerSlot* slot = evaluation->slots + start;
+    size_t i;
+
+    for (i = start; i < end; i++, slot++) {
+        slot->player.seek(evaluation->timestamp);
+
+        if (evaluation->colors) {
+            evaluation->colors[i] = slot->player.currentColor();
+        }
+
+        if (evaluation->pyro_channels) {
+            evaluation->pyro_channels[i] = slot->player.currentPyroChannels();
+        }
+    }
+
+    return SB_SUCCESS;
+}
@@ -24,4 +24,10 @@
 #define CONFIG_MAX_LOOP_DEPTH 4
 #define CONFIG_MAX_TRIGGER_COUNT 4
 
+/* Evaluate color transitions with precomputed easing lookup tables and
+ * fixed-point color interpolation instead of floating-point math */
+#ifndef CONFIG_FIXED_POINT_TRANSITIONS
+#define CONFIG_FIXED_POINT_TRANSITIONS 1
+#endif
+
 #endif
@@ -21,7 +21,7 @@
 
 bool LoopStack::begin(bytecode_location_t location, uint8_t iterations)
 {
-    if (m_pTopItem >= m_items + CONFIG_MAX_LOOP_DEPTH) {
+    if (m_pTopItem >= m_items + CONFIG_MAX_LOOP_DEPTH - 1) {
         return false;
     }
 
@@ -60,3 +60,19 @@ bytecode_location_t LoopStack::end()
         return BYTECODE_LOCATION_NOWHERE;
     }
 }
+
+void LoopStack::restore(const LoopStackItem* items, uint8_t numLoops)
+{
+    uint8_t i;
+
+    if (numLoops > CONFIG_MAX_LOOP_DEPTH) {
+        numLoops = CONFIG_MAX_LOOP_DEPTH;
+    }
+
+    for (i = 0; i < numLoops; i++) {
+        m_items[i] = items[i];
+    }
+
+    m_numLoops = numLoops;
+    m_pTopItem = numLoops > 0 ? m_items + numLoops - 1 : 0;
+}
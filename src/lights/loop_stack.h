@@ -119,6 +119,25 @@ public:
      */
     bytecode_location_t end();
 
+    /**
+     * Returns a pointer to the items in the loop stack, starting from the
+     * outermost loop. Only the first \ref size() items are valid.
+     */
+    const LoopStackItem* items() const
+    {
+        return m_items;
+    }
+
+    /**
+     * Replaces the contents of the loop stack with the given items, starting
+     * from the outermost loop.
+     *
+     * \param  items     the items to copy into the loop stack
+     * \param  numLoops  the number of items to copy; it is clamped to the
+     *         maximum depth of the loop stack
+     */
+    void restore(const LoopStackItem* items, uint8_t numLoops);
+
     /**
      * Returns the number of active loops in the stack.
      */
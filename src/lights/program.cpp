@@ -57,7 +57,8 @@ sb_error_t sb_light_program_init_from_binary_file(sb_light_program_t* program, i
     sb_binary_file_parser_t parser;
     sb_error_t retval;
 
-    SB_CHECK(sb_binary_file_parser_init_from_file(&parser, fd));
+    SB_CHECK(sb_binary_file_parser_init_from_file_with_flags(
+        &parser, fd, SB_BINARY_PARSER_USE_CRC_CACHE));
     retval = sb_i_light_program_init_from_parser(program, &parser);
     sb_binary_file_parser_destroy(&parser);
 
@@ -77,6 +78,21 @@ sb_error_t sb_light_program_init_from_binary_file_in_memory(
     return retval;
 }
 
+sb_error_t sb_light_program_init_from_parser(sb_light_program_t* program, sb_binary_file_parser_t* parser)
+{
+    sb_binary_block_t block;
+    uint8_t* buf;
+
+    SB_CHECK(sb_binary_file_find_first_block_by_type(parser, SB_BINARY_BLOCK_LIGHT_PROGRAM));
+
+    if (sb_binary_file_get_current_block_view(parser, &buf) == SB_SUCCESS) {
+        block = sb_binary_file_get_current_block(parser);
+        return sb_light_program_init_from_buffer(program, buf, block.length);
+    }
+
+    return sb_i_light_program_init_from_parser(program, parser);
+}
+
 sb_error_t sb_i_light_program_init_from_parser(
     sb_light_program_t* program, sb_binary_file_parser_t* parser)
 {
@@ -133,15 +149,34 @@ static void sb_i_light_program_take_ownership(sb_light_program_t* program)
 
 /* ************************************************************************** */
 
-#define PLAYER (static_cast<BytecodePlayer*>(player->player))
-#define STORE (static_cast<BytecodeStore*>(player->store))
+/**
+ * Magic number at the start of light player snapshots.
+ */
+#define SB_I_LIGHT_PLAYER_SNAPSHOT_MAGIC 0x50534c53 /* "SLSP" */
 
-static void sb_i_light_player_set_store(sb_light_player_t* player, BytecodeStore* store);
+/**
+ * Internal layout of a light player snapshot.
+ */
+typedef struct
+{
+    uint32_t magic; /**< Magic number to recognize valid snapshots */
+    uint32_t program_length; /**< Length of the light program, for validation */
+    unsigned long next_timestamp; /**< Next timestamp of the light player */
+    BytecodePlayerState state; /**< State of the bytecode player */
+} sb_i_light_player_snapshot_t;
+
+static_assert(sizeof(sb_i_light_player_snapshot_t) <= SB_LIGHT_PLAYER_SNAPSHOT_SIZE,
+    "light player snapshot does not fit into sb_light_player_snapshot_t");
+
+#define PLAYER (static_cast<ArrayBytecodePlayer*>(player->player))
+#define STORE (static_cast<ArrayBytecodeStore*>(player->store))
+
+static void sb_i_light_player_set_store(sb_light_player_t* player, ArrayBytecodeStore* store);
 
 sb_error_t sb_light_player_init(sb_light_player_t* player, const sb_light_program_t* program)
 {
-    BytecodePlayer* new_player;
-    BytecodeStore* new_store;
+    ArrayBytecodePlayer* new_player;
+    ArrayBytecodeStore* new_store;
 
     if (program == 0) {
         return SB_EINVAL;
@@ -149,7 +184,7 @@ sb_error_t sb_light_player_init(sb_light_player_t* player, const sb_light_progra
 
     memset(player, 0, sizeof(sb_light_player_t));
 
-    new_player = new BytecodePlayer();
+    new_player = new ArrayBytecodePlayer();
     if (new_player == 0) {
         return SB_ENOMEM; /* LCOV_EXCL_LINE */
     }
@@ -180,9 +215,9 @@ void sb_light_player_destroy(sb_light_player_t* player)
     memset(player, 0, sizeof(sb_light_player_t));
 }
 
-static void sb_i_light_player_set_store(sb_light_player_t* player, BytecodeStore* store)
+static void sb_i_light_player_set_store(sb_light_player_t* player, ArrayBytecodeStore* store)
 {
-    BytecodeStore* oldStore = STORE;
+    ArrayBytecodeStore* oldStore = STORE;
     player->store = store;
     PLAYER->setBytecodeStore(store);
 
@@ -218,5 +253,75 @@ sb_bool_t sb_light_player_seek(
     return ended;
 }
 
+sb_error_t sb_light_player_save_snapshot(
+    const sb_light_player_t* player, sb_light_player_snapshot_t* snapshot)
+{
+    sb_i_light_player_snapshot_t data;
+
+    memset(&data, 0, sizeof(data));
+    if (!PLAYER->saveState(data.state)) {
+        return SB_EUNSUPPORTED;
+    }
+
+    data.magic = SB_I_LIGHT_PLAYER_SNAPSHOT_MAGIC;
+    data.program_length = player->program->buffer_length;
+    data.next_timestamp = player->next_timestamp;
+
+    memset(snapshot, 0, sizeof(sb_light_player_snapshot_t));
+    memcpy(snapshot->data, &data, sizeof(data));
+
+    return SB_SUCCESS;
+}
+
+sb_error_t sb_light_player_restore_snapshot(
+    sb_light_player_t* player, const sb_light_player_snapshot_t* snapshot)
+{
+    sb_i_light_player_snapshot_t data;
+    bytecode_location_t length = player->program->buffer_length;
+    uint8_t i;
+
+    memcpy(&data, snapshot->data, sizeof(data));
+
+    if (data.magic != SB_I_LIGHT_PLAYER_SNAPSHOT_MAGIC || data.program_length != player->program->buffer_length) {
+        return SB_EINVAL;
+    }
+
+    if (data.state.executor.location < 0 || data.state.executor.location > length || data.state.executor.numLoops > CONFIG_MAX_LOOP_DEPTH) {
+        return SB_EINVAL;
+    }
+
+    for (i = 0; i < data.state.executor.numLoops; i++) {
+        if (data.state.executor.loops[i].start < 0 || data.state.executor.loops[i].start > length) {
+            return SB_EINVAL;
+        }
+    }
+
+    PLAYER->restoreState(data.state);
+    player->next_timestamp = data.next_timestamp;
+
+    return SB_SUCCESS;
+}
+
+sb_error_t sb_light_player_get_perf_counters(
+    const sb_light_player_t* player, sb_perf_counters_t* result)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    *result = PLAYER->perfCounters();
+    return SB_SUCCESS;
+#else
+    memset(result, 0, sizeof(sb_perf_counters_t));
+    return SB_EUNSUPPORTED;
+#endif
+}
+
+void sb_light_player_reset_perf_counters(sb_light_player_t* player)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    memset(&PLAYER->perfCounters(), 0, sizeof(sb_perf_counters_t));
+#else
+    ((void)player);
+#endif
+}
+
 #undef PLAYER
 #undef STORE
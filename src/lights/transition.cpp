@@ -90,7 +90,7 @@ transition_progress_t easing_func_in_quad(transition_progress_t p)
 
 transition_progress_t easing_func_out_quad(transition_progress_t p)
 {
-    return p * p;
+    return -(p * (p - 2));
 }
 
 transition_progress_t easing_func_in_out_quad(transition_progress_t p)
@@ -125,7 +125,7 @@ transition_progress_t easing_func_out_quart(transition_progress_t p)
 
 transition_progress_t easing_func_in_out_quart(transition_progress_t p)
 {
-    return (p < 0.5f) ? 8 * powf(p, 4) : (-8 * powf(p, 4) + 1);
+    return (p < 0.5f) ? 8 * powf(p, 4) : (-8 * powf(p - 1, 4) + 1);
 }
 
 transition_progress_t easing_func_in_quint(transition_progress_t p)
@@ -25,6 +25,10 @@
 #ifndef SKYBRUSH_LIGHTS_TRANSITION_H
 #define SKYBRUSH_LIGHTS_TRANSITION_H
 
+#include <stdint.h>
+
+#include "light_player_config.h"
+
 /**
  * \brief Defines the floating-point type that transitions will use.
  *
@@ -33,6 +37,29 @@
  */
 typedef float transition_progress_t;
 
+/**
+ * \brief Defines the fixed-point type that transitions will use when
+ * \c CONFIG_FIXED_POINT_TRANSITIONS is enabled.
+ *
+ * Values of this type are expressed in units of 1 / \c TRANSITION_FIXED_ONE.
+ * The type is signed because some easing functions overshoot the [0; 1] range.
+ */
+typedef int32_t transition_fixed_progress_t;
+
+/**
+ * \brief The fixed-point representation of a progress value of 1.
+ */
+#define TRANSITION_FIXED_ONE 16384
+
+/**
+ * \brief Number of entries in each easing lookup table.
+ *
+ * Entries are spaced evenly between progress 0 and 1 (inclusive); the
+ * number of intervals between them must be a power of two that divides
+ * \c TRANSITION_FIXED_ONE.
+ */
+#define EASING_LUT_SIZE 129
+
 /**
  * \brief Easing modes for transitions.
  *
@@ -83,13 +110,55 @@ typedef transition_progress_t easing_function_t(transition_progress_t);
  */
 extern easing_function_t* const EASING_FUNCTIONS[NUM_EASING_FUNCTIONS];
 
+/**
+ * \brief Precomputed lookup tables of the easing functions in fixed-point
+ * representation, one for each easing mode.
+ *
+ * The tables are generated by \c etc/scripts/generate_easing_lut.cpp from
+ * \c EASING_FUNCTIONS and live in \c easing_lut.cpp .
+ */
+extern const int16_t EASING_LUTS[NUM_EASING_FUNCTIONS][EASING_LUT_SIZE];
+
+/**
+ * \brief Evaluates an easing function in fixed-point arithmetic.
+ *
+ * Uses the precomputed lookup table of the easing mode and interpolates
+ * linearly between the two nearest entries.
+ *
+ * \param  mode      the easing mode
+ * \param  progress  the progress of the transition before easing, in units
+ *         of 1 / \c TRANSITION_FIXED_ONE. Values outside the [0; 1] range
+ *         are clamped.
+ * \return the progress of the transition after easing, in units of
+ *         1 / \c TRANSITION_FIXED_ONE
+ */
+inline transition_fixed_progress_t easing_lut_evaluate(EasingMode mode, transition_fixed_progress_t progress)
+{
+    const int16_t* lut = EASING_LUTS[mode];
+    const int32_t step = TRANSITION_FIXED_ONE / (EASING_LUT_SIZE - 1);
+    int32_t index, remainder;
+
+    if (progress <= 0) {
+        return lut[0];
+    } else if (progress >= TRANSITION_FIXED_ONE) {
+        return lut[EASING_LUT_SIZE - 1];
+    }
+
+    index = progress / step;
+    remainder = progress - index * step;
+
+    return lut[index] + ((lut[index + 1] - lut[index]) * remainder) / step;
+}
+
 /**
  * \brief Encapsulates information about a color transition in progress on a LED strip.
  *
  * \tparam  TransitionHandler  a function that will be called with a single floating-point
  *             value between 0 and 1 from the \c step() method. The value
  *             corresponds to the progress of the transition after the
- *             easing function has been applied.
+ *             easing function has been applied. When
+ *             \c CONFIG_FIXED_POINT_TRANSITIONS is enabled, the handler is
+ *             called with a \c transition_fixed_progress_t instead.
  */
 template <typename TransitionHandler>
 class Transition {
@@ -142,6 +211,14 @@ public:
         m_active = false;
     }
 
+    /**
+     * Returns the duration of the current transition.
+     */
+    unsigned long duration() const
+    {
+        return m_duration;
+    }
+
     /**
      * Returns the current easing mode of the transition.
      */
@@ -171,6 +248,39 @@ public:
         }
     }
 
+    /**
+     * \brief Returns the progress of the transition \em before applying the easing
+     * function, in fixed-point representation.
+     *
+     * \param  clock  the value of the internal clock
+     * \return the progress of the transition expressed as a value between 0 and
+     *         \c TRANSITION_FIXED_ONE
+     */
+    transition_fixed_progress_t progressPreEasingFixed(unsigned long clock) const
+    {
+        unsigned long duration = m_duration;
+
+        if (clock < m_start) {
+            return 0;
+        } else if (duration == 0) {
+            return TRANSITION_FIXED_ONE;
+        }
+
+        clock -= m_start;
+        if (clock >= duration) {
+            return TRANSITION_FIXED_ONE;
+        }
+
+        /* Scale down long transitions so the multiplication below cannot overflow
+         * on platforms where unsigned long is 32 bits wide */
+        while (duration >= (1UL << 17)) {
+            duration >>= 1;
+            clock >>= 1;
+        }
+
+        return (clock * TRANSITION_FIXED_ONE) / duration;
+    }
+
     /**
      * \brief Returns the progress of the transition \em after applying the easing function.
      *
@@ -205,6 +315,14 @@ public:
         m_active = true;
     }
 
+    /**
+     * Returns the start time of the current transition.
+     */
+    unsigned long startTime() const
+    {
+        return m_start;
+    }
+
     /**
      * Makes a step in the transition, assuming that the internal
      * clock is at the given time.
@@ -217,12 +335,20 @@ public:
      */
     bool step(const TransitionHandler& handler, unsigned long clock)
     {
+#if CONFIG_FIXED_POINT_TRANSITIONS
+        transition_fixed_progress_t progress = progressPreEasingFixed(clock);
+
+        handler(easing_lut_evaluate(m_easingMode, progress));
+
+        m_active = progress < TRANSITION_FIXED_ONE;
+#else
         transition_progress_t progress = progressPreEasing(clock);
         transition_progress_t transformedProgress = EASING_FUNCTIONS[m_easingMode](progress);
 
         handler(transformedProgress);
 
         m_active = progress < 1;
+#endif
         return m_active;
     }
 };
@@ -0,0 +1,170 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "parallel.h"
+
+#ifdef SB_ENABLE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <skybrush/basic_types.h>
+#include <skybrush/memory.h>
+
+/**
+ * Returns the number of threads to use for processing the given number of
+ * items, given the number of threads requested by the user.
+ *
+ * \param  num_threads  the number of threads requested by the user; zero
+ *         means to use one thread per online CPU core
+ * \param  num_items    the number of items to process
+ * \return the number of threads to use; always at least 1 and at most the
+ *         number of items (unless there are no items at all)
+ */
+size_t sb_i_parallel_get_num_threads(size_t num_threads, size_t num_items)
+{
+#ifdef SB_ENABLE_THREADS
+    if (num_threads == 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cpus > 0 ? (size_t)num_cpus : 1;
+    }
+
+    if (num_threads > num_items) {
+        num_threads = num_items;
+    }
+
+    return num_threads > 0 ? num_threads : 1;
+#else
+    return 1;
+#endif
+}
+
+#ifdef SB_ENABLE_THREADS
+typedef struct {
+    sb_i_parallel_task_t* task;
+    void* context;
+    size_t start;
+    size_t end;
+    sb_error_t retval;
+} sb_i_parallel_job_t;
+
+static void* sb_i_parallel_job_run(void* arg)
+{
+    sb_i_parallel_job_t* job = (sb_i_parallel_job_t*)arg;
+    job->retval = job->task(job->context, job->start, job->end);
+    return 0;
+}
+#endif
+
+/**
+ * Processes the given number of items by splitting them into contiguous
+ * ranges of roughly equal size and calling the given task for each range,
+ * possibly from multiple threads.
+ *
+ * The calling thread processes the first range itself; additional threads
+ * are spawned for the remaining ranges and the function waits for all of
+ * them to finish before returning. Falls back to processing all the items
+ * on the calling thread if threads cannot be created.
+ *
+ * \param  num_items    the number of items to process
+ * \param  num_threads  the number of threads to use; zero means one thread
+ *         per online CPU core
+ * \param  task         the task to call for each range of items
+ * \param  context      arbitrary pointer that is passed to the task
+ * \return the first error code returned from any of the tasks, or
+ *         \c SB_SUCCESS if all the tasks succeeded
+ */
+sb_error_t sb_i_parallel_for(
+    size_t num_items, size_t num_threads, sb_i_parallel_task_t* task, void* context)
+{
+#ifdef SB_ENABLE_THREADS
+    sb_i_parallel_job_t* jobs;
+    pthread_t* threads;
+    sb_bool_t* started;
+    size_t i, chunk_size, remainder, start;
+    sb_error_t retval = SB_SUCCESS;
+#endif
+
+    if (num_items == 0) {
+        return SB_SUCCESS;
+    }
+
+#ifdef SB_ENABLE_THREADS
+    num_threads = sb_i_parallel_get_num_threads(num_threads, num_items);
+    if (num_threads <= 1) {
+        return task(context, 0, num_items);
+    }
+
+    jobs = sb_calloc(sb_i_parallel_job_t, num_threads);
+    threads = sb_calloc(pthread_t, num_threads);
+    started = sb_calloc(sb_bool_t, num_threads);
+    if (jobs == 0 || threads == 0 || started == 0) {
+        /* LCOV_EXCL_START */
+        sb_free_unless_null(jobs);
+        sb_free_unless_null(threads);
+        sb_free_unless_null(started);
+        return task(context, 0, num_items);
+        /* LCOV_EXCL_STOP */
+    }
+
+    chunk_size = num_items / num_threads;
+    remainder = num_items % num_threads;
+    start = 0;
+
+    for (i = 0; i < num_threads; i++) {
+        jobs[i].task = task;
+        jobs[i].context = context;
+        jobs[i].start = start;
+        jobs[i].end = start + chunk_size + (i < remainder ? 1 : 0);
+        jobs[i].retval = SB_SUCCESS;
+        start = jobs[i].end;
+    }
+
+    for (i = 1; i < num_threads; i++) {
+        started[i] = pthread_create(&threads[i], 0, sb_i_parallel_job_run, &jobs[i]) == 0;
+        if (!started[i]) {
+            sb_i_parallel_job_run(&jobs[i]); /* LCOV_EXCL_LINE */
+        }
+    }
+
+    sb_i_parallel_job_run(&jobs[0]);
+
+    for (i = 1; i < num_threads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], 0);
+        }
+    }
+
+    for (i = 0; i < num_threads; i++) {
+        if (jobs[i].retval != SB_SUCCESS) {
+            retval = jobs[i].retval;
+            break;
+        }
+    }
+
+    sb_free(jobs);
+    sb_free(threads);
+    sb_free(started);
+
+    return retval;
+#else
+    (void)num_threads;
+    return task(context, 0, num_items);
+#endif
+}
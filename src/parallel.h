@@ -0,0 +1,55 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file parallel.h
+ * \brief Internal helpers for splitting work across multiple threads
+ *
+ * Multi-threading is available only if the library was compiled with
+ * \c SB_ENABLE_THREADS defined (see the \c LIBSKYBRUSH_ENABLE_THREADS
+ * CMake option). Otherwise all the work is performed on the calling thread.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdlib.h>
+
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+
+__BEGIN_DECLS
+
+/**
+ * \brief Function prototype of a task that processes a contiguous range of items.
+ *
+ * \param  context  the context pointer passed to \ref sb_i_parallel_for()
+ * \param  start    index of the first item to process
+ * \param  end      index of the first item \em not to process
+ * \return error code to report back to the caller of \ref sb_i_parallel_for()
+ */
+typedef sb_error_t sb_i_parallel_task_t(void* context, size_t start, size_t end);
+
+size_t sb_i_parallel_get_num_threads(size_t num_threads, size_t num_items);
+sb_error_t sb_i_parallel_for(
+    size_t num_items, size_t num_threads, sb_i_parallel_task_t* task, void* context);
+
+__END_DECLS
+
+#endif
@@ -19,6 +19,10 @@
 
 #include "parsing.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * Parses a signed 16-bit little-endian integer from a buffer.
  *
@@ -29,6 +33,47 @@ int16_t sb_parse_int16(const uint8_t* buf, size_t* offset)
     return (int16_t)(sb_parse_uint16(buf, offset));
 }
 
+/**
+ * Parses a run of signed 16-bit little-endian integers from a buffer,
+ * converts them to floats and multiplies them with a common scaling factor.
+ *
+ * Uses SSE2 instructions to convert eight or four integers at once where
+ * available. The results are identical to calling \ref sb_parse_int16() for
+ * each integer and multiplying the result with the scaling factor.
+ *
+ * The offset is automatically advanced after reading the integers.
+ */
+void sb_parse_int16_array_scaled(const uint8_t* buf, size_t* offset, size_t count, float scale, float* result)
+{
+    const uint8_t* ptr = buf + *offset;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 scale_vec = _mm_set1_ps(scale);
+    __m128i values;
+
+    /* Unpacking each 16-bit lane with itself and shifting right by 16 bits
+     * sign-extends the values to 32 bits */
+    for (; i + 8 <= count; i += 8) {
+        values = _mm_loadu_si128((const __m128i*)(ptr + 2 * i));
+        _mm_storeu_ps(result + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16)), scale_vec));
+        _mm_storeu_ps(result + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16)), scale_vec));
+    }
+
+    if (i + 4 <= count) {
+        values = _mm_loadl_epi64((const __m128i*)(ptr + 2 * i));
+        _mm_storeu_ps(result + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16)), scale_vec));
+        i += 4;
+    }
+#endif
+
+    for (; i < count; i++) {
+        result[i] = ((int16_t)(ptr[2 * i] | (ptr[2 * i + 1] << 8))) * scale;
+    }
+
+    *offset += 2 * count;
+}
+
 /**
  * Parses a signed 32-bit little-endian integer from a buffer.
  *
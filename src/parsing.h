@@ -41,6 +41,7 @@ int16_t sb_parse_int16(const uint8_t* buf, size_t* offset);
 uint16_t sb_parse_uint16(const uint8_t* buf, size_t* offset);
 int32_t sb_parse_int32(const uint8_t* buf, size_t* offset);
 uint32_t sb_parse_uint32(const uint8_t* buf, size_t* offset);
+void sb_parse_int16_array_scaled(const uint8_t* buf, size_t* offset, size_t count, float scale, float* result);
 sb_error_t sb_parse_varuint32(const uint8_t* buf, size_t num_bytes, size_t* offset, uint32_t* result);
 
 __END_DECLS
@@ -0,0 +1,41 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file perf_counters.h
+ * \brief Internal helpers for maintaining performance counters
+ *
+ * The macros in this file expand to nothing unless the library is compiled
+ * with \c SB_ENABLE_PERF_COUNTERS defined.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <skybrush/perf_counters.h>
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+#define SB_PERF_COUNT(counters, field) ((counters).field++)
+#define SB_PERF_ADD(counters, field, value) ((counters).field += (value))
+#else
+#define SB_PERF_COUNT(counters, field) ((void)0)
+#define SB_PERF_ADD(counters, field, value) ((void)0)
+#endif
+
+#endif
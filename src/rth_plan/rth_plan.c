@@ -129,7 +129,8 @@ sb_error_t sb_rth_plan_init_from_binary_file(sb_rth_plan_t* plan, int fd)
     sb_binary_file_parser_t parser;
     sb_error_t retval;
 
-    SB_CHECK(sb_binary_file_parser_init_from_file(&parser, fd));
+    SB_CHECK(sb_binary_file_parser_init_from_file_with_flags(
+        &parser, fd, SB_BINARY_PARSER_USE_CRC_CACHE));
     retval = sb_i_rth_plan_init_from_parser(plan, &parser);
     sb_binary_file_parser_destroy(&parser);
 
@@ -160,6 +161,35 @@ sb_error_t sb_rth_plan_init_from_binary_file_in_memory(
     return retval;
 }
 
+/**
+ * Initializes an RTH plan object from the first RTH plan block found by an
+ * already open binary file parser.
+ *
+ * Memory-backed parsers yield a plan that refers to their buffer without
+ * copying it.
+ *
+ * \param plan  the object to initialize
+ * \param parser  the parser to read the block from
+ *
+ * \return \c SB_SUCCESS if the object was initialized successfully,
+ *         \c SB_ENOENT if the file did not contain an RTH plan block,
+ *         \c SB_EREAD for read errors
+ */
+sb_error_t sb_rth_plan_init_from_parser(sb_rth_plan_t* plan, sb_binary_file_parser_t* parser)
+{
+    sb_binary_block_t block;
+    uint8_t* buf;
+
+    SB_CHECK(sb_binary_file_find_first_block_by_type(parser, SB_BINARY_BLOCK_RTH_PLAN));
+
+    if (sb_binary_file_get_current_block_view(parser, &buf) == SB_SUCCESS) {
+        block = sb_binary_file_get_current_block(parser);
+        return sb_rth_plan_init_from_buffer(plan, buf, block.length);
+    }
+
+    return sb_i_rth_plan_init_from_parser(plan, parser);
+}
+
 sb_error_t sb_i_rth_plan_init_from_parser(sb_rth_plan_t* plan, sb_binary_file_parser_t* parser)
 {
     sb_error_t retval;
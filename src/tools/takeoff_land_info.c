@@ -18,26 +18,79 @@
  */
 
 #include <math.h>
+#include <skybrush/memory.h>
 #include <skybrush/skybrush.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
-#define SB_CHECK_MAIN(retval)                                  \
-    {                                                          \
-        if (retval != SB_SUCCESS) {                            \
-            printf("Error: %s\n", sb_error_to_string(retval)); \
-            return 1;                                          \
-        }                                                      \
-    }
+#include "../parallel.h"
+
+/**
+ * Options of the validator, as parsed from the command line.
+ */
+typedef struct {
+    size_t num_threads; /**< Number of threads to use; zero means auto */
+    sb_bool_t json; /**< Whether to produce JSON output instead of TSV */
+    sb_bool_t use_geofence; /**< Whether to check the bounding box against the geofence */
+    sb_bounding_box_t geofence; /**< The geofence, in millimeters */
+    float max_velocity_xy; /**< Maximum allowed horizontal velocity in mm/s; infinity if not checked */
+    float max_velocity_z; /**< Maximum allowed vertical velocity in mm/s; infinity if not checked */
+    float max_acceleration_xy; /**< Maximum allowed horizontal acceleration in mm/s^2; infinity if not checked */
+    float max_acceleration_z; /**< Maximum allowed vertical acceleration in mm/s^2; infinity if not checked */
+    sb_bool_t require_rth_plan; /**< Whether each file must have an RTH plan */
+} options_t;
+
+/**
+ * Results of validating a single show file.
+ */
+typedef struct {
+    const char* filename;
+    const char* error; /**< Empty string if the file passed all the checks */
+
+    sb_trajectory_stats_t stats;
+    float starts_at_altitude;
+    float ends_at_altitude;
+    float lands_from_altitude;
+    sb_trajectory_kinematic_peaks_t peaks;
+    sb_bounding_box_t bounding_box;
+    sb_bool_t has_light_program;
+    sb_bool_t has_rth_plan;
 
-static sb_error_t load_trajectory(sb_trajectory_t* trajectory, const char* filename)
+    double load_time_msec; /**< Time spent loading and parsing the file */
+    double check_time_msec; /**< Time spent running the checks */
+} report_t;
+
+typedef struct {
+    const options_t* options;
+    report_t* reports;
+} job_t;
+
+static double now_msec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static sb_error_t load_file(sb_buffer_t* buf, const char* filename)
 {
+    uint8_t chunk[4096];
+    size_t num_read;
     sb_error_t retval = SB_SUCCESS;
     FILE* fp = fopen(filename, "rb");
     if (fp == NULL) {
         return SB_EOPEN;
     }
 
-    retval = sb_trajectory_init_from_binary_file(trajectory, fileno(fp));
+    retval = sb_buffer_init(buf, 0);
+    while (retval == SB_SUCCESS && (num_read = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        retval = sb_buffer_append_bytes(buf, chunk, num_read);
+    }
+
+    if (retval == SB_SUCCESS && ferror(fp)) {
+        retval = SB_EREAD;
+    }
 
     fclose(fp);
 
@@ -59,76 +112,422 @@ static sb_error_t calculate_stats(const sb_trajectory_t* trajectory, sb_trajecto
     return retval;
 }
 
-int main(int argc, char* argv[])
+static sb_bool_t is_inside(const sb_bounding_box_t* box, const sb_bounding_box_t* fence)
+{
+    return box->x.min >= fence->x.min && box->x.max <= fence->x.max && box->y.min >= fence->y.min && box->y.max <= fence->y.max && box->z.min >= fence->z.min && box->z.max <= fence->z.max;
+}
+
+static const char* check_takeoff_and_landing(const sb_trajectory_t* trajectory, report_t* report)
 {
-    sb_trajectory_t trajectory;
     sb_trajectory_player_t player;
-    sb_trajectory_stats_t stats;
-    sb_bool_t first = 1;
     sb_vector3_with_yaw_t pos;
-    float starts_at_altitude;
-    float ends_at_altitude;
-    float lands_from_altitude;
+    const sb_trajectory_stats_t* stats = &report->stats;
+
+    if (!isfinite(stats->takeoff_time_sec)) {
+        return "takeoff time is not finite";
+    } else if (!isfinite(stats->landing_time_sec)) {
+        return "landing time is not finite";
+    } else if (stats->landing_time_sec < stats->takeoff_time_sec) {
+        return "landing time is before takeoff time";
+    }
+
+    if (sb_trajectory_player_init(&player, trajectory) != SB_SUCCESS) {
+        return "cannot play trajectory";
+    }
+
+    if (sb_trajectory_player_get_position_at(&player, 0, &pos) != SB_SUCCESS) {
+        sb_trajectory_player_destroy(&player);
+        return "cannot evaluate start position";
+    }
+    report->starts_at_altitude = pos.z;
+
+    if (sb_trajectory_player_get_position_at(&player, stats->duration_sec, &pos) != SB_SUCCESS) {
+        sb_trajectory_player_destroy(&player);
+        return "cannot evaluate end position";
+    }
+    report->ends_at_altitude = pos.z;
+
+    if (sb_trajectory_player_get_position_at(&player, stats->landing_time_sec, &pos) != SB_SUCCESS) {
+        sb_trajectory_player_destroy(&player);
+        return "cannot evaluate landing position";
+    }
+    report->lands_from_altitude = pos.z;
+
+    sb_trajectory_player_destroy(&player);
+
+    if (report->lands_from_altitude < report->ends_at_altitude) {
+        return "lands below end altitude";
+    } else if (report->lands_from_altitude > report->ends_at_altitude + 2600) {
+        return "lands from too high";
+    }
+
+    return "";
+}
+
+static const char* check_light_program(sb_binary_file_parser_t* parser, report_t* report)
+{
+    sb_light_program_t program;
+    sb_light_program_analysis_t analysis;
+    sb_error_t retval;
+
+    retval = sb_light_program_init_from_parser(&program, parser);
+    if (retval == SB_ENOENT) {
+        return "";
+    } else if (retval != SB_SUCCESS) {
+        return "cannot load light program";
+    }
+
+    report->has_light_program = 1;
+
+    retval = sb_light_program_analyze(&program, &analysis);
+    sb_light_program_destroy(&program);
+
+    if (retval != SB_SUCCESS) {
+        return "cannot analyze light program";
+    } else if (analysis.flags & SB_LIGHT_PROGRAM_INVALID) {
+        return "invalid light program";
+    } else if (analysis.flags & SB_LIGHT_PROGRAM_LOOPS_TOO_DEEP) {
+        return "light program loops too deep";
+    }
+
+    return "";
+}
+
+static const char* check_rth_plan(sb_binary_file_parser_t* parser, report_t* report, const options_t* options)
+{
+    sb_rth_plan_t plan;
+    sb_rth_plan_entry_t entry;
+    sb_error_t retval;
+    const char* error = "";
+    float t;
+
+    retval = sb_rth_plan_init_from_parser(&plan, parser);
+    if (retval == SB_ENOENT) {
+        return options->require_rth_plan ? "no RTH plan" : "";
+    } else if (retval != SB_SUCCESS) {
+        return "cannot load RTH plan";
+    }
+
+    report->has_rth_plan = 1;
+
+    if (sb_rth_plan_is_empty(&plan)) {
+        error = options->require_rth_plan ? "empty RTH plan" : "";
+    } else {
+        /* Every second between takeoff and landing must be covered by a
+         * valid entry of the plan */
+        for (t = report->stats.takeoff_time_sec; t <= report->stats.landing_time_sec; t += 1) {
+            if (sb_rth_plan_evaluate_at(&plan, t, &entry) != SB_SUCCESS) {
+                error = "invalid RTH plan";
+                break;
+            }
+        }
+    }
+
+    sb_rth_plan_destroy(&plan);
+
+    return error;
+}
+
+static void validate_file(report_t* report, const options_t* options)
+{
+    sb_buffer_t buf;
+    sb_binary_file_parser_t parser;
+    sb_trajectory_t trajectory;
+    sb_error_t retval;
     const char* error;
-    int i;
+    double start = now_msec();
 
-    if (argc < 2) {
-        printf("Usage: %s <input_file.skyb> ...\n", argv[0]);
-        return 1;
+    retval = load_file(&buf, report->filename);
+    if (retval != SB_SUCCESS) {
+        report->error = retval == SB_EOPEN ? "cannot open file" : "cannot read file";
+        return;
     }
 
-    for (i = 1; i < argc; i++) {
-        SB_CHECK_MAIN(load_trajectory(&trajectory, argv[i]));
-        SB_CHECK_MAIN(calculate_stats(&trajectory, &stats));
-
-        if (!isfinite(stats.takeoff_time_sec)) {
-            error = "takeoff time is not finite";
-        } else if (!isfinite(stats.landing_time_sec)) {
-            error = "landing time is not finite";
-        } else if (stats.landing_time_sec < stats.takeoff_time_sec) {
-            error = "landing time is before takeoff time";
-        } else if (stats.duration_msec < 0) {
-            error = "duration is negative";
+    retval = sb_binary_file_parser_init_from_buffer(&parser, SB_BUFFER(buf), sb_buffer_size(&buf));
+    if (retval != SB_SUCCESS) {
+        report->error = retval == SB_ECORRUPTED ? "checksum mismatch" : "cannot parse file";
+        sb_buffer_destroy(&buf);
+        return;
+    }
+
+    retval = sb_trajectory_init_from_parser(&trajectory, &parser);
+    if (retval != SB_SUCCESS) {
+        report->error = retval == SB_ENOENT ? "no trajectory" : "cannot load trajectory";
+        sb_binary_file_parser_destroy(&parser);
+        sb_buffer_destroy(&buf);
+        return;
+    }
+
+    report->load_time_msec = now_msec() - start;
+    start = now_msec();
+
+    if (calculate_stats(&trajectory, &report->stats) != SB_SUCCESS) {
+        error = "cannot calculate trajectory statistics";
+    } else if (sb_trajectory_get_axis_aligned_bounding_box(&trajectory, &report->bounding_box) != SB_SUCCESS) {
+        error = "cannot calculate bounding box";
+    } else if (sb_trajectory_get_kinematic_peaks(&trajectory, &report->peaks) != SB_SUCCESS) {
+        error = "cannot calculate velocities";
+    } else {
+        error = check_takeoff_and_landing(&trajectory, report);
+    }
+
+    if (!*error && options->use_geofence && !is_inside(&report->bounding_box, &options->geofence)) {
+        error = "outside geofence";
+    }
+
+    if (!*error && report->peaks.horizontal_velocity.value > options->max_velocity_xy) {
+        error = "horizontal velocity too high";
+    }
+
+    if (!*error && report->peaks.vertical_velocity.value > options->max_velocity_z) {
+        error = "vertical velocity too high";
+    }
+
+    if (!*error && report->peaks.horizontal_acceleration.value > options->max_acceleration_xy) {
+        error = "horizontal acceleration too high";
+    }
+
+    if (!*error && report->peaks.vertical_acceleration.value > options->max_acceleration_z) {
+        error = "vertical acceleration too high";
+    }
+
+    if (!*error) {
+        error = check_light_program(&parser, report);
+    }
+
+    if (!*error) {
+        error = check_rth_plan(&parser, report, options);
+    }
+
+    report->error = error;
+    report->check_time_msec = now_msec() - start;
+
+    sb_trajectory_destroy(&trajectory);
+    sb_binary_file_parser_destroy(&parser);
+    sb_buffer_destroy(&buf);
+}
+
+static sb_error_t validate_files(void* context, size_t start, size_t end)
+{
+    job_t* job = (job_t*)context;
+
+    for (; start < end; start++) {
+        validate_file(&job->reports[start], job->options);
+    }
+
+    return SB_SUCCESS;
+}
+
+static void print_json_string(const char* str)
+{
+    putchar('"');
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            putchar('\\');
+            putchar(*str);
+        } else if ((unsigned char)*str < 0x20) {
+            printf("\\u%04x", (unsigned char)*str);
         } else {
-            SB_CHECK_MAIN(sb_trajectory_player_init(&player, &trajectory));
+            putchar(*str);
+        }
+    }
+    putchar('"');
+}
 
-            SB_CHECK_MAIN(sb_trajectory_player_get_position_at(&player, 0, &pos));
-            starts_at_altitude = pos.z;
+static void print_tsv(const report_t* reports, size_t num_reports)
+{
+    const report_t* report;
+    size_t i;
 
-            SB_CHECK_MAIN(sb_trajectory_player_get_position_at(&player, stats.duration_sec, &pos));
-            ends_at_altitude = pos.z;
+    printf("filename\tduration [s]\ttakeoff_time [s]\trel_landing_time [s]\tstart_alt [m]\tend_alt [m]\tland_alt [m]\tmax_vel_xy [m/s]\tmax_vel_z [m/s]\tmax_acc_xy [m/s^2]\tmax_acc_z [m/s^2]\tload_time [ms]\tcheck_time [ms]\terror\n");
 
-            SB_CHECK_MAIN(sb_trajectory_player_get_position_at(&player, stats.landing_time_sec, &pos));
-            lands_from_altitude = pos.z;
+    for (i = 0; i < num_reports; i++) {
+        report = &reports[i];
+        printf("%s\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%s\n",
+            report->filename,
+            report->stats.duration_msec / 1000.0,
+            (double)report->stats.takeoff_time_sec,
+            report->stats.landing_time_sec - report->stats.duration_msec / 1000.0,
+            report->starts_at_altitude / 1000.0,
+            report->ends_at_altitude / 1000.0,
+            report->lands_from_altitude / 1000.0,
+            report->peaks.horizontal_velocity.value / 1000.0,
+            report->peaks.vertical_velocity.value / 1000.0,
+            report->peaks.horizontal_acceleration.value / 1000.0,
+            report->peaks.vertical_acceleration.value / 1000.0,
+            report->load_time_msec,
+            report->check_time_msec,
+            report->error);
+    }
+}
 
-            sb_trajectory_player_destroy(&player);
+static void print_json(const report_t* reports, size_t num_reports)
+{
+    const report_t* report;
+    size_t i;
 
-            if (lands_from_altitude < ends_at_altitude) {
-                error = "lands below end altitude";
-            } else if (lands_from_altitude > ends_at_altitude + 2600) {
-                error = "lands from too high";
-            } else {
-                error = "";
-            }
+    printf("[\n");
+
+    for (i = 0; i < num_reports; i++) {
+        report = &reports[i];
+
+        printf("  {\"filename\": ");
+        print_json_string(report->filename);
+
+        /* Non-finite numbers are not valid JSON so we print them as null */
+        printf(", \"duration\": %.3f", report->stats.duration_msec / 1000.0);
+        if (isfinite(report->stats.takeoff_time_sec) && isfinite(report->stats.landing_time_sec)) {
+            printf(", \"takeoff_time\": %.3f, \"landing_time\": %.3f",
+                (double)report->stats.takeoff_time_sec, (double)report->stats.landing_time_sec);
+        } else {
+            printf(", \"takeoff_time\": null, \"landing_time\": null");
+        }
+        printf(", \"start_alt\": %.3f, \"end_alt\": %.3f, \"land_alt\": %.3f",
+            report->starts_at_altitude / 1000.0,
+            report->ends_at_altitude / 1000.0,
+            report->lands_from_altitude / 1000.0);
+        printf(", \"bounding_box\": [[%.3f, %.3f, %.3f], [%.3f, %.3f, %.3f]]",
+            report->bounding_box.x.min / 1000.0,
+            report->bounding_box.y.min / 1000.0,
+            report->bounding_box.z.min / 1000.0,
+            report->bounding_box.x.max / 1000.0,
+            report->bounding_box.y.max / 1000.0,
+            report->bounding_box.z.max / 1000.0);
+        printf(", \"max_vel_xy\": %.3f, \"max_vel_xy_time\": %.3f",
+            report->peaks.horizontal_velocity.value / 1000.0,
+            (double)report->peaks.horizontal_velocity.time_sec);
+        printf(", \"max_vel_z\": %.3f, \"max_vel_z_time\": %.3f",
+            report->peaks.vertical_velocity.value / 1000.0,
+            (double)report->peaks.vertical_velocity.time_sec);
+        printf(", \"max_acc_xy\": %.3f, \"max_acc_xy_time\": %.3f",
+            report->peaks.horizontal_acceleration.value / 1000.0,
+            (double)report->peaks.horizontal_acceleration.time_sec);
+        printf(", \"max_acc_z\": %.3f, \"max_acc_z_time\": %.3f",
+            report->peaks.vertical_acceleration.value / 1000.0,
+            (double)report->peaks.vertical_acceleration.time_sec);
+        printf(", \"has_light_program\": %s, \"has_rth_plan\": %s",
+            report->has_light_program ? "true" : "false",
+            report->has_rth_plan ? "true" : "false");
+        printf(", \"load_time_ms\": %.3f, \"check_time_ms\": %.3f",
+            report->load_time_msec, report->check_time_msec);
+        printf(", \"error\": ");
+        if (*report->error) {
+            print_json_string(report->error);
+        } else {
+            printf("null");
         }
+        printf("}%s\n", i + 1 < num_reports ? "," : "");
+    }
 
-        sb_trajectory_destroy(&trajectory);
+    printf("]\n");
+}
 
-        if (first) {
-            printf("filename\tduration [s]\ttakeoff_time [s]\trel_landing_time [s]\tstart_alt [m]\tend_alt [m]\tland_alt [m]\terror\n");
-            first = 0;
+static void print_usage(const char* program)
+{
+    printf("Usage: %s [options] <input_file.skyb> ...\n", program);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -j N                     use N threads (default: number of CPUs)\n");
+    printf("  --json                   print the results in JSON format instead of TSV\n");
+    printf("  --geofence X,Y,Z,X,Y,Z   minimum and maximum corner of the geofence [m]\n");
+    printf("  --max-velocity-xy V      maximum allowed horizontal velocity [m/s]\n");
+    printf("  --max-velocity-z V       maximum allowed vertical velocity [m/s]\n");
+    printf("  --max-acceleration-xy A  maximum allowed horizontal acceleration [m/s^2]\n");
+    printf("  --max-acceleration-z A   maximum allowed vertical acceleration [m/s^2]\n");
+    printf("  --require-rth-plan       report files without an RTH plan as errors\n");
+}
+
+static int parse_options(int argc, char* argv[], options_t* options)
+{
+    sb_bounding_box_t* fence = &options->geofence;
+    int i;
+
+    memset(options, 0, sizeof(options_t));
+    options->max_velocity_xy = options->max_velocity_z = INFINITY;
+    options->max_acceleration_xy = options->max_acceleration_z = INFINITY;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            options->num_threads = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "--json")) {
+            options->json = 1;
+        } else if (!strcmp(argv[i], "--geofence") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%f,%f,%f,%f,%f,%f",
+                    &fence->x.min, &fence->y.min, &fence->z.min,
+                    &fence->x.max, &fence->y.max, &fence->z.max)
+                != 6) {
+                return -1;
+            }
+            fence->x.min *= 1000;
+            fence->y.min *= 1000;
+            fence->z.min *= 1000;
+            fence->x.max *= 1000;
+            fence->y.max *= 1000;
+            fence->z.max *= 1000;
+            options->use_geofence = 1;
+        } else if (!strcmp(argv[i], "--max-velocity-xy") && i + 1 < argc) {
+            options->max_velocity_xy = strtof(argv[++i], NULL) * 1000;
+        } else if (!strcmp(argv[i], "--max-velocity-z") && i + 1 < argc) {
+            options->max_velocity_z = strtof(argv[++i], NULL) * 1000;
+        } else if (!strcmp(argv[i], "--max-acceleration-xy") && i + 1 < argc) {
+            options->max_acceleration_xy = strtof(argv[++i], NULL) * 1000;
+        } else if (!strcmp(argv[i], "--max-acceleration-z") && i + 1 < argc) {
+            options->max_acceleration_z = strtof(argv[++i], NULL) * 1000;
+        } else if (!strcmp(argv[i], "--require-rth-plan")) {
+            options->require_rth_plan = 1;
+        } else if (argv[i][0] == '-') {
+            return -1;
+        } else {
+            break;
         }
+    }
 
-        printf("%s\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%s\n",
-            argv[i],
-            stats.duration_msec / 1000.0,
-            (double)stats.takeoff_time_sec,
-            stats.landing_time_sec - stats.duration_msec / 1000.0,
-            starts_at_altitude / 1000.0,
-            ends_at_altitude / 1000.0,
-            lands_from_altitude / 1000.0,
-            error);
+    return i;
+}
+
+int main(int argc, char* argv[])
+{
+    options_t options;
+    report_t* reports;
+    job_t job;
+    size_t i, num_files;
+    int first_file, num_errors = 0;
+
+    first_file = parse_options(argc, argv, &options);
+    if (first_file < 0 || first_file >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    num_files = argc - first_file;
+    reports = sb_calloc(report_t, num_files);
+    if (reports == NULL) {
+        printf("Error: %s\n", sb_error_to_string(SB_ENOMEM));
+        return 1;
     }
 
-    return 0;
+    for (i = 0; i < num_files; i++) {
+        reports[i].filename = argv[first_file + i];
+        reports[i].error = "";
+    }
+
+    job.options = &options;
+    job.reports = reports;
+    sb_i_parallel_for(num_files, options.num_threads, validate_files, &job);
+
+    if (options.json) {
+        print_json(reports, num_files);
+    } else {
+        print_tsv(reports, num_files);
+    }
+
+    for (i = 0; i < num_files; i++) {
+        if (*reports[i].error) {
+            num_errors++;
+        }
+    }
+
+    sb_free(reports);
+
+    return num_errors > 0 ? 1 : 0;
 }
@@ -23,16 +23,39 @@
 #include <skybrush/trajectory.h>
 
 #include "../parsing.h"
+#include "builder.h"
 
 #define HEADER_LENGTH 9
 #define MAX_DURATION_MSEC 60000
+#define MAX_BEZIER_DEGREE 7
+
+/**
+ * Control points of a Bezier curve along each axis of a trajectory segment,
+ * including the start point of the segment. The axes are X, Y, Z and yaw,
+ * in this order.
+ */
+typedef float sb_i_bezier_axes_t[4][MAX_BEZIER_DEGREE + 1];
 
 static sb_error_t sb_i_trajectory_builder_scale_coordinate(
-    sb_trajectory_builder_t* builder, float coordinate, int16_t* scaled_coordinate);
+    const sb_trajectory_builder_t* builder, float coordinate, int16_t* scaled_coordinate);
 static sb_error_t sb_i_trajectory_builder_write_angle(
-    sb_trajectory_builder_t* builder, size_t* offset, float angle);
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset, float angle);
 static sb_error_t sb_i_trajectory_builder_write_coordinate(
-    sb_trajectory_builder_t* builder, size_t* offset, float coordinate);
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset, float coordinate);
+static sb_error_t sb_i_trajectory_builder_write_line(
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset,
+    sb_vector3_with_yaw_t* last_position, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec);
+static sb_error_t sb_i_trajectory_builder_append_bezier(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* points,
+    uint8_t degree, uint32_t duration_msec, sb_bool_t lossless);
+static sb_error_t sb_i_trajectory_builder_write_bezier(
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset,
+    sb_i_bezier_axes_t points, uint8_t degree, uint32_t duration_msec,
+    float* position, sb_bool_t lossless);
+static float sb_i_trajectory_builder_quantize_angle(float angle);
+static float sb_i_trajectory_builder_quantize_coordinate(
+    const sb_trajectory_builder_t* builder, float coordinate);
 
 /**
  * @brief Creates a new trajectory builder.
@@ -89,11 +112,12 @@ sb_error_t sb_trajectory_builder_set_start_position(
     }
 
     size_t offset = 1;
+    uint8_t* buf = SB_BUFFER(builder->buffer);
 
-    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, start.x));
-    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, start.y));
-    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, start.z));
-    SB_CHECK(sb_i_trajectory_builder_write_angle(builder, &offset, start.yaw));
+    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, &offset, start.x));
+    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, &offset, start.y));
+    SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, &offset, start.z));
+    SB_CHECK(sb_i_trajectory_builder_write_angle(builder, buf, &offset, start.yaw));
 
     builder->last_position = start;
 
@@ -111,54 +135,55 @@ sb_error_t sb_trajectory_builder_append_line(
     sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t target,
     uint32_t duration_msec)
 {
-    if (duration_msec > MAX_DURATION_MSEC) {
-        /* If duration_msec > 60000, split the segment into multiple sub-segments */
-        sb_vector3_with_yaw_t midpoint;
-        uint32_t half_duration_msec = duration_msec >> 1;
-
-        midpoint.x = (builder->last_position.x + target.x) / 2;
-        midpoint.y = (builder->last_position.y + target.y) / 2;
-        midpoint.z = (builder->last_position.z + target.z) / 2;
-        midpoint.yaw = (builder->last_position.yaw + target.yaw) / 2;
-
-        SB_CHECK(sb_trajectory_builder_append_line(builder, midpoint, half_duration_msec));
-        SB_CHECK(sb_trajectory_builder_append_line(builder, target, duration_msec - half_duration_msec));
+    return sb_trajectory_builder_append_lines(builder, &target, &duration_msec, 1);
+}
 
-        return SB_SUCCESS;
+/**
+ * @brief Appends multiple straight-line segments to the trajectory being built.
+ *
+ * This function is equivalent to calling \ref sb_trajectory_builder_append_line()
+ * for each target in turn, but it calculates the exact number of bytes needed
+ * for all the segments first and grows the buffer only once. Segments longer
+ * than the maximum allowed length of a single segment are split appropriately.
+ *
+ * The trajectory being built is left intact if any of the targets cannot be
+ * represented in the trajectory.
+ *
+ * @param builder the trajectory builder
+ * @param targets the targets to move to, one for each segment
+ * @param durations_msec the durations of the segments, in milliseconds
+ * @param num_segments the number of segments to append
+ * @return \c SB_EINVAL if one of the targets is out of the range of the
+ *     trajectory, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_builder_append_lines(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* targets,
+    const uint32_t* durations_msec, size_t num_segments)
+{
+    sb_vector3_with_yaw_t last_position;
+    size_t i, offset, num_bytes;
+    uint8_t* buf;
+
+    /* First pass: validate the targets and calculate the number of bytes needed */
+    last_position = builder->last_position;
+    num_bytes = 0;
+    for (i = 0; i < num_segments; i++) {
+        SB_CHECK(sb_i_trajectory_builder_write_line(
+            builder, 0, &num_bytes, &last_position, targets[i], durations_msec[i]));
     }
 
-    size_t offset = sb_buffer_size(&builder->buffer);
-    uint8_t* flags_ptr;
-
-    SB_CHECK(sb_buffer_extend_with_zeros(&builder->buffer, 11));
-
-    /* We will always need 1 byte for the header */
-    flags_ptr = SB_BUFFER(builder->buffer) + offset;
-    offset++;
-    *flags_ptr = 0;
+    SB_CHECK(sb_buffer_extend_uninitialized(&builder->buffer, num_bytes, &buf));
 
-    sb_write_uint16(SB_BUFFER(builder->buffer), &offset, duration_msec);
-    if (builder->last_position.x != target.x) {
-        *flags_ptr |= 1;
-        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, target.x));
-    }
-    if (builder->last_position.y != target.y) {
-        *flags_ptr |= (1 << 2);
-        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, target.y));
-    }
-    if (builder->last_position.z != target.z) {
-        *flags_ptr |= (1 << 4);
-        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, &offset, target.z));
+    /* Second pass: write the segments; this cannot fail any more and it
+     * fills every byte that was reserved above */
+    offset = 0;
+    last_position = builder->last_position;
+    for (i = 0; i < num_segments; i++) {
+        sb_i_trajectory_builder_write_line(
+            builder, buf, &offset, &last_position, targets[i], durations_msec[i]);
     }
-    if (builder->last_position.yaw != target.yaw) {
-        *flags_ptr |= (1 << 6);
-        SB_CHECK(sb_i_trajectory_builder_write_angle(builder, &offset, target.yaw));
-    }
-
-    /* Trim the unneeded bytes from the end */
-    SB_CHECK(sb_buffer_resize(&builder->buffer, offset));
 
-    builder->last_position = target;
+    builder->last_position = last_position;
 
     return SB_SUCCESS;
 }
@@ -186,6 +211,92 @@ sb_error_t sb_trajectory_builder_hold_position_for(
 
     return SB_SUCCESS;
 }
+
+/**
+ * @brief Appends a new cubic Bezier segment to the trajectory being built.
+ *
+ * The segment starts from the last position of the trajectory. Each axis of
+ * the segment is encoded in the cheapest form that is within one unit of the
+ * trajectory scale (or 0.1 degrees for yaw) of the original control points:
+ * constant if all the control points are the same, linear if they are evenly
+ * spaced along a line, and cubic otherwise. Coordinates are then rounded down
+ * to the nearest multiple of the scale when they are encoded, so the curve
+ * read back from the trajectory may deviate from the original one by almost
+ * twice the scale (or 0.2 degrees for yaw). When the duration is larger than
+ * the maximum allowed length of a single segment, the segment is subdivided
+ * appropriately.
+ *
+ * The last position of the builder is updated to the endpoint as it was
+ * encoded in the trajectory and not to the given target, so rounding errors
+ * do not accumulate when multiple segments are chained.
+ *
+ * @param builder the trajectory builder
+ * @param control1 the first control point of the curve
+ * @param control2 the second control point of the curve
+ * @param target the endpoint of the curve
+ * @param duration_msec the duration of the segment, in milliseconds
+ * @return \c SB_EINVAL if one of the control points is out of the range of
+ *     the trajectory, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_builder_append_cubic_bezier(
+    sb_trajectory_builder_t* builder, sb_vector3_with_yaw_t control1,
+    sb_vector3_with_yaw_t control2, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec)
+{
+    sb_vector3_with_yaw_t points[3];
+
+    points[0] = control1;
+    points[1] = control2;
+    points[2] = target;
+
+    return sb_i_trajectory_builder_append_bezier(builder, points, 3, duration_msec, 0);
+}
+
+/**
+ * Appends a new cubic Bezier segment to the trajectory being built without
+ * simplifying its axes, except for axes that are exactly constant or linear.
+ * Used by the sample fitter, which has already verified its error bound on
+ * the quantized control points.
+ */
+sb_error_t sb_i_trajectory_builder_append_cubic_bezier_lossless(
+    sb_trajectory_builder_t* builder, sb_vector3_with_yaw_t control1,
+    sb_vector3_with_yaw_t control2, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec)
+{
+    sb_vector3_with_yaw_t points[3];
+
+    points[0] = control1;
+    points[1] = control2;
+    points[2] = target;
+
+    return sb_i_trajectory_builder_append_bezier(builder, points, 3, duration_msec, 1);
+}
+
+/**
+ * @brief Appends a new segment with seven control points to the trajectory
+ * being built.
+ *
+ * The segment is a Bezier curve of degree 7 that starts from the last position
+ * of the trajectory. Each axis of the segment is encoded in the cheapest form
+ * that is within one unit of the trajectory scale of the original control
+ * points, so the encoded curve may deviate from the original one by almost
+ * twice the scale; see \ref sb_trajectory_builder_append_cubic_bezier() for
+ * more details.
+ *
+ * @param builder the trajectory builder
+ * @param points the seven control points of the curve after the start point;
+ *     the last one is the endpoint of the segment
+ * @param duration_msec the duration of the segment, in milliseconds
+ * @return \c SB_EINVAL if one of the control points is out of the range of
+ *     the trajectory, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_builder_append_poly7d(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* points,
+    uint32_t duration_msec)
+{
+    return sb_i_trajectory_builder_append_bezier(builder, points, 7, duration_msec, 0);
+}
+
 /**
  * @brief Finalizes the trajectory being built and converts it into a trajectory
  * object.
@@ -215,7 +326,7 @@ sb_error_t sb_trajectory_init_from_builder(
 /* ************************************************************************** */
 
 static sb_error_t sb_i_trajectory_builder_scale_coordinate(
-    sb_trajectory_builder_t* builder, float coordinate, int16_t* scaled_coordinate)
+    const sb_trajectory_builder_t* builder, float coordinate, int16_t* scaled_coordinate)
 {
     float scaled = floorf(coordinate / builder->scale);
     if (scaled < INT16_MIN || scaled > INT16_MAX) {
@@ -226,25 +337,370 @@ static sb_error_t sb_i_trajectory_builder_scale_coordinate(
     }
 }
 
+/* Returns the value that the decoder reads back for the given coordinate */
+static float sb_i_trajectory_builder_quantize_coordinate(
+    const sb_trajectory_builder_t* builder, float coordinate)
+{
+    return floorf(coordinate / builder->scale) * builder->scale;
+}
+
+/* Returns the value that the decoder reads back for the given angle */
+static float sb_i_trajectory_builder_quantize_angle(float angle)
+{
+    int16_t scaled = fmodf(angle, 360) * 10.0f;
+    if (scaled < 0) {
+        scaled += 3600;
+    }
+
+    return scaled / 10.0f;
+}
+
+/* The functions below write into the given buffer at the given offset and
+ * advance the offset. When the buffer is null, they only advance the offset
+ * so they can be used to calculate the encoded length of the data. */
+
 static sb_error_t sb_i_trajectory_builder_write_angle(
-    sb_trajectory_builder_t* builder, size_t* offset, float angle)
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset, float angle)
 {
     int16_t scaled = fmodf(angle, 360) * 10.0f;
     if (scaled < 0) {
         scaled += 3600;
     }
 
-    sb_write_int16(SB_BUFFER(builder->buffer), offset, scaled);
+    if (buf) {
+        sb_write_int16(buf, offset, scaled);
+    } else {
+        *offset += 2;
+    }
+
     return SB_SUCCESS;
 }
 
 static sb_error_t sb_i_trajectory_builder_write_coordinate(
-    sb_trajectory_builder_t* builder, size_t* offset, float coordinate)
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset, float coordinate)
 {
     int16_t scaled;
 
     SB_CHECK(sb_i_trajectory_builder_scale_coordinate(builder, coordinate, &scaled));
-    sb_write_int16(SB_BUFFER(builder->buffer), offset, scaled);
+
+    if (buf) {
+        sb_write_int16(buf, offset, scaled);
+    } else {
+        *offset += 2;
+    }
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_trajectory_builder_write_line(
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset,
+    sb_vector3_with_yaw_t* last_position, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec)
+{
+    uint8_t flags = 0;
+    size_t flags_offset;
+
+    if (duration_msec > MAX_DURATION_MSEC) {
+        /* If duration_msec > 60000, split the segment into multiple sub-segments */
+        sb_vector3_with_yaw_t midpoint;
+        uint32_t half_duration_msec = duration_msec >> 1;
+
+        midpoint.x = (last_position->x + target.x) / 2;
+        midpoint.y = (last_position->y + target.y) / 2;
+        midpoint.z = (last_position->z + target.z) / 2;
+        midpoint.yaw = (last_position->yaw + target.yaw) / 2;
+
+        SB_CHECK(sb_i_trajectory_builder_write_line(
+            builder, buf, offset, last_position, midpoint, half_duration_msec));
+        SB_CHECK(sb_i_trajectory_builder_write_line(
+            builder, buf, offset, last_position, target, duration_msec - half_duration_msec));
+
+        return SB_SUCCESS;
+    }
+
+    /* We will always need 1 byte for the header and 2 bytes for the duration */
+    flags_offset = *offset;
+    if (buf) {
+        (*offset)++;
+        sb_write_uint16(buf, offset, duration_msec);
+    } else {
+        *offset += 3;
+    }
+
+    if (last_position->x != target.x) {
+        flags |= 1;
+        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, offset, target.x));
+    }
+    if (last_position->y != target.y) {
+        flags |= (1 << 2);
+        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, offset, target.y));
+    }
+    if (last_position->z != target.z) {
+        flags |= (1 << 4);
+        SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, offset, target.z));
+    }
+    if (last_position->yaw != target.yaw) {
+        flags |= (1 << 6);
+        SB_CHECK(sb_i_trajectory_builder_write_angle(builder, buf, offset, target.yaw));
+    }
+
+    if (buf) {
+        buf[flags_offset] = flags;
+    }
+
+    *last_position = target;
+
+    return SB_SUCCESS;
+}
+
+/* ************************************************************************** */
+
+/**
+ * Raises the degree of a Bezier curve by one without changing its shape.
+ */
+static void sb_i_bezier_elevate(const float* points, uint8_t degree, float* result)
+{
+    uint8_t i;
+    float ratio;
+
+    result[0] = points[0];
+    for (i = 1; i <= degree; i++) {
+        ratio = (float)i / (degree + 1);
+        result[i] = ratio * points[i - 1] + (1 - ratio) * points[i];
+    }
+    result[degree + 1] = points[degree];
+}
+
+/**
+ * Checks whether two sets of control points match within the given tolerance.
+ */
+static sb_bool_t sb_i_bezier_matches(const float* points, const float* other, uint8_t degree, float tolerance)
+{
+    uint8_t i;
+
+    for (i = 0; i <= degree; i++) {
+        if (fabsf(points[i] - other[i]) > tolerance) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Finds the lowest degree that can represent the given Bezier curve within
+ * the given tolerance, and rewrites the control points to that degree.
+ *
+ * Candidate curves of lower degrees are degree-elevated back to the original
+ * degree and compared with the original control points. Since a Bezier curve
+ * lies within the convex hull of its control points, the candidate curve
+ * deviates from the original one by at most the tolerance.
+ *
+ * @return the new degree of the curve; 0, 1, 3 or 7
+ */
+static uint8_t sb_i_bezier_reduce(float* points, uint8_t degree, float tolerance)
+{
+    float candidate[MAX_BEZIER_DEGREE + 1];
+    float elevated[MAX_BEZIER_DEGREE + 1];
+    uint8_t i, d;
+
+    /* Constant */
+    for (i = 0; i <= degree; i++) {
+        candidate[i] = points[0];
+    }
+    if (sb_i_bezier_matches(points, candidate, degree, tolerance)) {
+        return 0;
+    }
+
+    /* Linear */
+    for (i = 0; i <= degree; i++) {
+        candidate[i] = points[0] + (points[degree] - points[0]) * i / degree;
+    }
+    if (sb_i_bezier_matches(points, candidate, degree, tolerance)) {
+        points[1] = points[degree];
+        return 1;
+    }
+
+    if (degree <= 3) {
+        return degree;
+    }
+
+    /* Cubic; the inner control points are reconstructed from the control
+     * points next to the endpoints and the result is verified by raising
+     * its degree back to the original one */
+    candidate[0] = points[0];
+    candidate[1] = (degree * points[1] - (degree - 3) * points[0]) / 3;
+    candidate[2] = (degree * points[degree - 1] - (degree - 3) * points[degree]) / 3;
+    candidate[3] = points[degree];
+    for (d = 3; d < degree; d++) {
+        sb_i_bezier_elevate(candidate, d, elevated);
+        memcpy(candidate, elevated, sizeof(float) * (d + 2));
+    }
+    if (sb_i_bezier_matches(points, candidate, degree, tolerance)) {
+        points[1] = (degree * points[1] - (degree - 3) * points[0]) / 3;
+        points[2] = (degree * points[degree - 1] - (degree - 3) * points[degree]) / 3;
+        points[3] = points[degree];
+        return 3;
+    }
+
+    return degree;
+}
+
+/**
+ * Splits a Bezier curve in half with de Casteljau's algorithm.
+ */
+static void sb_i_bezier_split(const float* points, uint8_t degree, float* left, float* right)
+{
+    float work[MAX_BEZIER_DEGREE + 1];
+    uint8_t i, j;
+
+    memcpy(work, points, sizeof(float) * (degree + 1));
+
+    left[0] = work[0];
+    right[degree] = work[degree];
+    for (i = 1; i <= degree; i++) {
+        for (j = 0; j <= degree - i; j++) {
+            work[j] = (work[j] + work[j + 1]) / 2;
+        }
+        left[i] = work[0];
+        right[degree - i] = work[degree - i];
+    }
+}
+
+static sb_error_t sb_i_trajectory_builder_append_bezier(
+    sb_trajectory_builder_t* builder, const sb_vector3_with_yaw_t* points,
+    uint8_t degree, uint32_t duration_msec, sb_bool_t lossless)
+{
+    sb_i_bezier_axes_t axes;
+    float position[4], end[4];
+    size_t offset, num_bytes;
+    uint8_t* buf;
+    uint8_t i;
+
+    /* Start from the last position as the decoder will see it */
+    position[0] = sb_i_trajectory_builder_quantize_coordinate(builder, builder->last_position.x);
+    position[1] = sb_i_trajectory_builder_quantize_coordinate(builder, builder->last_position.y);
+    position[2] = sb_i_trajectory_builder_quantize_coordinate(builder, builder->last_position.z);
+    position[3] = sb_i_trajectory_builder_quantize_angle(builder->last_position.yaw);
+
+    for (i = 0; i < 4; i++) {
+        axes[i][0] = position[i];
+    }
+    for (i = 1; i <= degree; i++) {
+        axes[0][i] = points[i - 1].x;
+        axes[1][i] = points[i - 1].y;
+        axes[2][i] = points[i - 1].z;
+        axes[3][i] = points[i - 1].yaw;
+    }
+
+    /* First pass: validate the control points and calculate the number of
+     * bytes needed */
+    num_bytes = 0;
+    memcpy(end, position, sizeof(end));
+    SB_CHECK(sb_i_trajectory_builder_write_bezier(builder, 0, &num_bytes, axes, degree, duration_msec, end, lossless));
+
+    SB_CHECK(sb_buffer_extend_uninitialized(&builder->buffer, num_bytes, &buf));
+
+    /* Second pass: write the segments; this cannot fail any more and it
+     * fills every byte that was reserved above */
+    offset = 0;
+    sb_i_trajectory_builder_write_bezier(builder, buf, &offset, axes, degree, duration_msec, position, lossless);
+
+    builder->last_position.x = position[0];
+    builder->last_position.y = position[1];
+    builder->last_position.z = position[2];
+    builder->last_position.yaw = position[3];
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Writes a Bezier segment, splitting it if it is too long. \p position holds
+ * the start point of the segment as encoded in the trajectory; it replaces
+ * the first control point of the segment and it is updated to the encoded
+ * endpoint of the segment. When \p lossless is set, axes are simplified only
+ * if that does not change the curve at all.
+ */
+static sb_error_t sb_i_trajectory_builder_write_bezier(
+    const sb_trajectory_builder_t* builder, uint8_t* buf, size_t* offset,
+    sb_i_bezier_axes_t points, uint8_t degree, uint32_t duration_msec,
+    float* position, sb_bool_t lossless)
+{
+    sb_i_bezier_axes_t reduced;
+    uint8_t flags = 0, axis, i, axis_degree;
+    size_t flags_offset;
+
+    if (duration_msec > MAX_DURATION_MSEC) {
+        /* If duration_msec > 60000, split the curve into two halves */
+        sb_i_bezier_axes_t left, right;
+        uint32_t half_duration_msec = duration_msec >> 1;
+
+        for (axis = 0; axis < 4; axis++) {
+            sb_i_bezier_split(points[axis], degree, left[axis], right[axis]);
+        }
+
+        SB_CHECK(sb_i_trajectory_builder_write_bezier(
+            builder, buf, offset, left, degree, half_duration_msec, position, lossless));
+        SB_CHECK(sb_i_trajectory_builder_write_bezier(
+            builder, buf, offset, right, degree, duration_msec - half_duration_msec, position, lossless));
+
+        return SB_SUCCESS;
+    }
+
+    /* We will always need 1 byte for the header and 2 bytes for the duration */
+    flags_offset = *offset;
+    if (buf) {
+        (*offset)++;
+        sb_write_uint16(buf, offset, duration_msec);
+    } else {
+        *offset += 3;
+    }
+
+    memcpy(reduced, points, sizeof(sb_i_bezier_axes_t));
+
+    for (axis = 0; axis < 4; axis++) {
+        /* The segment starts where the previous one ended in the encoded
+         * trajectory, so the reduction must be measured from there */
+        reduced[axis][0] = position[axis];
+
+        /* Angles are stored in tenths of degrees */
+        axis_degree = sb_i_bezier_reduce(
+            reduced[axis], degree, lossless ? 0 : (axis < 3 ? builder->scale : 0.1f));
+
+        switch (axis_degree) {
+        case 0:
+            break;
+
+        case 1:
+            flags |= 1 << (axis * 2);
+            break;
+
+        case 3:
+            flags |= 2 << (axis * 2);
+            break;
+
+        default:
+            flags |= 3 << (axis * 2);
+        }
+
+        for (i = 1; i <= axis_degree; i++) {
+            if (axis < 3) {
+                SB_CHECK(sb_i_trajectory_builder_write_coordinate(builder, buf, offset, reduced[axis][i]));
+            } else {
+                SB_CHECK(sb_i_trajectory_builder_write_angle(builder, buf, offset, reduced[axis][i]));
+            }
+        }
+
+        if (axis_degree > 0) {
+            position[axis] = axis < 3
+                ? sb_i_trajectory_builder_quantize_coordinate(builder, reduced[axis][axis_degree])
+                : sb_i_trajectory_builder_quantize_angle(reduced[axis][axis_degree]);
+        }
+    }
+
+    if (buf) {
+        buf[flags_offset] = flags;
+    }
 
     return SB_SUCCESS;
 }
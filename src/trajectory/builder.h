@@ -0,0 +1,42 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORY_BUILDER_H
+#define TRAJECTORY_BUILDER_H
+
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+#include <skybrush/trajectory.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file builder.h
+ * @brief Internal functions of the trajectory builder shared with the sample
+ * fitter.
+ */
+
+sb_error_t sb_i_trajectory_builder_append_cubic_bezier_lossless(
+    sb_trajectory_builder_t* builder, sb_vector3_with_yaw_t control1,
+    sb_vector3_with_yaw_t control2, sb_vector3_with_yaw_t target,
+    uint32_t duration_msec);
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <skybrush/trajectory.h>
+
+#include "../parallel.h"
+#include "builder.h"
+
+#define MAX_DURATION_MSEC 60000
+
+/**
+ * Control points of a cubic Bezier segment candidate, already quantized to
+ * the resolution of the trajectory being built.
+ */
+typedef struct {
+    sb_vector3_with_yaw_t points[4];
+} sb_i_cubic_fit_t;
+
+typedef struct {
+    sb_trajectory_builder_t* builders;
+    const sb_trajectory_samples_t* samples;
+    float tolerance;
+    float yaw_tolerance;
+} sb_i_fit_samples_job_t;
+
+static sb_bool_t sb_i_cubic_fit_is_within_tolerance(
+    const sb_i_cubic_fit_t* fit, const sb_trajectory_samples_t* samples,
+    size_t start, size_t end, float tolerance, float yaw_tolerance);
+static void sb_i_cubic_fit_samples(
+    const sb_trajectory_builder_t* builder, const sb_trajectory_samples_t* samples,
+    size_t start, size_t end, sb_vector3_with_yaw_t first, sb_i_cubic_fit_t* fit);
+static sb_error_t sb_i_fit_samples_range(void* context, size_t start, size_t end);
+static float sb_i_quantize_angle(float angle);
+static float sb_i_quantize_coordinate(const sb_trajectory_builder_t* builder, float coordinate);
+static float sb_i_wrap_angle(float angle);
+
+/**
+ * @brief Appends segments to the trajectory being built that approximate the
+ * given sampled positions.
+ *
+ * The first sample is assumed to coincide with the last position of the
+ * builder in space and with the end of the trajectory built so far in time;
+ * its position is not used. Each subsequent segment ends exactly at one of
+ * the samples and is a cubic Bezier curve whose inner control points are
+ * least-squares fits to the samples it covers. Segments are extended greedily
+ * as long as the curve stays within the given tolerance at every sample
+ * after quantizing the control points to the resolution of the trajectory,
+ * and as long as their duration fits into a single segment.
+ *
+ * Two consecutive samples are always connected by a single segment, even if
+ * the tolerance cannot be met due to quantization. Since yaw angles are
+ * stored modulo 360 degrees, segments also tend to be split where the yaw
+ * angle wraps around.
+ *
+ * @param builder the trajectory builder
+ * @param samples the samples to approximate
+ * @param tolerance the maximum allowed deviation from the samples along the
+ *     X, Y and Z axes, in the units of the trajectory. Tolerances smaller
+ *     than the scale of the trajectory cannot be guaranteed.
+ * @param yaw_tolerance the maximum allowed deviation from the yaw angles of
+ *     the samples, in degrees. Use \c INFINITY if the yaw angles do not matter.
+ * @return \c SB_EINVAL if the timestamps of the samples are not strictly
+ *     increasing, if a tolerance is negative or if one of the samples is out
+ *     of the range of the trajectory, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_builder_fit_samples(
+    sb_trajectory_builder_t* builder, const sb_trajectory_samples_t* samples,
+    float tolerance, float yaw_tolerance)
+{
+    sb_i_cubic_fit_t fit, candidate;
+    sb_vector3_with_yaw_t first;
+    size_t i, start, end, good, bad, step;
+
+    if (!(tolerance >= 0) || !(yaw_tolerance >= 0)) {
+        return SB_EINVAL;
+    }
+
+    for (i = 1; i < samples->num_samples; i++) {
+        if (samples->times_msec[i] <= samples->times_msec[i - 1]) {
+            return SB_EINVAL;
+        }
+    }
+
+    start = 0;
+    while (start + 1 < samples->num_samples) {
+        first.x = sb_i_quantize_coordinate(builder, builder->last_position.x);
+        first.y = sb_i_quantize_coordinate(builder, builder->last_position.y);
+        first.z = sb_i_quantize_coordinate(builder, builder->last_position.z);
+        first.yaw = sb_i_quantize_angle(builder->last_position.yaw);
+
+        /* Two consecutive samples are always connected, even if the result
+         * is not within the tolerance */
+        good = start + 1;
+        sb_i_cubic_fit_samples(builder, samples, start, good, first, &fit);
+
+        /* Find an upper bound for the end of the segment by doubling the
+         * number of samples covered... */
+        bad = samples->num_samples;
+        for (step = 2; start + step < samples->num_samples; step *= 2) {
+            end = start + step;
+            if (samples->times_msec[end] - samples->times_msec[start] > MAX_DURATION_MSEC) {
+                bad = end;
+                break;
+            }
+
+            sb_i_cubic_fit_samples(builder, samples, start, end, first, &candidate);
+            if (!sb_i_cubic_fit_is_within_tolerance(
+                    &candidate, samples, start, end, tolerance, yaw_tolerance)) {
+                bad = end;
+                break;
+            }
+
+            good = end;
+            fit = candidate;
+        }
+
+        /* ...then refine it with a binary search */
+        while (good + 1 < bad) {
+            end = good + (bad - good) / 2;
+            if (samples->times_msec[end] - samples->times_msec[start] > MAX_DURATION_MSEC) {
+                bad = end;
+                continue;
+            }
+
+            sb_i_cubic_fit_samples(builder, samples, start, end, first, &candidate);
+            if (sb_i_cubic_fit_is_within_tolerance(
+                    &candidate, samples, start, end, tolerance, yaw_tolerance)) {
+                good = end;
+                fit = candidate;
+            } else {
+                bad = end;
+            }
+        }
+
+        /* The error bound was verified on exactly these control points so
+         * they must not be simplified any further by the builder */
+        SB_CHECK(sb_i_trajectory_builder_append_cubic_bezier_lossless(
+            builder, fit.points[1], fit.points[2], fit.points[3],
+            samples->times_msec[good] - samples->times_msec[start]));
+
+        start = good;
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * @brief Fits sampled positions for multiple trajectories at once.
+ *
+ * This function calls \ref sb_trajectory_builder_fit_samples() for each
+ * builder with the corresponding samples, distributing the builders among
+ * multiple threads.
+ *
+ * @param builders the trajectory builders, one for each trajectory
+ * @param samples the samples to approximate, one for each builder
+ * @param num_builders the number of builders
+ * @param tolerance the maximum allowed deviation from the samples along the
+ *     X, Y and Z axes, in the units of the trajectories
+ * @param yaw_tolerance the maximum allowed deviation from the yaw angles of
+ *     the samples, in degrees
+ * @param num_threads the number of threads to use; zero means one thread
+ *     per CPU core. Has no effect if the library was compiled without thread
+ *     support.
+ * @return the first error code returned by one of the fits, or \c SB_SUCCESS
+ *     if all of them succeeded
+ */
+sb_error_t sb_trajectory_builder_fit_samples_parallel(
+    sb_trajectory_builder_t* builders, const sb_trajectory_samples_t* samples,
+    size_t num_builders, float tolerance, float yaw_tolerance, size_t num_threads)
+{
+    sb_i_fit_samples_job_t job;
+
+    job.builders = builders;
+    job.samples = samples;
+    job.tolerance = tolerance;
+    job.yaw_tolerance = yaw_tolerance;
+
+    return sb_i_parallel_for(num_builders, num_threads, sb_i_fit_samples_range, &job);
+}
+
+/* ************************************************************************** */
+
+static sb_error_t sb_i_fit_samples_range(void* context, size_t start, size_t end)
+{
+    sb_i_fit_samples_job_t* job = (sb_i_fit_samples_job_t*)context;
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        SB_CHECK(sb_trajectory_builder_fit_samples(
+            job->builders + i, job->samples + i, job->tolerance, job->yaw_tolerance));
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Fits a cubic Bezier curve to the samples between the given start and end
+ * indices (inclusive), with fixed endpoints. The first endpoint is given
+ * explicitly, the last one is the quantized position of the last sample.
+ * The inner control points are calculated with least squares, mapping the
+ * time interval of the segment to [0; 1].
+ */
+static void sb_i_cubic_fit_samples(
+    const sb_trajectory_builder_t* builder, const sb_trajectory_samples_t* samples,
+    size_t start, size_t end, sb_vector3_with_yaw_t first, sb_i_cubic_fit_t* fit)
+{
+    const sb_vector3_with_yaw_t* last = samples->positions + end;
+    float duration = samples->times_msec[end] - samples->times_msec[start];
+    float a11 = 0, a12 = 0, a22 = 0, det;
+    float b1[4] = { 0, 0, 0, 0 }, b2[4] = { 0, 0, 0, 0 };
+    float p0[4], p3[4], c1[4], c2[4], pos[4];
+    float u, v, f0, f1, f2, f3, r;
+    size_t i;
+    uint8_t axis;
+
+    p0[0] = first.x;
+    p0[1] = first.y;
+    p0[2] = first.z;
+    p0[3] = first.yaw;
+
+    p3[0] = sb_i_quantize_coordinate(builder, last->x);
+    p3[1] = sb_i_quantize_coordinate(builder, last->y);
+    p3[2] = sb_i_quantize_coordinate(builder, last->z);
+    p3[3] = sb_i_quantize_angle(last->yaw);
+
+    for (i = start + 1; i < end; i++) {
+        const sb_vector3_with_yaw_t* sample = samples->positions + i;
+
+        /* Yaw angles are unwrapped relative to the start of the segment */
+        pos[0] = sample->x;
+        pos[1] = sample->y;
+        pos[2] = sample->z;
+        pos[3] = p0[3] + sb_i_wrap_angle(sample->yaw - p0[3]);
+
+        u = (samples->times_msec[i] - samples->times_msec[start]) / duration;
+        v = 1 - u;
+        f0 = v * v * v;
+        f1 = 3 * u * v * v;
+        f2 = 3 * u * u * v;
+        f3 = u * u * u;
+
+        a11 += f1 * f1;
+        a12 += f1 * f2;
+        a22 += f2 * f2;
+
+        for (axis = 0; axis < 4; axis++) {
+            r = pos[axis] - f0 * p0[axis] - f3 * p3[axis];
+            b1[axis] += f1 * r;
+            b2[axis] += f2 * r;
+        }
+    }
+
+    det = a11 * a22 - a12 * a12;
+
+    for (axis = 0; axis < 4; axis++) {
+        if (fabsf(det) > 1e-6f) {
+            c1[axis] = (a22 * b1[axis] - a12 * b2[axis]) / det;
+            c2[axis] = (a11 * b2[axis] - a12 * b1[axis]) / det;
+        } else {
+            /* Not enough samples to determine the inner control points, fall
+             * back to a straight line */
+            c1[axis] = p0[axis] + (p3[axis] - p0[axis]) / 3;
+            c2[axis] = p0[axis] + (p3[axis] - p0[axis]) * 2 / 3;
+        }
+    }
+
+    fit->points[0] = first;
+
+    fit->points[1].x = sb_i_quantize_coordinate(builder, c1[0]);
+    fit->points[1].y = sb_i_quantize_coordinate(builder, c1[1]);
+    fit->points[1].z = sb_i_quantize_coordinate(builder, c1[2]);
+    fit->points[1].yaw = sb_i_quantize_angle(c1[3]);
+
+    fit->points[2].x = sb_i_quantize_coordinate(builder, c2[0]);
+    fit->points[2].y = sb_i_quantize_coordinate(builder, c2[1]);
+    fit->points[2].z = sb_i_quantize_coordinate(builder, c2[2]);
+    fit->points[2].yaw = sb_i_quantize_angle(c2[3]);
+
+    fit->points[3].x = p3[0];
+    fit->points[3].y = p3[1];
+    fit->points[3].z = p3[2];
+    fit->points[3].yaw = p3[3];
+}
+
+/**
+ * Checks whether the given cubic Bezier curve is within the given tolerance
+ * of the samples between the given start and end indices (inclusive).
+ */
+static sb_bool_t sb_i_cubic_fit_is_within_tolerance(
+    const sb_i_cubic_fit_t* fit, const sb_trajectory_samples_t* samples,
+    size_t start, size_t end, float tolerance, float yaw_tolerance)
+{
+    const sb_vector3_with_yaw_t* p = fit->points;
+    float duration = samples->times_msec[end] - samples->times_msec[start];
+    float u, v, f0, f1, f2, f3, diff;
+    size_t i;
+
+    for (i = start + 1; i <= end; i++) {
+        const sb_vector3_with_yaw_t* pos = samples->positions + i;
+
+        u = (samples->times_msec[i] - samples->times_msec[start]) / duration;
+        v = 1 - u;
+        f0 = v * v * v;
+        f1 = 3 * u * v * v;
+        f2 = 3 * u * u * v;
+        f3 = u * u * u;
+
+#define CHECK_AXIS(AXIS)                                                                        \
+    diff = f0 * p[0].AXIS + f1 * p[1].AXIS + f2 * p[2].AXIS + f3 * p[3].AXIS - pos->AXIS; \
+    if (fabsf(diff) > tolerance) {                                                              \
+        return 0;                                                                               \
+    }
+
+        CHECK_AXIS(x);
+        CHECK_AXIS(y);
+        CHECK_AXIS(z);
+
+#undef CHECK_AXIS
+
+        if (!isinf(yaw_tolerance)) {
+            diff = f0 * p[0].yaw + f1 * p[1].yaw + f2 * p[2].yaw + f3 * p[3].yaw - pos->yaw;
+            if (fabsf(sb_i_wrap_angle(diff)) > yaw_tolerance) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Quantizes an angle the same way as it would be stored in a trajectory.
+ */
+static float sb_i_quantize_angle(float angle)
+{
+    int16_t scaled = fmodf(angle, 360) * 10.0f;
+    if (scaled < 0) {
+        scaled += 3600;
+    }
+    return scaled / 10.0f;
+}
+
+/**
+ * Quantizes a coordinate the same way as it would be stored in a trajectory.
+ * Coordinates out of the range of the trajectory are returned intact; the
+ * builder will reject them when the segment is appended.
+ */
+static float sb_i_quantize_coordinate(const sb_trajectory_builder_t* builder, float coordinate)
+{
+    float scaled = floorf(coordinate / builder->scale);
+    return (scaled < INT16_MIN || scaled > INT16_MAX) ? coordinate : scaled * builder->scale;
+}
+
+/**
+ * Wraps an angle difference into the [-180; 180] interval.
+ */
+static float sb_i_wrap_angle(float angle)
+{
+    angle = fmodf(angle, 360);
+    if (angle > 180) {
+        angle -= 360;
+    } else if (angle < -180) {
+        angle += 360;
+    }
+    return angle;
+}
@@ -0,0 +1,49 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORY_PLAYER_H
+#define TRAJECTORY_PLAYER_H
+
+#include <skybrush/decls.h>
+#include <skybrush/error.h>
+#include <skybrush/trajectory.h>
+
+__BEGIN_DECLS
+
+/**
+ * @file player.h
+ * @brief Internal functions of the trajectory player shared with the
+ * trajectory statistics calculator.
+ */
+
+/**
+ * Predicate that decides whether a trajectory segment with the given start
+ * and end point belongs to a run of segments.
+ */
+typedef sb_bool_t sb_i_trajectory_segment_predicate_t(
+    const sb_vector3_with_yaw_t* start, const sb_vector3_with_yaw_t* end,
+    void* context);
+
+sb_error_t sb_i_trajectory_player_build_first_segment_of_final_run(
+    sb_trajectory_player_t* player, sb_i_trajectory_segment_predicate_t* predicate,
+    void* context);
+
+__END_DECLS
+
+#endif
@@ -212,6 +212,38 @@ sb_error_t sb_poly_get_extrema(const sb_poly_t* poly, sb_interval_t* result)
     return SB_SUCCESS;
 }
 
+void sb_poly_get_extrema_bounds(const sb_poly_t* poly, sb_interval_t* result)
+{
+    uint8_t i, j, n;
+    float coeff, binom;
+
+    n = sb_i_poly_count_significant_coeffs(poly);
+    if (n <= 4) {
+        sb_poly_get_extrema(poly, result);
+        return;
+    }
+
+    /* Convert the polynomial to the Bernstein basis of degree n-1; the
+     * polynomial lies within the convex hull of the Bernstein coefficients.
+     * b_i = sum_{j <= i} C(i, j) / C(n-1, j) * a_j */
+    n--;
+    for (i = 0; i <= n; i++) {
+        coeff = 0;
+        for (j = 0; j <= i; j++) {
+            binom = (float)facs[i] / facs[j] / facs[i - j];
+            binom /= (float)facs[n] / facs[j] / facs[n - j];
+            coeff += binom * poly->coeffs[j];
+        }
+
+        if (i == 0 || coeff < result->min) {
+            result->min = coeff;
+        }
+        if (i == 0 || coeff > result->max) {
+            result->max = coeff;
+        }
+    }
+}
+
 void sb_poly_deriv(sb_poly_t* poly)
 {
     if (poly->num_coeffs > 1) {
@@ -637,12 +669,89 @@ static sb_error_t sb_i_poly_solve_4d(const sb_poly_t* poly, float rhs, float* ro
     return SB_SUCCESS;
 }
 
-/* LCOV_EXCL_START */
+/**
+ * Solves polynomials of degree 4 or higher.
+ *
+ * The roots of the derivative split the real line into intervals where the
+ * polynomial is monotonic, therefore each interval contains at most one root
+ * that can be found with bisection. The roots of the derivative are found by
+ * calling \ref sb_poly_solve() recursively, and the outermost intervals are
+ * closed by the Cauchy bound of the roots.
+ */
 static sb_error_t sb_i_poly_solve_generic(const sb_poly_t* poly, float rhs, float* roots, uint8_t* num_roots)
 {
-    return SB_EUNIMPLEMENTED;
+    sb_poly_t shifted = *poly;
+    sb_poly_t deriv;
+    float bounds[SB_MAX_POLY_COEFFS + 2];
+    float swap;
+    uint8_t i, j, n, num_bounds;
+    double lo, hi, mid, value_lo, value_hi, value_mid, bound, ratio;
+
+    shifted.coeffs[0] -= rhs;
+    n = sb_i_poly_count_significant_coeffs(&shifted);
+    shifted.num_coeffs = n;
+
+    bound = 0;
+    for (i = 0; i + 1 < n; i++) {
+        ratio = fabs((double)shifted.coeffs[i] / (double)shifted.coeffs[n - 1]);
+        if (ratio > bound) {
+            bound = ratio;
+        }
+    }
+    bound += 1;
+
+    deriv = shifted;
+    sb_poly_deriv(&deriv);
+    SB_CHECK(sb_poly_solve(&deriv, 0, bounds + 1, &num_bounds));
+
+    /* Sort the critical points with insertion sort; there are only a few */
+    for (i = 2; i <= num_bounds; i++) {
+        for (j = i; j > 1 && bounds[j - 1] > bounds[j]; j--) {
+            swap = bounds[j];
+            bounds[j] = bounds[j - 1];
+            bounds[j - 1] = swap;
+        }
+    }
+
+    bounds[0] = (float)-bound;
+    bounds[num_bounds + 1] = (float)bound;
+    num_bounds += 2;
+
+    *num_roots = 0;
+    for (i = 0; i + 1 < num_bounds; i++) {
+        lo = bounds[i];
+        hi = bounds[i + 1];
+        value_lo = sb_poly_eval_double(&shifted, lo);
+        value_hi = sb_poly_eval_double(&shifted, hi);
+
+        if (value_lo == 0) {
+            if (*num_roots == 0 || roots[*num_roots - 1] != (float)lo) {
+                roots[(*num_roots)++] = (float)lo;
+            }
+            continue;
+        }
+
+        if (value_hi == 0 || (value_lo < 0) == (value_hi < 0)) {
+            /* No sign change; a root at the upper end is handled in the next
+             * interval */
+            continue;
+        }
+
+        for (j = 0; j < 64 && lo < hi; j++) {
+            mid = (lo + hi) / 2;
+            value_mid = sb_poly_eval_double(&shifted, mid);
+            if ((value_mid < 0) == (value_lo < 0)) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        roots[(*num_roots)++] = (float)((lo + hi) / 2);
+    }
+
+    return SB_SUCCESS;
 }
-/* LCOV_EXCL_STOP */
 
 #undef ZERO
 
@@ -660,6 +769,18 @@ sb_vector3_with_yaw_t sb_poly_4d_eval(const sb_poly_4d_t* poly, float t)
     return result;
 }
 
+sb_vector3_with_yaw_t sb_poly_4d_eval_double(const sb_poly_4d_t* poly, double t)
+{
+    sb_vector3_with_yaw_t result;
+
+    result.x = (float)sb_poly_eval_double(&poly->x, t);
+    result.y = (float)sb_poly_eval_double(&poly->y, t);
+    result.z = (float)sb_poly_eval_double(&poly->z, t);
+    result.yaw = (float)sb_poly_eval_double(&poly->yaw, t);
+
+    return result;
+}
+
 void sb_poly_4d_make_constant(sb_poly_4d_t* poly, sb_vector3_with_yaw_t vec)
 {
     sb_poly_make_constant(&poly->x, vec.x);
@@ -0,0 +1,281 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <skybrush/memory.h>
+#include <skybrush/trajectory.h>
+
+/** Maximum number of segments that may be merged into a single line */
+#define MAX_RUN_LENGTH 256
+
+/** Maximum duration of a merged line; longer lines would have to be split */
+#define MAX_DURATION_MSEC 60000
+
+/**
+ * A single segment of the original trajectory that is a candidate for being
+ * merged into a straight line with its neighbours.
+ */
+typedef struct {
+    uint32_t start_time_msec; /**< Start time of the segment relative to the start of the run */
+    uint16_t duration_msec; /**< Duration of the segment */
+    sb_poly_4d_t poly; /**< The polynomial of the segment, mapped to [0; 1] */
+} sb_i_simplify_run_item_t;
+
+static sb_bool_t sb_i_poly_is_close_to_line(
+    const sb_poly_t* poly, float start, float end, float t0, float t1,
+    float tolerance);
+static sb_bool_t sb_i_run_is_close_to_line(
+    const sb_i_simplify_run_item_t* run, size_t length,
+    sb_vector3_with_yaw_t start, sb_vector3_with_yaw_t end, uint32_t duration_msec,
+    float tolerance, float yaw_tolerance);
+
+/**
+ * @brief Creates a simplified copy of a trajectory.
+ *
+ * Consecutive segments of the trajectory are merged into a single straight
+ * line segment as long as the merged line deviates from the original
+ * trajectory by at most the given tolerance along each axis at any point in
+ * time. The deviation is calculated analytically from the polynomials of the
+ * segments, not by sampling. Segments that cannot be replaced by a straight
+ * line are copied verbatim, and segments with zero duration are never merged.
+ *
+ * Yaw angles are checked against the yaw tolerance only if the trajectory
+ * declares that its yaw angles are relevant.
+ *
+ * @param result the trajectory to initialize
+ * @param trajectory the trajectory to simplify
+ * @param tolerance the maximum allowed deviation along the X, Y and Z axes,
+ *     in the units of the trajectory
+ * @param yaw_tolerance the maximum allowed deviation of the yaw angle,
+ *     in degrees
+ * @return \c SB_EINVAL if one of the tolerances is negative, \c SB_SUCCESS
+ *     or another error code otherwise
+ */
+sb_error_t sb_trajectory_init_simplified(
+    sb_trajectory_t* result, const sb_trajectory_t* trajectory,
+    float tolerance, float yaw_tolerance)
+{
+    sb_trajectory_player_t player;
+    sb_trajectory_builder_t builder;
+    sb_i_simplify_run_item_t* run;
+    sb_i_simplify_run_item_t* item;
+    const sb_trajectory_segment_t* segment;
+    sb_vector3_with_yaw_t run_start, run_end;
+    uint32_t run_duration_msec;
+    size_t run_length;
+    sb_bool_t merged;
+    sb_error_t retval;
+
+    if (!(tolerance >= 0) || !(yaw_tolerance >= 0)) {
+        return SB_EINVAL;
+    }
+
+    if (!trajectory->use_yaw) {
+        yaw_tolerance = INFINITY;
+    }
+
+    if (sb_trajectory_is_empty(trajectory)) {
+        return sb_trajectory_init_empty(result);
+    }
+
+    run = sb_calloc(sb_i_simplify_run_item_t, MAX_RUN_LENGTH);
+    if (run == 0) {
+        return SB_ENOMEM; /* LCOV_EXCL_LINE */
+    }
+
+    retval = sb_trajectory_builder_init(
+        &builder, (uint8_t)trajectory->scale,
+        trajectory->use_yaw ? SB_TRAJECTORY_USE_YAW : 0);
+    if (retval) {
+        goto cleanup_run;
+    }
+
+    retval = sb_trajectory_player_init(&player, trajectory);
+    if (retval) {
+        goto cleanup_builder;
+    }
+
+    retval = sb_trajectory_builder_set_start_position(&builder, trajectory->start);
+    if (retval) {
+        goto cleanup;
+    }
+
+    run_start = run_end = trajectory->start;
+    run_duration_msec = 0;
+    run_length = 0;
+
+    while (sb_trajectory_player_has_more_segments(&player)) {
+        segment = sb_trajectory_player_get_current_segment(&player);
+        merged = 0;
+
+        if (segment->duration_msec > 0) {
+            /* Try to extend the current run with this segment */
+            if (run_length < MAX_RUN_LENGTH && run_duration_msec + segment->duration_msec <= MAX_DURATION_MSEC) {
+                item = run + run_length;
+                item->start_time_msec = run_duration_msec;
+                item->duration_msec = segment->duration_msec;
+                item->poly = segment->poly;
+
+                merged = sb_i_run_is_close_to_line(
+                    run, run_length + 1, run_start, segment->end,
+                    run_duration_msec + segment->duration_msec,
+                    tolerance, yaw_tolerance);
+            }
+
+            /* If the segment does not fit into the current run, flush the run
+             * and try to start a new one with this segment */
+            if (!merged && run_length > 0) {
+                retval = sb_trajectory_builder_append_line(&builder, run_end, run_duration_msec);
+                if (retval) {
+                    goto cleanup;
+                }
+
+                run_start = run_end;
+                run_duration_msec = 0;
+                run_length = 0;
+
+                item = run;
+                item->start_time_msec = 0;
+                item->duration_msec = segment->duration_msec;
+                item->poly = segment->poly;
+
+                merged = sb_i_run_is_close_to_line(
+                    run, 1, run_start, segment->end, segment->duration_msec,
+                    tolerance, yaw_tolerance);
+            }
+
+            if (merged) {
+                run_length++;
+                run_duration_msec += segment->duration_msec;
+                run_end = segment->end;
+            }
+        } else if (run_length > 0) {
+            /* Segments with zero duration are never merged */
+            retval = sb_trajectory_builder_append_line(&builder, run_end, run_duration_msec);
+            if (retval) {
+                goto cleanup;
+            }
+
+            run_duration_msec = 0;
+            run_length = 0;
+        }
+
+        if (!merged) {
+            /* The control points of a segment are stored as absolute
+             * coordinates and its start point is implied by the end of the
+             * previous segment, which is left intact, so the segment can be
+             * copied verbatim */
+            retval = sb_buffer_append_bytes(
+                &builder.buffer,
+                SB_BUFFER(trajectory->buffer) + player.current_segment.start,
+                player.current_segment.length);
+            if (retval) {
+                goto cleanup; /* LCOV_EXCL_LINE */
+            }
+
+            builder.last_position = segment->end;
+            run_start = run_end = segment->end;
+        }
+
+        retval = sb_trajectory_player_build_next_segment(&player);
+        if (retval) {
+            goto cleanup;
+        }
+    }
+
+    if (run_length > 0) {
+        retval = sb_trajectory_builder_append_line(&builder, run_end, run_duration_msec);
+        if (retval) {
+            goto cleanup;
+        }
+    }
+
+    retval = sb_trajectory_init_from_builder(result, &builder);
+
+cleanup:
+    sb_trajectory_player_destroy(&player);
+
+cleanup_builder:
+    sb_trajectory_builder_destroy(&builder);
+
+cleanup_run:
+    sb_free(run);
+
+    return retval;
+}
+
+/* ************************************************************************** */
+
+/**
+ * Checks whether a single-axis polynomial, mapped to [0; 1], stays within the
+ * given tolerance of the line that goes from \p start to \p end such that
+ * the line is at \p t0 at the start of the polynomial and at \p t1 at the end,
+ * \p t0 and \p t1 being relative positions along the line.
+ */
+static sb_bool_t sb_i_poly_is_close_to_line(
+    const sb_poly_t* poly, float start, float end, float t0, float t1,
+    float tolerance)
+{
+    sb_poly_t diff = *poly;
+    sb_interval_t extrema;
+    uint8_t i;
+
+    if (isinf(tolerance)) {
+        return 1;
+    }
+
+    for (i = diff.num_coeffs; i < 2; i++) {
+        diff.coeffs[i] = 0;
+    }
+    if (diff.num_coeffs < 2) {
+        diff.num_coeffs = 2;
+    }
+
+    diff.coeffs[0] -= start + (end - start) * t0;
+    diff.coeffs[1] -= (end - start) * (t1 - t0);
+
+    sb_poly_get_extrema_bounds(&diff, &extrema);
+
+    return extrema.min >= -tolerance && extrema.max <= tolerance;
+}
+
+static sb_bool_t sb_i_run_is_close_to_line(
+    const sb_i_simplify_run_item_t* run, size_t length,
+    sb_vector3_with_yaw_t start, sb_vector3_with_yaw_t end, uint32_t duration_msec,
+    float tolerance, float yaw_tolerance)
+{
+    const sb_i_simplify_run_item_t* item;
+    float t0, t1;
+    size_t i;
+
+    for (i = 0, item = run; i < length; i++, item++) {
+        t0 = (float)item->start_time_msec / duration_msec;
+        t1 = (float)(item->start_time_msec + item->duration_msec) / duration_msec;
+
+        if (!sb_i_poly_is_close_to_line(&item->poly.x, start.x, end.x, t0, t1, tolerance)
+            || !sb_i_poly_is_close_to_line(&item->poly.y, start.y, end.y, t0, t1, tolerance)
+            || !sb_i_poly_is_close_to_line(&item->poly.z, start.z, end.z, t0, t1, tolerance)
+            || !sb_i_poly_is_close_to_line(&item->poly.yaw, start.yaw, end.yaw, t0, t1, yaw_tolerance)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
@@ -24,8 +24,15 @@
 #include <skybrush/trajectory.h>
 #include <skybrush/utils.h>
 
+#include "player.h"
+
+static sb_error_t sb_i_calculate_landing_time(
+    const sb_trajectory_stats_calculator_t* calc,
+    sb_trajectory_player_t* player,
+    float* result);
 static sb_bool_t sb_i_is_segment_descending_vertically(
-    const sb_trajectory_segment_t* segment, float threshold);
+    const sb_vector3_with_yaw_t* start, const sb_vector3_with_yaw_t* end,
+    void* threshold);
 
 /**
  * \brief Initializes a trajectory statistics calculator with sane defaults.
@@ -77,16 +84,9 @@ sb_error_t sb_trajectory_stats_calculator_run(
     sb_trajectory_player_t player;
     sb_trajectory_segment_t* segment;
     sb_vector3_with_yaw_t start, end;
-    struct sb_trajectory_player_state_s state;
-    sb_bool_t state_valid;
     float takeoff_altitude;
     float rel_t;
     float adjustment;
-    float altitude;
-    float delta;
-    float last_vertical_section_start_altitude;
-    float last_vertical_section_end_altitude;
-    float to_descend;
     sb_error_t retval = SB_SUCCESS;
 
     if (result == 0 || trajectory == 0) {
@@ -126,11 +126,13 @@ sb_error_t sb_trajectory_stats_calculator_run(
     /* Calculate the altitude we need to cross at takeoff */
     takeoff_altitude = start.z + calc->min_ascent;
 
-    /* Initialization before the main loop */
-    state_valid = 0;
+    /* Only the duration and the takeoff time need a forward pass over the
+     * segments; the landing time is calculated by walking backwards from the
+     * end of the trajectory */
+    components &= SB_TRAJECTORY_STATS_DURATION | SB_TRAJECTORY_STATS_TAKEOFF_TIME;
 
     /* Main loop over the trajectory segments */
-    while (sb_trajectory_player_has_more_segments(&player)) {
+    while (components != SB_TRAJECTORY_STATS_NONE && sb_trajectory_player_has_more_segments(&player)) {
         if (components & SB_TRAJECTORY_STATS_DURATION) {
             /* Add the duration of the current segment to the total duration */
             result->duration_msec += player.current_segment.data.duration_msec;
@@ -150,24 +152,6 @@ sb_error_t sb_trajectory_stats_calculator_run(
             }
         }
 
-        if (components & SB_TRAJECTORY_STATS_LANDING_TIME) {
-            if (sb_i_is_segment_descending_vertically(segment, calc->verticality_threshold)) {
-                if (!state_valid) {
-                    /* This is the first vertical segment in the current run of
-                     * vertical segments so remember the state */
-                    state = player.current_segment;
-                    state_valid = 1;
-                    last_vertical_section_start_altitude = sb_poly_eval(&segment->poly.z, 0);
-                }
-                last_vertical_section_end_altitude = sb_poly_eval(&segment->poly.z, 1);
-            } else {
-                /* This segment is not vertical so we cannot land earlier than
-                 * the end of this segment */
-                result->landing_time_sec = segment->end_time_sec;
-                state_valid = 0;
-            }
-        }
-
         if ((retval = sb_trajectory_player_build_next_segment(&player))) {
             goto cleanup;
         }
@@ -203,58 +187,8 @@ sb_error_t sb_trajectory_stats_calculator_run(
     }
 
     if (components & SB_TRAJECTORY_STATS_LANDING_TIME) {
-        /* Did the trajectory end with a sequence of vertically descending segments? */
-        if (state_valid) {
-            /* Jump back to the first such segment */
-            player.current_segment = state;
-
-            /* Given the total altitude difference in the vertically descending
-             * segment, calculate the distance we need to descend before switching
-             * to land mode to ensure that the final, automatic landing does not
-             * traverse more than a distance of preferred_descent */
-            to_descend = (
-                /* clang-format off */
-                last_vertical_section_start_altitude -
-                (last_vertical_section_end_altitude + calc->preferred_descent)
-                /* clang-format on */
-            );
-
-            if (to_descend > 0) {
-                /* The last vertical section is longer than the preferred
-                 * descent so find the point in the last vertical section where
-                 * we need to trigger the landing */
-                altitude = sb_poly_eval(&segment->poly.z, 0);
-                while (sb_trajectory_player_has_more_segments(&player)) {
-                    /* Can we consume the current segment in full? */
-                    delta = altitude - segment->end.z;
-                    if (delta < 0) {
-                        /* Segment is ascending, this should not happen */
-                        goto cleanup;
-                    } else if (delta <= to_descend) {
-                        /* We can consume the entire segment */
-                        to_descend -= delta;
-                        altitude = segment->end.z;
-                    } else {
-                        /* We can consume only part of the segment */
-                        if (!sb_poly_touches(&segment->poly.z, altitude - to_descend, &rel_t)) {
-                            /* should not happen, let's just land at the beginning
-                             * of the segment */
-                            rel_t = 0;
-                        }
-                        result->landing_time_sec = segment->start_time_sec + rel_t * segment->duration_sec;
-                        break;
-                    }
-
-                    /* Jump to the next segment */
-                    if (sb_trajectory_player_build_next_segment(&player)) {
-                        goto cleanup;
-                    }
-                }
-            } else {
-                /* The last vertical section is too short so we just trigger
-                 * landing at its beginning */
-                result->landing_time_sec = segment->start_time_sec;
-            }
+        if ((retval = sb_i_calculate_landing_time(calc, &player, &result->landing_time_sec))) {
+            goto cleanup;
         }
     }
 
@@ -265,26 +199,127 @@ cleanup:
 }
 
 /**
- * \brief Decides whether the given trajectory segment is descending vertically.
+ * \brief Calculates the proposed landing time of a trajectory.
+ *
+ * The function skims over the segments of the trajectory without constructing
+ * their polynomials to find the run of vertically descending segments at the
+ * end of the trajectory, and then decodes only the segments of this run. It
+ * does not allocate memory.
+ *
+ * \param calc    the calculator holding the landing-related settings
+ * \param player  a player for the trajectory; its state will be modified
+ * \param result  the proposed landing time is returned here, in seconds
+ */
+static sb_error_t sb_i_calculate_landing_time(
+    const sb_trajectory_stats_calculator_t* calc,
+    sb_trajectory_player_t* player,
+    float* result)
+{
+    sb_trajectory_segment_t* segment = &player->current_segment.data;
+    sb_trajectory_player_snapshot_t snapshot;
+    sb_vector3_with_yaw_t end;
+    float threshold = calc->verticality_threshold;
+    float last_vertical_section_start_altitude;
+    float last_vertical_section_end_altitude;
+    float to_descend;
+    float altitude;
+    float delta;
+    float rel_t;
+
+    /* Jump to the first segment in the final run of vertically descending
+     * segments */
+    SB_CHECK(sb_i_trajectory_player_build_first_segment_of_final_run(
+        player, sb_i_is_segment_descending_vertically, &threshold));
+
+    *result = segment->start_time_sec;
+
+    if (!sb_trajectory_player_has_more_segments(player)) {
+        /* The trajectory is empty or it does not end with a vertical descent
+         * so we cannot land earlier than its end */
+        return SB_SUCCESS;
+    }
+
+    /* Find the altitude at the end of the run and come back */
+    sb_trajectory_player_save_snapshot(player, &snapshot);
+    SB_CHECK(sb_trajectory_player_get_position_at(player, INFINITY, &end));
+    SB_CHECK(sb_trajectory_player_restore_snapshot(player, &snapshot));
+    last_vertical_section_end_altitude = end.z;
+
+    last_vertical_section_start_altitude = sb_poly_eval(&segment->poly.z, 0);
+
+    /* Given the total altitude difference in the vertically descending
+     * segment, calculate the distance we need to descend before switching
+     * to land mode to ensure that the final, automatic landing does not
+     * traverse more than a distance of preferred_descent */
+    to_descend = (
+        /* clang-format off */
+        last_vertical_section_start_altitude -
+        (last_vertical_section_end_altitude + calc->preferred_descent)
+        /* clang-format on */
+    );
+
+    if (to_descend <= 0) {
+        /* The last vertical section is too short so we just trigger
+         * landing at its beginning */
+        *result = segment->start_time_sec;
+        return SB_SUCCESS;
+    }
+
+    /* The last vertical section is longer than the preferred descent so find
+     * the point in the last vertical section where we need to trigger the
+     * landing */
+    altitude = last_vertical_section_start_altitude;
+    while (sb_trajectory_player_has_more_segments(player)) {
+        /* Can we consume the current segment in full? */
+        delta = altitude - segment->end.z;
+        if (delta < 0) {
+            /* Segment is ascending, this should not happen */
+            break;
+        } else if (delta <= to_descend) {
+            /* We can consume the entire segment */
+            to_descend -= delta;
+            altitude = segment->end.z;
+        } else {
+            /* We can consume only part of the segment */
+            if (!sb_poly_touches(&segment->poly.z, altitude - to_descend, &rel_t)) {
+                /* should not happen, let's just land at the beginning
+                 * of the segment */
+                rel_t = 0;
+            }
+            *result = segment->start_time_sec + rel_t * segment->duration_sec;
+            break;
+        }
+
+        /* Jump to the next segment */
+        SB_CHECK(sb_trajectory_player_build_next_segment(player));
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * \brief Decides whether a trajectory segment is descending vertically.
  *
  * A trajectory segment is considered to descend vertically if the distance between
  * the start and the end point of the segment along the X and Y axes are both
  * less than the given threshold, and the Z coordinate of the end point is less
  * than the Z coordinate of the start point.
  *
- * \param segment    the trajectory segment to check
- * \param threshold  the distance threshold
+ * \param start      the start point of the segment
+ * \param end        the end point of the segment
+ * \param threshold  pointer to the distance threshold, as a \c float
  */
 static sb_bool_t sb_i_is_segment_descending_vertically(
-    const sb_trajectory_segment_t* segment, float threshold)
+    const sb_vector3_with_yaw_t* start, const sb_vector3_with_yaw_t* end,
+    void* threshold)
 {
-    sb_vector3_with_yaw_t start = sb_poly_4d_eval(&segment->poly, 0);
+    float value = *(const float*)threshold;
 
     return (
         /* clang-format off */
-        fabsf(start.x - segment->end.x) <= threshold &&
-        fabsf(start.y - segment->end.y) <= threshold &&
-        start.z >= segment->end.z
+        fabsf(start->x - end->x) <= value &&
+        fabsf(start->y - end->y) <= value &&
+        start->z >= end->z
         /* clang-format on */
     );
 }
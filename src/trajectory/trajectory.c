@@ -26,7 +26,29 @@
 #include <skybrush/memory.h>
 #include <skybrush/trajectory.h>
 
+#include "../parallel.h"
 #include "../parsing.h"
+#include "../perf_counters.h"
+#include "player.h"
+
+/**
+ * Maximum number of coefficients of the polynomials that the root finder used
+ * for finding kinematic peaks needs to handle. These polynomials are products
+ * of two polynomials from a trajectory segment.
+ */
+#define SB_I_MAX_PEAK_POLY_COEFFS (2 * SB_MAX_POLY_COEFFS)
+
+/**
+ * Maximum number of candidate roots that the root finder may return.
+ */
+#define SB_I_MAX_PEAK_ROOTS (2 * SB_I_MAX_PEAK_POLY_COEFFS)
+
+/**
+ * Maximum depth of recursive subdivision in the root finder. Intervals are
+ * halved in each step so this is also the number of bits of precision that we
+ * have for roots that could not be isolated.
+ */
+#define SB_I_MAX_ROOT_FINDER_DEPTH 48
 
 static sb_error_t sb_i_trajectory_init_from_bytes(sb_trajectory_t* trajectory, uint8_t* buf, size_t nbytes, sb_bool_t owned);
 static sb_error_t sb_i_trajectory_init_from_parser(sb_trajectory_t* trajectory, sb_binary_file_parser_t* parser);
@@ -60,19 +82,39 @@ static size_t sb_i_trajectory_parse_header(sb_trajectory_t* trajectory);
  * Calculates the polygon representing the first derivative of the trajectory
  * segment if needed and returns it.
  */
-static sb_poly_4d_t* sb_i_get_dpoly(sb_trajectory_segment_t* segment);
+static sb_poly_4d_t* sb_i_get_dpoly(sb_trajectory_player_t* player);
 
 /**
  * Calculates the polygon representing the second derivative of the trajectory
  * segment if needed and returns it.
  */
-static sb_poly_4d_t* sb_i_get_ddpoly(sb_trajectory_segment_t* segment);
+static sb_poly_4d_t* sb_i_get_ddpoly(sb_trajectory_player_t* player);
 
 /**
  * @brief Returns the number of expected coordinates given the header bits.
  */
 static uint8_t sb_i_get_num_coords(uint8_t header_bits);
 
+/**
+ * Finds the peak of the length of the vector formed by one or two polynomials
+ * in a trajectory segment, given their derivatives.
+ */
+static void sb_i_find_peak(
+    const sb_poly_t* x, const sb_poly_t* y, const sb_poly_t* dx,
+    const sb_poly_t* dy, const sb_trajectory_segment_t* segment,
+    sb_trajectory_peak_t* peak);
+
+/**
+ * Finds the roots of a polynomial in the open interval (0; 1).
+ *
+ * Roots that are closer to each other than the precision of the subdivision
+ * may be reported more than once, and roots of even multiplicity may be
+ * missed. Both are harmless when the roots are used as candidate locations of
+ * extrema.
+ */
+static uint8_t sb_i_find_roots_in_unit_interval(
+    const double* coeffs, uint8_t num_coeffs, double* roots);
+
 /**
  * Builds the current trajectory segment from the wrapped buffer, starting from
  * the given offset, assuming that the start point of the current segment has
@@ -82,6 +124,30 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
     sb_trajectory_player_t* player, size_t offset, uint32_t start_time_msec,
     sb_vector3_with_yaw_t start);
 
+/**
+ * Skims over the segment of the trajectory starting at the given offset
+ * without constructing its polynomials. Adds the duration of the segment to
+ * \p time_msec , updates \p pos to the end point of the segment and returns
+ * the offset of the next segment.
+ */
+static size_t sb_i_trajectory_skim_segment(
+    const sb_trajectory_t* trajectory, size_t offset, uint32_t* time_msec,
+    sb_vector3_with_yaw_t* pos);
+
+/**
+ * Builds the segment table of the trajectory player if it has not been built
+ * yet. The table is built by skimming through the segments of the trajectory
+ * without constructing their polynomials.
+ */
+static sb_error_t sb_i_trajectory_player_ensure_segment_table(sb_trajectory_player_t* player);
+
+/**
+ * Finds the index of the current segment of the player in the segment table.
+ * Returns the number of segments if the player is beyond the last segment.
+ */
+static sb_error_t sb_i_trajectory_player_find_current_segment_in_table(
+    const sb_trajectory_player_t* player, size_t* index);
+
 /**
  * Finds the segment in the trajectory that contains the given time.
  * Returns the relative time into the segment such that rel_t = 0 is the
@@ -90,11 +156,21 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
  */
 static sb_error_t sb_i_trajectory_player_seek_to_time(sb_trajectory_player_t* player, float t, float* rel_t);
 
+/**
+ * Same as \ref sb_i_trajectory_player_seek_to_time() but takes the time in
+ * milliseconds and uses double-precision arithmetic. Segment boundaries are
+ * compared against the integer timestamps of the segments so the result does
+ * not depend on rounding errors late in long trajectories.
+ */
+static sb_error_t sb_i_trajectory_player_seek_to_time_msec(
+    sb_trajectory_player_t* player, double t_msec, double* rel_t);
+
 /**
  * Destroys a trajectory object and releases all memory that it owns.
  */
 void sb_trajectory_destroy(sb_trajectory_t* trajectory)
 {
+    trajectory->frozen = 0;
     sb_trajectory_clear(trajectory); /* will not fail here */
     sb_buffer_destroy(&trajectory->buffer);
 }
@@ -102,9 +178,16 @@ void sb_trajectory_destroy(sb_trajectory_t* trajectory)
 /**
  * Clears the trajectory object and removes all segments from it. Also releases
  * any memory that the trajectory owns.
+ *
+ * \return \c SB_SUCCESS if the trajectory was cleared, \c SB_EPERM if the
+ *         trajectory is frozen
  */
 sb_error_t sb_trajectory_clear(sb_trajectory_t* trajectory)
 {
+    if (trajectory->frozen) {
+        return SB_EPERM;
+    }
+
     if (sb_buffer_is_view(&trajectory->buffer)) {
         /* clear the entire buffer with zero bytes -- this should be enough
          * to make the trajectory empty because the duration of the first
@@ -125,6 +208,27 @@ sb_error_t sb_trajectory_clear(sb_trajectory_t* trajectory)
     return SB_SUCCESS;
 }
 
+/**
+ * Freezes the trajectory, marking it as read-only for the rest of its
+ * lifetime.
+ *
+ * A frozen trajectory rejects all modifications with \c SB_EPERM; the only
+ * mutating operation that remains permitted is \ref sb_trajectory_destroy() ,
+ * which must not be called while any player still uses the trajectory.
+ *
+ * Frozen trajectories may be shared between threads without any locking.
+ * Trajectory players keep all their lazily computed state in the player
+ * itself and never write into the trajectory, so any number of threads may
+ * each run their own \ref sb_trajectory_player_t on the same frozen
+ * trajectory concurrently, and may call any function that takes a const
+ * trajectory pointer at the same time. A single player must still not be
+ * used from multiple threads at once.
+ */
+void sb_trajectory_freeze(sb_trajectory_t* trajectory)
+{
+    trajectory->frozen = 1;
+}
+
 /**
  * Initializes a trajectory object from the contents of a Skybrush file in
  * binary format.
@@ -141,7 +245,8 @@ sb_error_t sb_trajectory_init_from_binary_file(sb_trajectory_t* trajectory, int
     sb_binary_file_parser_t parser;
     sb_error_t retval;
 
-    SB_CHECK(sb_binary_file_parser_init_from_file(&parser, fd));
+    SB_CHECK(sb_binary_file_parser_init_from_file_with_flags(
+        &parser, fd, SB_BINARY_PARSER_USE_CRC_CACHE));
     retval = sb_i_trajectory_init_from_parser(trajectory, &parser);
     sb_binary_file_parser_destroy(&parser);
 
@@ -180,9 +285,40 @@ sb_error_t sb_i_trajectory_init_from_bytes(sb_trajectory_t* trajectory, uint8_t*
         sb_buffer_init_view(&trajectory->buffer, buf, nbytes);
     }
     trajectory->header_length = sb_i_trajectory_parse_header(trajectory);
+    trajectory->frozen = 0;
     return SB_SUCCESS;
 }
 
+/**
+ * Initializes a trajectory object from the first trajectory block found by an
+ * already open binary file parser.
+ *
+ * If the parser reads from memory, the trajectory refers to the block in the
+ * buffer of the parser instead of copying it, so that buffer must outlive the
+ * trajectory.
+ *
+ * \param trajectory  the object to initialize
+ * \param parser  the parser to read the block from
+ *
+ * \return \c SB_SUCCESS if the object was initialized successfully,
+ *         \c SB_ENOENT if the file did not contain a trajectory block,
+ *         \c SB_EREAD for read errors
+ */
+sb_error_t sb_trajectory_init_from_parser(sb_trajectory_t* trajectory, sb_binary_file_parser_t* parser)
+{
+    sb_binary_block_t block;
+    uint8_t* buf;
+
+    SB_CHECK(sb_binary_file_find_first_block_by_type(parser, SB_BINARY_BLOCK_TRAJECTORY));
+
+    if (sb_binary_file_get_current_block_view(parser, &buf) == SB_SUCCESS) {
+        block = sb_binary_file_get_current_block(parser);
+        return sb_trajectory_init_from_buffer(trajectory, buf, block.length);
+    }
+
+    return sb_i_trajectory_init_from_parser(trajectory, parser);
+}
+
 static sb_error_t sb_i_trajectory_init_from_parser(sb_trajectory_t* trajectory, sb_binary_file_parser_t* parser)
 {
     sb_error_t retval;
@@ -258,6 +394,7 @@ sb_error_t sb_trajectory_init_empty(sb_trajectory_t* trajectory)
     trajectory->scale = 1;
     trajectory->use_yaw = 0;
     trajectory->header_length = 0;
+    trajectory->frozen = 0;
 
     return SB_SUCCESS;
 }
@@ -283,15 +420,15 @@ sb_error_t sb_trajectory_get_axis_aligned_bounding_box(
         const sb_trajectory_segment_t* segment = sb_trajectory_player_get_current_segment(&player);
         sb_interval_t interval;
 
-#define CHECK_DIM(DIM)                                      \
-    {                                                       \
-        sb_poly_get_extrema(&segment->poly.DIM, &interval); \
-        if (interval.min < result->DIM.min) {               \
-            result->DIM.min = interval.min;                 \
-        }                                                   \
-        if (interval.max > result->DIM.max) {               \
-            result->DIM.max = interval.max;                 \
-        }                                                   \
+#define CHECK_DIM(DIM)                                             \
+    {                                                              \
+        sb_poly_get_extrema_bounds(&segment->poly.DIM, &interval); \
+        if (interval.min < result->DIM.min) {                      \
+            result->DIM.min = interval.min;                        \
+        }                                                          \
+        if (interval.max > result->DIM.max) {                      \
+            result->DIM.max = interval.max;                        \
+        }                                                          \
     }
 
         CHECK_DIM(x);
@@ -324,6 +461,102 @@ sb_error_t sb_trajectory_get_end_position(
     return retval;
 }
 
+typedef struct {
+    const sb_trajectory_t* trajectories;
+    sb_trajectory_kinematic_peaks_t* results;
+} sb_i_kinematic_peaks_job_t;
+
+static void sb_i_kinematic_peaks_init(sb_trajectory_kinematic_peaks_t* peaks, float time_sec)
+{
+    peaks->horizontal_velocity.value = 0;
+    peaks->horizontal_velocity.time_sec = time_sec;
+    peaks->vertical_velocity = peaks->horizontal_acceleration = peaks->vertical_acceleration = peaks->horizontal_velocity;
+}
+
+static sb_error_t sb_i_kinematic_peaks_range(void* context, size_t start, size_t end)
+{
+    sb_i_kinematic_peaks_job_t* job = (sb_i_kinematic_peaks_job_t*)context;
+
+    for (; start < end; start++) {
+        SB_CHECK(sb_trajectory_get_kinematic_peaks(&job->trajectories[start], &job->results[start]));
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Returns the peak horizontal and vertical velocities and accelerations of the
+ * trajectory, along with the times when they are attained.
+ *
+ * The peaks are calculated analytically for each segment with
+ * \ref sb_trajectory_player_get_current_segment_peaks() so they are exact up
+ * to floating-point precision, unlike the ones obtained by sampling the
+ * velocities and accelerations.
+ *
+ * When the same peak value is attained multiple times, the earliest one is
+ * returned.
+ */
+sb_error_t sb_trajectory_get_kinematic_peaks(
+    const sb_trajectory_t* trajectory, sb_trajectory_kinematic_peaks_t* result)
+{
+    sb_trajectory_player_t player;
+    sb_trajectory_kinematic_peaks_t segment_peaks;
+
+    sb_i_kinematic_peaks_init(result, 0);
+
+    SB_CHECK(sb_trajectory_player_init(&player, trajectory));
+
+    while (sb_trajectory_player_has_more_segments(&player)) {
+        SB_CHECK(sb_trajectory_player_get_current_segment_peaks(&player, &segment_peaks));
+
+#define MERGE(FIELD)                                       \
+    if (segment_peaks.FIELD.value > result->FIELD.value) { \
+        result->FIELD = segment_peaks.FIELD;               \
+    }
+
+        MERGE(horizontal_velocity);
+        MERGE(vertical_velocity);
+        MERGE(horizontal_acceleration);
+        MERGE(vertical_acceleration);
+
+#undef MERGE
+
+        SB_CHECK(sb_trajectory_player_build_next_segment(&player));
+    }
+
+    sb_trajectory_player_destroy(&player);
+
+    return SB_SUCCESS;
+}
+
+/**
+ * @brief Calculates the kinematic peaks of multiple trajectories at once.
+ *
+ * This function calls \ref sb_trajectory_get_kinematic_peaks() for each
+ * trajectory, distributing the trajectories among multiple threads.
+ *
+ * @param trajectories the trajectories to process
+ * @param num_trajectories the number of trajectories
+ * @param results the peaks of each trajectory are returned here; must have
+ *     room for \p num_trajectories items
+ * @param num_threads the number of threads to use; zero means one thread
+ *     per CPU core. Has no effect if the library was compiled without thread
+ *     support.
+ * @return the first error code returned for one of the trajectories, or
+ *     \c SB_SUCCESS if all of them were processed successfully
+ */
+sb_error_t sb_trajectory_get_kinematic_peaks_parallel(
+    const sb_trajectory_t* trajectories, size_t num_trajectories,
+    sb_trajectory_kinematic_peaks_t* results, size_t num_threads)
+{
+    sb_i_kinematic_peaks_job_t job;
+
+    job.trajectories = trajectories;
+    job.results = results;
+
+    return sb_i_parallel_for(num_trajectories, num_threads, sb_i_kinematic_peaks_range, &job);
+}
+
 /**
  * Returns the start position of the trajectory.
  */
@@ -485,6 +718,16 @@ sb_bool_t sb_trajectory_is_empty(const sb_trajectory_t* trajectory)
         sb_buffer_size(&trajectory->buffer) == 0 || (SB_BUFFER(trajectory->buffer)[0] & 0x7f) == 0);
 }
 
+/**
+ * Returns whether the trajectory is frozen and cannot be modified any more.
+ *
+ * \sa sb_trajectory_freeze()
+ */
+sb_bool_t sb_trajectory_is_frozen(const sb_trajectory_t* trajectory)
+{
+    return trajectory->frozen;
+}
+
 /* ************************************************************************** */
 
 static size_t sb_i_trajectory_parse_header(sb_trajectory_t* trajectory)
@@ -547,6 +790,7 @@ sb_error_t sb_trajectory_player_init(sb_trajectory_player_t* player, const sb_tr
  */
 void sb_trajectory_player_destroy(sb_trajectory_player_t* player)
 {
+    sb_free_unless_null(player->segment_table);
     memset(player, 0, sizeof(sb_trajectory_player_t));
 }
 
@@ -559,6 +803,78 @@ sb_error_t sb_trajectory_player_rewind(sb_trajectory_player_t* player)
         player, player->trajectory->header_length, 0, player->trajectory->start);
 }
 
+/**
+ * Saves the state of the trajectory player into a snapshot.
+ *
+ * The snapshot records the current segment only; it can be restored into any
+ * player that plays the same trajectory with
+ * \ref sb_trajectory_player_restore_snapshot() .
+ *
+ * \param player    the player whose state is to be saved
+ * \param snapshot  the snapshot to write the state into
+ */
+void sb_trajectory_player_save_snapshot(
+    const sb_trajectory_player_t* player, sb_trajectory_player_snapshot_t* snapshot)
+{
+    const sb_trajectory_segment_t* data = &player->current_segment.data;
+
+    memset(snapshot, 0, sizeof(sb_trajectory_player_snapshot_t));
+    snapshot->trajectory_size = sb_buffer_size(&player->trajectory->buffer);
+    snapshot->offset = player->current_segment.start;
+    snapshot->length = player->current_segment.length;
+    snapshot->start_time_msec = data->start_time_msec;
+    snapshot->start = data->start;
+}
+
+/**
+ * Restores the state of the trajectory player from a snapshot.
+ *
+ * Only the segment that was current when the snapshot was taken is decoded
+ * again, so restoring a snapshot takes constant time irrespectively of how
+ * far the player was into the trajectory.
+ *
+ * \param player    the player to restore; it must already be initialized with
+ *        the same trajectory that the snapshot was taken from
+ * \param snapshot  the snapshot to restore
+ *
+ * \return \c SB_SUCCESS if the snapshot was restored, \c SB_EINVAL if the
+ *         snapshot does not belong to the trajectory of the player or the
+ *         segment that it points to does not fit in the trajectory. The state
+ *         of the player is left intact in case of an error.
+ */
+sb_error_t sb_trajectory_player_restore_snapshot(
+    sb_trajectory_player_t* player, const sb_trajectory_player_snapshot_t* snapshot)
+{
+    const sb_trajectory_t* trajectory = player->trajectory;
+    const uint8_t* buf = SB_BUFFER(trajectory->buffer);
+    size_t size = sb_buffer_size(&trajectory->buffer);
+    size_t length;
+    uint8_t header;
+
+    if (snapshot->trajectory_size != size || snapshot->offset < trajectory->header_length || snapshot->offset > size) {
+        return SB_EINVAL;
+    }
+
+    /* An offset equal to the size of the buffer is the state of the player
+     * after the last segment. Anything else must hold a segment whose header
+     * and duration fit in the buffer and whose length, as derived from the
+     * header, matches the snapshot and fits in the buffer as well */
+    if (snapshot->offset < size && trajectory->scale != 0) {
+        if (size - snapshot->offset < 3) {
+            return SB_EINVAL;
+        }
+
+        header = buf[snapshot->offset];
+        length = 3 + 2 * (sb_i_get_num_coords(header) + sb_i_get_num_coords(header >> 2) + sb_i_get_num_coords(header >> 4) + sb_i_get_num_coords(header >> 6) - 4);
+        if (length != snapshot->length || length > size - snapshot->offset) {
+            return SB_EINVAL;
+        }
+    }
+
+    return sb_i_trajectory_player_build_current_segment(
+        player, snapshot->offset, snapshot->start_time_msec, snapshot->start);
+}
+
 /**
  * Builds the next segment in the trajectory player. Used to move on to the next
  * segment during an iteration over the segments of the trajectory.
@@ -574,6 +890,108 @@ sb_error_t sb_trajectory_player_build_next_segment(sb_trajectory_player_t* playe
         segment->end);
 }
 
+/**
+ * Builds the segment preceding the current one in the trajectory player. Used
+ * to iterate over the segments of the trajectory backwards.
+ *
+ * The first call to this function builds a table of all the segments in the
+ * trajectory, which takes time proportional to the number of segments but does
+ * not involve decoding the polynomials of the segments. Subsequent steps take
+ * constant time.
+ *
+ * \param player  the trajectory player
+ * \return \c SB_ENOENT if the current segment is the first one, in which case
+ *         the state of the player is left intact, \c SB_ENOMEM if the segment
+ *         table could not be allocated, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_player_build_previous_segment(sb_trajectory_player_t* player)
+{
+    const sb_trajectory_segment_table_entry_t* entry;
+    size_t index;
+
+    SB_CHECK(sb_i_trajectory_player_ensure_segment_table(player));
+    SB_CHECK(sb_i_trajectory_player_find_current_segment_in_table(player, &index));
+
+    if (index == 0) {
+        return SB_ENOENT;
+    }
+
+    entry = &player->segment_table[index - 1];
+    return sb_i_trajectory_player_build_current_segment(
+        player, entry->offset, entry->start_time_msec, entry->start);
+}
+
+/**
+ * Builds the last segment of the trajectory in the trajectory player. Used
+ * to start an iteration over the segments of the trajectory backwards.
+ *
+ * \param player  the trajectory player
+ * \return \c SB_ENOENT if the trajectory has no segments, in which case the
+ *         state of the player is left intact, \c SB_ENOMEM if the segment
+ *         table could not be allocated, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_player_build_last_segment(sb_trajectory_player_t* player)
+{
+    const sb_trajectory_segment_table_entry_t* entry;
+
+    SB_CHECK(sb_i_trajectory_player_ensure_segment_table(player));
+
+    if (player->num_segments == 0) {
+        return SB_ENOENT;
+    }
+
+    entry = &player->segment_table[player->num_segments - 1];
+    return sb_i_trajectory_player_build_current_segment(
+        player, entry->offset, entry->start_time_msec, entry->start);
+}
+
+/**
+ * Builds the first segment of the run of segments at the end of the
+ * trajectory that all satisfy the given predicate. If the last segment does
+ * not satisfy the predicate, the player is moved beyond the end of the
+ * trajectory instead.
+ *
+ * The segments are skimmed without constructing their polynomials and without
+ * allocating memory, so this takes time proportional to the number of
+ * segments but is much cheaper than iterating over them with
+ * \ref sb_trajectory_player_build_next_segment() .
+ *
+ * \param player     the trajectory player
+ * \param predicate  function that receives the start and the end point of a
+ *        segment and the context, and decides whether the segment belongs to
+ *        the run
+ * \param context    arbitrary pointer passed to the predicate
+ */
+sb_error_t sb_i_trajectory_player_build_first_segment_of_final_run(
+    sb_trajectory_player_t* player, sb_i_trajectory_segment_predicate_t* predicate,
+    void* context)
+{
+    const sb_trajectory_t* trajectory = player->trajectory;
+    size_t buffer_length = sb_buffer_size(&trajectory->buffer);
+    size_t offset, run_offset;
+    uint32_t time_msec, run_time_msec;
+    sb_vector3_with_yaw_t start, end, run_start;
+
+    offset = run_offset = trajectory->header_length;
+    time_msec = run_time_msec = 0;
+    end = run_start = trajectory->start;
+
+    if (trajectory->scale != 0) {
+        while (offset < buffer_length) {
+            start = end;
+            offset = sb_i_trajectory_skim_segment(trajectory, offset, &time_msec, &end);
+            if (!predicate(&start, &end, context)) {
+                /* The run can start at the next segment at the earliest */
+                run_offset = offset;
+                run_time_msec = time_msec;
+                run_start = end;
+            }
+        }
+    }
+
+    return sb_i_trajectory_player_build_current_segment(player, run_offset, run_time_msec, run_start);
+}
+
 /* LCOV_EXCL_START */
 
 /**
@@ -584,8 +1002,8 @@ void sb_trajectory_player_dump_current_segment(const sb_trajectory_player_t* pla
 #ifdef LIBSKYBRUSH_DEBUG
     sb_vector3_with_yaw_t pos, vel, acc;
     const sb_trajectory_segment_t* current = sb_trajectory_player_get_current_segment(player);
-    const sb_poly_4d_t* dpoly = sb_i_get_dpoly(current);
-    const sb_poly_4d_t* ddpoly = sb_i_get_dpoly(current);
+    const sb_poly_4d_t* dpoly = sb_i_get_dpoly((sb_trajectory_player_t*)player);
+    const sb_poly_4d_t* ddpoly = sb_i_get_ddpoly((sb_trajectory_player_t*)player);
 
     printf("Start offset = %ld bytes\n", (long int)player->current_segment.start);
     printf("Length = %ld bytes\n", (long int)player->current_segment.length);
@@ -654,7 +1072,7 @@ sb_error_t sb_trajectory_player_get_velocity_at(sb_trajectory_player_t* player,
     SB_CHECK(sb_i_trajectory_player_seek_to_time(player, t, &rel_t));
 
     if (result) {
-        *result = sb_poly_4d_eval(sb_i_get_dpoly(&player->current_segment.data), rel_t);
+        *result = sb_poly_4d_eval(sb_i_get_dpoly(player), rel_t);
     }
 
     return SB_SUCCESS;
@@ -671,9 +1089,125 @@ sb_error_t sb_trajectory_player_get_acceleration_at(sb_trajectory_player_t* play
     SB_CHECK(sb_i_trajectory_player_seek_to_time(player, t, &rel_t));
 
     if (result) {
-        *result = sb_poly_4d_eval(sb_i_get_ddpoly(&player->current_segment.data), rel_t);
+        *result = sb_poly_4d_eval(sb_i_get_ddpoly(player), rel_t);
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Returns the position on the trajectory associated to the player at the given
+ * time instant, using double-precision time arithmetic.
+ *
+ * Single-precision time in seconds loses sub-millisecond resolution after a
+ * few hours, which may make the player flip between adjacent segments near
+ * their boundaries. This function is slightly slower than
+ * \ref sb_trajectory_player_get_position_at() but it is accurate for the
+ * entire range of timestamps that a trajectory can represent.
+ *
+ * \param player  the trajectory player
+ * \param t_msec  the time instant, in milliseconds; fractional values are
+ *        allowed
+ * \param result  the position is returned here
+ */
+sb_error_t sb_trajectory_player_get_position_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result)
+{
+    double rel_t;
+
+    SB_CHECK(sb_i_trajectory_player_seek_to_time_msec(player, t_msec, &rel_t));
+
+    if (result) {
+        *result = sb_poly_4d_eval_double(&player->current_segment.data.poly, rel_t);
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Returns the velocity on the trajectory associated to the player at the given
+ * time instant, using double-precision time arithmetic.
+ *
+ * \sa sb_trajectory_player_get_position_at_msec()
+ */
+sb_error_t sb_trajectory_player_get_velocity_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result)
+{
+    double rel_t;
+
+    SB_CHECK(sb_i_trajectory_player_seek_to_time_msec(player, t_msec, &rel_t));
+
+    if (result) {
+        *result = sb_poly_4d_eval_double(sb_i_get_dpoly(player), rel_t);
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Returns the acceleration on the trajectory associated to the player at the
+ * given time instant, using double-precision time arithmetic.
+ *
+ * \sa sb_trajectory_player_get_position_at_msec()
+ */
+sb_error_t sb_trajectory_player_get_acceleration_at_msec(
+    sb_trajectory_player_t* player, double t_msec, sb_vector3_with_yaw_t* result)
+{
+    double rel_t;
+
+    SB_CHECK(sb_i_trajectory_player_seek_to_time_msec(player, t_msec, &rel_t));
+
+    if (result) {
+        *result = sb_poly_4d_eval_double(sb_i_get_ddpoly(player), rel_t);
+    }
+
+    return SB_SUCCESS;
+}
+
+/**
+ * Returns the peak horizontal and vertical velocities and accelerations in the
+ * current segment of the trajectory player, along with the times when they are
+ * attained.
+ *
+ * The peaks are found analytically. The extrema of each quantity are either at
+ * the endpoints of the segment or at the roots of its derivative, which is
+ * built from the velocity and acceleration polynomials of the segment (or the
+ * acceleration and jerk polynomials for the acceleration peaks).
+ *
+ * Peaks are zero and are timestamped at the start of the segment if the
+ * segment has zero duration or if the player has reached the end of the
+ * trajectory.
+ */
+sb_error_t sb_trajectory_player_get_current_segment_peaks(
+    sb_trajectory_player_t* player, sb_trajectory_kinematic_peaks_t* result)
+{
+    const sb_trajectory_segment_t* segment = &player->current_segment.data;
+    const sb_poly_4d_t* dpoly;
+    const sb_poly_4d_t* ddpoly;
+    sb_poly_t jerk_x, jerk_y, jerk_z;
+
+    sb_i_kinematic_peaks_init(result, segment->start_time_sec);
+
+    if (!sb_trajectory_player_has_more_segments(player) || segment->duration_msec == 0) {
+        return SB_SUCCESS;
     }
 
+    dpoly = sb_i_get_dpoly(player);
+    ddpoly = sb_i_get_ddpoly(player);
+
+    /* We need the roots of the jerk only so there is no need to scale it */
+    jerk_x = ddpoly->x;
+    jerk_y = ddpoly->y;
+    jerk_z = ddpoly->z;
+    sb_poly_deriv(&jerk_x);
+    sb_poly_deriv(&jerk_y);
+    sb_poly_deriv(&jerk_z);
+
+    sb_i_find_peak(&dpoly->x, &dpoly->y, &ddpoly->x, &ddpoly->y, segment, &result->horizontal_velocity);
+    sb_i_find_peak(&dpoly->z, NULL, &ddpoly->z, NULL, segment, &result->vertical_velocity);
+    sb_i_find_peak(&ddpoly->x, &ddpoly->y, &jerk_x, &jerk_y, segment, &result->horizontal_acceleration);
+    sb_i_find_peak(&ddpoly->z, NULL, &jerk_z, NULL, segment, &result->vertical_acceleration);
+
     return SB_SUCCESS;
 }
 
@@ -710,6 +1244,41 @@ sb_bool_t sb_trajectory_player_has_more_segments(const sb_trajectory_player_t* p
 
 /* ************************************************************************** */
 
+/**
+ * Returns the performance counters of the trajectory player.
+ *
+ * \param player  the trajectory player
+ * \param result  the counters are returned here; all of them are set to zero
+ *        if the library was compiled without performance counters
+ * \return \c SB_EUNSUPPORTED if the library was compiled without performance
+ *         counters, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_trajectory_player_get_perf_counters(
+    const sb_trajectory_player_t* player, sb_perf_counters_t* result)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    *result = player->perf_counters;
+    return SB_SUCCESS;
+#else
+    memset(result, 0, sizeof(sb_perf_counters_t));
+    return SB_EUNSUPPORTED;
+#endif
+}
+
+/**
+ * Resets the performance counters of the trajectory player to zero.
+ */
+void sb_trajectory_player_reset_perf_counters(sb_trajectory_player_t* player)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    memset(&player->perf_counters, 0, sizeof(sb_perf_counters_t));
+#else
+    ((void)player);
+#endif
+}
+
+/* ************************************************************************** */
+
 static sb_error_t sb_i_trajectory_player_seek_to_time(sb_trajectory_player_t* player, float t, float* rel_t)
 {
     size_t offset;
@@ -718,12 +1287,15 @@ static sb_error_t sb_i_trajectory_player_seek_to_time(sb_trajectory_player_t* pl
         t = 0;
     }
 
+    SB_PERF_COUNT(player->perf_counters, seeks);
+
     while (1) {
         sb_trajectory_segment_t* segment = &player->current_segment.data;
 
         if (segment->start_time_sec > t) {
             /* time that the user asked for is before the current segment. We simply
              * rewind and start from scratch */
+            SB_PERF_COUNT(player->perf_counters, rewinds);
             SB_CHECK(sb_trajectory_player_rewind(player));
             assert(player->current_segment.data.start_time_msec == 0);
         } else if (segment->end_time_sec < t) {
@@ -753,6 +1325,50 @@ static sb_error_t sb_i_trajectory_player_seek_to_time(sb_trajectory_player_t* pl
     }
 }
 
+static sb_error_t sb_i_trajectory_player_seek_to_time_msec(
+    sb_trajectory_player_t* player, double t_msec, double* rel_t)
+{
+    sb_trajectory_segment_t* segment;
+    size_t offset;
+
+    if (t_msec <= 0) {
+        t_msec = 0;
+    } else if (t_msec > UINT32_MAX) {
+        /* the last segment of every trajectory ends at UINT32_MAX */
+        t_msec = UINT32_MAX;
+    }
+
+    SB_PERF_COUNT(player->perf_counters, seeks);
+
+    while (1) {
+        segment = &player->current_segment.data;
+
+        if (segment->start_time_msec > t_msec) {
+            SB_PERF_COUNT(player->perf_counters, rewinds);
+            SB_CHECK(sb_trajectory_player_rewind(player));
+        } else if (segment->end_time_msec < t_msec) {
+            offset = player->current_segment.start;
+            SB_CHECK(sb_trajectory_player_build_next_segment(player));
+            if (sb_trajectory_player_has_more_segments(player)) {
+                assert(player->current_segment.start > offset);
+            }
+            ((void)offset);
+        } else {
+            if (rel_t) {
+                if (!isfinite(segment->duration_sec)) {
+                    /* infinite segment after the end of the trajectory */
+                    *rel_t = t_msec < UINT32_MAX ? 0 : 1;
+                } else if (segment->duration_msec > 0) {
+                    *rel_t = (t_msec - segment->start_time_msec) / segment->duration_msec;
+                } else {
+                    *rel_t = 0.5;
+                }
+            }
+            return SB_SUCCESS;
+        }
+    }
+}
+
 static sb_error_t sb_i_trajectory_player_build_current_segment(
     sb_trajectory_player_t* player, size_t offset, uint32_t start_time_msec,
     sb_vector3_with_yaw_t start)
@@ -761,20 +1377,26 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
     uint8_t* buf = SB_BUFFER(trajectory->buffer);
     size_t buffer_length = sb_buffer_size(&trajectory->buffer);
     sb_trajectory_segment_t* data = &player->current_segment.data;
+    sb_poly_t* polys[3] = { &data->poly.x, &data->poly.y, &data->poly.z };
+    float* ends[3] = { &data->end.x, &data->end.y, &data->end.z };
+    const float starts[3] = { start.x, start.y, start.z };
+    float points[21];
+    const float* points_ptr;
     float coords[8];
-    unsigned int i;
+    unsigned int i, axis;
 
     uint8_t header;
-    size_t num_coords;
+    size_t num_coords, num_points;
 
     /* Initialize the current segment */
     memset(&player->current_segment, 0, sizeof(player->current_segment));
     player->current_segment.start = offset;
     player->current_segment.length = 0;
 
-    /* Store the start time as instructed */
+    /* Store the start time and the start point as instructed */
     data->start_time_msec = start_time_msec;
     data->start_time_sec = start_time_msec / 1000.0f;
+    data->start = start;
 
     if (offset >= buffer_length || trajectory->scale == 0) {
         /* We are beyond the end of the buffer or the scale is zero, indicating
@@ -792,6 +1414,8 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
         return SB_SUCCESS;
     }
 
+    SB_PERF_COUNT(player->perf_counters, items_decoded);
+
     /* Parse header */
     header = buf[offset++];
 
@@ -801,32 +1425,21 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
     data->end_time_msec = data->start_time_msec + data->duration_msec;
     data->end_time_sec = data->end_time_msec / 1000.0f;
 
-    /* Parse X coordinates */
-    num_coords = sb_i_get_num_coords(header >> 0);
-    coords[0] = start.x;
-    for (i = 1; i < num_coords; i++) {
-        coords[i] = sb_i_trajectory_parse_coordinate(trajectory, &offset);
-    }
-    data->end.x = coords[num_coords - 1];
-    sb_poly_make_bezier(&data->poly.x, 1, coords, num_coords);
-
-    /* Parse Y coordinates */
-    num_coords = sb_i_get_num_coords(header >> 2);
-    coords[0] = start.y;
-    for (i = 1; i < num_coords; i++) {
-        coords[i] = sb_i_trajectory_parse_coordinate(trajectory, &offset);
-    }
-    data->end.y = coords[num_coords - 1];
-    sb_poly_make_bezier(&data->poly.y, 1, coords, num_coords);
-
-    /* Parse Z coordinates */
-    num_coords = sb_i_get_num_coords(header >> 4);
-    coords[0] = start.z;
-    for (i = 1; i < num_coords; i++) {
-        coords[i] = sb_i_trajectory_parse_coordinate(trajectory, &offset);
+    /* The control points of the X, Y and Z coordinates are stored back to
+     * back so we can decode all of them in one go and then distribute them
+     * among the axes */
+    num_points = sb_i_get_num_coords(header) + sb_i_get_num_coords(header >> 2) + sb_i_get_num_coords(header >> 4) - 3;
+    sb_parse_int16_array_scaled(buf, &offset, num_points, trajectory->scale, points);
+
+    points_ptr = points;
+    for (axis = 0; axis < 3; axis++) {
+        num_coords = sb_i_get_num_coords(header >> (2 * axis));
+        coords[0] = starts[axis];
+        memcpy(coords + 1, points_ptr, (num_coords - 1) * sizeof(float));
+        points_ptr += num_coords - 1;
+        *ends[axis] = coords[num_coords - 1];
+        sb_poly_make_bezier(polys[axis], 1, coords, num_coords);
     }
-    data->end.z = coords[num_coords - 1];
-    sb_poly_make_bezier(&data->poly.z, 1, coords, num_coords);
 
     /* Parse yaw coordinates */
     num_coords = sb_i_get_num_coords(header >> 6);
@@ -846,12 +1459,121 @@ static sb_error_t sb_i_trajectory_player_build_current_segment(
     return SB_SUCCESS;
 }
 
-static sb_poly_4d_t* sb_i_get_dpoly(sb_trajectory_segment_t* data)
+static size_t sb_i_trajectory_skim_segment(
+    const sb_trajectory_t* trajectory, size_t offset, uint32_t* time_msec,
+    sb_vector3_with_yaw_t* pos)
+{
+    const uint8_t* buf = SB_BUFFER(trajectory->buffer);
+    float* coords[3] = { &pos->x, &pos->y, &pos->z };
+    size_t points_offset, num_points;
+    uint8_t header, num_coords, axis;
+
+    /* Parse the header and the duration, then pick the last control point of
+     * each axis as the end point of the segment */
+    header = buf[offset++];
+    *time_msec += sb_parse_uint16(buf, &offset);
+
+    num_points = 0;
+    for (axis = 0; axis < 3; axis++) {
+        num_coords = sb_i_get_num_coords(header >> (2 * axis));
+        num_points += num_coords - 1;
+        if (num_coords > 1) {
+            points_offset = offset + 2 * (num_points - 1);
+            *coords[axis] = sb_i_trajectory_parse_coordinate(trajectory, &points_offset);
+        }
+    }
+    offset += 2 * num_points;
+
+    num_coords = sb_i_get_num_coords(header >> 6);
+    if (num_coords > 1) {
+        points_offset = offset + 2 * (num_coords - 2);
+        pos->yaw = sb_i_trajectory_parse_angle(trajectory, &points_offset);
+    }
+    offset += 2 * (num_coords - 1);
+
+    return offset;
+}
+
+static sb_error_t sb_i_trajectory_player_ensure_segment_table(sb_trajectory_player_t* player)
+{
+    const sb_trajectory_t* trajectory = player->trajectory;
+    size_t buffer_length = sb_buffer_size(&trajectory->buffer);
+    sb_trajectory_segment_table_entry_t* table = 0;
+    sb_trajectory_segment_table_entry_t* new_table;
+    size_t num_segments = 0, capacity = 0;
+    size_t offset;
+    uint32_t time_msec;
+    sb_vector3_with_yaw_t pos;
+
+    if (player->segment_table != 0 || trajectory->scale == 0) {
+        return SB_SUCCESS;
+    }
+
+    offset = trajectory->header_length;
+    time_msec = 0;
+    pos = trajectory->start;
+
+    while (offset < buffer_length) {
+        if (num_segments == capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 16;
+            new_table = sb_realloc(table, sb_trajectory_segment_table_entry_t, capacity);
+            if (new_table == 0) {
+                sb_free(table); /* LCOV_EXCL_LINE */
+                return SB_ENOMEM; /* LCOV_EXCL_LINE */
+            }
+            table = new_table;
+        }
+
+        table[num_segments].offset = offset;
+        table[num_segments].start_time_msec = time_msec;
+        table[num_segments].start = pos;
+        num_segments++;
+
+        offset = sb_i_trajectory_skim_segment(trajectory, offset, &time_msec, &pos);
+    }
+
+    player->segment_table = table;
+    player->num_segments = num_segments;
+
+    return SB_SUCCESS;
+}
+
+static sb_error_t sb_i_trajectory_player_find_current_segment_in_table(
+    const sb_trajectory_player_t* player, size_t* index)
 {
+    size_t offset = player->current_segment.start;
+    size_t lo = 0, hi = player->num_segments, mid;
+
+    /* Binary search for the first segment that does not start before the
+     * current offset */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (player->segment_table[mid].offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < player->num_segments && player->segment_table[lo].offset != offset) {
+        /* Offset points into the middle of a segment */
+        return SB_EINVAL;
+    }
+
+    *index = lo;
+    return SB_SUCCESS;
+}
+
+static sb_poly_4d_t* sb_i_get_dpoly(sb_trajectory_player_t* player)
+{
+    sb_trajectory_segment_t* data = &player->current_segment.data;
+
     if (data->flags & SB_TRAJECTORY_SEGMENT_DPOLY_VALID) {
         return &data->dpoly;
     }
 
+    SB_PERF_COUNT(player->perf_counters, dpoly_computations);
+
     /* Calculate first derivatives for velocity */
     data->dpoly = data->poly;
     sb_poly_4d_deriv(&data->dpoly);
@@ -864,14 +1586,18 @@ static sb_poly_4d_t* sb_i_get_dpoly(sb_trajectory_segment_t* data)
     return &data->dpoly;
 }
 
-static sb_poly_4d_t* sb_i_get_ddpoly(sb_trajectory_segment_t* data)
+static sb_poly_4d_t* sb_i_get_ddpoly(sb_trajectory_player_t* player)
 {
+    sb_trajectory_segment_t* data = &player->current_segment.data;
+
     if (data->flags & SB_TRAJECTORY_SEGMENT_DDPOLY_VALID) {
         return &data->ddpoly;
     }
 
+    SB_PERF_COUNT(player->perf_counters, ddpoly_computations);
+
     /* Calculate second derivatives for acceleration */
-    data->ddpoly = *sb_i_get_dpoly(data);
+    data->ddpoly = *sb_i_get_dpoly(player);
     sb_poly_4d_deriv(&data->ddpoly);
     if (fabsf(data->duration_sec) > 1.0e-6f) {
         sb_poly_4d_scale(&data->ddpoly, 1.0f / data->duration_sec);
@@ -886,3 +1612,207 @@ static uint8_t sb_i_get_num_coords(uint8_t header_bits)
 {
     return 1 << (header_bits & 0x03);
 }
+
+/* ************************************************************************** */
+
+static uint8_t sb_i_poly_mul_add(double* result, const sb_poly_t* a, const sb_poly_t* b)
+{
+    uint8_t i, j;
+
+    if (a->num_coeffs == 0 || b->num_coeffs == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < a->num_coeffs; i++) {
+        for (j = 0; j < b->num_coeffs; j++) {
+            result[i + j] += (double)a->coeffs[i] * (double)b->coeffs[j];
+        }
+    }
+
+    return a->num_coeffs + b->num_coeffs - 1;
+}
+
+static void sb_i_update_peak(
+    const sb_poly_t* x, const sb_poly_t* y, double u,
+    const sb_trajectory_segment_t* segment, sb_trajectory_peak_t* peak)
+{
+    float value_x = sb_poly_eval(x, (float)u);
+    float value_y = y ? sb_poly_eval(y, (float)u) : 0.0f;
+    float value = sqrtf(value_x * value_x + value_y * value_y);
+
+    if (value > peak->value) {
+        peak->value = value;
+        peak->time_sec = segment->start_time_sec + (float)u * segment->duration_sec;
+    }
+}
+
+static void sb_i_find_peak(
+    const sb_poly_t* x, const sb_poly_t* y, const sb_poly_t* dx,
+    const sb_poly_t* dy, const sb_trajectory_segment_t* segment,
+    sb_trajectory_peak_t* peak)
+{
+    double coeffs[SB_I_MAX_PEAK_POLY_COEFFS] = { 0 };
+    double roots[SB_I_MAX_PEAK_ROOTS];
+    uint8_t num_coeffs, num_roots, i;
+
+    /* The extrema of sqrt(x^2 + y^2) are at the same places as the extrema of
+     * (x^2 + y^2) / 2, whose derivative is x * dx + y * dy */
+    num_coeffs = sb_i_poly_mul_add(coeffs, x, dx);
+    if (y) {
+        i = sb_i_poly_mul_add(coeffs, y, dy);
+        if (i > num_coeffs) {
+            num_coeffs = i;
+        }
+    }
+
+    num_roots = sb_i_find_roots_in_unit_interval(coeffs, num_coeffs, roots);
+
+    sb_i_update_peak(x, y, 0, segment, peak);
+    for (i = 0; i < num_roots; i++) {
+        sb_i_update_peak(x, y, roots[i], segment, peak);
+    }
+    sb_i_update_peak(x, y, 1, segment, peak);
+}
+
+static double sb_i_binomial(uint8_t n, uint8_t k)
+{
+    double result = 1;
+    uint8_t i;
+
+    for (i = 1; i <= k; i++) {
+        result = result * (n - k + i) / i;
+    }
+
+    return result;
+}
+
+static uint8_t sb_i_count_sign_variations(const double* coeffs, uint8_t num_coeffs)
+{
+    uint8_t i, result = 0;
+    int sign, last_sign = 0;
+
+    for (i = 0; i < num_coeffs; i++) {
+        sign = coeffs[i] > 0 ? 1 : (coeffs[i] < 0 ? -1 : 0);
+        if (sign != 0) {
+            if (last_sign != 0 && sign != last_sign) {
+                result++;
+            }
+            last_sign = sign;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Splits a polynomial given in Bernstein basis at the given parameter value
+ * using de Casteljau's algorithm. The last coefficient of the left half is
+ * the value of the polynomial at the split point. The right half may be
+ * omitted.
+ */
+static void sb_i_bernstein_split(
+    const double* coeffs, uint8_t degree, double t, double* left, double* right)
+{
+    double tmp[SB_I_MAX_PEAK_POLY_COEFFS];
+    uint8_t i, j;
+
+    memcpy(tmp, coeffs, (degree + 1) * sizeof(double));
+
+    for (i = 0; i <= degree; i++) {
+        left[i] = tmp[0];
+        if (right) {
+            right[degree - i] = tmp[degree - i];
+        }
+        for (j = 0; j < degree - i; j++) {
+            tmp[j] = (1 - t) * tmp[j] + t * tmp[j + 1];
+        }
+    }
+}
+
+static void sb_i_add_root(double* roots, uint8_t* num_roots, double root)
+{
+    if (*num_roots < SB_I_MAX_PEAK_ROOTS) {
+        roots[(*num_roots)++] = root;
+    }
+}
+
+/**
+ * Isolates the roots of a polynomial given in Bernstein basis over [lo; hi]
+ * by recursive subdivision. The number of sign variations of the Bernstein
+ * coefficients is an upper bound on the number of roots in the interval and
+ * it is exact when it is zero or one.
+ */
+static void sb_i_isolate_roots(
+    const double* coeffs, uint8_t degree, double lo, double hi, uint8_t depth,
+    double* roots, uint8_t* num_roots)
+{
+    double left[SB_I_MAX_PEAK_POLY_COEFFS], right[SB_I_MAX_PEAK_POLY_COEFFS];
+    double t_lo, t_hi, t_mid;
+    uint8_t variations, i;
+
+    variations = sb_i_count_sign_variations(coeffs, degree + 1);
+    if (variations == 0) {
+        return;
+    }
+
+    if (variations == 1 && coeffs[0] != 0 && coeffs[degree] != 0) {
+        /* Exactly one root in the interval and the polynomial has opposite
+         * signs at the two endpoints, so we can use bisection */
+        t_lo = 0;
+        t_hi = 1;
+        for (i = 0; i < 64 && (t_hi - t_lo) * (hi - lo) > 1e-12; i++) {
+            t_mid = (t_lo + t_hi) / 2;
+            sb_i_bernstein_split(coeffs, degree, t_mid, left, NULL);
+            if ((left[degree] < 0) == (coeffs[0] < 0)) {
+                t_lo = t_mid;
+            } else {
+                t_hi = t_mid;
+            }
+        }
+        sb_i_add_root(roots, num_roots, lo + (hi - lo) * (t_lo + t_hi) / 2);
+        return;
+    }
+
+    t_mid = (lo + hi) / 2;
+
+    if (depth >= SB_I_MAX_ROOT_FINDER_DEPTH) {
+        sb_i_add_root(roots, num_roots, t_mid);
+        return;
+    }
+
+    sb_i_bernstein_split(coeffs, degree, 0.5, left, right);
+    sb_i_isolate_roots(left, degree, lo, t_mid, depth + 1, roots, num_roots);
+    if (left[degree] == 0) {
+        sb_i_add_root(roots, num_roots, t_mid);
+    }
+    sb_i_isolate_roots(right, degree, t_mid, hi, depth + 1, roots, num_roots);
+}
+
+static uint8_t sb_i_find_roots_in_unit_interval(
+    const double* coeffs, uint8_t num_coeffs, double* roots)
+{
+    double bernstein[SB_I_MAX_PEAK_POLY_COEFFS];
+    uint8_t degree, i, j, num_roots = 0;
+
+    while (num_coeffs > 0 && coeffs[num_coeffs - 1] == 0) {
+        num_coeffs--;
+    }
+
+    if (num_coeffs < 2) {
+        return 0;
+    }
+
+    degree = num_coeffs - 1;
+
+    /* Convert the polynomial from power basis to Bernstein basis over [0; 1] */
+    for (i = 0; i <= degree; i++) {
+        bernstein[i] = 0;
+        for (j = 0; j <= i; j++) {
+            bernstein[i] += sb_i_binomial(i, j) / sb_i_binomial(degree, j) * coeffs[j];
+        }
+    }
+
+    sb_i_isolate_roots(bernstein, degree, 0, 1, 0, roots, &num_roots);
+
+    return num_roots;
+}
@@ -33,6 +33,7 @@
 #include <skybrush/yaw_control.h>
 
 #include "../parsing.h"
+#include "../perf_counters.h"
 
 #define SIZE_OF_DELTA (sizeof(uint16_t) + sizeof(int16_t))
 #define OFFSET_OF_DELTA(index) (ctrl->header_length + (index) * SIZE_OF_DELTA)
@@ -124,7 +125,8 @@ sb_error_t sb_yaw_control_init_from_binary_file(sb_yaw_control_t* ctrl, int fd)
     sb_binary_file_parser_t parser;
     sb_error_t retval;
 
-    SB_CHECK(sb_binary_file_parser_init_from_file(&parser, fd));
+    SB_CHECK(sb_binary_file_parser_init_from_file_with_flags(
+        &parser, fd, SB_BINARY_PARSER_USE_CRC_CACHE));
     retval = sb_i_yaw_control_init_from_parser(ctrl, &parser);
     sb_binary_file_parser_destroy(&parser);
 
@@ -155,6 +157,35 @@ sb_error_t sb_yaw_control_init_from_binary_file_in_memory(
     return retval;
 }
 
+/**
+ * Initializes a yaw control object from the first yaw control block found by
+ * an already open binary file parser.
+ *
+ * Memory-backed parsers yield an object that refers to their buffer without
+ * copying it.
+ *
+ * \param ctrl  the object to initialize
+ * \param parser  the parser to read the block from
+ *
+ * \return \c SB_SUCCESS if the object was initialized successfully,
+ *         \c SB_ENOENT if the file did not contain a yaw control block,
+ *         \c SB_EREAD for read errors
+ */
+sb_error_t sb_yaw_control_init_from_parser(sb_yaw_control_t* ctrl, sb_binary_file_parser_t* parser)
+{
+    sb_binary_block_t block;
+    uint8_t* buf;
+
+    SB_CHECK(sb_binary_file_find_first_block_by_type(parser, SB_BINARY_BLOCK_YAW_CONTROL));
+
+    if (sb_binary_file_get_current_block_view(parser, &buf) == SB_SUCCESS) {
+        block = sb_binary_file_get_current_block(parser);
+        return sb_yaw_control_init_from_buffer(ctrl, buf, block.length);
+    }
+
+    return sb_i_yaw_control_init_from_parser(ctrl, parser);
+}
+
 sb_error_t sb_i_yaw_control_init_from_parser(sb_yaw_control_t* ctrl, sb_binary_file_parser_t* parser)
 {
     sb_error_t retval;
@@ -313,6 +344,63 @@ sb_error_t sb_yaw_player_build_next_setpoint(sb_yaw_player_t* player)
         player->current_setpoint.data.end_yaw_ddeg);
 }
 
+/**
+ * Saves the state of the yaw player into a snapshot.
+ *
+ * The snapshot records the current setpoint only; it can be restored into any
+ * player that plays the same yaw control object with
+ * \ref sb_yaw_player_restore_snapshot() .
+ *
+ * \param player    the player whose state is to be saved
+ * \param snapshot  the snapshot to write the state into
+ */
+void sb_yaw_player_save_snapshot(
+    const sb_yaw_player_t* player, sb_yaw_player_snapshot_t* snapshot)
+{
+    memset(snapshot, 0, sizeof(sb_yaw_player_snapshot_t));
+    snapshot->ctrl_size = player->ctrl->buffer_length;
+    snapshot->offset = player->current_setpoint.start;
+    snapshot->start_time_msec = player->current_setpoint.data.start_time_msec;
+    snapshot->start_yaw_ddeg = player->current_setpoint.data.start_yaw_ddeg;
+}
+
+/**
+ * Restores the state of the yaw player from a snapshot in constant time.
+ *
+ * \param player    the player to restore; it must already be initialized with
+ *        the same yaw control object that the snapshot was taken from
+ * \param snapshot  the snapshot to restore
+ *
+ * \return \c SB_SUCCESS if the snapshot was restored, \c SB_EINVAL if the
+ *         snapshot does not belong to the yaw control object of the player or
+ *         does not point to the start of a delta. The state of the player is
+ *         left intact in case of an error.
+ */
+sb_error_t sb_yaw_player_restore_snapshot(
+    sb_yaw_player_t* player, const sb_yaw_player_snapshot_t* snapshot)
+{
+    const sb_yaw_control_t* ctrl = player->ctrl;
+    size_t index;
+
+    if (snapshot->ctrl_size != ctrl->buffer_length || snapshot->offset < ctrl->header_length) {
+        return SB_EINVAL;
+    }
+
+    /* The offset must point to the start of a delta, or just past the last
+     * delta if the player was beyond the end of the buffer */
+    if ((snapshot->offset - ctrl->header_length) % SIZE_OF_DELTA != 0) {
+        return SB_EINVAL;
+    }
+
+    index = (snapshot->offset - ctrl->header_length) / SIZE_OF_DELTA;
+    if (index > ctrl->num_deltas || (index == ctrl->num_deltas && snapshot->offset < ctrl->buffer_length)) {
+        return SB_EINVAL;
+    }
+
+    return sb_i_yaw_player_build_current_setpoint(
+        player, snapshot->offset, snapshot->start_time_msec, snapshot->start_yaw_ddeg);
+}
+
 /* LCOV_EXCL_START */
 
 /**
@@ -412,6 +500,39 @@ sb_bool_t sb_yaw_player_has_more_setpoints(const sb_yaw_player_t* player)
     return player->current_setpoint.length > 0;
 }
 
+/**
+ * Returns the performance counters of the yaw player.
+ *
+ * \param player  the yaw player
+ * \param result  the counters are returned here; all of them are set to zero
+ *        if the library was compiled without performance counters
+ * \return \c SB_EUNSUPPORTED if the library was compiled without performance
+ *         counters, \c SB_SUCCESS otherwise
+ */
+sb_error_t sb_yaw_player_get_perf_counters(
+    const sb_yaw_player_t* player, sb_perf_counters_t* result)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    *result = player->perf_counters;
+    return SB_SUCCESS;
+#else
+    memset(result, 0, sizeof(sb_perf_counters_t));
+    return SB_EUNSUPPORTED;
+#endif
+}
+
+/**
+ * Resets the performance counters of the yaw player to zero.
+ */
+void sb_yaw_player_reset_perf_counters(sb_yaw_player_t* player)
+{
+#ifdef SB_ENABLE_PERF_COUNTERS
+    memset(&player->perf_counters, 0, sizeof(sb_perf_counters_t));
+#else
+    ((void)player);
+#endif
+}
+
 /* ************************************************************************** */
 
 static sb_error_t sb_i_yaw_player_seek_to_time(sb_yaw_player_t* player, float t, float* rel_t)
@@ -422,12 +543,15 @@ static sb_error_t sb_i_yaw_player_seek_to_time(sb_yaw_player_t* player, float t,
         t = 0;
     }
 
+    SB_PERF_COUNT(player->perf_counters, seeks);
+
     while (1) {
         sb_yaw_setpoint_t* setpoint = &player->current_setpoint.data;
 
         if (setpoint->start_time_sec > t) {
             /* time that the user asked for is before the current setpoint. We simply
              * rewind and start from scratch */
+            SB_PERF_COUNT(player->perf_counters, rewinds);
             SB_CHECK(sb_i_yaw_player_rewind(player));
             assert(player->current_setpoint.data.start_time_msec == 0);
         } else if (setpoint->end_time_sec < t) {
@@ -490,6 +614,8 @@ static sb_error_t sb_i_yaw_player_build_current_setpoint(
         return SB_SUCCESS;
     }
 
+    SB_PERF_COUNT(player->perf_counters, items_decoded);
+
     /* Parse duration and calculate end time */
     data->duration_msec = sb_i_yaw_control_parse_duration(ctrl, &offset);
     data->duration_sec = data->duration_msec / 1000.0f;
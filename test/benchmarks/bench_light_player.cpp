@@ -0,0 +1,179 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file bench_light_player.cpp
+ * \brief Compares the virtual, the devirtualized and the pre-decoded bytecode
+ *        players on a dense, fade-heavy light program.
+ *
+ * This benchmark is written in C++ because it needs access to the internal
+ * C++ classes of the light player.
+ */
+
+#include "bench.h"
+
+#include <vector>
+
+#include "bytecode_array.hpp"
+#include "bytecode_player.h"
+#include "decoded_program.h"
+
+/* Maximum size of a program that an ArrayBytecodeStore can hold */
+#define MAX_PROGRAM_SIZE 65535
+
+/**
+ * Generates a dense light program consisting mostly of short fades, with
+ * occasional loops, and returns its total duration in milliseconds.
+ */
+static unsigned long generate_fade_heavy_program(std::vector<uint8_t>& program)
+{
+    unsigned long duration = 0;
+    unsigned int i = 0, j;
+    uint8_t frames;
+
+    program.clear();
+
+    while (program.size() < MAX_PROGRAM_SIZE - 32) {
+        frames = 1 + (i % 5);
+
+        if (i % 50 == 49) {
+            /* a short loop of fades every now and then */
+            program.push_back(CMD_LOOP_BEGIN);
+            program.push_back(4);
+            for (j = 0; j < 3; j++) {
+                program.push_back(CMD_FADE_TO_COLOR);
+                program.push_back(j * 80);
+                program.push_back(255 - j * 80);
+                program.push_back(i & 0xff);
+                program.push_back(frames);
+            }
+            program.push_back(CMD_LOOP_END);
+            duration += 4 * 3 * frames * 20;
+        } else if (i % 3 == 0) {
+            program.push_back(CMD_FADE_TO_GRAY);
+            program.push_back(i & 0xff);
+            program.push_back(frames);
+            duration += frames * 20;
+        } else {
+            program.push_back(CMD_FADE_TO_COLOR);
+            program.push_back(i & 0xff);
+            program.push_back((i * 7) & 0xff);
+            program.push_back((i * 13) & 0xff);
+            program.push_back(frames);
+            duration += frames * 20;
+        }
+
+        i++;
+    }
+
+    program.push_back(CMD_END);
+
+    return duration;
+}
+
+template <typename Player>
+static unsigned long iterate(Player& player, unsigned long duration, unsigned long dt)
+{
+    unsigned long t, checksum = 0;
+
+    for (t = 0; t < duration; t += dt) {
+        player.seek(t);
+        checksum += player.currentColor().red;
+    }
+
+    return checksum;
+}
+
+template <typename Player>
+static unsigned long seek_randomly(Player& player, unsigned long duration, int num_seeks)
+{
+    unsigned long t = 12345, checksum = 0;
+    int i;
+
+    for (i = 0; i < num_seeks; i++) {
+        player.seek(t);
+        checksum += player.currentColor().green;
+        t = (t * 7919 + 104729) % duration;
+    }
+
+    return checksum;
+}
+
+int main(int argc, char* argv[])
+{
+    BENCH_INIT("light player");
+
+    std::vector<uint8_t> program;
+    unsigned long duration = generate_fade_heavy_program(program);
+    volatile unsigned long checksum = 0;
+
+    ArrayBytecodeStore store(program.data(), program.size());
+    BytecodePlayer virtual_player;
+    ArrayBytecodePlayer devirtualized_player;
+    DecodedProgram decoded_program;
+    DecodedBytecodePlayer decoded_player;
+
+    virtual_player.setBytecodeStore(&store);
+    devirtualized_player.setBytecodeStore(&store);
+
+    if (!decoded_program.decode(program.data(), program.size())) {
+        abort();
+    }
+
+    DecodedBytecodeStore decoded_store(decoded_program);
+    decoded_player.setBytecodeStore(&decoded_store);
+
+    printf("| program size: %lu bytes, %lu instructions, duration: %lu ms\n",
+        (unsigned long)program.size(), (unsigned long)decoded_program.size(),
+        duration);
+
+    BENCH(
+        "decoding the program, 100x",
+        REPEAT(decoded_program.decode(program.data(), program.size()), 100));
+
+    BENCH(
+        "iterating at 25 fps with virtual store, 100x",
+        REPEAT(checksum += iterate(virtual_player, duration, 40), 100));
+    BENCH(
+        "iterating at 25 fps with devirtualized store, 100x",
+        REPEAT(checksum += iterate(devirtualized_player, duration, 40), 100));
+    BENCH(
+        "iterating at 25 fps with decoded store, 100x",
+        REPEAT(checksum += iterate(decoded_player, duration, 40), 100));
+    BENCH(
+        "iterating at 100 fps with virtual store, 25x",
+        REPEAT(checksum += iterate(virtual_player, duration, 10), 25));
+    BENCH(
+        "iterating at 100 fps with devirtualized store, 25x",
+        REPEAT(checksum += iterate(devirtualized_player, duration, 10), 25));
+    BENCH(
+        "iterating at 100 fps with decoded store, 25x",
+        REPEAT(checksum += iterate(decoded_player, duration, 10), 25));
+    BENCH(
+        "100 random seeks with virtual store, 10x",
+        REPEAT(checksum += seek_randomly(virtual_player, duration, 100), 10));
+    BENCH(
+        "100 random seeks with devirtualized store, 10x",
+        REPEAT(checksum += seek_randomly(devirtualized_player, duration, 100), 10));
+    BENCH(
+        "100 random seeks with decoded store, 10x",
+        REPEAT(checksum += seek_randomly(decoded_player, duration, 100), 10));
+
+    return 0;
+}
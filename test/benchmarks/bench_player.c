@@ -29,9 +29,26 @@ void iterate(sb_trajectory_t* trajectory, uint32_t duration_msec, uint32_t dt_ms
     sb_trajectory_player_init(&player, trajectory);
 
     for (t = 0; t < duration_msec; t += dt_msec) {
-        sb_trajectory_player_get_position_at(&player, t, &pos);
-        sb_trajectory_player_get_velocity_at(&player, t, &pos);
-        sb_trajectory_player_get_acceleration_at(&player, t, &pos);
+        sb_trajectory_player_get_position_at(&player, t / 1000.0f, &pos);
+        sb_trajectory_player_get_velocity_at(&player, t / 1000.0f, &pos);
+        sb_trajectory_player_get_acceleration_at(&player, t / 1000.0f, &pos);
+    }
+
+    sb_trajectory_player_destroy(&player);
+}
+
+void iterate_msec(sb_trajectory_t* trajectory, uint32_t duration_msec, uint32_t dt_msec)
+{
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t pos;
+    uint32_t t;
+
+    sb_trajectory_player_init(&player, trajectory);
+
+    for (t = 0; t < duration_msec; t += dt_msec) {
+        sb_trajectory_player_get_position_at_msec(&player, t, &pos);
+        sb_trajectory_player_get_velocity_at_msec(&player, t, &pos);
+        sb_trajectory_player_get_acceleration_at_msec(&player, t, &pos);
     }
 
     sb_trajectory_player_destroy(&player);
@@ -69,6 +86,13 @@ int main(int argc, char* argv[])
         "iterating trajectory at 100 fps, 100x",
         REPEAT(iterate(&trajectory, duration_msec, 10), 100));
 
+    BENCH(
+        "iterating trajectory at 25 fps with msec API, 400x",
+        REPEAT(iterate_msec(&trajectory, duration_msec, 40), 400));
+    BENCH(
+        "iterating trajectory at 100 fps with msec API, 100x",
+        REPEAT(iterate_msec(&trajectory, duration_msec, 10), 100));
+
     sb_trajectory_destroy(&trajectory);
 
     return 0;
@@ -17,7 +17,13 @@
  * this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <skybrush/formats/binary.h>
+#include <skybrush/lights.h>
+#include <skybrush/rth_plan.h>
+#include <skybrush/trajectory.h>
+#include <skybrush/yaw_control.h>
 
 #include "unity.h"
 
@@ -197,6 +203,113 @@ void test_find_first_block_by_type(void)
     fclose(fp);
 }
 
+void test_get_current_block_view(void)
+{
+    sb_binary_file_parser_t parser;
+    FILE* fp;
+    uint8_t buf[4096];
+    uint8_t* view;
+    size_t nbytes;
+    int fd;
+
+    fp = fopen("fixtures/test.skyb", "rb");
+    TEST_ASSERT(fp);
+    nbytes = fread(buf, sizeof(uint8_t), sizeof(buf) / sizeof(uint8_t), fp);
+    TEST_ASSERT(nbytes > 0);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer(&parser, buf, nbytes));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_find_first_block_by_type(&parser, SB_BINARY_BLOCK_COMMENT));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_get_current_block_view(&parser, &view));
+    TEST_ASSERT_EQUAL_PTR(buf + 47, view);
+    TEST_ASSERT_EQUAL(0, memcmp("this is a test file", view, 19));
+
+    /* no current block at the end of the file */
+    while (sb_binary_file_is_current_block_valid(&parser)) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_seek_to_next_block(&parser));
+    }
+    TEST_ASSERT_EQUAL(SB_EREAD, sb_binary_file_get_current_block_view(&parser, &view));
+    sb_binary_file_parser_destroy(&parser);
+
+    /* views are not supported for files */
+    rewind(fp);
+    fd = fileno(fp);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_file(&parser, fd));
+    TEST_ASSERT_EQUAL(SB_EUNSUPPORTED, sb_binary_file_get_current_block_view(&parser, &view));
+    sb_binary_file_parser_destroy(&parser);
+
+    fclose(fp);
+}
+
+void test_init_objects_from_parser(void)
+{
+    sb_binary_file_parser_t parser;
+    sb_trajectory_t trajectory, trajectory_from_file;
+    sb_light_program_t program;
+    sb_yaw_control_t ctrl;
+    sb_rth_plan_t plan;
+    FILE* fp;
+    uint8_t buf[4096];
+    size_t nbytes;
+
+    fp = fopen("fixtures/test.skyb", "rb");
+    TEST_ASSERT(fp);
+    nbytes = fread(buf, sizeof(uint8_t), sizeof(buf) / sizeof(uint8_t), fp);
+    TEST_ASSERT(nbytes > 0);
+
+    /* in-memory parser: objects are views into the buffer */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer(&parser, buf, nbytes));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_parser(&trajectory, &parser));
+    TEST_ASSERT_TRUE(sb_buffer_is_view(&trajectory.buffer));
+    TEST_ASSERT_EQUAL_PTR(buf + 8, SB_BUFFER(trajectory.buffer));
+    TEST_ASSERT_EQUAL(36, sb_buffer_size(&trajectory.buffer));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_program_init_from_parser(&program, &parser));
+    TEST_ASSERT_FALSE(program.owner);
+    TEST_ASSERT_EQUAL_PTR(buf + 69, program.buffer);
+    TEST_ASSERT_EQUAL(27, program.buffer_length);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_control_init_from_parser(&ctrl, &parser));
+    TEST_ASSERT_FALSE(ctrl.owner);
+    TEST_ASSERT_EQUAL_PTR(buf + 99, ctrl.buffer);
+    TEST_ASSERT_EQUAL(11, ctrl.buffer_length);
+
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_rth_plan_init_from_parser(&plan, &parser));
+
+    sb_binary_file_parser_destroy(&parser);
+
+    /* file-based parser: objects own a copy of the block */
+    rewind(fp);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_file(&parser, fileno(fp)));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_parser(&trajectory_from_file, &parser));
+    TEST_ASSERT_FALSE(sb_buffer_is_view(&trajectory_from_file.buffer));
+    TEST_ASSERT_EQUAL(36, sb_buffer_size(&trajectory_from_file.buffer));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(SB_BUFFER(trajectory.buffer), SB_BUFFER(trajectory_from_file.buffer), 36);
+    sb_binary_file_parser_destroy(&parser);
+
+    sb_trajectory_destroy(&trajectory_from_file);
+    sb_yaw_control_destroy(&ctrl);
+    sb_light_program_destroy(&program);
+    sb_trajectory_destroy(&trajectory);
+
+    fclose(fp);
+
+    /* RTH plan from another file */
+    fp = fopen("fixtures/hover_3m_with_rth_plan.skyb", "rb");
+    TEST_ASSERT(fp);
+    nbytes = fread(buf, sizeof(uint8_t), sizeof(buf) / sizeof(uint8_t), fp);
+    TEST_ASSERT(nbytes > 0);
+    fclose(fp);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer(&parser, buf, nbytes));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_rth_plan_init_from_parser(&plan, &parser));
+    TEST_ASSERT_FALSE(plan.owner);
+    TEST_ASSERT(plan.buffer > buf && plan.buffer < buf + nbytes);
+    TEST_ASSERT(sb_rth_plan_get_num_entries(&plan) > 0);
+    sb_rth_plan_destroy(&plan);
+    sb_binary_file_parser_destroy(&parser);
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
@@ -205,6 +318,8 @@ int main(int argc, char* argv[])
     RUN_TEST(test_read_blocks_from_file);
     RUN_TEST(test_read_blocks_from_memory);
     RUN_TEST(test_find_first_block_by_type);
+    RUN_TEST(test_get_current_block_view);
+    RUN_TEST(test_init_objects_from_parser);
 
     return UNITY_END();
 }
@@ -277,6 +277,143 @@ void test_extend_with_zeros(void)
     }
 }
 
+void test_extend_uninitialized(void)
+{
+    sb_buffer_t buf;
+    const char* str = "hello world";
+    uint8_t* ptr;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_init(&buf, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_append_bytes(&buf, str, 5));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_extend_uninitialized(&buf, strlen(str) - 5 + 1, &ptr));
+    TEST_ASSERT_EQUAL(strlen(str) + 1, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL_PTR(SB_BUFFER(buf) + 5, ptr);
+    memcpy(ptr, str + 5, strlen(str) - 5 + 1);
+    TEST_ASSERT_EQUAL_STRING(str, (char*)SB_BUFFER(buf));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_extend_uninitialized(&buf, 0, &ptr));
+    TEST_ASSERT_EQUAL(strlen(str) + 1, sb_buffer_size(&buf));
+
+    sb_buffer_destroy(&buf);
+}
+
+void test_reserve_and_shrink_to_fit(void)
+{
+    sb_buffer_t buf;
+    uint8_t* storage;
+    size_t i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_init(&buf, 4));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_reserve(&buf, 100));
+    TEST_ASSERT_EQUAL(4, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL(100, sb_buffer_capacity(&buf));
+
+    /* reserving less than the current capacity is a no-op */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_reserve(&buf, 10));
+    TEST_ASSERT_EQUAL(100, sb_buffer_capacity(&buf));
+
+    /* no reallocation while growing up to the reserved capacity */
+    storage = SB_BUFFER(buf);
+    for (i = 4; i < 100; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_append_byte(&buf, i));
+    }
+    TEST_ASSERT_EQUAL_PTR(storage, SB_BUFFER(buf));
+    TEST_ASSERT_EQUAL(100, sb_buffer_capacity(&buf));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_resize(&buf, 50));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_shrink_to_fit(&buf));
+    TEST_ASSERT_EQUAL(50, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL(50, sb_buffer_capacity(&buf));
+    for (i = 4; i < 50; i++) {
+        TEST_ASSERT_EQUAL(i, SB_BUFFER(buf)[i]);
+    }
+
+    sb_buffer_destroy(&buf);
+}
+
+void test_geometric_growth(void)
+{
+    sb_buffer_t buf;
+    size_t i, capacity, num_reallocations;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_init(&buf, 0));
+
+    num_reallocations = 0;
+    capacity = sb_buffer_capacity(&buf);
+    for (i = 0; i < 65536; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_resize(&buf, i + 1));
+        if (sb_buffer_capacity(&buf) != capacity) {
+            TEST_ASSERT_GREATER_OR_EQUAL(2 * capacity, sb_buffer_capacity(&buf));
+            capacity = sb_buffer_capacity(&buf);
+            num_reallocations++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(65536, sb_buffer_size(&buf));
+    TEST_ASSERT_LESS_OR_EQUAL(16, num_reallocations);
+
+    sb_buffer_destroy(&buf);
+}
+
+void test_growth_from_zero_capacity(void)
+{
+    sb_buffer_t buf;
+    uint8_t storage[1];
+    uint8_t* ptr;
+
+    /* views cannot grow, but they must fail instead of looping forever when
+     * their capacity is zero */
+    sb_buffer_init_view(&buf, storage, 0);
+    TEST_ASSERT_EQUAL(0, sb_buffer_capacity(&buf));
+
+    TEST_ASSERT_EQUAL(SB_FAILURE, sb_buffer_append_bytes(&buf, "abc", 3));
+    TEST_ASSERT_EQUAL(SB_FAILURE, sb_buffer_append_byte(&buf, 42));
+    TEST_ASSERT_EQUAL(SB_FAILURE, sb_buffer_extend_uninitialized(&buf, 5, &ptr));
+    TEST_ASSERT_EQUAL(0, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL(0, sb_buffer_capacity(&buf));
+
+    sb_buffer_destroy(&buf);
+}
+
+void test_init_with_storage(void)
+{
+    sb_buffer_t buf;
+    uint8_t storage[8];
+    const char* str = "hello world";
+
+    sb_buffer_init_with_storage(&buf, storage, sizeof(storage));
+    TEST_ASSERT_FALSE(sb_buffer_is_view(&buf));
+    TEST_ASSERT_EQUAL(0, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL(sizeof(storage), sb_buffer_capacity(&buf));
+
+    /* appending within the capacity uses the storage area */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_append_bytes(&buf, str, 5));
+    TEST_ASSERT_EQUAL_PTR(storage, SB_BUFFER(buf));
+    TEST_ASSERT_EQUAL(0, memcmp(storage, str, 5));
+
+    /* shrinking is a no-op while the storage area is in use */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_shrink_to_fit(&buf));
+    TEST_ASSERT_EQUAL_PTR(storage, SB_BUFFER(buf));
+    TEST_ASSERT_EQUAL(sizeof(storage), sb_buffer_capacity(&buf));
+
+    /* growing beyond the capacity moves the contents to the heap */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_append_bytes(&buf, str + 5, strlen(str) - 5 + 1));
+    TEST_ASSERT(SB_BUFFER(buf) != storage);
+    TEST_ASSERT_EQUAL_STRING(str, (char*)SB_BUFFER(buf));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_shrink_to_fit(&buf));
+    TEST_ASSERT_EQUAL(strlen(str) + 1, sb_buffer_capacity(&buf));
+    TEST_ASSERT_EQUAL_STRING(str, (char*)SB_BUFFER(buf));
+
+    sb_buffer_destroy(&buf);
+
+    /* destroying the buffer while it uses the storage area must not free it */
+    sb_buffer_init_with_storage(&buf, storage, sizeof(storage));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_buffer_append_byte(&buf, 42));
+    sb_buffer_destroy(&buf);
+}
+
 void test_init_view(void)
 {
     sb_buffer_t buf;
@@ -341,9 +478,14 @@ int main(int argc, char* argv[])
     RUN_TEST(test_append);
     RUN_TEST(test_append_zero_length);
     RUN_TEST(test_extend_with_zeros);
+    RUN_TEST(test_extend_uninitialized);
+    RUN_TEST(test_reserve_and_shrink_to_fit);
+    RUN_TEST(test_geometric_growth);
+    RUN_TEST(test_init_with_storage);
 
     RUN_TEST(test_init_view);
     RUN_TEST(test_init_view_cannot_grow_or_shrink);
+    RUN_TEST(test_growth_from_zero_capacity);
 
     RUN_TEST(test_init_from_bytes);
     RUN_TEST(test_init_from_bytes_zero_size);
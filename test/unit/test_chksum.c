@@ -19,6 +19,9 @@
 
 #include <skybrush/formats/binary.h>
 #include <skybrush/trajectory.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "unity.h"
 
@@ -57,6 +60,10 @@ void loadFixtureAndValidate(const char* fname, sb_error_t expected_retval)
 
     fclose(fp);
     sb_trajectory_player_destroy(&player);
+
+    if (retval == SB_SUCCESS) {
+        sb_trajectory_destroy(&trajectory);
+    }
 }
 
 void test_valid_checksum(void)
@@ -69,12 +76,148 @@ void test_invalid_checksum(void)
     loadFixtureAndValidate("fixtures/forward_left_back_v2_invalid_chksum.skyb", SB_ECORRUPTED);
 }
 
+static uint8_t* loadFixtureToBuffer(const char* fname, size_t* nbytes)
+{
+    FILE* fp;
+    uint8_t* buf;
+
+    fp = fopen(fname, "rb");
+    if (fp == 0) {
+        abort();
+    }
+
+    buf = (uint8_t*)malloc(65536);
+    if (buf == 0) {
+        abort();
+    }
+
+    *nbytes = fread(buf, sizeof(uint8_t), 65536, fp);
+    fclose(fp);
+
+    return buf;
+}
+
+void test_lazy_verification(void)
+{
+    sb_binary_file_parser_t parser;
+    sb_trajectory_t trajectory;
+    uint8_t* buf;
+    uint8_t* view;
+    size_t nbytes;
+
+    buf = loadFixtureToBuffer("fixtures/forward_left_back_v2_invalid_chksum.skyb", &nbytes);
+
+    /* Eager verification fails immediately */
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, SB_BINARY_PARSER_VERIFY_CRC_EAGER));
+
+    /* Lazy verification fails when the first block is accessed */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, SB_BINARY_PARSER_VERIFY_CRC_LAZY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_find_first_block_by_type(&parser, SB_BINARY_BLOCK_TRAJECTORY));
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_get_current_block_view(&parser, &view));
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_trajectory_init_from_parser(&trajectory, &parser));
+    sb_binary_file_parser_destroy(&parser);
+
+    /* Verification can also be skipped entirely */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, SB_BINARY_PARSER_VERIFY_CRC_SKIP));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_find_first_block_by_type(&parser, SB_BINARY_BLOCK_TRAJECTORY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_parser(&trajectory, &parser));
+    sb_trajectory_destroy(&trajectory);
+    sb_binary_file_parser_destroy(&parser);
+
+    free(buf);
+
+    /* Lazy verification of a valid file succeeds */
+    buf = loadFixtureToBuffer("fixtures/forward_left_back_v2.skyb", &nbytes);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, SB_BINARY_PARSER_VERIFY_CRC_LAZY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_find_first_block_by_type(&parser, SB_BINARY_BLOCK_TRAJECTORY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_parser(&trajectory, &parser));
+    sb_trajectory_destroy(&trajectory);
+    sb_binary_file_parser_destroy(&parser);
+    free(buf);
+}
+
+void test_crc_cache(void)
+{
+    sb_binary_file_parser_t parser;
+    uint8_t* buf;
+    size_t nbytes;
+    const uint8_t flags = SB_BINARY_PARSER_VERIFY_CRC_EAGER | SB_BINARY_PARSER_USE_CRC_CACHE;
+
+    sb_binary_file_crc_cache_clear();
+
+    buf = loadFixtureToBuffer("fixtures/forward_left_back_v2.skyb", &nbytes);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, flags));
+    sb_binary_file_parser_destroy(&parser);
+
+    /* Corrupt the last byte of the buffer; the cached result is used because
+     * the address, the size and the expected checksum are the same */
+    buf[nbytes - 1] ^= 0xff;
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, flags));
+    sb_binary_file_parser_destroy(&parser);
+
+    /* Parsers not using the cache still see the corruption */
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_parser_init_from_buffer(&parser, buf, nbytes));
+
+    /* Clearing the cache forces re-verification */
+    sb_binary_file_crc_cache_clear();
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_parser_init_from_buffer_with_flags(&parser, buf, nbytes, flags));
+
+    free(buf);
+}
+
+void test_crc_cache_file_rewritten_within_same_second(void)
+{
+    sb_binary_file_parser_t parser;
+    uint8_t* buf;
+    size_t nbytes;
+    FILE* fp;
+    int fd;
+    struct timespec times[2];
+    const uint8_t flags = SB_BINARY_PARSER_VERIFY_CRC_EAGER | SB_BINARY_PARSER_USE_CRC_CACHE;
+
+    sb_binary_file_crc_cache_clear();
+
+    buf = loadFixtureToBuffer("fixtures/forward_left_back_v2.skyb", &nbytes);
+    fp = tmpfile();
+    TEST_ASSERT_NOT_NULL(fp);
+    fd = fileno(fp);
+
+    TEST_ASSERT_EQUAL(nbytes, fwrite(buf, 1, nbytes, fp));
+    TEST_ASSERT_EQUAL(0, fflush(fp));
+    times[0].tv_sec = times[1].tv_sec = 1700000000;
+    times[0].tv_nsec = times[1].tv_nsec = 100000000;
+    TEST_ASSERT_EQUAL(0, futimens(fd, times));
+
+    TEST_ASSERT_EQUAL(0, lseek(fd, 0, SEEK_SET));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_binary_file_parser_init_from_file_with_flags(&parser, fd, flags));
+    sb_binary_file_parser_destroy(&parser);
+
+    /* Corrupt the last byte of the file in place, keeping its size and the
+     * whole-second part of its modification time */
+    buf[nbytes - 1] ^= 0xff;
+    TEST_ASSERT_EQUAL(0, fseek(fp, (long)(nbytes - 1), SEEK_SET));
+    TEST_ASSERT_EQUAL(1, fwrite(buf + nbytes - 1, 1, 1, fp));
+    TEST_ASSERT_EQUAL(0, fflush(fp));
+    times[0].tv_nsec = times[1].tv_nsec = 200000000;
+    TEST_ASSERT_EQUAL(0, futimens(fd, times));
+
+    TEST_ASSERT_EQUAL(0, lseek(fd, 0, SEEK_SET));
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_parser_init_from_file_with_flags(&parser, fd, flags));
+
+    fclose(fp);
+    free(buf);
+    sb_binary_file_crc_cache_clear();
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_valid_checksum);
     RUN_TEST(test_invalid_checksum);
+    RUN_TEST(test_lazy_verification);
+    RUN_TEST(test_crc_cache);
+    RUN_TEST(test_crc_cache_file_rewritten_within_same_second);
 
     return UNITY_END();
 }
@@ -222,6 +222,52 @@ void test_rgbw_conversion(void)
         sb_rgb_color_to_rgbw(color, conv)));
 }
 
+void test_rgb_linear_interpolation(void)
+{
+    sb_rgb_color_t red = { 255, 0, 0 };
+    sb_rgb_color_t blue = { 0, 0, 255 };
+    sb_rgb_color_t gray = { 128, 128, 128 };
+    float ratios[] = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f, -0.5f, 1.5f, 0.125f, 0.375f };
+    size_t i;
+
+    TEST_ASSERT_TRUE(sb_rgb_color_equals(red, sb_rgb_color_linear_interpolation(red, blue, 0)));
+    TEST_ASSERT_TRUE(sb_rgb_color_equals(blue, sb_rgb_color_linear_interpolation(red, blue, 1)));
+    TEST_ASSERT_TRUE(sb_rgb_color_equals(
+        sb_rgb_color_make(127, 0, 127),
+        sb_rgb_color_linear_interpolation(red, blue, 0.5f)));
+
+    /* values outside [0; 1] are clamped to the valid color range */
+    TEST_ASSERT_TRUE(sb_rgb_color_equals(
+        sb_rgb_color_make(255, 0, 0),
+        sb_rgb_color_linear_interpolation(red, blue, -1)));
+    TEST_ASSERT_TRUE(sb_rgb_color_equals(
+        sb_rgb_color_make(0, 0, 255),
+        sb_rgb_color_linear_interpolation(red, blue, 2)));
+
+    /* fixed-point variant must match the floating-point one for ratios that
+     * can be represented exactly */
+    for (i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        int32_t fixed_ratio = ratios[i] * SB_RGB_COLOR_FIXED_RATIO_ONE;
+
+        TEST_ASSERT_TRUE(sb_rgb_color_equals(
+            sb_rgb_color_linear_interpolation(red, blue, ratios[i]),
+            sb_rgb_color_linear_interpolation_fixed(red, blue, fixed_ratio)));
+        TEST_ASSERT_TRUE(sb_rgb_color_equals(
+            sb_rgb_color_linear_interpolation(blue, gray, ratios[i]),
+            sb_rgb_color_linear_interpolation_fixed(blue, gray, fixed_ratio)));
+    }
+
+    /* for arbitrary ratios, the fixed-point variant may be off by at most one */
+    for (i = 0; i <= 1000; i++) {
+        float ratio = i / 1000.0f;
+        int32_t fixed_ratio = ratio * SB_RGB_COLOR_FIXED_RATIO_ONE;
+
+        TEST_ASSERT_TRUE(sb_rgb_color_almost_equals(
+            sb_rgb_color_linear_interpolation(red, gray, ratio),
+            sb_rgb_color_linear_interpolation_fixed(red, gray, fixed_ratio), 1));
+    }
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
@@ -230,6 +276,7 @@ int main(int argc, char* argv[])
     RUN_TEST(test_encode_rgb565);
     RUN_TEST(test_rgb_equals);
     RUN_TEST(test_rgb_from_color_temperature);
+    RUN_TEST(test_rgb_linear_interpolation);
     RUN_TEST(test_rgbw_equals);
     RUN_TEST(test_rgbw_conversion);
 
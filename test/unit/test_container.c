@@ -0,0 +1,264 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <skybrush/formats/container.h>
+#include <skybrush/trajectory.h>
+
+#include "unity.h"
+
+#define NUM_SHOWS 3
+
+static const char* fixtures[NUM_SHOWS] = {
+    "fixtures/test.skyb",
+    "fixtures/hover_3m.skyb",
+    "fixtures/forward_left_back.skyb"
+};
+static const uint32_t ids[NUM_SHOWS] = { 42, 7, 1000 };
+
+static uint8_t* shows[NUM_SHOWS];
+static size_t show_lengths[NUM_SHOWS];
+static sb_buffer_t container_buf;
+static sb_container_t container;
+
+static uint8_t* loadFixtureToBuffer(const char* fname, size_t* nbytes)
+{
+    FILE* fp;
+    uint8_t* buf;
+
+    fp = fopen(fname, "rb");
+    if (fp == 0) {
+        abort();
+    }
+
+    buf = (uint8_t*)malloc(65536);
+    if (buf == 0) {
+        abort();
+    }
+
+    *nbytes = fread(buf, sizeof(uint8_t), 65536, fp);
+    fclose(fp);
+
+    return buf;
+}
+
+void setUp(void)
+{
+    sb_container_builder_t builder;
+    size_t i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_init(&builder));
+
+    for (i = 0; i < NUM_SHOWS; i++) {
+        shows[i] = loadFixtureToBuffer(fixtures[i], &show_lengths[i]);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_add(&builder, ids[i], shows[i], show_lengths[i]));
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_get_result(&builder, &container_buf));
+    sb_container_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_from_buffer(&container, SB_BUFFER(container_buf), sb_buffer_size(&container_buf)));
+}
+
+void tearDown(void)
+{
+    size_t i;
+
+    sb_container_destroy(&container);
+    sb_buffer_destroy(&container_buf);
+
+    for (i = 0; i < NUM_SHOWS; i++) {
+        free(shows[i]);
+    }
+}
+
+void test_directory(void)
+{
+    sb_container_entry_t entry;
+    uint32_t i;
+
+    TEST_ASSERT_EQUAL(NUM_SHOWS, sb_container_get_num_entries(&container));
+
+    /* Entries are sorted by ID */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_entry(&container, 0, &entry));
+    TEST_ASSERT_EQUAL(7, entry.id);
+    TEST_ASSERT_EQUAL(show_lengths[1], entry.length);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_entry(&container, 1, &entry));
+    TEST_ASSERT_EQUAL(42, entry.id);
+    TEST_ASSERT_EQUAL(show_lengths[0], entry.length);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_entry(&container, 2, &entry));
+    TEST_ASSERT_EQUAL(1000, entry.id);
+    TEST_ASSERT_EQUAL(show_lengths[2], entry.length);
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_container_get_entry(&container, 3, &entry));
+
+    /* Show files are aligned */
+    for (i = 0; i < NUM_SHOWS; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_entry(&container, i, &entry));
+        TEST_ASSERT_EQUAL(0, entry.offset % SB_CONTAINER_ALIGNMENT);
+    }
+}
+
+void test_find_entry(void)
+{
+    sb_container_entry_t entry;
+    uint8_t* show;
+    size_t i, nbytes;
+
+    for (i = 0; i < NUM_SHOWS; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_find_entry(&container, ids[i], &entry));
+        TEST_ASSERT_EQUAL(ids[i], entry.id);
+
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_show_view(&container, ids[i], 1, &show, &nbytes));
+        TEST_ASSERT_EQUAL(show_lengths[i], nbytes);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(shows[i], show, nbytes);
+    }
+
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_find_entry(&container, 0, &entry));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_find_entry(&container, 43, &entry));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_find_entry(&container, 2000, 0));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_get_show_view(&container, 2000, 1, &show, &nbytes));
+}
+
+void test_init_parser(void)
+{
+    sb_binary_file_parser_t parser;
+    sb_trajectory_t trajectory;
+    sb_container_entry_t entry;
+    uint8_t* start;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_find_entry(&container, 42, &entry));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_parser(&container, 42, &parser, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_parser(&trajectory, &parser));
+
+    /* The trajectory is a view into the container */
+    start = SB_BUFFER(container_buf) + entry.offset;
+    TEST_ASSERT_TRUE(SB_BUFFER(trajectory.buffer) >= start);
+    TEST_ASSERT_TRUE(SB_BUFFER(trajectory.buffer) < start + entry.length);
+
+    sb_trajectory_destroy(&trajectory);
+    sb_binary_file_parser_destroy(&parser);
+
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_init_parser(&container, 43, &parser, 0));
+}
+
+void test_corrupted_show(void)
+{
+    sb_binary_file_parser_t parser;
+    sb_container_entry_t entry;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_find_entry(&container, 7, &entry));
+    SB_BUFFER(container_buf)[entry.offset + entry.length - 1] ^= 0xff;
+
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_container_get_show_view(&container, 7, 1, 0, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_show_view(&container, 7, 0, 0, 0));
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_container_init_parser(&container, 7, &parser, 0));
+
+    /* Other drones are not affected */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_get_show_view(&container, 42, 1, 0, 0));
+}
+
+void test_init_parser_verifies_checksum_once(void)
+{
+    sb_container_builder_t builder;
+    sb_container_t other;
+    sb_buffer_t buf;
+    sb_binary_file_parser_t parser;
+    uint8_t* show;
+    size_t nbytes;
+
+    /* The header of this show file has an invalid checksum but the checksum
+     * in the directory table is computed from its actual contents */
+    show = loadFixtureToBuffer("fixtures/forward_left_back_v2_invalid_chksum.skyb", &nbytes);
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_binary_file_parser_init_from_buffer(&parser, show, nbytes));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_init(&builder));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_add(&builder, 1, show, nbytes));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_get_result(&builder, &buf));
+    sb_container_builder_destroy(&builder);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_from_buffer(&other, SB_BUFFER(buf), sb_buffer_size(&buf)));
+
+    /* Only the checksum in the directory table is verified */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_parser(&other, 1, &parser, SB_BINARY_PARSER_VERIFY_CRC_EAGER));
+    sb_binary_file_parser_destroy(&parser);
+
+    sb_container_destroy(&other);
+    sb_buffer_destroy(&buf);
+    free(show);
+}
+
+void test_invalid_container(void)
+{
+    sb_container_t other;
+    uint8_t* buf = SB_BUFFER(container_buf);
+    size_t nbytes = sb_buffer_size(&container_buf);
+
+    TEST_ASSERT_EQUAL(SB_EPARSE, sb_container_init_from_buffer(&other, buf, 15));
+    TEST_ASSERT_EQUAL(SB_EPARSE, sb_container_init_from_buffer(&other, buf, 40));
+
+    buf[0] = 'x';
+    TEST_ASSERT_EQUAL(SB_EPARSE, sb_container_init_from_buffer(&other, buf, nbytes));
+    buf[0] = 's';
+
+    /* Corrupt the directory table */
+    buf[16] ^= 0xff;
+    TEST_ASSERT_EQUAL(SB_ECORRUPTED, sb_container_init_from_buffer(&other, buf, nbytes));
+    buf[16] ^= 0xff;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_from_buffer(&other, buf, nbytes));
+    sb_container_destroy(&other);
+}
+
+void test_builder(void)
+{
+    sb_container_builder_t builder;
+    sb_container_t other;
+    sb_buffer_t buf;
+
+    /* Empty container */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_init(&builder));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_get_result(&builder, &buf));
+    TEST_ASSERT_EQUAL(16, sb_buffer_size(&buf));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_init_from_buffer(&other, SB_BUFFER(buf), sb_buffer_size(&buf)));
+    TEST_ASSERT_EQUAL(0, sb_container_get_num_entries(&other));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_container_find_entry(&other, 1, 0));
+    sb_container_destroy(&other);
+    sb_buffer_destroy(&buf);
+
+    /* Duplicate IDs */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_add(&builder, 1, shows[0], show_lengths[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_container_builder_add(&builder, 1, shows[1], show_lengths[1]));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_container_builder_get_result(&builder, &buf));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_container_builder_add(&builder, 2, 0, 5));
+
+    sb_container_builder_destroy(&builder);
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_directory);
+    RUN_TEST(test_find_entry);
+    RUN_TEST(test_init_parser);
+    RUN_TEST(test_corrupted_show);
+    RUN_TEST(test_init_parser_verifies_checksum_once);
+    RUN_TEST(test_invalid_container);
+    RUN_TEST(test_builder);
+
+    return UNITY_END();
+}
@@ -0,0 +1,281 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <skybrush/fleet.h>
+
+#include "unity.h"
+
+#define NUM_DRONES 40
+#define NUM_MOVES 12
+
+sb_trajectory_t trajectories[NUM_DRONES];
+sb_trajectory_player_t players[NUM_DRONES];
+
+static unsigned long seed;
+
+static float random_coordinate(float range)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((long)((seed >> 8) % 20001) - 10000) / 10000.0f * range;
+}
+
+static uint32_t random_duration(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return 1000 + (seed >> 8) % 9000;
+}
+
+void setUp(void)
+{
+    sb_trajectory_builder_t builder;
+    sb_vector3_with_yaw_t start, target, control1, control2;
+    size_t i, j;
+
+    seed = 42;
+
+    for (i = 0; i < NUM_DRONES; i++) {
+        if (i == NUM_DRONES - 1) {
+            /* The last drone has no trajectory at all */
+            if (sb_trajectory_init_empty(&trajectories[i])) {
+                abort();
+            }
+        } else {
+            start.x = random_coordinate(20000);
+            start.y = random_coordinate(20000);
+            start.z = 0;
+            start.yaw = 0;
+
+            if (sb_trajectory_builder_init(&builder, 1, 0)) {
+                abort();
+            }
+            if (sb_trajectory_builder_set_start_position(&builder, start)) {
+                abort();
+            }
+
+            for (j = 0; j < NUM_MOVES; j++) {
+                target.x = random_coordinate(20000);
+                target.y = random_coordinate(20000);
+                target.z = 5000 + random_coordinate(4000);
+                target.yaw = 0;
+
+                if (j % 2) {
+                    control1 = target;
+                    control1.x = random_coordinate(20000);
+                    control2 = target;
+                    control2.y = random_coordinate(20000);
+                    if (sb_trajectory_builder_append_cubic_bezier(&builder, control1, control2, target, random_duration())) {
+                        abort();
+                    }
+                } else if (sb_trajectory_builder_append_line(&builder, target, random_duration())) {
+                    abort();
+                }
+            }
+
+            if (sb_trajectory_init_from_builder(&trajectories[i], &builder)) {
+                abort();
+            }
+            sb_trajectory_builder_destroy(&builder);
+        }
+
+        if (sb_trajectory_player_init(&players[i], &trajectories[i])) {
+            abort();
+        }
+    }
+}
+
+void tearDown(void)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_DRONES; i++) {
+        sb_trajectory_player_destroy(&players[i]);
+        sb_trajectory_destroy(&trajectories[i]);
+    }
+}
+
+static int compare_size_t(const void* a, const void* b)
+{
+    size_t sa = *(const size_t*)a;
+    size_t sb = *(const size_t*)b;
+    return sa < sb ? -1 : (sa > sb ? 1 : 0);
+}
+
+static size_t find_near_point_brute_force(
+    unsigned long timestamp, sb_vector3_with_yaw_t point, float radius,
+    size_t exclude, size_t* result)
+{
+    sb_vector3_with_yaw_t pos;
+    float dx, dy, dz;
+    size_t i, num_found = 0;
+
+    for (i = 0; i < NUM_DRONES; i++) {
+        if (i == exclude) {
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&players[i], timestamp, &pos));
+        dx = pos.x - point.x;
+        dy = pos.y - point.y;
+        dz = pos.z - point.z;
+        if (dx * dx + dy * dy + dz * dz <= radius * radius) {
+            result[num_found++] = i;
+        }
+    }
+
+    return num_found;
+}
+
+static void check_queries(sb_fleet_index_t* index)
+{
+    size_t expected[NUM_DRONES], found[NUM_DRONES];
+    size_t num_expected, num_found, i, drone;
+    unsigned long timestamp;
+    sb_vector3_with_yaw_t point;
+    float radius;
+
+    for (i = 0; i < 200; i++) {
+        timestamp = random_duration() * (i % 16);
+        point.x = random_coordinate(20000);
+        point.y = random_coordinate(20000);
+        point.z = 5000 + random_coordinate(5000);
+        point.yaw = 0;
+        radius = 2000 + random_coordinate(1000) + (i % 5) * 3000;
+
+        num_expected = find_near_point_brute_force(timestamp, point, radius, SIZE_MAX, expected);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_point(
+                                          index, timestamp, point, radius, found, NUM_DRONES, &num_found));
+        TEST_ASSERT_EQUAL(num_expected, num_found);
+
+        qsort(found, num_found, sizeof(size_t), compare_size_t);
+        if (num_expected > 0) {
+            TEST_ASSERT_EQUAL_MEMORY(expected, found, num_expected * sizeof(size_t));
+        }
+
+        drone = i % NUM_DRONES;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&players[drone], timestamp, &point));
+        num_expected = find_near_point_brute_force(timestamp, point, radius, drone, expected);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_drone(
+                                          index, timestamp, drone, radius, found, NUM_DRONES, &num_found));
+        TEST_ASSERT_EQUAL(num_expected, num_found);
+
+        qsort(found, num_found, sizeof(size_t), compare_size_t);
+        if (num_expected > 0) {
+            TEST_ASSERT_EQUAL_MEMORY(expected, found, num_expected * sizeof(size_t));
+        }
+    }
+}
+
+void test_empty_fleet(void)
+{
+    sb_fleet_index_t index;
+    sb_vector3_with_yaw_t point = { 0, 0, 0, 0 };
+    size_t num_found = 42;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_init(&index, 0, 0, 1));
+    TEST_ASSERT_EQUAL(0, sb_fleet_index_size(&index));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_point(&index, 0, point, 1000, 0, 0, &num_found));
+    TEST_ASSERT_EQUAL(0, num_found);
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_find_near_drone(&index, 0, 0, 1000, 0, 0, &num_found));
+    sb_fleet_index_destroy(&index);
+
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_init(&index, 0, 5, 1));
+}
+
+void test_find_near_point(void)
+{
+    sb_fleet_index_t index;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_init(&index, trajectories, NUM_DRONES, 1));
+    TEST_ASSERT_EQUAL(NUM_DRONES, sb_fleet_index_size(&index));
+    check_queries(&index);
+    sb_fleet_index_destroy(&index);
+}
+
+void test_find_near_point_built_in_parallel(void)
+{
+    sb_fleet_index_t index;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_init(&index, trajectories, NUM_DRONES, 4));
+    check_queries(&index);
+    sb_fleet_index_destroy(&index);
+}
+
+void test_result_buffer_too_small(void)
+{
+    sb_fleet_index_t index;
+    sb_vector3_with_yaw_t point = { 0, 0, 0, 0 };
+    size_t found[2] = { SIZE_MAX, SIZE_MAX };
+    size_t num_found;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_init(&index, trajectories, NUM_DRONES, 1));
+
+    /* Before takeoff, all drones are within 30 km of the origin */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_point(&index, 0, point, 30000, found, 1, &num_found));
+    TEST_ASSERT_EQUAL(NUM_DRONES, num_found);
+    TEST_ASSERT_TRUE(found[0] < NUM_DRONES);
+    TEST_ASSERT_EQUAL(SIZE_MAX, found[1]);
+
+    /* Counting only */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_point(&index, 0, point, 30000, 0, 0, &num_found));
+    TEST_ASSERT_EQUAL(NUM_DRONES, num_found);
+
+    /* Invalid arguments */
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_find_near_point(&index, 0, point, -1, found, 2, &num_found));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_find_near_point(&index, 0, point, NAN, found, 2, &num_found));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_find_near_point(&index, 0, point, 1000, 0, 2, &num_found));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_index_find_near_drone(&index, 0, NUM_DRONES, 1000, found, 2, &num_found));
+
+    sb_fleet_index_destroy(&index);
+}
+
+void test_after_end_of_show(void)
+{
+    sb_fleet_index_t index;
+    sb_vector3_with_yaw_t end;
+    size_t found[NUM_DRONES];
+    size_t num_found, i;
+    sb_bool_t seen = 0;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_init(&index, trajectories, NUM_DRONES, 1));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_end_position(&trajectories[0], &end));
+
+    /* Drones stay at the end of their trajectories after the show */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_index_find_near_point(&index, 10000000, end, 1, found, NUM_DRONES, &num_found));
+    for (i = 0; i < num_found; i++) {
+        seen |= found[i] == 0;
+    }
+    TEST_ASSERT_TRUE(seen);
+
+    sb_fleet_index_destroy(&index);
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_fleet);
+    RUN_TEST(test_find_near_point);
+    RUN_TEST(test_find_near_point_built_in_parallel);
+    RUN_TEST(test_result_buffer_too_small);
+    RUN_TEST(test_after_end_of_show);
+
+    return UNITY_END();
+}
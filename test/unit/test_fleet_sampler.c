@@ -0,0 +1,185 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+
+#include <skybrush/fleet.h>
+#include <skybrush/formats/binary.h>
+
+#include "unity.h"
+#include "utils.h"
+
+#define NUM_DRONES 5
+
+sb_trajectory_t trajectories[NUM_DRONES];
+sb_yaw_control_t yaw_controls[NUM_DRONES];
+sb_light_program_t programs[NUM_DRONES];
+sb_fleet_sampler_t sampler;
+
+static int open_fixture(FILE** fp)
+{
+    int fd;
+
+    *fp = fopen("fixtures/test.skyb", "rb");
+    if (*fp == 0) {
+        abort();
+    }
+
+    fd = fileno(*fp);
+    if (fd < 0) {
+        abort();
+    }
+
+    return fd;
+}
+
+void setUp(void)
+{
+    FILE* fp;
+    size_t i;
+
+    for (i = 0; i < NUM_DRONES; i++) {
+        if (sb_trajectory_init_from_binary_file(&trajectories[i], open_fixture(&fp))) {
+            abort();
+        }
+        fclose(fp);
+
+        if (sb_yaw_control_init_from_binary_file(&yaw_controls[i], open_fixture(&fp))) {
+            abort();
+        }
+        fclose(fp);
+
+        if (sb_light_program_init_from_binary_file(&programs[i], open_fixture(&fp))) {
+            abort();
+        }
+        fclose(fp);
+    }
+}
+
+void tearDown(void)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_DRONES; i++) {
+        sb_trajectory_destroy(&trajectories[i]);
+        sb_yaw_control_destroy(&yaw_controls[i]);
+        sb_light_program_destroy(&programs[i]);
+    }
+}
+
+/**
+ * Samples the fleet at the given timestamps and compares the results with
+ * standalone players.
+ */
+static void check_sampler_matches_players(const unsigned long* timestamps, size_t num_timestamps, sb_bool_t with_yaw_and_lights)
+{
+    sb_trajectory_player_t trajectory_player;
+    sb_yaw_player_t yaw_player;
+    sb_light_player_t light_player;
+    sb_vector3_with_yaw_t pos;
+    float x[NUM_DRONES], y[NUM_DRONES], z[NUM_DRONES], yaw[NUM_DRONES];
+    float expected_yaw;
+    sb_rgb_color_t colors[NUM_DRONES], expected_color;
+    size_t i, j;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&trajectory_player, &trajectories[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_init(&yaw_player, &yaw_controls[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_init(&light_player, &programs[0]));
+
+    for (i = 0; i < num_timestamps; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_sample_at(&sampler, timestamps[i], x, y, z, yaw, colors));
+
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&trajectory_player, timestamps[i] / 1000.0f, &pos));
+        if (with_yaw_and_lights) {
+            TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&yaw_player, timestamps[i] / 1000.0f, &expected_yaw));
+            expected_color = sb_light_player_get_color_at(&light_player, timestamps[i]);
+        } else {
+            expected_yaw = pos.yaw;
+            expected_color = SB_COLOR_BLACK;
+        }
+
+        for (j = 0; j < NUM_DRONES; j++) {
+            TEST_ASSERT_EQUAL_FLOAT(pos.x, x[j]);
+            TEST_ASSERT_EQUAL_FLOAT(pos.y, y[j]);
+            TEST_ASSERT_EQUAL_FLOAT(pos.z, z[j]);
+            TEST_ASSERT_EQUAL_FLOAT(expected_yaw, yaw[j]);
+            TEST_ASSERT_EQUAL_COLOR(expected_color, colors[j]);
+        }
+    }
+
+    sb_light_player_destroy(&light_player);
+    sb_yaw_player_destroy(&yaw_player);
+    sb_trajectory_player_destroy(&trajectory_player);
+}
+
+void test_empty_fleet(void)
+{
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_init(&sampler, 0, 0, 0, 0));
+    TEST_ASSERT_EQUAL(0, sb_fleet_sampler_size(&sampler));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_sample_at(&sampler, 1000, 0, 0, 0, 0, 0));
+    sb_fleet_sampler_destroy(&sampler);
+
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_fleet_sampler_init(&sampler, 0, 0, 0, NUM_DRONES));
+}
+
+void test_sample_forward(void)
+{
+    unsigned long timestamps[241];
+    size_t i;
+
+    for (i = 0; i < 241; i++) {
+        timestamps[i] = i * 250;
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_init(&sampler, trajectories, yaw_controls, programs, NUM_DRONES));
+    TEST_ASSERT_EQUAL(NUM_DRONES, sb_fleet_sampler_size(&sampler));
+    check_sampler_matches_players(timestamps, 241, 1);
+    sb_fleet_sampler_destroy(&sampler);
+}
+
+void test_sample_random_access_parallel(void)
+{
+    const unsigned long timestamps[] = { 60000, 10000, 25000, 40000, 55000, 5000, 20000, 35000, 50000, 0, 15000, 30000, 45000 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_init(&sampler, trajectories, yaw_controls, programs, NUM_DRONES));
+    sb_fleet_sampler_set_num_threads(&sampler, 3);
+    check_sampler_matches_players(timestamps, sizeof(timestamps) / sizeof(timestamps[0]), 1);
+    sb_fleet_sampler_destroy(&sampler);
+}
+
+void test_sample_without_yaw_and_lights(void)
+{
+    const unsigned long timestamps[] = { 0, 12500, 27500, 42500, 60000 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_fleet_sampler_init(&sampler, trajectories, 0, 0, NUM_DRONES));
+    check_sampler_matches_players(timestamps, sizeof(timestamps) / sizeof(timestamps[0]), 0);
+    sb_fleet_sampler_destroy(&sampler);
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_fleet);
+    RUN_TEST(test_sample_forward);
+    RUN_TEST(test_sample_random_access_parallel);
+    RUN_TEST(test_sample_without_yaw_and_lights);
+
+    return UNITY_END();
+}
@@ -0,0 +1,270 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <skybrush/geofence.h>
+#include <skybrush/trajectory.h>
+
+#include "unity.h"
+
+/* Square fence of 20 m x 20 m with a 10 m x 10 m notch cut out of its
+ * upper right quarter, between 0 and 5 m altitude */
+static const sb_vector2_t vertices[6] = {
+    { -10000, -10000 },
+    { 10000, -10000 },
+    { 10000, 0 },
+    { 0, 0 },
+    { 0, 10000 },
+    { -10000, 10000 },
+};
+
+static sb_geofence_t fence;
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_init(&fence, vertices, 6, 0, 5000));
+}
+
+void tearDown(void)
+{
+    sb_geofence_destroy(&fence);
+}
+
+static void buildTrajectory(
+    sb_trajectory_t* trajectory, sb_vector3_with_yaw_t start,
+    const sb_vector3_with_yaw_t* targets, const uint32_t* durations_msec,
+    size_t num_segments)
+{
+    sb_trajectory_builder_t builder;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_lines(&builder, targets, durations_msec, num_segments));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+}
+
+void test_init_invalid(void)
+{
+    sb_geofence_t other;
+
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_geofence_init(&other, vertices, 2, 0, 5000));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_geofence_init(&other, vertices, 6, 5000, 0));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_geofence_init(&other, vertices, 6, NAN, 0));
+}
+
+void test_contains(void)
+{
+    sb_vector3_with_yaw_t point = { -5000, 5000, 1000, 0 };
+
+    TEST_ASSERT_TRUE(sb_geofence_contains(&fence, point));
+
+    point.x = 5000;
+    TEST_ASSERT_FALSE(sb_geofence_contains(&fence, point));
+
+    point.y = -5000;
+    TEST_ASSERT_TRUE(sb_geofence_contains(&fence, point));
+
+    point.z = 6000;
+    TEST_ASSERT_FALSE(sb_geofence_contains(&fence, point));
+
+    point.z = -1;
+    TEST_ASSERT_FALSE(sb_geofence_contains(&fence, point));
+
+    point.z = 1000;
+    point.x = 20000;
+    TEST_ASSERT_FALSE(sb_geofence_contains(&fence, point));
+}
+
+void test_check_trajectory_inside(void)
+{
+    sb_trajectory_t trajectory;
+    sb_vector3_with_yaw_t start = { -5000, -5000, 0, 0 };
+    sb_vector3_with_yaw_t targets[3] = {
+        { -5000, -5000, 3000, 0 },
+        { 5000, -5000, 3000, 0 },
+        { -5000, 4000, 3000, 0 },
+    };
+    uint32_t durations[3] = { 3000, 5000, 5000 };
+    float violation_time = 0;
+
+    buildTrajectory(&trajectory, start, targets, durations, 3);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+    TEST_ASSERT_TRUE(isinf(violation_time));
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectory_leaves_through_edge(void)
+{
+    sb_trajectory_t trajectory;
+    sb_vector3_with_yaw_t start = { 0, -5000, 0, 0 };
+    sb_vector3_with_yaw_t targets[2] = {
+        { 0, -5000, 3000, 0 },
+        { 20000, -5000, 3000, 0 },
+    };
+    uint32_t durations[2] = { 3000, 10000 };
+    float violation_time = 0;
+
+    /* Crosses X = 10 m after 5 seconds in the second segment */
+    buildTrajectory(&trajectory, start, targets, durations, 2);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 8, violation_time);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectory_enters_notch(void)
+{
+    sb_trajectory_t trajectory;
+    sb_vector3_with_yaw_t start = { -5000, 5000, 1000, 0 };
+    sb_vector3_with_yaw_t targets[1] = {
+        { 5000, 5000, 1000, 0 },
+    };
+    uint32_t durations[1] = { 10000 };
+    float violation_time = 0;
+
+    /* Moving from (-5, 5) to (5, 5) enters the notch at X = 0 after 5 seconds */
+    buildTrajectory(&trajectory, start, targets, durations, 1);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 5, violation_time);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectory_altitude(void)
+{
+    sb_trajectory_t trajectory;
+    sb_vector3_with_yaw_t start = { -5000, -5000, 0, 0 };
+    sb_vector3_with_yaw_t targets[2] = {
+        { -5000, -5000, 6000, 0 },
+        { -5000, -5000, 0, 0 },
+    };
+    uint32_t durations[2] = { 6000, 6000 };
+    float violation_time = 0;
+
+    buildTrajectory(&trajectory, start, targets, durations, 2);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 5, violation_time);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectory_starting_outside(void)
+{
+    sb_trajectory_t trajectory;
+    sb_vector3_with_yaw_t start = { 5000, 5000, 1000, 0 };
+    sb_vector3_with_yaw_t targets[1] = {
+        { -5000, -5000, 1000, 0 },
+    };
+    uint32_t durations[1] = { 10000 };
+    float violation_time = -1;
+
+    buildTrajectory(&trajectory, start, targets, durations, 1);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+    TEST_ASSERT_EQUAL_FLOAT(0, violation_time);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectory_curved(void)
+{
+    sb_trajectory_builder_t builder;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t start = { -5000, -5000, 1000, 0 };
+    sb_vector3_with_yaw_t points[7] = {
+        { 0, -8000, 2000, 0 },
+        { 15000, -6000, 3000, 0 },
+        { 12000, 4000, 2000, 0 },
+        { 3000, 6000, 1000, 0 },
+        { -4000, 12000, 2000, 0 },
+        { -8000, 3000, 3000, 0 },
+        { -5000, 5000, 1000, 0 },
+    };
+    sb_vector3_with_yaw_t pos;
+    float violation_time = 0, expected = INFINITY, t;
+    int i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_poly7d(&builder, points, 10000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectory(&fence, &trajectory, &violation_time));
+
+    /* Compare with dense sampling */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+    for (i = 0; i <= 100000; i++) {
+        t = i * 0.0001f;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t, &pos));
+        if (!sb_geofence_contains(&fence, pos)) {
+            expected = t;
+            break;
+        }
+    }
+    sb_trajectory_player_destroy(&player);
+
+    TEST_ASSERT_TRUE(isfinite(expected));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, expected, violation_time);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_check_trajectories_parallel(void)
+{
+    sb_trajectory_t trajectories[3];
+    sb_vector3_with_yaw_t start = { -5000, -5000, 0, 0 };
+    sb_vector3_with_yaw_t targets[3][1] = {
+        { { -5000, -5000, 3000, 0 } },
+        { { 15000, -5000, 0, 0 } },
+        { { -5000, -5000, 10000, 0 } },
+    };
+    uint32_t durations[1] = { 10000 };
+    float violation_times[3];
+    size_t i;
+
+    for (i = 0; i < 3; i++) {
+        buildTrajectory(&trajectories[i], start, targets[i], durations, 1);
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_geofence_check_trajectories_parallel(&fence, trajectories, 3, violation_times, 2));
+
+    TEST_ASSERT_TRUE(isinf(violation_times[0]));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 7.5, violation_times[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 5, violation_times[2]);
+
+    for (i = 0; i < 3; i++) {
+        sb_trajectory_destroy(&trajectories[i]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_init_invalid);
+    RUN_TEST(test_contains);
+    RUN_TEST(test_check_trajectory_inside);
+    RUN_TEST(test_check_trajectory_leaves_through_edge);
+    RUN_TEST(test_check_trajectory_enters_notch);
+    RUN_TEST(test_check_trajectory_altitude);
+    RUN_TEST(test_check_trajectory_starting_outside);
+    RUN_TEST(test_check_trajectory_curved);
+    RUN_TEST(test_check_trajectories_parallel);
+
+    return UNITY_END();
+}
@@ -0,0 +1,291 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <skybrush/lights.h>
+
+#include "unity.h"
+#include "utils.h"
+
+#define NUM_PROGRAMS 4
+#define FLEET_SIZE 10
+
+sb_light_program_t programs[NUM_PROGRAMS];
+sb_light_program_t fleet_programs[FLEET_SIZE];
+sb_light_player_t color_players[FLEET_SIZE];
+sb_light_player_t pyro_players[FLEET_SIZE];
+sb_light_fleet_player_t fleet;
+
+/* Program that uses pyro commands, fades and a loop */
+uint8_t pyro_program[] = {
+    0x04, 255, 0, 0, 50, /* SET_COLOR red, 1 sec */
+    0x14, 0x81, /* SET_PYRO channel 0 on */
+    0x08, 0, 0, 255, 100, /* FADE_TO_COLOR blue, 2 sec */
+    0x0C, 3, /* LOOP_BEGIN 3 iterations */
+    0x14, 0x82, /* SET_PYRO channel 1 on */
+    0x0B, 25, /* FADE_TO_WHITE, 0.5 sec */
+    0x14, 0x02, /* SET_PYRO channel 1 off */
+    0x06, 25, /* SET_BLACK, 0.5 sec */
+    0x0D, /* LOOP_END */
+    0x15, 0x00, /* SET_PYRO_ALL off */
+    0x00 /* END */
+};
+
+/* Program that stops with an error at an invalid command code */
+uint8_t invalid_program[] = {
+    0x04, 0, 255, 0, 50, /* SET_COLOR green, 1 sec */
+    0x0A, 25, /* FADE_TO_BLACK, 0.5 sec */
+    0x7F, /* invalid command code */
+    0x07, 50, /* SET_WHITE, 1 sec (never reached) */
+    0x00 /* END */
+};
+
+/* Program that skips a command with a forward jump and repeats forever with a
+ * backward jump */
+uint8_t jump_program[] = {
+    0x05, 128, 25, /* SET_GRAY 50%, 0.5 sec */
+    0x12, 7, /* JUMP to FADE_TO_COLOR */
+    0x07, 50, /* SET_WHITE, 1 sec (skipped) */
+    0x08, 0, 255, 0, 50, /* FADE_TO_COLOR green, 1 sec */
+    0x0A, 25, /* FADE_TO_BLACK, 0.5 sec */
+    0x12, 7 /* JUMP to FADE_TO_COLOR */
+};
+
+static void load_program_from_file(sb_light_program_t* program, const char* fname)
+{
+    FILE* fp;
+    int fd;
+
+    fp = fopen(fname, "rb");
+    if (fp == 0) {
+        abort();
+    }
+
+    fd = fileno(fp);
+    if (fd < 0) {
+        abort();
+    }
+
+    if (sb_light_program_init_from_binary_file(program, fd)) {
+        abort();
+    }
+
+    fclose(fp);
+}
+
+void setUp(void)
+{
+    int i;
+
+    load_program_from_file(&programs[0], "fixtures/test.skyb");
+    load_program_from_file(&programs[1], "fixtures/light_program_with_wait_until_cmd.skyb");
+    sb_light_program_init_from_buffer(&programs[2], pyro_program, sizeof(pyro_program));
+    sb_light_program_init_from_buffer(&programs[3], jump_program, sizeof(jump_program));
+
+    for (i = 0; i < FLEET_SIZE; i++) {
+        if (i == FLEET_SIZE - 1) {
+            sb_light_program_init_empty(&fleet_programs[i]);
+        } else {
+            fleet_programs[i] = programs[i % NUM_PROGRAMS];
+            fleet_programs[i].owner = 0;
+        }
+        sb_light_player_init(&color_players[i], &fleet_programs[i]);
+        sb_light_player_init(&pyro_players[i], &fleet_programs[i]);
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_init(&fleet, fleet_programs, FLEET_SIZE));
+}
+
+void tearDown(void)
+{
+    int i;
+
+    sb_light_fleet_player_destroy(&fleet);
+
+    for (i = 0; i < FLEET_SIZE; i++) {
+        sb_light_player_destroy(&color_players[i]);
+        sb_light_player_destroy(&pyro_players[i]);
+        sb_light_program_destroy(&fleet_programs[i]);
+    }
+
+    for (i = 0; i < NUM_PROGRAMS; i++) {
+        sb_light_program_destroy(&programs[i]);
+    }
+}
+
+static void check_fleet_at(unsigned long timestamp)
+{
+    sb_rgb_color_t colors[FLEET_SIZE];
+    uint8_t pyro_channels[FLEET_SIZE];
+    int i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, timestamp, colors, pyro_channels));
+
+    /* Separate players are used for colors and pyro channels because each
+     * query seeks the player once, just like a single fleet evaluation */
+    for (i = 0; i < FLEET_SIZE; i++) {
+        TEST_ASSERT_EQUAL_COLOR(sb_light_player_get_color_at(&color_players[i], timestamp), colors[i]);
+        TEST_ASSERT_EQUAL_UINT8(sb_light_player_get_pyro_channels_at(&pyro_players[i], timestamp), pyro_channels[i]);
+    }
+}
+
+static void check_fleet_matches_individual_players(void)
+{
+    unsigned long t;
+    int i;
+
+    /* forward */
+    for (t = 0; t <= 70000; t += 250) {
+        check_fleet_at(t);
+    }
+
+    /* backward */
+    for (t = 70000; t > 0; t -= 1750) {
+        check_fleet_at(t);
+    }
+
+    /* (pseudo)random access */
+    for (i = 0, t = 12345; i < 100; i++) {
+        check_fleet_at(t);
+        t = (t * 7919 + 104729) % 75000;
+    }
+}
+
+void test_init_empty(void)
+{
+    sb_light_fleet_player_t empty;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_init(&empty, 0, 0));
+    TEST_ASSERT_EQUAL(0, sb_light_fleet_player_size(&empty));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&empty, 1000, 0, 0));
+    sb_light_fleet_player_destroy(&empty);
+
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_light_fleet_player_init(&empty, 0, 5));
+}
+
+void test_size(void)
+{
+    TEST_ASSERT_EQUAL(FLEET_SIZE, sb_light_fleet_player_size(&fleet));
+}
+
+void test_pyro_channels(void)
+{
+    uint8_t pyro_channels[FLEET_SIZE];
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 500, 0, pyro_channels));
+    TEST_ASSERT_EQUAL_UINT8(0, pyro_channels[2]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 2000, 0, pyro_channels));
+    TEST_ASSERT_EQUAL_UINT8(1, pyro_channels[2]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 4250, 0, pyro_channels));
+    TEST_ASSERT_EQUAL_UINT8(3, pyro_channels[2]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 4750, 0, pyro_channels));
+    TEST_ASSERT_EQUAL_UINT8(1, pyro_channels[2]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 6500, 0, pyro_channels));
+    TEST_ASSERT_EQUAL_UINT8(0, pyro_channels[2]);
+}
+
+void test_jumps(void)
+{
+    sb_rgb_color_t colors[FLEET_SIZE];
+    sb_rgb_color_t green = { 0, 255, 0 };
+
+    /* The skipped SET_WHITE command must never show up; we must be fading
+     * from gray to green instead */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 750, colors, 0));
+    TEST_ASSERT_INT_WITHIN(1, 96, colors[3].red);
+    TEST_ASSERT_INT_WITHIN(1, 160, colors[3].green);
+    TEST_ASSERT_INT_WITHIN(1, 96, colors[3].blue);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 1500, colors, 0));
+    TEST_ASSERT_EQUAL_COLOR(green, colors[3]);
+
+    /* Backward jump repeats the fade forever */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 30000, colors, 0));
+    TEST_ASSERT_EQUAL_COLOR(green, colors[3]);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&fleet, 30500, colors, 0));
+    TEST_ASSERT_EQUAL_COLOR(SB_COLOR_BLACK, colors[3]);
+}
+
+void test_evaluate_single_thread(void)
+{
+    sb_light_fleet_player_set_num_threads(&fleet, 1);
+    check_fleet_matches_individual_players();
+}
+
+void test_evaluate_multiple_threads(void)
+{
+    sb_light_fleet_player_set_num_threads(&fleet, 3);
+    check_fleet_matches_individual_players();
+
+    sb_light_fleet_player_set_num_threads(&fleet, 0);
+    check_fleet_matches_individual_players();
+}
+
+void test_evaluate_multiple_threads_with_errors(void)
+{
+    sb_light_fleet_player_t error_fleet;
+    sb_light_program_t error_programs[FLEET_SIZE];
+    sb_light_player_t player;
+    sb_rgb_color_t colors[FLEET_SIZE];
+    unsigned long t;
+    int i, round;
+
+    /* Every player runs into an error and clears it again when it rewinds;
+     * the players must not share error state across worker threads */
+    for (i = 0; i < FLEET_SIZE; i++) {
+        sb_light_program_init_from_buffer(&error_programs[i], invalid_program, sizeof(invalid_program));
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_init(&error_fleet, error_programs, FLEET_SIZE));
+    sb_light_fleet_player_set_num_threads(&error_fleet, 4);
+    sb_light_player_init(&player, &error_programs[0]);
+
+    for (round = 0; round < 5; round++) {
+        for (t = 0; t <= 3000; t += 100) {
+            TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_fleet_player_evaluate_at(&error_fleet, t, colors, 0));
+            for (i = 0; i < FLEET_SIZE; i++) {
+                TEST_ASSERT_EQUAL_COLOR(sb_light_player_get_color_at(&player, t), colors[i]);
+            }
+        }
+    }
+
+    sb_light_player_destroy(&player);
+    sb_light_fleet_player_destroy(&error_fleet);
+    for (i = 0; i < FLEET_SIZE; i++) {
+        sb_light_program_destroy(&error_programs[i]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_init_empty);
+    RUN_TEST(test_size);
+    RUN_TEST(test_pyro_channels);
+    RUN_TEST(test_jumps);
+    RUN_TEST(test_evaluate_single_thread);
+    RUN_TEST(test_evaluate_multiple_threads);
+    RUN_TEST(test_evaluate_multiple_threads_with_errors);
+
+    return UNITY_END();
+}
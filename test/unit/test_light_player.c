@@ -95,11 +95,79 @@ void test_get_color_at(void)
     }
 }
 
+void test_perf_counters(void)
+{
+    sb_perf_counters_t counters;
+
+    sb_light_player_reset_perf_counters(&player);
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    sb_light_player_get_color_at(&player, 10000);
+    sb_light_player_get_color_at(&player, 20000);
+    sb_light_player_get_color_at(&player, 5000);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(3, counters.seeks);
+    TEST_ASSERT_EQUAL(1, counters.rewinds);
+    TEST_ASSERT_TRUE(counters.items_decoded > 1);
+    TEST_ASSERT_TRUE(counters.bytes_executed >= counters.items_decoded);
+    TEST_ASSERT_EQUAL(0, counters.dpoly_computations);
+
+    sb_light_player_reset_perf_counters(&player);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+    TEST_ASSERT_EQUAL(0, counters.bytes_executed);
+#else
+    sb_light_player_get_color_at(&player, 10000);
+    TEST_ASSERT_EQUAL(SB_EUNSUPPORTED, sb_light_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+#endif
+}
+
+void test_snapshot(void)
+{
+    sb_light_player_t other;
+    sb_light_player_snapshot_t snapshot;
+    sb_perf_counters_t counters;
+    unsigned long t;
+
+    /* Take the snapshot in the middle of a fade */
+    sb_light_player_get_color_at(&player, 42000);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_save_snapshot(&player, &snapshot));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_init(&other, &program));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_restore_snapshot(&other, &snapshot));
+    sb_light_player_reset_perf_counters(&other);
+
+    for (t = 42000; t <= 60000; t += 500) {
+        TEST_ASSERT_EQUAL_COLOR(
+            sb_light_player_get_color_at(&player, t),
+            sb_light_player_get_color_at(&other, t));
+    }
+
+    if (sb_light_player_get_perf_counters(&other, &counters) == SB_SUCCESS) {
+        TEST_ASSERT_EQUAL(0, counters.rewinds);
+    }
+
+    /* Seeking backwards after a restore must still work */
+    TEST_ASSERT_EQUAL_COLOR(
+        sb_light_player_get_color_at(&player, 5000),
+        sb_light_player_get_color_at(&other, 5000));
+
+    /* Corrupted snapshots are rejected */
+    snapshot.data[0] ^= 0xff;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_light_player_restore_snapshot(&other, &snapshot));
+
+    sb_light_player_destroy(&other);
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_get_color_at);
+    RUN_TEST(test_perf_counters);
+    RUN_TEST(test_snapshot);
 
     return UNITY_END();
 }
@@ -0,0 +1,476 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <skybrush/lights.h>
+
+#include "unity.h"
+#include "utils.h"
+
+sb_light_program_t program;
+sb_light_program_analysis_t analysis;
+sb_light_pyro_events_t pyro_events;
+
+/* Program that uses pyro commands, fades and a loop */
+uint8_t pyro_program[] = {
+    0x04, 255, 0, 0, 50, /* SET_COLOR red, 1 sec */
+    0x14, 0x81, /* SET_PYRO channel 0 on */
+    0x08, 0, 0, 255, 100, /* FADE_TO_COLOR blue, 2 sec */
+    0x0C, 3, /* LOOP_BEGIN 3 iterations */
+    0x14, 0x82, /* SET_PYRO channel 1 on */
+    0x0B, 25, /* FADE_TO_WHITE, 0.5 sec */
+    0x14, 0x02, /* SET_PYRO channel 1 off */
+    0x06, 25, /* SET_BLACK, 0.5 sec */
+    0x0D, /* LOOP_END */
+    0x05, 64, 5, /* SET_GRAY 25%, 0.1 sec */
+    0x00 /* END */
+};
+
+/* Program that changes pyro channels multiple times at the same timestamp */
+uint8_t simultaneous_pyro_program[] = {
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x14, 0x81, /* SET_PYRO channel 0 on */
+    0x14, 0x82, /* SET_PYRO channel 1 on */
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x14, 0x84, /* SET_PYRO channel 2 on */
+    0x14, 0x04, /* SET_PYRO channel 2 off */
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x15, 0x00, /* SET_PYRO_ALL off */
+    0x00 /* END */
+};
+
+/* Program with nested loops */
+uint8_t nested_loops_program[] = {
+    0x0C, 3, /* LOOP_BEGIN 3 iterations */
+    0x0C, 2, /* LOOP_BEGIN 2 iterations */
+    0x04, 0, 255, 0, 5, /* SET_COLOR green, 0.1 sec */
+    0x0B, 5, /* FADE_TO_WHITE, 0.1 sec */
+    0x0D, /* LOOP_END */
+    0x02, 3, /* SLEEP 60 msec */
+    0x14, 0x84, /* SET_PYRO channel 2 on */
+    0x0D, /* LOOP_END */
+    0x08, 10, 20, 30, 200, 1, /* FADE_TO_COLOR, 4 sec (varint duration) */
+    0x00 /* END */
+};
+
+/* Program with clock manipulation inside a loop */
+uint8_t clock_program[] = {
+    0x02, 10, /* SLEEP 200 msec */
+    0x0C, 3, /* LOOP_BEGIN 3 iterations */
+    0x0E, /* RESET_CLOCK */
+    0x05, 128, 10, /* SET_GRAY 50%, 0.2 sec */
+    0x03, 25, /* WAIT_UNTIL 0.5 sec */
+    0x0D, /* LOOP_END */
+    0x03, 30, /* WAIT_UNTIL 0.6 sec since the last reset */
+    0x06, 5, /* SET_BLACK, 0.1 sec */
+    0x00 /* END */
+};
+
+/* Program that skips a command with a forward jump */
+uint8_t forward_jump_program[] = {
+    0x05, 128, 25, /* SET_GRAY 50%, 0.5 sec */
+    0x12, 7, /* JUMP to FADE_TO_COLOR */
+    0x07, 50, /* SET_WHITE, 1 sec (skipped) */
+    0x08, 0, 255, 0, 50, /* FADE_TO_COLOR green, 1 sec */
+    0x00 /* END */
+};
+
+/* Program that repeats forever with a backward jump */
+uint8_t backward_jump_program[] = {
+    0x05, 128, 25, /* SET_GRAY 50%, 0.5 sec */
+    0x08, 0, 255, 0, 50, /* FADE_TO_COLOR green, 1 sec */
+    0x12, 3 /* JUMP to FADE_TO_COLOR */
+};
+
+/* Program with an infinite loop */
+uint8_t infinite_loop_program[] = {
+    0x0C, 0, /* LOOP_BEGIN infinite */
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x06, 50, /* SET_BLACK, 1 sec */
+    0x0D, /* LOOP_END */
+    0x00 /* END */
+};
+
+/* Program that uses triggers and channels */
+uint8_t trigger_program[] = {
+    0x13, 0x21, 0, /* TRIGGERED_JUMP on rising edge of channel 1 to start */
+    0x10, 0, 1, 2, 50, /* SET_COLOR_FROM_CHANNELS 0, 1, 2, 1 sec */
+    0x00 /* END */
+};
+
+/* Program with an invalid command code */
+uint8_t invalid_program[] = {
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x0F, /* invalid command */
+    0x06, 50, /* SET_BLACK, 1 sec */
+    0x00 /* END */
+};
+
+/* Program with a jump into the middle of an instruction */
+uint8_t invalid_jump_program[] = {
+    0x07, 50, /* SET_WHITE, 1 sec */
+    0x12, 1, /* JUMP into SET_WHITE */
+    0x00 /* END */
+};
+
+/* Program with loops nested too deep */
+uint8_t deep_loops_program[] = {
+    0x0C, 2, 0x0C, 2, 0x0C, 2, 0x0C, 2, 0x0C, 2, /* 5x LOOP_BEGIN 2 iterations */
+    0x07, 5, /* SET_WHITE, 0.1 sec */
+    0x0D, 0x0D, 0x0D, 0x0D, 0x0D, /* 5x LOOP_END */
+    0x00 /* END */
+};
+
+void setUp(void)
+{
+    sb_light_program_init_empty(&program);
+}
+
+void tearDown(void)
+{
+    sb_light_program_destroy(&program);
+}
+
+static void load_program_from_file(const char* fname)
+{
+    FILE* fp;
+    int fd;
+
+    fp = fopen(fname, "rb");
+    if (fp == 0) {
+        abort();
+    }
+
+    fd = fileno(fp);
+    if (fd < 0) {
+        abort();
+    }
+
+    sb_light_program_destroy(&program);
+    if (sb_light_program_init_from_binary_file(&program, fd)) {
+        abort();
+    }
+
+    fclose(fp);
+}
+
+static void load_program_from_buffer(uint8_t* buf, size_t length)
+{
+    sb_light_program_destroy(&program);
+    if (sb_light_program_init_from_buffer(&program, buf, length)) {
+        abort();
+    }
+}
+
+static void analyze(void)
+{
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_program_analyze(&program, &analysis));
+}
+
+/**
+ * Plays the current program with a light player until it ends and checks
+ * whether the results of the analysis match what the player did.
+ */
+static void check_analysis_matches_player(void)
+{
+    sb_light_player_t player;
+    unsigned long t = 0, next;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_init(&player, &program));
+
+    /* seeking repeatedly to the same timestamp executes the zero-duration
+     * commands one by one */
+    while (!sb_light_player_seek(&player, t, &next)) {
+        if (next > t) {
+            t = next;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(t, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(sb_light_player_get_color_at(&player, t), analysis.final_color);
+    TEST_ASSERT_EQUAL_UINT8(sb_light_player_get_pyro_channels_at(&player, t), analysis.final_pyro_channels);
+
+    sb_light_player_destroy(&player);
+}
+
+/**
+ * Extracts the pyro events from the current program and checks whether they
+ * match what the player reports, except at the exact timestamps of the events
+ * where the player may still be in the middle of executing the commands that
+ * belong to the same timestamp.
+ */
+static void check_pyro_events_match_player(void)
+{
+    sb_light_player_t player;
+    const sb_light_pyro_event_t* next;
+    unsigned long t, end;
+    size_t i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_pyro_events_init_from_program(&pyro_events, &program));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_player_init(&player, &program));
+
+    for (i = 1; i < pyro_events.num_events; i++) {
+        TEST_ASSERT_TRUE(pyro_events.events[i - 1].time_msec < pyro_events.events[i].time_msec);
+        TEST_ASSERT_EQUAL_UINT8(pyro_events.events[i - 1].channels_after, pyro_events.events[i].channels_before);
+    }
+
+    end = pyro_events.num_events > 0 ? pyro_events.events[pyro_events.num_events - 1].time_msec : 0;
+    for (t = 0; t <= end + 1000; t += 10) {
+        next = sb_light_pyro_events_get_next(&pyro_events, t > 0 ? t - 1 : 0);
+        if (next && next->time_msec == t) {
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL_UINT8(
+            sb_light_player_get_pyro_channels_at(&player, t),
+            sb_light_pyro_events_get_channels_at(&pyro_events, t));
+    }
+
+    sb_light_player_destroy(&player);
+    sb_light_pyro_events_destroy(&pyro_events);
+}
+
+void test_empty_program(void)
+{
+    analyze();
+
+    TEST_ASSERT_EQUAL(0, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(SB_COLOR_BLACK, analysis.final_color);
+    TEST_ASSERT_EQUAL(0, analysis.final_pyro_channels);
+    TEST_ASSERT_EQUAL(0, analysis.max_loop_depth);
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+}
+
+void test_programs_from_files(void)
+{
+    /* this fixture ends with a stray byte instead of an END command */
+    load_program_from_file("fixtures/test.skyb");
+    analyze();
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_INVALID, analysis.flags);
+    check_analysis_matches_player();
+
+    load_program_from_file("fixtures/light_program_with_wait_until_cmd.skyb");
+    analyze();
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+
+    load_program_from_file("fixtures/real_show.skyb");
+    analyze();
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_loop(void)
+{
+    sb_rgb_color_t gray = { 64, 64, 64 };
+
+    load_program_from_buffer(pyro_program, sizeof(pyro_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(6100, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(gray, analysis.final_color);
+    TEST_ASSERT_EQUAL(1, analysis.final_pyro_channels);
+    TEST_ASSERT_EQUAL(1, analysis.max_loop_depth);
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_nested_loops(void)
+{
+    sb_rgb_color_t color = { 10, 20, 30 };
+
+    load_program_from_buffer(nested_loops_program, sizeof(nested_loops_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(3 * (2 * 200 + 60) + 4000, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(color, analysis.final_color);
+    TEST_ASSERT_EQUAL(4, analysis.final_pyro_channels);
+    TEST_ASSERT_EQUAL(2, analysis.max_loop_depth);
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_clock_manipulation_in_loop(void)
+{
+    load_program_from_buffer(clock_program, sizeof(clock_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(200 + 3 * 500 + 100 + 100, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(SB_COLOR_BLACK, analysis.final_color);
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_forward_jump(void)
+{
+    sb_rgb_color_t green = { 0, 255, 0 };
+
+    load_program_from_buffer(forward_jump_program, sizeof(forward_jump_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(1500, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(green, analysis.final_color);
+    TEST_ASSERT_EQUAL(0, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_infinite_programs(void)
+{
+    load_program_from_buffer(backward_jump_program, sizeof(backward_jump_program));
+    analyze();
+    TEST_ASSERT_EQUAL(UINT32_MAX, analysis.duration_msec);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_INFINITE, analysis.flags);
+
+    load_program_from_buffer(infinite_loop_program, sizeof(infinite_loop_program));
+    analyze();
+    TEST_ASSERT_EQUAL(UINT32_MAX, analysis.duration_msec);
+    TEST_ASSERT_EQUAL(1, analysis.max_loop_depth);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_INFINITE, analysis.flags);
+}
+
+void test_triggers_and_channels(void)
+{
+    load_program_from_buffer(trigger_program, sizeof(trigger_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(1000, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(SB_COLOR_BLACK, analysis.final_color);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_HAS_TRIGGERS | SB_LIGHT_PROGRAM_USES_CHANNELS, analysis.flags);
+}
+
+void test_invalid_programs(void)
+{
+    load_program_from_buffer(invalid_program, sizeof(invalid_program));
+    analyze();
+    TEST_ASSERT_EQUAL(1000, analysis.duration_msec);
+    TEST_ASSERT_EQUAL_COLOR(SB_COLOR_WHITE, analysis.final_color);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_INVALID, analysis.flags);
+
+    load_program_from_buffer(invalid_jump_program, sizeof(invalid_jump_program));
+    analyze();
+    TEST_ASSERT_EQUAL(1000, analysis.duration_msec);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_INVALID, analysis.flags);
+}
+
+void test_loops_too_deep(void)
+{
+    load_program_from_buffer(deep_loops_program, sizeof(deep_loops_program));
+    analyze();
+
+    TEST_ASSERT_EQUAL(5, analysis.max_loop_depth);
+    TEST_ASSERT_EQUAL(SB_LIGHT_PROGRAM_LOOPS_TOO_DEEP, analysis.flags);
+    check_analysis_matches_player();
+}
+
+void test_pyro_events(void)
+{
+    const uint32_t times[] = { 1000, 3000, 3500, 4000, 4500, 5000, 5500 };
+    const uint8_t states[] = { 1, 3, 1, 3, 1, 3, 1 };
+    const sb_light_pyro_event_t* next;
+    size_t i;
+
+    load_program_from_buffer(pyro_program, sizeof(pyro_program));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_pyro_events_init_from_program(&pyro_events, &program));
+
+    /* the loop must be unrolled */
+    TEST_ASSERT_EQUAL(7, pyro_events.num_events);
+    TEST_ASSERT_EQUAL(0, pyro_events.flags);
+    for (i = 0; i < pyro_events.num_events; i++) {
+        TEST_ASSERT_EQUAL(times[i], pyro_events.events[i].time_msec);
+        TEST_ASSERT_EQUAL_UINT8(i > 0 ? states[i - 1] : 0, pyro_events.events[i].channels_before);
+        TEST_ASSERT_EQUAL_UINT8(states[i], pyro_events.events[i].channels_after);
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(0, sb_light_pyro_events_get_channels_at(&pyro_events, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, sb_light_pyro_events_get_channels_at(&pyro_events, 999));
+    TEST_ASSERT_EQUAL_UINT8(1, sb_light_pyro_events_get_channels_at(&pyro_events, 1000));
+    TEST_ASSERT_EQUAL_UINT8(3, sb_light_pyro_events_get_channels_at(&pyro_events, 3200));
+    TEST_ASSERT_EQUAL_UINT8(1, sb_light_pyro_events_get_channels_at(&pyro_events, 100000));
+
+    next = sb_light_pyro_events_get_next(&pyro_events, 0);
+    TEST_ASSERT_NOT_NULL(next);
+    TEST_ASSERT_EQUAL(1000, next->time_msec);
+    next = sb_light_pyro_events_get_next(&pyro_events, 4000);
+    TEST_ASSERT_NOT_NULL(next);
+    TEST_ASSERT_EQUAL(4500, next->time_msec);
+    TEST_ASSERT_NULL(sb_light_pyro_events_get_next(&pyro_events, 5500));
+
+    sb_light_pyro_events_destroy(&pyro_events);
+
+    check_pyro_events_match_player();
+}
+
+void test_pyro_events_at_same_timestamp(void)
+{
+    load_program_from_buffer(simultaneous_pyro_program, sizeof(simultaneous_pyro_program));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_pyro_events_init_from_program(&pyro_events, &program));
+
+    /* changes at the same timestamp are merged, cancelling changes dropped */
+    TEST_ASSERT_EQUAL(2, pyro_events.num_events);
+    TEST_ASSERT_EQUAL(1000, pyro_events.events[0].time_msec);
+    TEST_ASSERT_EQUAL_UINT8(0, pyro_events.events[0].channels_before);
+    TEST_ASSERT_EQUAL_UINT8(3, pyro_events.events[0].channels_after);
+    TEST_ASSERT_EQUAL(3000, pyro_events.events[1].time_msec);
+    TEST_ASSERT_EQUAL_UINT8(3, pyro_events.events[1].channels_before);
+    TEST_ASSERT_EQUAL_UINT8(0, pyro_events.events[1].channels_after);
+
+    sb_light_pyro_events_destroy(&pyro_events);
+}
+
+void test_pyro_events_match_player(void)
+{
+    load_program_from_buffer(nested_loops_program, sizeof(nested_loops_program));
+    check_pyro_events_match_player();
+
+    load_program_from_file("fixtures/light_program_with_wait_until_cmd.skyb");
+    check_pyro_events_match_player();
+
+    load_program_from_file("fixtures/real_show.skyb");
+    check_pyro_events_match_player();
+}
+
+void test_pyro_events_of_empty_program(void)
+{
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_light_pyro_events_init_from_program(&pyro_events, &program));
+    TEST_ASSERT_EQUAL(0, pyro_events.num_events);
+    TEST_ASSERT_EQUAL_UINT8(0, sb_light_pyro_events_get_channels_at(&pyro_events, 1000));
+    TEST_ASSERT_NULL(sb_light_pyro_events_get_next(&pyro_events, 0));
+    sb_light_pyro_events_destroy(&pyro_events);
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_program);
+    RUN_TEST(test_programs_from_files);
+    RUN_TEST(test_loop);
+    RUN_TEST(test_nested_loops);
+    RUN_TEST(test_clock_manipulation_in_loop);
+    RUN_TEST(test_forward_jump);
+    RUN_TEST(test_infinite_programs);
+    RUN_TEST(test_triggers_and_channels);
+    RUN_TEST(test_invalid_programs);
+    RUN_TEST(test_loops_too_deep);
+    RUN_TEST(test_pyro_events);
+    RUN_TEST(test_pyro_events_at_same_timestamp);
+    RUN_TEST(test_pyro_events_match_player);
+    RUN_TEST(test_pyro_events_of_empty_program);
+
+    return UNITY_END();
+}
@@ -111,6 +111,36 @@ void test_parse_uint16(void)
     TEST_ASSERT_EQUAL(7, offset);
 }
 
+void test_parse_int16_array_scaled(void)
+{
+    uint8_t buf[32];
+    float result[15];
+    size_t i, offset, count;
+    int16_t value;
+    float expected;
+
+    buf[0] = 0xaa;
+    for (i = 0; i < 15; i++) {
+        value = (int16_t)(i * 4099 - 32768);
+        offset = 1 + 2 * i;
+        sb_write_int16(buf, &offset, value);
+    }
+
+    /* Check counts that exercise the 8-wide, 4-wide and scalar code paths */
+    for (count = 0; count <= 15; count++) {
+        offset = 1;
+        memset(result, 0, sizeof(result));
+        sb_parse_int16_array_scaled(buf, &offset, count, 2.5f, result);
+        TEST_ASSERT_EQUAL(1 + 2 * count, offset);
+
+        for (i = 0; i < count; i++) {
+            offset = 1 + 2 * i;
+            expected = sb_parse_int16(buf, &offset) * 2.5f;
+            TEST_ASSERT_EQUAL_FLOAT(expected, result[i]);
+        }
+    }
+}
+
 void test_format_int32(void)
 {
     const uint8_t expected[10] = { 0x01, 0x02, 0x03, 0x04, 0x04, 0x05, 0xff, 0xfe, 0x00, 0x00 };
@@ -244,6 +274,7 @@ int main(int argc, char* argv[])
     UNITY_BEGIN();
 
     RUN_TEST(test_parse_int16);
+    RUN_TEST(test_parse_int16_array_scaled);
     RUN_TEST(test_parse_int32);
     RUN_TEST(test_parse_uint16);
     RUN_TEST(test_parse_uint32);
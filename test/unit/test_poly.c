@@ -315,6 +315,44 @@ void test_get_extrema(void)
     TEST_ASSERT_EQUAL(4, result.max);
 }
 
+void test_get_extrema_bounds(void)
+{
+    sb_poly_t poly;
+    sb_interval_t result;
+    float cubic[4] = { 0, 7, 13, 61 };
+    float line[6] = { 0, 1, 2, 3, 4, 5 };
+    float xs[8] = { 0, 10, -5, 3, 3, 8, 1, 2 };
+    float t, y;
+    int i;
+
+    /* exact for low-degree polynomials */
+
+    sb_poly_make_bezier(&poly, 1, cubic, 4);
+    sb_poly_get_extrema_bounds(&poly, &result);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 0, result.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 61, result.max);
+
+    /* degree-elevated line is still treated as a line */
+
+    sb_poly_make_bezier(&poly, 1, line, 6);
+    sb_poly_get_extrema_bounds(&poly, &result);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, result.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 5, result.max);
+
+    /* Bernstein coefficients of a Bezier curve are its control points */
+
+    sb_poly_make_bezier(&poly, 1, xs, 8);
+    sb_poly_get_extrema_bounds(&poly, &result);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, -5, result.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 10, result.max);
+
+    for (i = 0; i <= 100; i++) {
+        t = i / 100.0f;
+        y = sb_poly_eval(&poly, t);
+        TEST_ASSERT_TRUE(y >= result.min && y <= result.max);
+    }
+}
+
 void test_stretch(void)
 {
     sb_poly_t poly;
@@ -613,6 +651,53 @@ void test_solve_generic(void)
     TEST_ASSERT_EQUAL(SB_SUCCESS, sb_poly_solve(&poly, 2, roots, &num_roots));
     TEST_ASSERT_EQUAL(1, num_roots);
     TEST_ASSERT_FLOAT_WITHIN(1e-4, -0.128953f, roots[0]);
+
+    /* quartic: (x-1)(x-2)(x-3)(x-4) */
+    xs[0] = 24;
+    xs[1] = -50;
+    xs[2] = 35;
+    xs[3] = -10;
+    xs[4] = 1;
+    sb_poly_make(&poly, xs, 5);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_poly_solve(&poly, 0, roots, &num_roots));
+    TEST_ASSERT_EQUAL(4, num_roots);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 1, roots[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 2, roots[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 3, roots[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 4, roots[3]);
+
+    /* quartic without real roots: x^4 + 1 */
+    xs[0] = 1;
+    xs[1] = 0;
+    xs[2] = 0;
+    xs[3] = 0;
+    xs[4] = 1;
+    sb_poly_make(&poly, xs, 5);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_poly_solve(&poly, 0, roots, &num_roots));
+    TEST_ASSERT_EQUAL(0, num_roots);
+
+    /* quintic: (x+2)(x-0.5)(x-1)(x-3)(x-4) */
+    xs[0] = 12;
+    xs[1] = -37;
+    xs[2] = 24.5f;
+    xs[3] = 6;
+    xs[4] = -6.5f;
+    xs[5] = 1;
+    sb_poly_make(&poly, xs, 6);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_poly_solve(&poly, 0, roots, &num_roots));
+    TEST_ASSERT_EQUAL(5, num_roots);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, -2, roots[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.5f, roots[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 1, roots[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 3, roots[3]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 4, roots[4]);
+
+    /* same quintic with a right hand side; x = 2 gives 12 */
+    xs[0] = 0;
+    sb_poly_make(&poly, xs, 6);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_poly_solve(&poly, -12, roots, &num_roots));
+    TEST_ASSERT_EQUAL(5, num_roots);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.5f, roots[1]);
 }
 
 void test_touches_simple(void)
@@ -868,6 +953,7 @@ int main(int argc, char* argv[])
     RUN_TEST(test_scale);
     RUN_TEST(test_get_degree);
     RUN_TEST(test_get_extrema);
+    RUN_TEST(test_get_extrema_bounds);
     RUN_TEST(test_stretch);
     RUN_TEST(test_deriv);
 
@@ -17,6 +17,8 @@
  * this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+
 #include <skybrush/formats/binary.h>
 #include <skybrush/trajectory.h>
 
@@ -395,6 +397,168 @@ void test_propose_landing_time_multiple_trailing_vertical_segments(void)
         sb_trajectory_propose_landing_time_sec(&trajectory, 15000 /* mm */, 50 /* mm */));
 }
 
+void test_get_kinematic_peaks(void)
+{
+    sb_trajectory_builder_t builder;
+    sb_trajectory_t built;
+    sb_trajectory_kinematic_peaks_t peaks;
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t corner = { 3000, 4000, 0, 0 };
+    sb_vector3_with_yaw_t top = { 3000, 4000, 2000, 0 };
+    sb_vector3_with_yaw_t control1 = { 3000, 4000, 2000, 0 };
+    sb_vector3_with_yaw_t control2 = { 6000, 4000, 2000, 0 };
+    sb_vector3_with_yaw_t target = { 6000, 4000, 2000, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+
+    /* 5 m/s horizontally for 1 second, then 1 m/s vertically for 2 seconds */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(&builder, corner, 1000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(&builder, top, 2000));
+
+    /* Smooth 3 m move along X in 1 second; x(u) = 3000 * (3u^2 - 2u^3), which
+     * peaks at 4.5 m/s in the middle and at 18 m/s^2 at the endpoints */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(
+                                      &builder, control1, control2, target, 1000));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&built, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks(&built, &peaks));
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-2, 5000, peaks.horizontal_velocity.value);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, peaks.horizontal_velocity.time_sec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2, 1000, peaks.vertical_velocity.value);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 1, peaks.vertical_velocity.time_sec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-1, 18000, peaks.horizontal_acceleration.value);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 3, peaks.horizontal_acceleration.time_sec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, peaks.vertical_acceleration.value);
+
+    sb_trajectory_destroy(&built);
+
+    /* Same trajectory without the first two segments to test an interior peak */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, top));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(
+                                      &builder, control1, control2, target, 1000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&built, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks(&built, &peaks));
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-2, 4500, peaks.horizontal_velocity.value);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.5, peaks.horizontal_velocity.time_sec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, peaks.vertical_velocity.value);
+
+    sb_trajectory_destroy(&built);
+}
+
+void test_get_kinematic_peaks_poly7d(void)
+{
+    sb_trajectory_builder_t builder;
+    sb_trajectory_t built;
+    sb_trajectory_player_t player;
+    sb_trajectory_kinematic_peaks_t peaks;
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t points[7] = {
+        { 200, 100, 100, 0 },
+        { -3000, 4000, 1500, 0 },
+        { 5000, 2000, -2000, 0 },
+        { 1000, -4000, 3000, 0 },
+        { -2000, 3000, 1000, 0 },
+        { 4000, 1000, 2500, 0 },
+        { 3000, 2000, 2000, 0 },
+    };
+    sb_vector3_with_yaw_t vel, acc;
+    float t, max_vel_xy = 0, max_acc_z = 0, value;
+    int i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_poly7d(&builder, points, 4000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&built, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks(&built, &peaks));
+
+    /* Compare with dense sampling; the root of the derivative of the
+     * horizontal speed is a polynomial of degree 11 here */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &built));
+    for (i = 0; i <= 8000; i++) {
+        t = i * 0.0005f;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, t, &vel));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_acceleration_at(&player, t, &acc));
+        value = sqrtf(vel.x * vel.x + vel.y * vel.y);
+        if (value > max_vel_xy) {
+            max_vel_xy = value;
+        }
+        if (fabsf(acc.z) > max_acc_z) {
+            max_acc_z = fabsf(acc.z);
+        }
+    }
+    sb_trajectory_player_destroy(&player);
+
+    TEST_ASSERT_FLOAT_WITHIN(max_vel_xy * 1e-4f, max_vel_xy, peaks.horizontal_velocity.value);
+    TEST_ASSERT_FLOAT_WITHIN(max_acc_z * 1e-4f, max_acc_z, peaks.vertical_acceleration.value);
+    TEST_ASSERT_TRUE(peaks.horizontal_velocity.value >= max_vel_xy * 0.99999f);
+    TEST_ASSERT_TRUE(peaks.horizontal_velocity.time_sec > 0.1f);
+    TEST_ASSERT_TRUE(peaks.horizontal_velocity.time_sec < 3.9f);
+
+    sb_trajectory_destroy(&built);
+}
+
+void test_get_kinematic_peaks_matches_sampling(void)
+{
+    sb_trajectory_player_t player;
+    sb_trajectory_kinematic_peaks_t peaks;
+    sb_vector3_with_yaw_t vel, acc;
+    float t, duration, value;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks(&trajectory, &peaks));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+
+    duration = sb_trajectory_get_total_duration_sec(&trajectory);
+
+    /* Sampled values may never exceed the analytic peaks */
+    for (t = 0; t <= duration; t += 0.01f) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, t, &vel));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_acceleration_at(&player, t, &acc));
+
+        value = sqrtf(vel.x * vel.x + vel.y * vel.y);
+        TEST_ASSERT_TRUE(value <= peaks.horizontal_velocity.value * 1.0001f + 1e-3f);
+        TEST_ASSERT_TRUE(fabsf(vel.z) <= peaks.vertical_velocity.value * 1.0001f + 1e-3f);
+    }
+
+    /* The peaks must be attained at the reported times */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(
+                                      &player, peaks.vertical_velocity.time_sec, &vel));
+    TEST_ASSERT_FLOAT_WITHIN(
+        peaks.vertical_velocity.value * 1e-3f, peaks.vertical_velocity.value, fabsf(vel.z));
+
+    sb_trajectory_player_destroy(&player);
+}
+
+void test_get_kinematic_peaks_parallel(void)
+{
+    sb_trajectory_t trajectories[3];
+    sb_trajectory_kinematic_peaks_t expected, results[3];
+    size_t i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks(&trajectory, &expected));
+
+    for (i = 0; i < 3; i++) {
+        trajectories[i] = trajectory;
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_kinematic_peaks_parallel(trajectories, 3, results, 2));
+
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(expected.horizontal_velocity.value, results[i].horizontal_velocity.value);
+        TEST_ASSERT_EQUAL_FLOAT(expected.horizontal_velocity.time_sec, results[i].horizontal_velocity.time_sec);
+        TEST_ASSERT_EQUAL_FLOAT(expected.vertical_acceleration.value, results[i].vertical_acceleration.value);
+    }
+}
+
 void test_load_truncated_file(void)
 {
     closeFixture();
@@ -428,11 +592,17 @@ int main(int argc, char* argv[])
     RUN_TEST(test_propose_takeoff_time_const_acceleration);
     RUN_TEST(test_propose_landing_time);
     RUN_TEST(test_propose_landing_time_multiple_trailing_vertical_segments);
+    RUN_TEST(test_get_kinematic_peaks_matches_sampling);
+    RUN_TEST(test_get_kinematic_peaks_parallel);
 
     /* additional tests with other files */
     RUN_TEST(test_load_truncated_file);
     RUN_TEST(test_load_file_with_zero_scale);
 
+    /* tests with trajectories built on the fly */
+    RUN_TEST(test_get_kinematic_peaks);
+    RUN_TEST(test_get_kinematic_peaks_poly7d);
+
     /* editing tests */
 
     /* regression tests */
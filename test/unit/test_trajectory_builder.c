@@ -17,6 +17,8 @@
  * this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+
 #include <skybrush/formats/binary.h>
 #include <skybrush/trajectory.h>
 
@@ -194,6 +196,279 @@ void test_append_line(void)
     sb_trajectory_builder_destroy(&builder);
 }
 
+void test_append_lines(void)
+{
+    sb_vector3_with_yaw_t start = { 10, 20, 15, 117 };
+    sb_vector3_with_yaw_t targets[] = {
+        { 20, 40, 30, 210 },
+        { 30, 40, 30, -30 },
+        { 30, 50, 30, -30 },
+        { 30, 50, 0, -30 },
+        { 7030, 50, 2000, 90 },
+    };
+    uint32_t durations[] = { 10000, 5000, 5000, 15000, 90000 };
+    sb_vector3_with_yaw_t invalid_targets[] = {
+        { 20, 40, 30, 210 },
+        { 200000, 40, 30, 210 },
+    };
+    // clang-format off
+    uint8_t expected[] = {
+        2, 5, 0, 10, 0, 7, 0, 146, 4,
+        0x55, 0x10, 0x27, 10, 0, 20, 0, 15, 0, 0x34, 8,
+        0x41, 0x88, 0x13, 15, 0, 0xe4, 0x0c,
+        0x04, 0x88, 0x13, 25, 0,
+        0x10, 0x98, 0x3a, 0, 0,
+        0x51, 0xc8, 0xaf, 0xe5, 0x06, 0xf4, 0x01, 0x2c, 0x01,
+        0x51, 0xc8, 0xaf, 0xbb, 0x0d, 0xe8, 0x03, 0x84, 0x03,
+    }; // clang-format on
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 2, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+
+    /* appending nothing is a no-op */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_lines(&builder, 0, 0, 0));
+    TEST_ASSERT_EQUAL(9, sb_buffer_size(&builder.buffer));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_lines(&builder, targets, durations, 5));
+    TEST_ASSERT_EQUAL(sizeof(expected), sb_buffer_size(&builder.buffer));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, SB_BUFFER(builder.buffer), sizeof(expected));
+    TEST_ASSERT_EQUAL(targets[4].x, builder.last_position.x);
+    TEST_ASSERT_EQUAL(targets[4].y, builder.last_position.y);
+    TEST_ASSERT_EQUAL(targets[4].z, builder.last_position.z);
+    TEST_ASSERT_EQUAL(targets[4].yaw, builder.last_position.yaw);
+
+    /* invalid targets leave the trajectory intact */
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_append_lines(&builder, invalid_targets, durations, 2));
+    TEST_ASSERT_EQUAL(sizeof(expected), sb_buffer_size(&builder.buffer));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, SB_BUFFER(builder.buffer), sizeof(expected));
+    TEST_ASSERT_EQUAL(targets[4].x, builder.last_position.x);
+
+    sb_trajectory_builder_destroy(&builder);
+}
+
+static void assert_position_equal(sb_vector3_with_yaw_t expected, sb_vector3_with_yaw_t actual, float tolerance)
+{
+    TEST_ASSERT_FLOAT_WITHIN(tolerance, expected.x, actual.x);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance, expected.y, actual.y);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance, expected.z, actual.z);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance, expected.yaw, actual.yaw);
+}
+
+static float cubic_bezier(float a, float b, float c, float d, float t)
+{
+    float u = 1 - t;
+    return u * u * u * a + 3 * u * u * t * b + 3 * u * t * t * c + t * t * t * d;
+}
+
+void test_append_cubic_bezier(void)
+{
+    sb_vector3_with_yaw_t start = { 0, 0, 100, 90 };
+    sb_vector3_with_yaw_t control1 = { 100, 100, 100, 90 };
+    sb_vector3_with_yaw_t control2 = { 300, 200, 100, 90 };
+    sb_vector3_with_yaw_t target = { 400, 300, 100, 90 };
+    sb_vector3_with_yaw_t vec, expected;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    uint8_t* buf;
+    float t;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+
+    /* X is a real cubic curve, Y is evenly spaced on a line, Z and yaw are
+     * constant */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(&builder, control1, control2, target, 10000));
+
+    buf = SB_BUFFER(builder.buffer);
+    TEST_ASSERT_EQUAL(9 + 3 + 6 + 2, sb_buffer_size(&builder.buffer));
+    TEST_ASSERT_EQUAL(SB_X_BEZIER | SB_Y_LINEAR | SB_Z_CONSTANT | SB_YAW_CONSTANT, buf[9]);
+    TEST_ASSERT_EQUAL(target.x, builder.last_position.x);
+    TEST_ASSERT_EQUAL(target.y, builder.last_position.y);
+
+    /* Long segments are subdivided */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(&builder, control2, control1, start, 100000));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+
+    for (t = 0; t <= 1; t += 0.125f) {
+        expected.x = cubic_bezier(start.x, control1.x, control2.x, target.x, t);
+        expected.y = cubic_bezier(start.y, control1.y, control2.y, target.y, t);
+        expected.z = 100;
+        expected.yaw = 90;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t * 10, &vec));
+        assert_position_equal(expected, vec, 0.01f);
+
+        expected.x = cubic_bezier(target.x, control2.x, control1.x, start.x, t);
+        expected.y = cubic_bezier(target.y, control2.y, control1.y, start.y, t);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, 10 + t * 100, &vec));
+        assert_position_equal(expected, vec, 0.01f);
+    }
+
+    sb_trajectory_player_destroy(&player);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_append_poly7d(void)
+{
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t points[7];
+    sb_vector3_with_yaw_t vec;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    /* cubic curve (0, 70, 140, 210) elevated to degree 7 */
+    float elevated[] = { 0, 30, 60, 90, 120, 150, 180, 210 };
+    float cubic[] = { 0, 10, 200, 210 };
+    float elevated_cubic[8];
+    float genuine[] = { 0, 50, -50, 100, 0, 300, 100, 200 };
+    /* binomial coefficients */
+    float c3[] = { 1, 3, 3, 1 };
+    float c4[] = { 1, 4, 6, 4, 1 };
+    float c7[] = { 1, 7, 21, 35, 35, 21, 7, 1 };
+    uint8_t* buf;
+    int i, j;
+    float t, u, expected, coeff;
+
+    /* elevate the cubic curve to degree 7 by hand: the control points of
+     * the elevated curve are weighted sums of the original ones */
+    for (i = 0; i <= 7; i++) {
+        elevated_cubic[i] = 0;
+        for (j = 0; j <= 3; j++) {
+            if (i - j >= 0 && i - j <= 4) {
+                elevated_cubic[i] += cubic[j] * c3[j] * c4[i - j] / c7[i];
+            }
+        }
+    }
+
+    for (i = 0; i < 7; i++) {
+        points[i].x = elevated[i + 1];
+        points[i].y = elevated_cubic[i + 1];
+        points[i].z = genuine[i + 1];
+        points[i].yaw = 0;
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_poly7d(&builder, points, 7000));
+
+    buf = SB_BUFFER(builder.buffer);
+    TEST_ASSERT_EQUAL(9 + 3 + 2 + 6 + 14, sb_buffer_size(&builder.buffer));
+    TEST_ASSERT_EQUAL(SB_X_LINEAR | SB_Y_BEZIER | SB_Z_POLY7D | SB_YAW_CONSTANT, buf[9]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+
+    for (t = 0; t <= 1; t += 0.125f) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t * 7, &vec));
+
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 210 * t, vec.x);
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, cubic_bezier(cubic[0], cubic[1], cubic[2], cubic[3], t), vec.y);
+
+        /* evaluate the degree 7 curve with Bernstein polynomials */
+        expected = 0;
+        u = 1 - t;
+        for (i = 0; i <= 7; i++) {
+            coeff = c7[i];
+            for (j = 0; j < i; j++) {
+                coeff *= t;
+            }
+            for (j = 0; j < 7 - i; j++) {
+                coeff *= u;
+            }
+            expected += coeff * genuine[i];
+        }
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expected, vec.z);
+    }
+
+    sb_trajectory_player_destroy(&player);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_append_cubic_bezier_chained_without_drift(void)
+{
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t control1, control2, target, end;
+    sb_trajectory_t trajectory;
+    int i;
+
+    /* Each segment is shorter than one unit of the scale; the builder must
+     * not lose track of where the encoded trajectory is */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 10, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+
+    target = start;
+    for (i = 1; i <= 20; i++) {
+        control1 = control2 = target;
+        control1.x = target.x + 8.0f / 3;
+        control2.x = target.x + 16.0f / 3;
+        target.x = 8 * i;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(&builder, control1, control2, target, 1000));
+        TEST_ASSERT_FLOAT_WITHIN(10, target.x, builder.last_position.x);
+    }
+
+    end = builder.last_position;
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_end_position(&trajectory, &start));
+    TEST_ASSERT_EQUAL_FLOAT(end.x, start.x);
+    TEST_ASSERT_FLOAT_WITHIN(10, 160, start.x);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_append_cubic_bezier_error_bound(void)
+{
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t control1 = { 48.8f, 95.5f, 7, 0 };
+    sb_vector3_with_yaw_t control2 = { 88.6f, 8.5f, -7, 0 };
+    sb_vector3_with_yaw_t target = { 119.5f, 199, 9, 0 };
+    sb_vector3_with_yaw_t vec;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    float t, error, max_error = 0;
+
+    /* X and Z are simplified to a line and a constant, respectively, and
+     * then all the coordinates are rounded down to multiples of the scale,
+     * so the error may exceed one unit of the scale but not two */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 10, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(&builder, control1, control2, target, 10000));
+    TEST_ASSERT_EQUAL(SB_X_LINEAR | SB_Y_BEZIER | SB_Z_CONSTANT | SB_YAW_CONSTANT, SB_BUFFER(builder.buffer)[9]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+
+    for (t = 0; t <= 1; t += 0.0625f) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t * 10, &vec));
+        error = fabsf(cubic_bezier(start.x, control1.x, control2.x, target.x, t) - vec.x);
+        TEST_ASSERT_TRUE(error < 20);
+        max_error = error > max_error ? error : max_error;
+        TEST_ASSERT_FLOAT_WITHIN(20, cubic_bezier(start.y, control1.y, control2.y, target.y, t), vec.y);
+        TEST_ASSERT_FLOAT_WITHIN(20, cubic_bezier(start.z, control1.z, control2.z, target.z, t), vec.z);
+    }
+
+    TEST_ASSERT_TRUE(max_error > 10);
+
+    sb_trajectory_player_destroy(&player);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_append_bezier_invalid_coordinate(void)
+{
+    sb_vector3_with_yaw_t control1 = { 10, 0, 0, 0 };
+    sb_vector3_with_yaw_t control2 = { 200000, 0, 0, 0 };
+    sb_vector3_with_yaw_t target = { 20, 0, 0, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_append_cubic_bezier(&builder, control1, control2, target, 1000));
+    TEST_ASSERT_EQUAL(9, sb_buffer_size(&builder.buffer));
+    sb_trajectory_builder_destroy(&builder);
+}
+
 void test_set_start_position_later(void)
 {
     sb_vector3_with_yaw_t vec;
@@ -315,6 +590,208 @@ void test_hold_position_for(void)
     sb_trajectory_builder_destroy(&builder);
 }
 
+#define NUM_SAMPLES 1001
+
+static uint32_t sample_times[NUM_SAMPLES];
+static sb_vector3_with_yaw_t sample_positions[NUM_SAMPLES];
+
+static void make_samples(sb_trajectory_samples_t* samples, float phase)
+{
+    size_t i;
+    float t;
+
+    /* 20 seconds of a helix, sampled at 50 Hz */
+    for (i = 0; i < NUM_SAMPLES; i++) {
+        sample_times[i] = i * 20;
+        t = i / 50.0f;
+        sample_positions[i].x = 1000 * cosf(t * 0.314159f + phase);
+        sample_positions[i].y = 1000 * sinf(t * 0.314159f + phase);
+        sample_positions[i].z = 100 + 50 * t;
+        sample_positions[i].yaw = 10 + 5 * t;
+    }
+
+    samples->times_msec = sample_times;
+    samples->positions = sample_positions;
+    samples->num_samples = NUM_SAMPLES;
+}
+
+static size_t count_segments(const sb_trajectory_t* trajectory)
+{
+    sb_trajectory_player_t player;
+    size_t result = 0;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, trajectory));
+    while (sb_trajectory_player_has_more_segments(&player)) {
+        result++;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_next_segment(&player));
+    }
+    sb_trajectory_player_destroy(&player);
+
+    return result;
+}
+
+void test_fit_samples(void)
+{
+    sb_trajectory_samples_t samples;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t vec;
+    size_t i;
+
+    make_samples(&samples, 0);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, SB_TRAJECTORY_USE_YAW));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, sample_positions[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_fit_samples(&builder, &samples, 5, 0.5f));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(20000, sb_trajectory_get_total_duration_msec(&trajectory));
+    TEST_ASSERT_LESS_THAN(50, count_segments(&trajectory));
+
+    /* Allow one extra unit for the quantization of the control points */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+    for (i = 0; i < NUM_SAMPLES; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, sample_times[i] / 1000.0f, &vec));
+        TEST_ASSERT_FLOAT_WITHIN(6, sample_positions[i].x, vec.x);
+        TEST_ASSERT_FLOAT_WITHIN(6, sample_positions[i].y, vec.y);
+        TEST_ASSERT_FLOAT_WITHIN(6, sample_positions[i].z, vec.z);
+        TEST_ASSERT_FLOAT_WITHIN(0.6f, sample_positions[i].yaw, vec.yaw);
+    }
+    sb_trajectory_player_destroy(&player);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_fit_samples_error_bound_after_encoding(void)
+{
+    sb_trajectory_samples_t samples;
+    sb_trajectory_t trajectory;
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t vec;
+    size_t i;
+    float t;
+
+    /* Small wiggles at a coarse scale, where simplifying the axes of the
+     * fitted segments would add up to one more unit of error */
+    for (i = 0; i < 601; i++) {
+        sample_times[i] = i * 20;
+        t = i / 50.0f;
+        sample_positions[i].x = 8 * sinf(t * 2.5f) + 4 * t;
+        sample_positions[i].y = 40 * sinf(t * 5.0f);
+        sample_positions[i].z = 1000 + 12 * sinf(t * 0.3f);
+        sample_positions[i].yaw = 0;
+    }
+
+    samples.times_msec = sample_times;
+    samples.positions = sample_positions;
+    samples.num_samples = 601;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 10, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, sample_positions[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_fit_samples(&builder, &samples, 10, INFINITY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    /* Every sample after the first one must be within the tolerance in the
+     * decoded trajectory; allow a tiny slack for floating-point evaluation */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+    for (i = 1; i < 601; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&player, sample_times[i], &vec));
+        TEST_ASSERT_FLOAT_WITHIN(10.01f, sample_positions[i].x, vec.x);
+        TEST_ASSERT_FLOAT_WITHIN(10.01f, sample_positions[i].y, vec.y);
+        TEST_ASSERT_FLOAT_WITHIN(10.01f, sample_positions[i].z, vec.z);
+    }
+    sb_trajectory_player_destroy(&player);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_fit_samples_long_segments(void)
+{
+    sb_trajectory_samples_t samples;
+    sb_trajectory_t trajectory;
+    size_t i;
+
+    /* Straight line for 150 seconds must still be split into segments no
+     * longer than 60 seconds */
+    for (i = 0; i < 151; i++) {
+        sample_times[i] = i * 1000;
+        sample_positions[i].x = i * 10.0f;
+        sample_positions[i].y = 0;
+        sample_positions[i].z = 0;
+        sample_positions[i].yaw = 0;
+    }
+    samples.times_msec = sample_times;
+    samples.positions = sample_positions;
+    samples.num_samples = 151;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_fit_samples(&builder, &samples, 1, INFINITY));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(150000, sb_trajectory_get_total_duration_msec(&trajectory));
+    TEST_ASSERT_EQUAL(3, count_segments(&trajectory));
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_fit_samples_parallel(void)
+{
+    sb_trajectory_builder_t builders[3];
+    sb_trajectory_samples_t samples[3];
+    sb_trajectory_samples_t single;
+    size_t i;
+
+    make_samples(&single, 0);
+
+    for (i = 0; i < 3; i++) {
+        samples[i] = single;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builders[i], 1, 0));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builders[i], sample_positions[0]));
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, sample_positions[0]));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_fit_samples(&builder, &single, 2, INFINITY));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_fit_samples_parallel(builders, samples, 3, 2, INFINITY, 0));
+
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(sb_buffer_size(&builder.buffer), sb_buffer_size(&builders[i].buffer));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(SB_BUFFER(builder.buffer), SB_BUFFER(builders[i].buffer), sb_buffer_size(&builder.buffer));
+        sb_trajectory_builder_destroy(&builders[i]);
+    }
+
+    sb_trajectory_builder_destroy(&builder);
+}
+
+void test_fit_samples_invalid(void)
+{
+    sb_trajectory_samples_t samples;
+    size_t size;
+
+    make_samples(&samples, 0);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    size = sb_buffer_size(&builder.buffer);
+
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_fit_samples(&builder, &samples, -1, 1));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_fit_samples(&builder, &samples, 1, -1));
+
+    sample_times[500] = sample_times[499];
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_fit_samples(&builder, &samples, 1, 1));
+    TEST_ASSERT_EQUAL(size, sb_buffer_size(&builder.buffer));
+
+    /* Out of range coordinates */
+    make_samples(&samples, 0);
+    sample_positions[500].x = 100000;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_builder_fit_samples(&builder, &samples, 1, 1));
+
+    sb_trajectory_builder_destroy(&builder);
+}
+
 void test_conversion_to_trajectory(void)
 {
     sb_vector3_with_yaw_t vec;
@@ -376,7 +853,18 @@ int main(int argc, char* argv[])
     RUN_TEST(test_set_start_position_invalid_coordinate);
     RUN_TEST(test_set_start_position_later);
     RUN_TEST(test_append_line);
+    RUN_TEST(test_append_lines);
     RUN_TEST(test_hold_position_for);
+    RUN_TEST(test_append_cubic_bezier);
+    RUN_TEST(test_append_poly7d);
+    RUN_TEST(test_append_cubic_bezier_chained_without_drift);
+    RUN_TEST(test_append_cubic_bezier_error_bound);
+    RUN_TEST(test_append_bezier_invalid_coordinate);
+    RUN_TEST(test_fit_samples);
+    RUN_TEST(test_fit_samples_error_bound_after_encoding);
+    RUN_TEST(test_fit_samples_long_segments);
+    RUN_TEST(test_fit_samples_parallel);
+    RUN_TEST(test_fit_samples_invalid);
     RUN_TEST(test_conversion_to_trajectory);
 
     return UNITY_END();
@@ -17,6 +17,8 @@
  * this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+
 #include <skybrush/formats/binary.h>
 #include <skybrush/trajectory.h>
 
@@ -207,6 +209,248 @@ void test_acceleration_at(void)
     }
 }
 
+void test_perf_counters(void)
+{
+    sb_perf_counters_t counters;
+    sb_vector3_with_yaw_t vec;
+
+    sb_trajectory_player_reset_perf_counters(&player);
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+    TEST_ASSERT_EQUAL(0, counters.items_decoded);
+
+    /* Two queries in the same segment, then one that requires a rewind */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, 30, &vec));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, 30, &vec));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_acceleration_at(&player, 5, &vec));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(3, counters.seeks);
+    TEST_ASSERT_EQUAL(1, counters.rewinds);
+    TEST_ASSERT_TRUE(counters.items_decoded > 1);
+    TEST_ASSERT_EQUAL(0, counters.bytes_executed);
+    TEST_ASSERT_EQUAL(2, counters.dpoly_computations);
+    TEST_ASSERT_EQUAL(1, counters.ddpoly_computations);
+
+    sb_trajectory_player_reset_perf_counters(&player);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+    TEST_ASSERT_EQUAL(0, counters.rewinds);
+    TEST_ASSERT_EQUAL(0, counters.dpoly_computations);
+#else
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, 30, &vec));
+    TEST_ASSERT_EQUAL(SB_EUNSUPPORTED, sb_trajectory_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+    TEST_ASSERT_EQUAL(0, counters.items_decoded);
+#endif
+}
+
+void test_kinematics_at_msec(void)
+{
+    sb_vector3_with_yaw_t expected, actual;
+    float t;
+
+    /* the millisecond-based API must agree with the seconds-based one */
+    for (t = 0; t <= 62; t += 0.5f) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t, &expected));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&player, t * 1000, &actual));
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.x, actual.x);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.y, actual.y);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.z, actual.z);
+
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, t, &expected));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at_msec(&player, t * 1000, &actual));
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.x, actual.x);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.y, actual.y);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.z, actual.z);
+
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_acceleration_at(&player, t, &expected));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_acceleration_at_msec(&player, t * 1000, &actual));
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.x, actual.x);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.y, actual.y);
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, expected.z, actual.z);
+    }
+
+    /* times beyond the end of the trajectory */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&player, 1.0e12, &actual));
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, 0, actual.z);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&player, INFINITY, &actual));
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, 0, actual.z);
+}
+
+void test_position_at_msec_late_in_long_show(void)
+{
+    const uint32_t hold_msec = 5 * 3600 * 1000;
+    sb_trajectory_builder_t builder;
+    sb_trajectory_t long_trajectory;
+    sb_trajectory_player_t long_player;
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+    sb_vector3_with_yaw_t target = { 10000, 0, 0, 0 };
+    sb_vector3_with_yaw_t pos;
+    int i;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_hold_position_for(&builder, hold_msec));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(&builder, target, 10000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&long_trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&long_player, &long_trajectory));
+
+    /* the drone moves 1 mm per millisecond after the hold; sub-millisecond
+     * steps around the boundary must be resolved exactly */
+    for (i = -4; i <= 8; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at_msec(&long_player, hold_msec + i * 0.25, &pos));
+        TEST_ASSERT_FLOAT_WITHIN(1e-3, i > 0 ? i * 0.25 : 0, pos.x);
+    }
+
+    sb_trajectory_player_destroy(&long_player);
+    sb_trajectory_destroy(&long_trajectory);
+}
+
+void test_build_previous_segment(void)
+{
+    sb_trajectory_segment_t forward[64];
+    const sb_trajectory_segment_t* segment;
+    sb_vector3_with_yaw_t expected, actual;
+    sb_trajectory_t empty;
+    sb_trajectory_player_t empty_player;
+    size_t i, num_segments = 0;
+
+    /* Record the segments while iterating forwards */
+    while (sb_trajectory_player_has_more_segments(&player)) {
+        TEST_ASSERT_TRUE(num_segments < sizeof(forward) / sizeof(forward[0]));
+        forward[num_segments++] = *sb_trajectory_player_get_current_segment(&player);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_next_segment(&player));
+    }
+    TEST_ASSERT_TRUE(num_segments > 1);
+
+    /* Stepping back from beyond the end yields the last segment */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_previous_segment(&player));
+    segment = sb_trajectory_player_get_current_segment(&player);
+    TEST_ASSERT_EQUAL(forward[num_segments - 1].start_time_msec, segment->start_time_msec);
+
+    /* Iterate backwards from the last segment and compare with the segments
+     * seen during the forward pass */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_last_segment(&player));
+    i = num_segments;
+    while (i > 0) {
+        i--;
+        segment = sb_trajectory_player_get_current_segment(&player);
+
+        TEST_ASSERT_EQUAL(forward[i].start_time_msec, segment->start_time_msec);
+        TEST_ASSERT_EQUAL(forward[i].duration_msec, segment->duration_msec);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].start.x, segment->start.x);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].start.y, segment->start.y);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].start.z, segment->start.z);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].start.yaw, segment->start.yaw);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].end.x, segment->end.x);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].end.y, segment->end.y);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].end.z, segment->end.z);
+        TEST_ASSERT_EQUAL_FLOAT(forward[i].end.yaw, segment->end.yaw);
+
+        expected = sb_poly_4d_eval(&forward[i].poly, 0.5f);
+        actual = sb_poly_4d_eval(&segment->poly, 0.5f);
+        TEST_ASSERT_EQUAL_FLOAT(expected.x, actual.x);
+        TEST_ASSERT_EQUAL_FLOAT(expected.y, actual.y);
+        TEST_ASSERT_EQUAL_FLOAT(expected.z, actual.z);
+
+        if (i > 0) {
+            TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_previous_segment(&player));
+        }
+    }
+
+    /* Cannot step back from the first segment */
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_trajectory_player_build_previous_segment(&player));
+    TEST_ASSERT_EQUAL(0, sb_trajectory_player_get_current_segment(&player)->start_time_msec);
+
+    /* Forward iteration still works after stepping backwards */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_next_segment(&player));
+    TEST_ASSERT_EQUAL(forward[1].start_time_msec, sb_trajectory_player_get_current_segment(&player)->start_time_msec);
+
+    /* Empty trajectory has no last segment */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_empty(&empty));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&empty_player, &empty));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_trajectory_player_build_last_segment(&empty_player));
+    TEST_ASSERT_EQUAL(SB_ENOENT, sb_trajectory_player_build_previous_segment(&empty_player));
+    sb_trajectory_player_destroy(&empty_player);
+    sb_trajectory_destroy(&empty);
+}
+
+void test_snapshot(void)
+{
+    sb_trajectory_player_t other;
+    sb_trajectory_player_snapshot_t snapshot;
+    sb_perf_counters_t counters;
+    sb_vector3_with_yaw_t pos, expected;
+    float t;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, 32, &pos));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&other, &trajectory));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    sb_trajectory_player_reset_perf_counters(&other);
+
+    /* Restoring must not skim the trajectory to build the segment table */
+    TEST_ASSERT_NULL(other.segment_table);
+
+    /* Restored player must continue from the same segment */
+    for (t = 32; t <= 60; t += 2) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, t, &expected));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&other, t, &pos));
+        TEST_ASSERT_EQUAL_FLOAT(expected.x, pos.x);
+        TEST_ASSERT_EQUAL_FLOAT(expected.y, pos.y);
+        TEST_ASSERT_EQUAL_FLOAT(expected.z, pos.z);
+        TEST_ASSERT_EQUAL_FLOAT(expected.yaw, pos.yaw);
+    }
+
+    if (sb_trajectory_player_get_perf_counters(&other, &counters) == SB_SUCCESS) {
+        TEST_ASSERT_EQUAL(0, counters.rewinds);
+    }
+
+    /* Seeking backwards after a restore must still work */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&other, 5, &pos));
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, 5000, pos.z);
+
+    /* Snapshots of other trajectories are rejected */
+    snapshot.trajectory_size++;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    snapshot.trajectory_size--;
+    snapshot.offset = 0;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+
+    /* Offsets past or too close to the end of the buffer are rejected, and
+     * so are offsets where the buffer does not hold a segment of the length
+     * recorded in the snapshot */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, 32, &pos));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+    snapshot.offset = snapshot.trajectory_size + 1;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+    snapshot.offset++;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+    snapshot.offset = snapshot.trajectory_size - 1;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+    snapshot.length++;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+
+    /* Snapshots taken after the end of the trajectory can be restored */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, 1000, &expected));
+    sb_trajectory_player_save_snapshot(&player, &snapshot);
+    TEST_ASSERT_EQUAL(snapshot.trajectory_size, snapshot.offset);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_restore_snapshot(&other, &snapshot));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&other, 1000, &pos));
+    TEST_ASSERT_EQUAL_FLOAT(expected.z, pos.z);
+
+    sb_trajectory_player_destroy(&other);
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
@@ -214,6 +458,11 @@ int main(int argc, char* argv[])
     RUN_TEST(test_position_at);
     RUN_TEST(test_velocity_at);
     RUN_TEST(test_acceleration_at);
+    RUN_TEST(test_perf_counters);
+    RUN_TEST(test_kinematics_at_msec);
+    RUN_TEST(test_position_at_msec_late_in_long_show);
+    RUN_TEST(test_build_previous_segment);
+    RUN_TEST(test_snapshot);
 
     return UNITY_END();
 }
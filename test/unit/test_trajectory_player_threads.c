@@ -0,0 +1,154 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../src/parallel.h"
+#include <stdio.h>
+#include <string.h>
+
+#include <skybrush/formats/binary.h>
+#include <skybrush/trajectory.h>
+
+#include "unity.h"
+
+#define NUM_SAMPLES 512
+#define NUM_TASKS 64
+#define NUM_THREADS 16
+#define NUM_ROUNDS 8
+
+sb_trajectory_t trajectory;
+sb_vector3_with_yaw_t expected_pos[NUM_SAMPLES];
+sb_vector3_with_yaw_t expected_vel[NUM_SAMPLES];
+float sample_times[NUM_SAMPLES];
+size_t mismatches[NUM_TASKS];
+
+void setUp(void)
+{
+    FILE* fp;
+    int fd;
+
+    fp = fopen("fixtures/real_show.skyb", "rb");
+    if (fp == 0) {
+        abort();
+    }
+
+    fd = fileno(fp);
+    if (fd < 0) {
+        abort();
+    }
+
+    if (sb_trajectory_init_from_binary_file(&trajectory, fd)) {
+        abort();
+    }
+
+    fclose(fp);
+}
+
+void tearDown(void)
+{
+    sb_trajectory_destroy(&trajectory);
+}
+
+/**
+ * Queries the shared trajectory with a player of its own in each task and
+ * counts the results that differ from the ones calculated on a single thread.
+ */
+static sb_error_t query_trajectory_range(void* context, size_t start, size_t end)
+{
+    sb_trajectory_player_t player;
+    sb_vector3_with_yaw_t pos, vel;
+    size_t task, round, i, index;
+
+    (void)context;
+
+    for (task = start; task < end; task++) {
+        SB_CHECK(sb_trajectory_player_init(&player, &trajectory));
+
+        for (round = 0; round < NUM_ROUNDS; round++) {
+            for (i = 0; i < NUM_SAMPLES; i++) {
+                /* each task sweeps forward from a different sample and
+                 * wraps around once, so players both step and rewind */
+                index = (i + task * 37 + round * 101) % NUM_SAMPLES;
+
+                SB_CHECK(sb_trajectory_player_get_position_at(&player, sample_times[index], &pos));
+                SB_CHECK(sb_trajectory_player_get_velocity_at(&player, sample_times[index], &vel));
+
+                if (memcmp(&pos, &expected_pos[index], sizeof(pos)) != 0 || memcmp(&vel, &expected_vel[index], sizeof(vel)) != 0) {
+                    mismatches[task]++;
+                }
+            }
+        }
+
+        sb_trajectory_player_destroy(&player);
+    }
+
+    return SB_SUCCESS;
+}
+
+void test_freeze(void)
+{
+    uint32_t duration = sb_trajectory_get_total_duration_msec(&trajectory);
+
+    TEST_ASSERT_FALSE(sb_trajectory_is_frozen(&trajectory));
+
+    sb_trajectory_freeze(&trajectory);
+    TEST_ASSERT_TRUE(sb_trajectory_is_frozen(&trajectory));
+
+    /* frozen trajectories cannot be modified */
+    TEST_ASSERT_EQUAL(SB_EPERM, sb_trajectory_clear(&trajectory));
+    TEST_ASSERT_EQUAL(duration, sb_trajectory_get_total_duration_msec(&trajectory));
+    TEST_ASSERT_FALSE(sb_trajectory_is_empty(&trajectory));
+}
+
+void test_concurrent_players(void)
+{
+    sb_trajectory_player_t player;
+    float duration;
+    size_t i;
+
+    sb_trajectory_freeze(&trajectory);
+
+    duration = sb_trajectory_get_total_duration_sec(&trajectory);
+    TEST_ASSERT_TRUE(duration > 0);
+
+    /* calculate the expected results on a single thread */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, &trajectory));
+    for (i = 0; i < NUM_SAMPLES; i++) {
+        sample_times[i] = duration * i / (NUM_SAMPLES - 1);
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(&player, sample_times[i], &expected_pos[i]));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_velocity_at(&player, sample_times[i], &expected_vel[i]));
+    }
+    sb_trajectory_player_destroy(&player);
+
+    memset(mismatches, 0, sizeof(mismatches));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_i_parallel_for(NUM_TASKS, NUM_THREADS, query_trajectory_range, 0));
+
+    for (i = 0; i < NUM_TASKS; i++) {
+        TEST_ASSERT_EQUAL(0, mismatches[i]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_freeze);
+    RUN_TEST(test_concurrent_players);
+
+    return UNITY_END();
+}
@@ -0,0 +1,287 @@
+/*
+ * This file is part of libskybrush.
+ *
+ * Copyright 2020-2025 CollMot Robotics Ltd.
+ *
+ * libskybrush is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libskybrush is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <skybrush/trajectory.h>
+
+#include "unity.h"
+
+sb_trajectory_t trajectory;
+sb_trajectory_t simplified;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void loadFixture(const char* fname)
+{
+    FILE* fp;
+    int fd;
+
+    fp = fopen(fname, "rb");
+    if (fp == 0) {
+        perror(fname);
+        abort();
+    }
+
+    fd = fileno(fp);
+    if (fd < 0) {
+        perror(NULL);
+        abort();
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_binary_file(&trajectory, fd));
+
+    fclose(fp);
+}
+
+static size_t countSegments(const sb_trajectory_t* trajectory)
+{
+    sb_trajectory_player_t player;
+    size_t result = 0;
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&player, trajectory));
+    while (sb_trajectory_player_has_more_segments(&player)) {
+        result++;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_build_next_segment(&player));
+    }
+    sb_trajectory_player_destroy(&player);
+
+    return result;
+}
+
+static void assertTrajectoriesWithin(
+    float tolerance, const sb_trajectory_t* expected, const sb_trajectory_t* actual)
+{
+    sb_trajectory_player_t expected_player, actual_player;
+    sb_vector3_with_yaw_t expected_pos, actual_pos;
+    uint32_t duration_msec, t;
+
+    duration_msec = sb_trajectory_get_total_duration_msec(expected);
+    TEST_ASSERT_EQUAL(duration_msec, sb_trajectory_get_total_duration_msec(actual));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&expected_player, expected));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_init(&actual_player, actual));
+
+    for (t = 0; t <= duration_msec; t += 50) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(
+                                          &expected_player, t / 1000.0f, &expected_pos));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_player_get_position_at(
+                                          &actual_player, t / 1000.0f, &actual_pos));
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, expected_pos.x, actual_pos.x);
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, expected_pos.y, actual_pos.y);
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, expected_pos.z, actual_pos.z);
+    }
+
+    sb_trajectory_player_destroy(&actual_player);
+    sb_trajectory_player_destroy(&expected_player);
+}
+
+static void buildTrajectory(void (*func)(sb_trajectory_builder_t*))
+{
+    sb_trajectory_builder_t builder;
+    sb_vector3_with_yaw_t start = { 0, 0, 0, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_init(&builder, 1, 0));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_set_start_position(&builder, start));
+    func(&builder);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_from_builder(&trajectory, &builder));
+    sb_trajectory_builder_destroy(&builder);
+}
+
+static void appendCollinearLines(sb_trajectory_builder_t* builder)
+{
+    sb_vector3_with_yaw_t target = { 0, 0, 0, 0 };
+    int i;
+
+    for (i = 1; i <= 4; i++) {
+        target.x = 100 * i;
+        target.z = 50 * i;
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(builder, target, 1000));
+    }
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_hold_position_for(builder, 2000));
+}
+
+static void appendCurve(sb_trajectory_builder_t* builder)
+{
+    sb_vector3_with_yaw_t c1 = { 0, 500, 0, 0 };
+    sb_vector3_with_yaw_t c2 = { 1000, 500, 0, 0 };
+    sb_vector3_with_yaw_t target = { 1000, 0, 0, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(
+                                      builder, c1, c2, target, 5000));
+}
+
+static void appendNearlyStraightCurve(sb_trajectory_builder_t* builder)
+{
+    sb_vector3_with_yaw_t c1 = { 333, 10, 0, 0 };
+    sb_vector3_with_yaw_t c2 = { 667, -10, 0, 0 };
+    sb_vector3_with_yaw_t target = { 1000, 0, 0, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_cubic_bezier(
+                                      builder, c1, c2, target, 5000));
+}
+
+static void appendLinesWithJump(sb_trajectory_builder_t* builder)
+{
+    sb_vector3_with_yaw_t target = { 100, 0, 0, 0 };
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(builder, target, 1000));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(builder, target, 0));
+    target.x = 200;
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_builder_append_line(builder, target, 1000));
+}
+
+void test_simplify_collinear_lines(void)
+{
+    sb_vector3_with_yaw_t pos;
+
+    buildTrajectory(appendCollinearLines);
+    TEST_ASSERT_EQUAL(5, countSegments(&trajectory));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 1, 1));
+    TEST_ASSERT_EQUAL(2, countSegments(&simplified));
+    assertTrajectoriesWithin(1e-3f, &trajectory, &simplified);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_get_end_position(&simplified, &pos));
+    TEST_ASSERT_EQUAL_FLOAT(400, pos.x);
+    TEST_ASSERT_EQUAL_FLOAT(0, pos.y);
+    TEST_ASSERT_EQUAL_FLOAT(200, pos.z);
+
+    sb_trajectory_destroy(&simplified);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_curve(void)
+{
+    buildTrajectory(appendCurve);
+
+    /* Curve deviates from a straight line by ~375 units, so it must be kept */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 100, 1));
+    TEST_ASSERT_EQUAL(1, countSegments(&simplified));
+    TEST_ASSERT_EQUAL(sb_buffer_size(&trajectory.buffer), sb_buffer_size(&simplified.buffer));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(
+        SB_BUFFER(trajectory.buffer), SB_BUFFER(simplified.buffer),
+        sb_buffer_size(&trajectory.buffer));
+    sb_trajectory_destroy(&simplified);
+
+    /* ...unless the tolerance is large enough */
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 400, 1));
+    TEST_ASSERT_EQUAL(1, countSegments(&simplified));
+    TEST_ASSERT_LESS_THAN(sb_buffer_size(&trajectory.buffer), sb_buffer_size(&simplified.buffer));
+    assertTrajectoriesWithin(400, &trajectory, &simplified);
+    sb_trajectory_destroy(&simplified);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_nearly_straight_curve(void)
+{
+    buildTrajectory(appendNearlyStraightCurve);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 1, 1));
+    TEST_ASSERT_EQUAL(sb_buffer_size(&trajectory.buffer), sb_buffer_size(&simplified.buffer));
+    sb_trajectory_destroy(&simplified);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 5, 1));
+    TEST_ASSERT_LESS_THAN(sb_buffer_size(&trajectory.buffer), sb_buffer_size(&simplified.buffer));
+    assertTrajectoriesWithin(5, &trajectory, &simplified);
+    sb_trajectory_destroy(&simplified);
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_does_not_merge_zero_duration_segments(void)
+{
+    buildTrajectory(appendLinesWithJump);
+    TEST_ASSERT_EQUAL(3, countSegments(&trajectory));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 1000, 1));
+    TEST_ASSERT_EQUAL(3, countSegments(&simplified));
+    assertTrajectoriesWithin(1e-3f, &trajectory, &simplified);
+
+    sb_trajectory_destroy(&simplified);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_fixture(void)
+{
+    float tolerances[] = { 0, 10, 100, 1000 };
+    size_t i, num_segments, last_num_segments;
+
+    loadFixture("fixtures/test.skyb");
+    last_num_segments = countSegments(&trajectory);
+
+    for (i = 0; i < sizeof(tolerances) / sizeof(tolerances[0]); i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(
+                                          &simplified, &trajectory, tolerances[i], 1));
+
+        num_segments = countSegments(&simplified);
+        TEST_ASSERT_LESS_OR_EQUAL(last_num_segments, num_segments);
+        last_num_segments = num_segments;
+
+        /* allow for rounding of floats */
+        assertTrajectoriesWithin(tolerances[i] + 1e-2f, &trajectory, &simplified);
+
+        sb_trajectory_destroy(&simplified);
+    }
+
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_empty(void)
+{
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_empty(&trajectory));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_trajectory_init_simplified(&simplified, &trajectory, 1, 1));
+    TEST_ASSERT_TRUE(sb_trajectory_is_empty(&simplified));
+    sb_trajectory_destroy(&simplified);
+    sb_trajectory_destroy(&trajectory);
+}
+
+void test_simplify_invalid_tolerance(void)
+{
+    loadFixture("fixtures/test.skyb");
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_init_simplified(&simplified, &trajectory, -1, 1));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_init_simplified(&simplified, &trajectory, 1, -1));
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_trajectory_init_simplified(&simplified, &trajectory, NAN, 1));
+    sb_trajectory_destroy(&trajectory);
+}
+
+int main(int argc, char* argv[])
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_simplify_collinear_lines);
+    RUN_TEST(test_simplify_curve);
+    RUN_TEST(test_simplify_nearly_straight_curve);
+    RUN_TEST(test_simplify_does_not_merge_zero_duration_segments);
+    RUN_TEST(test_simplify_fixture);
+    RUN_TEST(test_simplify_empty);
+    RUN_TEST(test_simplify_invalid_tolerance);
+
+    return UNITY_END();
+}
@@ -133,12 +133,83 @@ void test_yaw_rate_at(void)
     }
 }
 
+void test_perf_counters(void)
+{
+    sb_perf_counters_t counters;
+    float value;
+
+    sb_yaw_player_reset_perf_counters(&player);
+
+#ifdef SB_ENABLE_PERF_COUNTERS
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&player, 0.0045, &value));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&player, 0.0005, &value));
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(2, counters.seeks);
+    TEST_ASSERT_EQUAL(1, counters.rewinds);
+    TEST_ASSERT_TRUE(counters.items_decoded > 1);
+    TEST_ASSERT_EQUAL(0, counters.dpoly_computations);
+
+    sb_yaw_player_reset_perf_counters(&player);
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+    TEST_ASSERT_EQUAL(0, counters.items_decoded);
+#else
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&player, 0.004, &value));
+    TEST_ASSERT_EQUAL(SB_EUNSUPPORTED, sb_yaw_player_get_perf_counters(&player, &counters));
+    TEST_ASSERT_EQUAL(0, counters.seeks);
+#endif
+}
+
+void test_snapshot(void)
+{
+    sb_yaw_player_t other;
+    sb_yaw_player_snapshot_t snapshot;
+    float t[] = { 2.5, 3, 4, 5, 100 };
+    float value, expected;
+    int i, n = sizeof(t) / sizeof(t[0]);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&player, t[0] / 1000.0f, &value));
+    sb_yaw_player_save_snapshot(&player, &snapshot);
+
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_init(&other, &ctrl));
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_restore_snapshot(&other, &snapshot));
+
+    for (i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&player, t[i] / 1000.0f, &expected));
+        TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_get_yaw_at(&other, t[i] / 1000.0f, &value));
+        TEST_ASSERT_EQUAL_FLOAT(expected, value);
+    }
+
+    /* Snapshots of other yaw control objects are rejected */
+    snapshot.ctrl_size++;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_yaw_player_restore_snapshot(&other, &snapshot));
+    snapshot.ctrl_size--;
+
+    /* Offsets past the end of the buffer or not at the start of a delta are
+     * rejected */
+    snapshot.offset = ctrl.buffer_length - 1;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_yaw_player_restore_snapshot(&other, &snapshot));
+    snapshot.offset = ctrl.header_length + 1;
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_yaw_player_restore_snapshot(&other, &snapshot));
+    snapshot.offset = ctrl.header_length + 4 * (ctrl.num_deltas + 1);
+    TEST_ASSERT_EQUAL(SB_EINVAL, sb_yaw_player_restore_snapshot(&other, &snapshot));
+
+    /* The state after the last delta can be restored */
+    snapshot.offset = ctrl.header_length + 4 * ctrl.num_deltas;
+    TEST_ASSERT_EQUAL(SB_SUCCESS, sb_yaw_player_restore_snapshot(&other, &snapshot));
+
+    sb_yaw_player_destroy(&other);
+}
+
 int main(int argc, char* argv[])
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_yaw_at);
     RUN_TEST(test_yaw_rate_at);
+    RUN_TEST(test_perf_counters);
+    RUN_TEST(test_snapshot);
 
     return UNITY_END();
 }